@@ -0,0 +1,353 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+using System.Text.RegularExpressions;
+
+namespace CSIRO.Metaheuristics.Benchmarks
+{
+    /// <summary>
+    /// The timing loop of a benchmark, in the manner of Google Benchmark: the body of a benchmark runs its setup,
+    /// then repeats the measured operation while <see cref="KeepRunning"/> returns true.
+    /// </summary>
+    public sealed class BenchmarkState
+    {
+        internal BenchmarkState(long maxIterations)
+        {
+            this.maxIterations = maxIterations;
+            Counters = new Dictionary<string, double>();
+        }
+
+        private readonly long maxIterations;
+        private long iterations = 0;
+        private readonly Stopwatch stopwatch = new Stopwatch();
+        private TimeSpan cpuStart;
+        private TimeSpan cpuTime = TimeSpan.Zero;
+
+        /// <summary>
+        /// Gets whether to run one more iteration; the timers start at the first call, and stop when this returns false.
+        /// </summary>
+        public bool KeepRunning()
+        {
+            if (iterations == 0)
+                ResumeTiming();
+            if (iterations < maxIterations)
+            {
+                iterations++;
+                return true;
+            }
+            PauseTiming();
+            return false;
+        }
+
+        /// <summary>
+        /// Stops the timers, e.g. to exclude setting up the next iteration
+        /// </summary>
+        public void PauseTiming()
+        {
+            if (!stopwatch.IsRunning)
+                return;
+            stopwatch.Stop();
+            cpuTime += Process.GetCurrentProcess().TotalProcessorTime - cpuStart;
+        }
+
+        public void ResumeTiming()
+        {
+            if (stopwatch.IsRunning)
+                return;
+            cpuStart = Process.GetCurrentProcess().TotalProcessorTime;
+            stopwatch.Start();
+        }
+
+        /// <summary>
+        /// Gets or sets the number of items, e.g. objective evaluations, processed by all the iterations
+        /// </summary>
+        public long ItemsProcessed { get; set; }
+
+        /// <summary>
+        /// Gets additional values reported with the result, averaged per iteration
+        /// </summary>
+        public IDictionary<string, double> Counters { get; private set; }
+
+        internal long Iterations { get { return iterations; } }
+        internal double ElapsedSeconds { get { return stopwatch.Elapsed.TotalSeconds; } }
+        internal double CpuSeconds { get { return cpuTime.TotalSeconds; } }
+    }
+
+    public class Benchmark
+    {
+        public Benchmark(string name, Action<BenchmarkState> body)
+        {
+            Name = name;
+            Body = body;
+        }
+
+        public string Name { get; private set; }
+        public Action<BenchmarkState> Body { get; private set; }
+    }
+
+    public class BenchmarkResult
+    {
+        public string Name;
+        public string RunName;
+        /// <summary>null for a single run, otherwise e.g. "mean" for aggregates of repeated runs</summary>
+        public string AggregateName;
+        public int Repetitions;
+        public long Iterations;
+        /// <summary>Wall clock time per iteration, in seconds</summary>
+        public double RealTime;
+        /// <summary>Processor time of all the threads of the process per iteration, in seconds</summary>
+        public double CpuTime;
+        /// <summary>Items processed per second of wall clock time, NaN if the benchmark does not count items</summary>
+        public double ItemsPerSecond = double.NaN;
+        public Dictionary<string, double> Counters = new Dictionary<string, double>();
+    }
+
+    /// <summary>
+    /// Runs benchmarks until their measurements are significant, and writes the results in a machine-readable form:
+    /// the JSON or CSV layouts of Google Benchmark, so that the results of the managed and native benchmarks can be tracked with the same tools.
+    /// </summary>
+    public class BenchmarkRunner
+    {
+        public BenchmarkRunner()
+        {
+            MinTime = 0.5;
+            Repetitions = 1;
+            MaxIterations = 1000000000;
+        }
+
+        /// <summary>
+        /// Gets or sets the minimum wall clock time in seconds of the measured iterations of a run
+        /// </summary>
+        public double MinTime { get; set; }
+
+        /// <summary>
+        /// Gets or sets the number of runs of each benchmark; more than one adds the mean, median and standard deviation of the runs
+        /// </summary>
+        public int Repetitions { get; set; }
+
+        public long MaxIterations { get; set; }
+
+        public List<BenchmarkResult> Run(IEnumerable<Benchmark> benchmarks, string filter = null, TextWriter progress = null)
+        {
+            var regex = (string.IsNullOrEmpty(filter) ? null : new Regex(filter));
+            var results = new List<BenchmarkResult>();
+            foreach (var b in benchmarks)
+            {
+                if (regex != null && !regex.IsMatch(b.Name))
+                    continue;
+                var runs = new List<BenchmarkResult>();
+                for (int i = 0; i < Repetitions; i++)
+                {
+                    var r = runOnce(b);
+                    runs.Add(r);
+                    if (progress != null)
+                        progress.WriteLine(FormatLine(r));
+                }
+                results.AddRange(runs);
+                if (Repetitions > 1)
+                {
+                    foreach (var aggregate in aggregates(runs))
+                    {
+                        results.Add(aggregate);
+                        if (progress != null)
+                            progress.WriteLine(FormatLine(aggregate));
+                    }
+                }
+            }
+            return results;
+        }
+
+        private BenchmarkResult runOnce(Benchmark b)
+        {
+            long iterations = 1;
+            while (true)
+            {
+                var state = new BenchmarkState(iterations);
+                b.Body(state);
+                if (state.Iterations < iterations)
+                    throw new InvalidOperationException("Benchmark " + b.Name + " did not run the iterations requested");
+                double elapsed = state.ElapsedSeconds;
+                if (elapsed >= MinTime || iterations >= MaxIterations)
+                    return createResult(b, state);
+                // Same growth heuristic as Google Benchmark: aim 40% beyond the minimum time, growing tenfold at most.
+                double multiplier = (elapsed <= 0 ? 10 : Math.Min(10, MinTime * 1.4 / elapsed));
+                iterations = Math.Min(MaxIterations, Math.Max(iterations + 1, (long)(iterations * multiplier)));
+            }
+        }
+
+        private static BenchmarkResult createResult(Benchmark b, BenchmarkState state)
+        {
+            var r = new BenchmarkResult
+            {
+                Name = b.Name,
+                RunName = b.Name,
+                Repetitions = 1,
+                Iterations = state.Iterations,
+                RealTime = state.ElapsedSeconds / state.Iterations,
+                CpuTime = state.CpuSeconds / state.Iterations,
+            };
+            if (state.ItemsProcessed > 0)
+                r.ItemsPerSecond = state.ItemsProcessed / state.ElapsedSeconds;
+            foreach (var c in state.Counters)
+                r.Counters[c.Key] = c.Value / state.Iterations;
+            return r;
+        }
+
+        private static IEnumerable<BenchmarkResult> aggregates(List<BenchmarkResult> runs)
+        {
+            var functions = new Dictionary<string, Func<double[], double>>
+            {
+                { "mean", mean },
+                { "median", median },
+                { "stddev", stdDev },
+            };
+            foreach (var f in functions)
+            {
+                var r = new BenchmarkResult
+                {
+                    Name = runs[0].Name + "_" + f.Key,
+                    RunName = runs[0].Name,
+                    AggregateName = f.Key,
+                    Repetitions = runs.Count,
+                    Iterations = runs.Count,
+                    RealTime = f.Value(runs.Select(x => x.RealTime).ToArray()),
+                    CpuTime = f.Value(runs.Select(x => x.CpuTime).ToArray()),
+                    ItemsPerSecond = f.Value(runs.Select(x => x.ItemsPerSecond).ToArray()),
+                };
+                foreach (var k in runs[0].Counters.Keys)
+                    r.Counters[k] = f.Value(runs.Select(x => x.Counters[k]).ToArray());
+                yield return r;
+            }
+        }
+
+        private static double mean(double[] x)
+        {
+            return x.Average();
+        }
+
+        private static double median(double[] x)
+        {
+            var sorted = x.OrderBy(v => v).ToArray();
+            int n = sorted.Length;
+            return (n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+        }
+
+        private static double stdDev(double[] x)
+        {
+            if (x.Length < 2)
+                return 0;
+            double m = mean(x);
+            return Math.Sqrt(x.Sum(v => (v - m) * (v - m)) / (x.Length - 1));
+        }
+
+        public static string FormatLine(BenchmarkResult r)
+        {
+            var sb = new StringBuilder();
+            sb.AppendFormat(CultureInfo.InvariantCulture, "{0,-60} {1,14:0.###} us {2,14:0.###} us {3,12}", r.Name, r.RealTime * 1e6, r.CpuTime * 1e6, r.Iterations);
+            if (!double.IsNaN(r.ItemsPerSecond))
+                sb.AppendFormat(CultureInfo.InvariantCulture, " items_per_second={0:0.###}", r.ItemsPerSecond);
+            foreach (var c in r.Counters)
+                sb.AppendFormat(CultureInfo.InvariantCulture, " {0}={1:0.###}", c.Key, c.Value);
+            return sb.ToString();
+        }
+
+        /// <summary>
+        /// Writes results as the JSON output of Google Benchmark, with times in microseconds
+        /// </summary>
+        public static void WriteJson(TextWriter writer, IList<BenchmarkResult> results, IDictionary<string, string> context)
+        {
+            writer.Write("{\n  \"context\": {\n");
+            int k = 0;
+            foreach (var c in context)
+                writer.Write("    {0}: {1}{2}\n", quote(c.Key), quote(c.Value), (++k < context.Count ? "," : ""));
+            writer.Write("  },\n  \"benchmarks\": [\n");
+            for (int i = 0; i < results.Count; i++)
+            {
+                var r = results[i];
+                var fields = new List<string>
+                {
+                    quote("name") + ": " + quote(r.Name),
+                    quote("run_name") + ": " + quote(r.RunName),
+                    quote("run_type") + ": " + quote(r.AggregateName == null ? "iteration" : "aggregate"),
+                    quote("repetitions") + ": " + r.Repetitions.ToString(CultureInfo.InvariantCulture),
+                };
+                if (r.AggregateName != null)
+                    fields.Add(quote("aggregate_name") + ": " + quote(r.AggregateName));
+                fields.Add(quote("iterations") + ": " + r.Iterations.ToString(CultureInfo.InvariantCulture));
+                fields.Add(quote("real_time") + ": " + number(r.RealTime * 1e6));
+                fields.Add(quote("cpu_time") + ": " + number(r.CpuTime * 1e6));
+                fields.Add(quote("time_unit") + ": " + quote("us"));
+                if (!double.IsNaN(r.ItemsPerSecond))
+                    fields.Add(quote("items_per_second") + ": " + number(r.ItemsPerSecond));
+                foreach (var c in r.Counters)
+                    fields.Add(quote(c.Key) + ": " + number(c.Value));
+                writer.Write("    {\n      ");
+                writer.Write(string.Join(",\n      ", fields));
+                writer.Write("\n    }}{0}\n", (i < results.Count - 1 ? "," : ""));
+            }
+            writer.Write("  ]\n}\n");
+        }
+
+        /// <summary>
+        /// Writes results as the CSV output of Google Benchmark, with times in microseconds and counters as extra columns
+        /// </summary>
+        public static void WriteCsv(TextWriter writer, IList<BenchmarkResult> results)
+        {
+            var counterNames = results.SelectMany(x => x.Counters.Keys).Distinct().ToArray();
+            var header = new List<string> { "name", "iterations", "real_time", "cpu_time", "time_unit", "bytes_per_second", "items_per_second", "label", "error_occurred", "error_message" };
+            header.AddRange(counterNames.Select(x => csvQuote(x)));
+            writer.Write(string.Join(",", header) + "\n");
+            foreach (var r in results)
+            {
+                var line = new List<string>
+                {
+                    csvQuote(r.Name),
+                    r.Iterations.ToString(CultureInfo.InvariantCulture),
+                    number(r.RealTime * 1e6),
+                    number(r.CpuTime * 1e6),
+                    "us",
+                    "",
+                    (double.IsNaN(r.ItemsPerSecond) ? "" : number(r.ItemsPerSecond)),
+                    "", "", "",
+                };
+                foreach (var c in counterNames)
+                {
+                    double v;
+                    line.Add(r.Counters.TryGetValue(c, out v) ? number(v) : "");
+                }
+                writer.Write(string.Join(",", line) + "\n");
+            }
+        }
+
+        private static string number(double x)
+        {
+            if (double.IsNaN(x) || double.IsInfinity(x))
+                return "null";
+            return x.ToString("R", CultureInfo.InvariantCulture);
+        }
+
+        private static string csvQuote(string s)
+        {
+            return "\"" + s.Replace("\"", "\"\"") + "\"";
+        }
+
+        private static string quote(string s)
+        {
+            var sb = new StringBuilder("\"");
+            foreach (var c in s)
+            {
+                if (c == '"' || c == '\\')
+                    sb.Append('\\').Append(c);
+                else if (c < ' ')
+                    sb.AppendFormat(CultureInfo.InvariantCulture, "\\u{0:x4}", (int)c);
+                else
+                    sb.Append(c);
+            }
+            return sb.Append('"').ToString();
+        }
+    }
+}
@@ -0,0 +1,82 @@
+﻿using System;
+using System.Collections.Generic;
+using CSIRO.Metaheuristics.Fitness;
+using CSIRO.Metaheuristics.Objectives;
+using CSIRO.Metaheuristics.Tests;
+
+namespace CSIRO.Metaheuristics.Benchmarks
+{
+    /// <summary>
+    /// Scaling of the Pareto ranking and of the multi-objective fitness assignment with the size of the population
+    /// </summary>
+    public static class FitnessBenchmarks
+    {
+        public static IEnumerable<Benchmark> Create()
+        {
+            foreach (int numObjectives in new[] { 2, 3 })
+            {
+                foreach (int numPoints in new[] { 50, 100, 200, 400, 800 })
+                {
+                    var scores = createScores(numPoints, numObjectives);
+                    string suffix = "/objectives:" + numObjectives + "/points:" + numPoints;
+                    yield return new Benchmark("ParetoRanking" + suffix, s => paretoRanking(s, scores, new ParetoComparer<IObjectiveScores>()));
+                    yield return new Benchmark("ParetoRanking/pairwise" + suffix, s => paretoRanking(s, scores, new PairwiseParetoComparer()));
+                    yield return new Benchmark("NonDominatedSorting" + suffix, s => nonDominatedSorting(s, scores));
+                    yield return new Benchmark("ZitlerThieleFitnessAssignment" + suffix, s => zitlerThiele(s, scores));
+                }
+            }
+        }
+
+        /// <summary>
+        /// Creates a population of random scores, the same for all runs, with several Pareto fronts
+        /// </summary>
+        private static IObjectiveScores[] createScores(int numPoints, int numObjectives)
+        {
+            var random = new Random(numPoints * 10 + numObjectives);
+            var result = new IObjectiveScores[numPoints];
+            for (int i = 0; i < numPoints; i++)
+            {
+                var point = new TestHyperCube(numObjectives, 0, 0, 1);
+                var objectives = new IObjectiveScore[numObjectives];
+                for (int j = 0; j < numObjectives; j++)
+                {
+                    double x = random.NextDouble();
+                    point.SetValue(j.ToString(), x);
+                    objectives[j] = new DoubleObjectiveScore("f" + j, x, maximise: false);
+                }
+                result[i] = new MultipleScores<TestHyperCube>(objectives, point);
+            }
+            return result;
+        }
+
+        private static void paretoRanking(BenchmarkState state, IObjectiveScores[] scores, IComparer<IObjectiveScores> comparer)
+        {
+            while (state.KeepRunning())
+                new ParetoRanking<IObjectiveScores>(scores, comparer);
+            state.ItemsProcessed = state.Iterations * scores.Length;
+        }
+
+        private static void nonDominatedSorting(BenchmarkState state, IObjectiveScores[] scores)
+        {
+            while (state.KeepRunning())
+                NonDominatedSorting<IObjectiveScores>.Create(scores);
+            state.ItemsProcessed = state.Iterations * scores.Length;
+        }
+
+        private static void zitlerThiele(BenchmarkState state, IObjectiveScores[] scores)
+        {
+            var fitness = new ZitlerThieleFitnessAssignment();
+            while (state.KeepRunning())
+                fitness.AssignFitness(scores);
+            state.ItemsProcessed = state.Iterations * scores.Length;
+        }
+
+        /// <summary>
+        /// The same dominance as its base class, but a different type, so that the ranking compares all pairs of points
+        /// instead of using <see cref="NonDominatedSorting{T}"/>
+        /// </summary>
+        private class PairwiseParetoComparer : ParetoComparer<IObjectiveScores>
+        {
+        }
+    }
+}
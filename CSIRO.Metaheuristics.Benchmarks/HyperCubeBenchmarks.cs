@@ -0,0 +1,69 @@
+﻿using System.Collections.Generic;
+using CSIRO.Metaheuristics.RandomNumberGenerators;
+using CSIRO.Metaheuristics.SystemConfigurations;
+using CSIRO.Metaheuristics.Tests;
+
+namespace CSIRO.Metaheuristics.Benchmarks
+{
+    /// <summary>
+    /// Cost of the geometric operations on hypercubes used by the complex evolution: centroids and reflections,
+    /// for hypercubes addressed by variable name and for dense ones
+    /// </summary>
+    public static class HyperCubeBenchmarks
+    {
+        public static IEnumerable<Benchmark> Create()
+        {
+            foreach (int dim in new[] { 5, 20, 100 })
+            {
+                foreach (int numPoints in new[] { 10, 50 })
+                {
+                    var named = createPoints(dim, numPoints);
+                    var dense = toDense(named);
+                    string suffix = "/dim:" + dim + "/points:" + numPoints;
+                    yield return new Benchmark("HyperCubeOperations/GetCentroid/named" + suffix, s => centroid(s, named));
+                    yield return new Benchmark("HyperCubeOperations/GetCentroid/dense" + suffix, s => centroid(s, dense));
+                }
+                var namedPair = createPoints(dim, 2);
+                var densePair = toDense(namedPair);
+                yield return new Benchmark("HyperCube/Reflect/named/dim:" + dim, s => reflect(s, namedPair));
+                yield return new Benchmark("HyperCube/Reflect/dense/dim:" + dim, s => reflect(s, densePair));
+            }
+        }
+
+        private static IHyperCube<double>[] createPoints(int dim, int numPoints)
+        {
+            var rng = new BasicRngFactory(0);
+            var ops = new HyperCubeOperations(rng);
+            var template = new TestHyperCube(dim, 0, -10, 10);
+            var result = new IHyperCube<double>[numPoints];
+            for (int i = 0; i < numPoints; i++)
+                result[i] = ops.GenerateRandom(template);
+            return result;
+        }
+
+        private static IHyperCube<double>[] toDense(IHyperCube<double>[] points)
+        {
+            var schema = new HyperCubeSchema(points[0].GetVariableNames());
+            var result = new IHyperCube<double>[points.Length];
+            for (int i = 0; i < points.Length; i++)
+                result[i] = DenseHyperCube.FromHyperCube(points[i], schema);
+            return result;
+        }
+
+        private static void centroid(BenchmarkState state, IHyperCube<double>[] points)
+        {
+            var ops = new HyperCubeOperations(new BasicRngFactory(0));
+            while (state.KeepRunning())
+                ops.GetCentroid(points);
+            state.ItemsProcessed = state.Iterations * points.Length;
+        }
+
+        private static void reflect(BenchmarkState state, IHyperCube<double>[] points)
+        {
+            // The reflection of the SCE competitive complex evolution, about the centroid of the other points
+            while (state.KeepRunning())
+                points[0].HomotheticTransform(points[1], -1.0);
+            state.ItemsProcessed = state.Iterations;
+        }
+    }
+}
@@ -0,0 +1,99 @@
+﻿using System.Collections.Generic;
+using System.Threading;
+using CSIRO.Metaheuristics.CandidateFactories;
+using CSIRO.Metaheuristics.Fitness;
+using CSIRO.Metaheuristics.Optimization;
+using CSIRO.Metaheuristics.RandomNumberGenerators;
+using CSIRO.Metaheuristics.SystemConfigurations;
+using CSIRO.Metaheuristics.Tests;
+
+namespace CSIRO.Metaheuristics.Benchmarks
+{
+    /// <summary>
+    /// Throughput of the optimisers on cheap analytic objectives, so that the cost of the framework itself dominates.
+    /// Compare the evaluations per second of an optimiser to those of the bare objective to get its overhead per evaluation.
+    /// </summary>
+    public static class OptimizerBenchmarks
+    {
+        public static IEnumerable<Benchmark> Create()
+        {
+            foreach (int dim in new[] { 2, 10, 30 })
+            {
+                int d = dim;
+                yield return new Benchmark("Paraboloid/EvaluateScore/dim:" + d, s => evaluate(s, new TestHyperCube(d, 1, -10, 10)));
+                yield return new Benchmark("ShuffledComplexEvolution/Paraboloid/named/dim:" + d + "/threads:1", s => sce(s, new TestHyperCube(d, 1, -10, 10), 1));
+                yield return new Benchmark("ShuffledComplexEvolution/Paraboloid/named/dim:" + d + "/threads:all", s => sce(s, new TestHyperCube(d, 1, -10, 10), -1));
+                yield return new Benchmark("ShuffledComplexEvolution/Paraboloid/dense/dim:" + d + "/threads:1", s => sce(s, createDense(d), 1));
+            }
+        }
+
+        private static IHyperCube<double> createDense(int dim)
+        {
+            return DenseHyperCube.FromHyperCube(new TestHyperCube(dim, 1, -10, 10));
+        }
+
+        private static void evaluate(BenchmarkState state, IHyperCube<double> point)
+        {
+            var evaluator = new ParaboloidObjEval<IHyperCube<double>>(bestParam: 2);
+            while (state.KeepRunning())
+                evaluator.EvaluateScore(point);
+            state.ItemsProcessed = state.Iterations;
+        }
+
+        private static void sce(BenchmarkState state, IHyperCube<double> template, int maxDegreeOfParallelism)
+        {
+            int dim = template.GetVariableNames().Length;
+            long[] numEvaluations = new long[1];
+            var evaluator = new CountingEvaluator(new ParaboloidObjEval<IHyperCube<double>>(bestParam: 2), numEvaluations);
+            while (state.KeepRunning())
+            {
+                // The usual rules of thumb for the complexes, and a fixed number of shuffles so that all iterations do the same work
+                var rng = new BasicRngFactory(0);
+                var engine = new ShuffledComplexEvolution<IHyperCube<double>>(
+                    evaluator,
+                    new UniformRandomSamplingFactory<IHyperCube<double>>(rng.CreateFactory(), template),
+                    new ShuffledComplexEvolution<IHyperCube<double>>.MaxShuffleTerminationCondition(),
+                    p: 5, m: 2 * dim + 1, q: dim + 1, alpha: 1, beta: 2 * dim + 1, numShuffle: 10,
+                    rng: rng,
+                    fitnessAssignment: new DefaultFitnessAssignment());
+                engine.MaxDegreeOfParallelism = maxDegreeOfParallelism;
+                engine.Evolve();
+            }
+            state.ItemsProcessed = numEvaluations[0];
+            state.Counters["evaluations"] = numEvaluations[0];
+        }
+
+        private class CountingEvaluator : IClonableObjectiveEvaluator<IHyperCube<double>>
+        {
+            public CountingEvaluator(IClonableObjectiveEvaluator<IHyperCube<double>> inner, long[] count)
+            {
+                this.inner = inner;
+                this.count = count;
+            }
+
+            private readonly IClonableObjectiveEvaluator<IHyperCube<double>> inner;
+            private readonly long[] count;
+
+            public IObjectiveScores<IHyperCube<double>> EvaluateScore(IHyperCube<double> systemConfiguration)
+            {
+                Interlocked.Increment(ref count[0]);
+                return inner.EvaluateScore(systemConfiguration);
+            }
+
+            public IClonableObjectiveEvaluator<IHyperCube<double>> Clone()
+            {
+                return new CountingEvaluator(inner.Clone(), count);
+            }
+
+            public bool SupportsDeepCloning
+            {
+                get { return inner.SupportsDeepCloning; }
+            }
+
+            public bool SupportsThreadSafeCloning
+            {
+                get { return inner.SupportsThreadSafeCloning; }
+            }
+        }
+    }
+}
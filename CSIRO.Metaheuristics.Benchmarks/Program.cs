@@ -0,0 +1,116 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Reflection;
+using System.Text;
+
+namespace CSIRO.Metaheuristics.Benchmarks
+{
+    /// <summary>
+    /// Runs the benchmarks of the framework. The command line options are those of Google Benchmark, as used by the native model benchmarks:
+    /// <code>
+    /// CSIRO.Metaheuristics.Benchmarks.exe [--benchmark_filter=regex] [--benchmark_min_time=seconds] [--benchmark_repetitions=n]
+    ///     [--benchmark_out=file] [--benchmark_out_format=json|csv] [--benchmark_list_tests]
+    /// </code>
+    /// Results are printed to the console, and written to the output file if any, e.g. to track performance regressions across releases.
+    /// </summary>
+    class Program
+    {
+        static int Main(string[] args)
+        {
+            var options = new Dictionary<string, string>();
+            foreach (var arg in args)
+            {
+                if (!arg.StartsWith("--"))
+                    return usage("Unexpected argument: " + arg);
+                int eq = arg.IndexOf('=');
+                if (eq < 0)
+                    options[arg.Substring(2)] = "true";
+                else
+                    options[arg.Substring(2, eq - 2)] = arg.Substring(eq + 1);
+            }
+
+            var benchmarks = OptimizerBenchmarks.Create()
+                .Concat(FitnessBenchmarks.Create())
+                .Concat(HyperCubeBenchmarks.Create())
+                .ToList();
+            var runner = new BenchmarkRunner();
+            string filter = getOption(options, "benchmark_filter", null);
+            string outFile = getOption(options, "benchmark_out", null);
+            string format = getOption(options, "benchmark_out_format", "json");
+            if (format != "json" && format != "csv")
+                return usage("Unsupported output format: " + format);
+            try
+            {
+                runner.MinTime = double.Parse(getOption(options, "benchmark_min_time", "0.5"), CultureInfo.InvariantCulture);
+                runner.Repetitions = int.Parse(getOption(options, "benchmark_repetitions", "1"), CultureInfo.InvariantCulture);
+            }
+            catch (FormatException)
+            {
+                return usage("Invalid numeric option");
+            }
+            if (options.Keys.Except(new[] { "benchmark_filter", "benchmark_out", "benchmark_out_format", "benchmark_min_time", "benchmark_repetitions", "benchmark_list_tests" }).Any())
+                return usage("Unknown option");
+
+            if (options.ContainsKey("benchmark_list_tests"))
+            {
+                var regex = (filter == null ? null : new System.Text.RegularExpressions.Regex(filter));
+                foreach (var b in benchmarks.Where(b => regex == null || regex.IsMatch(b.Name)))
+                    Console.WriteLine(b.Name);
+                return 0;
+            }
+
+            var context = createContext();
+            foreach (var c in context)
+                Console.WriteLine("{0}: {1}", c.Key, c.Value);
+            Console.WriteLine("{0,-60} {1,17} {2,17} {3,12}", "Benchmark", "Time", "CPU", "Iterations");
+            var results = runner.Run(benchmarks, filter, Console.Out);
+
+            if (outFile != null)
+            {
+                using (var writer = new StreamWriter(outFile, false, new UTF8Encoding(false)))
+                {
+                    if (format == "csv")
+                        BenchmarkRunner.WriteCsv(writer, results);
+                    else
+                        BenchmarkRunner.WriteJson(writer, results, context);
+                }
+            }
+            return 0;
+        }
+
+        private static string getOption(Dictionary<string, string> options, string name, string defaultValue)
+        {
+            string value;
+            return options.TryGetValue(name, out value) ? value : defaultValue;
+        }
+
+        private static IDictionary<string, string> createContext()
+        {
+            var context = new Dictionary<string, string>();
+            context["date"] = DateTime.Now.ToString("yyyy-MM-ddTHH:mm:ssK", CultureInfo.InvariantCulture);
+            context["host_name"] = Environment.MachineName;
+            context["executable"] = Assembly.GetEntryAssembly().Location;
+            context["num_cpus"] = Environment.ProcessorCount.ToString(CultureInfo.InvariantCulture);
+            context["library_version"] = typeof(IObjectiveScores).Assembly.GetName().Version.ToString();
+            context["clr_version"] = Environment.Version.ToString();
+            context["os_version"] = Environment.OSVersion.ToString();
+            context["is_64bit_process"] = Environment.Is64BitProcess ? "true" : "false";
+#if DEBUG
+            context["library_build_type"] = "debug";
+#else
+            context["library_build_type"] = "release";
+#endif
+            return context;
+        }
+
+        private static int usage(string message)
+        {
+            Console.Error.WriteLine(message);
+            Console.Error.WriteLine("Usage: CSIRO.Metaheuristics.Benchmarks [--benchmark_filter=regex] [--benchmark_min_time=seconds] [--benchmark_repetitions=n] [--benchmark_out=file] [--benchmark_out_format=json|csv] [--benchmark_list_tests]");
+            return 1;
+        }
+    }
+}
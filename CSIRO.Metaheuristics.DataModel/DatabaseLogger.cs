@@ -0,0 +1,218 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Threading;
+using CSIRO.Metaheuristics.Logging;
+
+namespace CSIRO.Metaheuristics.DataModel
+{
+    /// <summary>
+    /// A logger saving the points and scores of an optimisation to the database of the data model as the optimisation runs,
+    /// as one results set.
+    /// </summary>
+    /// <remarks>
+    /// Logged points are copied into batches, which a background thread inserts in bulk with a <see cref="SqlBulkResultsWriter"/>;
+    /// the optimisation only waits for the database when the number of full batches waiting to be written reaches a maximum.
+    /// The tags of each write are saved as the tags of its points. Messages without points are not saved.
+    /// Errors of the background thread are reported on Flush or Dispose, later writes being discarded.
+    /// </remarks>
+    public sealed class DatabaseLogger : ILoggerMh, ILoggerMhLevelFilter, IDisposable
+    {
+        /// <summary>
+        /// Creates a logger saving a new results set to the database of the default connection string, MH.Results
+        /// </summary>
+        /// <param name="resultsSetName">The name of the results set</param>
+        /// <param name="attributes">The tags of the results set, or null</param>
+        /// <param name="level">The most detailed level of information recorded</param>
+        /// <param name="batchSize">The number of points inserted at once</param>
+        /// <param name="maxPendingBatches">The number of full batches waiting to be written beyond which logging threads wait for the writer</param>
+        public DatabaseLogger(string resultsSetName = "", IDictionary<string, string> attributes = null, LoggerMhLevel level = LoggerMhLevel.Detailed,
+            int batchSize = SqlBulkResultsWriter.DefaultBatchSize, int maxPendingBatches = 4)
+            : this(new SqlBulkResultsWriter(resultsSetName, attributes), level, batchSize, maxPendingBatches)
+        {
+        }
+
+        /// <summary>
+        /// Creates a logger saving to the results set of a writer, which is disposed of with this logger
+        /// </summary>
+        public DatabaseLogger(SqlBulkResultsWriter writer, LoggerMhLevel level = LoggerMhLevel.Detailed,
+            int batchSize = SqlBulkResultsWriter.DefaultBatchSize, int maxPendingBatches = 4)
+        {
+            if (writer == null)
+                throw new ArgumentNullException("writer");
+            if (batchSize < 1)
+                throw new ArgumentOutOfRangeException("batchSize", batchSize, "There must be at least one point per batch");
+            if (maxPendingBatches < 1)
+                throw new ArgumentOutOfRangeException("maxPendingBatches", "There must be at least one pending batch allowed");
+            this.writer = writer;
+            this.Level = level;
+            this.batchSize = batchSize;
+            pending = new BlockingCollection<Item>(maxPendingBatches);
+            current = writer.CreateBatch();
+            writerThread = new Thread(writeBatches) { IsBackground = true, Name = "DatabaseLogger writer" };
+            writerThread.Start();
+        }
+
+        private readonly SqlBulkResultsWriter writer;
+        private readonly int batchSize;
+        private readonly BlockingCollection<Item> pending;
+        private readonly ConcurrentBag<ResultsBatch> free = new ConcurrentBag<ResultsBatch>();
+        private readonly Thread writerThread;
+        private readonly object syncRoot = new object();
+        private ResultsBatch current;
+        private long writtenPoints = 0;
+        private volatile bool disposed = false;
+        private volatile Exception writerError = null;
+
+        private class Item
+        {
+            public ResultsBatch Batch;
+            /// <summary>Set by the writer once all the batches before this one are written, if not null</summary>
+            public ManualResetEventSlim Flushed;
+        }
+
+        /// <summary>
+        /// Gets or sets the most detailed level of information recorded
+        /// </summary>
+        public LoggerMhLevel Level { get; set; }
+
+        public bool IsEnabled(LoggerMhLevel level)
+        {
+            return level <= Level;
+        }
+
+        /// <summary>
+        /// Gets the key of the results set in the database
+        /// </summary>
+        public int CollectionId
+        {
+            get { return writer.CollectionId; }
+        }
+
+        /// <summary>
+        /// Gets the number of points written to the database so far
+        /// </summary>
+        public long WrittenPointCount
+        {
+            get { return Interlocked.Read(ref writtenPoints); }
+        }
+
+        public void Write(IObjectiveScores[] scores, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+            {
+                checkNotDisposed();
+                current.Add(scores, tags);
+                handOffIfFull();
+            }
+        }
+
+        public void Write(FitnessAssignedScores<double> worstPoint, IDictionary<string, string> tags)
+        {
+            Write(new[] { worstPoint.Scores }, tags);
+        }
+
+        public void Write(IHyperCube<double> newPoint, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+            {
+                checkNotDisposed();
+                current.Add(newPoint, tags);
+                handOffIfFull();
+            }
+        }
+
+        public void Write(string message, IDictionary<string, string> tags)
+        {
+            // The data model has no representation of messages without points
+        }
+
+        /// <summary>
+        /// Writes the points logged so far to the database
+        /// </summary>
+        public void Flush()
+        {
+            using (var flushed = new ManualResetEventSlim(false))
+            {
+                lock (syncRoot)
+                {
+                    checkNotDisposed();
+                    handOff();
+                    pending.Add(new Item { Flushed = flushed });
+                }
+                flushed.Wait();
+            }
+            throwOnWriterError();
+        }
+
+        public void Dispose()
+        {
+            lock (syncRoot)
+            {
+                if (disposed)
+                    return;
+                handOff();
+                disposed = true;
+            }
+            pending.CompleteAdding();
+            writerThread.Join();
+            writer.Dispose();
+            pending.Dispose();
+            throwOnWriterError();
+        }
+
+        private void checkNotDisposed()
+        {
+            if (disposed)
+                throw new ObjectDisposedException("DatabaseLogger");
+        }
+
+        private void handOffIfFull()
+        {
+            if (current.PointCount >= batchSize)
+                handOff();
+        }
+
+        private void handOff()
+        {
+            if (current.PointCount == 0)
+                return;
+            pending.Add(new Item { Batch = current });
+            ResultsBatch batch;
+            current = (free.TryTake(out batch) ? batch : writer.CreateBatch());
+        }
+
+        private void writeBatches()
+        {
+            foreach (var item in pending.GetConsumingEnumerable())
+            {
+                if (item.Batch == null)
+                {
+                    item.Flushed.Set();
+                    continue;
+                }
+                if (writerError == null)
+                {
+                    try
+                    {
+                        writer.Write(item.Batch);
+                        Interlocked.Add(ref writtenPoints, item.Batch.PointCount);
+                    }
+                    catch (Exception e)
+                    {
+                        // Logging threads carry on; the error is reported on Flush or Dispose
+                        writerError = e;
+                    }
+                }
+                item.Batch.Clear();
+                free.Add(item.Batch);
+            }
+        }
+
+        private void throwOnWriterError()
+        {
+            if (writerError != null)
+                throw new InvalidOperationException("The results could not be saved to the database", writerError);
+        }
+    }
+}
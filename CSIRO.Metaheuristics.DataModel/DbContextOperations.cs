@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Data.Entity;
 using System.Linq;
 using System.Text;
 
@@ -22,13 +23,43 @@ namespace CSIRO.Metaheuristics.DataModel
             return resultsSet.ObjectivesResultsCollectionId;
         }
 
+        /// <summary>
+        /// Saves a results set in bulk, without the change tracking of Entity Framework, for large sets such as complete optimisation logs.
+        /// </summary>
+        /// <param name="results">The points and their scores</param>
+        /// <param name="resultsSetName">The name of the results set</param>
+        /// <param name="attributes">The tags of the results set, or null</param>
+        /// <param name="batchSize">The number of points inserted at once</param>
+        /// <returns>The key of the results set</returns>
+        /// <seealso cref="SqlBulkResultsWriter"/>
+        public static int BulkSaveObjectiveResultsSet(IEnumerable<IObjectiveScores> results, string resultsSetName = "", IDictionary<string, string> attributes = null,
+            int batchSize = SqlBulkResultsWriter.DefaultBatchSize)
+        {
+            using (var writer = new SqlBulkResultsWriter(resultsSetName, attributes))
+            {
+                writer.Write(results, batchSize: batchSize);
+                return writer.CollectionId;
+            }
+        }
+
+        /// <summary>
+        /// Finds the results sets with all of a set of tags. The tags are matched by the database server, and loaded with the results sets, but not the scores.
+        /// </summary>
         public static ObjectivesResultsCollection[] FindResultsTagged(IDictionary<string, string> tags)
         {
             using (var db = new OptimizationResultsContext())
             {
-                return db.ObjectivesResultsCollectionSet
+                IQueryable<ObjectivesResultsCollection> query = db.ObjectivesResultsCollectionSet
                     .AsNoTracking()
-                    .Where((x => ContainsAllTags(x, tags))).ToArray();//.Tags.Tags.FirstOrDefault((y => y.TagId).FirstOrDefault().Value );
+                    .Include(x => x.Tags.Tags);
+                foreach (var tag in tags)
+                {
+                    // Local copies, as the query captures variables rather than their values
+                    string name = tag.Key;
+                    string value = tag.Value;
+                    query = query.Where(x => x.Tags.Tags.Any(y => y.Name == name && y.Value == value));
+                }
+                return query.ToArray();
             }
         }
 
@@ -16,6 +16,8 @@ namespace CSIRO.Metaheuristics.DataModel
 
         public OptimizationResultsContext() : base("name=MH.Results") { }
 
+        public OptimizationResultsContext(string nameOrConnectionString) : base(nameOrConnectionString) { }
+
         public DbSet<ObjectiveScore> ObjectiveScoreSet { get; set; }
         public DbSet<ObjectivesResultsCollection> ObjectivesResultsCollectionSet { get; set; }
         public DbSet<ObjectiveScoreCollection> ObjectiveScoresSet { get; set; }
@@ -24,4 +26,33 @@ namespace CSIRO.Metaheuristics.DataModel
         public DbSet<HyperCube> HyperCubeSet { get; set; }
         public DbSet<VariableSpecification> VariableSpecification { get; set; }
     }
+
+    /// <summary>
+    /// The names of the tables and foreign key columns that the conventions of Entity Framework give the data model
+    /// of <see cref="OptimizationResultsContext"/>, which the bulk inserts of <see cref="SqlBulkResultsWriter"/> write to directly.
+    /// </summary>
+    /// <remarks>
+    /// The model itself is left to the conventions: any change to its mapping would make 
+    /// DropCreateDatabaseIfModelChanges recreate the existing databases.
+    /// </remarks>
+    internal static class ResultsSchema
+    {
+        internal const string ResultsCollectionsTable = "ObjectivesResultsCollections";
+        internal const string ScoreCollectionsTable = "ObjectiveScoreCollections";
+        internal const string ScoresTable = "ObjectiveScores";
+        internal const string TagCollectionsTable = "TagCollections";
+        internal const string TagsTable = "Tags";
+        internal const string SystemConfigurationsTable = "SystemConfigurations";
+        internal const string VariablesTable = "VariableSpecifications";
+
+        internal const string ResultsCollectionTagsKey = "Tags_TagCollectionId";
+        internal const string ScoreCollectionResultsKey = "Collection_ObjectivesResultsCollectionId";
+        internal const string ScoreCollectionConfigurationKey = "SysConfiguration_SystemConfigurationId";
+        internal const string ScoreScoreCollectionKey = "ObjectiveScores_ObjectiveScoreCollectionId";
+        internal const string TagTagCollectionKey = "TagCollection_TagCollectionId";
+        internal const string SystemConfigurationTagsKey = "Tags_TagCollectionId";
+        internal const string VariableHyperCubeKey = "HyperCube_SystemConfigurationId";
+        internal const string Discriminator = "Discriminator";
+        internal const string HyperCubeDiscriminator = "HyperCube";
+    }
 }
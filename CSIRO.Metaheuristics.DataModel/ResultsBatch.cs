@@ -0,0 +1,144 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Data;
+
+namespace CSIRO.Metaheuristics.DataModel
+{
+    /// <summary>
+    /// A batch of points and scores to insert in bulk with a <see cref="SqlBulkResultsWriter"/>,
+    /// staged as rows of the tables of the data model without creating entities.
+    /// </summary>
+    /// <remarks>
+    /// The values are copied when they are added, so that the points can change afterwards.
+    /// The rows refer to each other by sequence numbers within the batch; the writer maps them to the database keys.
+    /// </remarks>
+    public sealed class ResultsBatch
+    {
+        /// <summary>
+        /// Creates an empty batch
+        /// </summary>
+        public ResultsBatch()
+        {
+            Groups = new DataTable("Groups");
+            Groups.Columns.Add("GroupSeq", typeof(int));
+
+            GroupTags = new DataTable("GroupTags");
+            GroupTags.Columns.Add("GroupSeq", typeof(int));
+            GroupTags.Columns.Add("Name", typeof(string));
+            GroupTags.Columns.Add("Value", typeof(string));
+
+            Points = new DataTable("Points");
+            Points.Columns.Add("Seq", typeof(int));
+            Points.Columns.Add("GroupSeq", typeof(int));
+            Points.Columns.Add("Name", typeof(string));
+
+            Variables = new DataTable("Variables");
+            Variables.Columns.Add("Seq", typeof(int));
+            Variables.Columns.Add("Name", typeof(string));
+            Variables.Columns.Add("Minimum", typeof(double));
+            Variables.Columns.Add("Maximum", typeof(double));
+            Variables.Columns.Add("Value", typeof(double));
+
+            Scores = new DataTable("Scores");
+            Scores.Columns.Add("Seq", typeof(int));
+            Scores.Columns.Add("Name", typeof(string));
+            Scores.Columns.Add("Maximize", typeof(bool));
+            Scores.Columns.Add("Value", typeof(string));
+        }
+
+        // The tags shared by the points added together, one group per call to Add with tags
+        internal readonly DataTable Groups;
+        internal readonly DataTable GroupTags;
+        internal readonly DataTable Points;
+        internal readonly DataTable Variables;
+        internal readonly DataTable Scores;
+
+        /// <summary>
+        /// Gets the number of points in this batch
+        /// </summary>
+        public int PointCount
+        {
+            get { return Points.Rows.Count; }
+        }
+
+        /// <summary>
+        /// Gets the number of scores of all the points in this batch
+        /// </summary>
+        public int ScoreCount
+        {
+            get { return Scores.Rows.Count; }
+        }
+
+        /// <summary>
+        /// Adds points with their scores
+        /// </summary>
+        /// <param name="scores">The scores, whose system configurations must be hypercubes</param>
+        /// <param name="tags">The tags of these points, or null</param>
+        public void Add(IEnumerable<IObjectiveScores> scores, IDictionary<string, string> tags)
+        {
+            object group = addGroup(tags);
+            foreach (var item in scores)
+            {
+                int seq = addPoint(item.GetSystemConfiguration(), group);
+                for (int i = 0; i < item.ObjectiveCount; i++)
+                {
+                    var score = item.GetObjective(i);
+                    Scores.Rows.Add(seq, score.Name, score.Maximise, score.ValueComparable.ToString());
+                }
+            }
+        }
+
+        /// <summary>
+        /// Adds a point without scores
+        /// </summary>
+        /// <param name="point">The point</param>
+        /// <param name="tags">The tags of this point, or null</param>
+        public void Add(IHyperCube<double> point, IDictionary<string, string> tags)
+        {
+            addPoint(point, addGroup(tags));
+        }
+
+        /// <summary>
+        /// Removes all the points, to reuse this batch
+        /// </summary>
+        public void Clear()
+        {
+            Groups.Clear();
+            GroupTags.Clear();
+            Points.Clear();
+            Variables.Clear();
+            Scores.Clear();
+        }
+
+        private object addGroup(IDictionary<string, string> tags)
+        {
+            if (tags == null || tags.Count == 0)
+                return DBNull.Value;
+            int groupSeq = Groups.Rows.Count;
+            Groups.Rows.Add(groupSeq);
+            foreach (var tag in tags)
+                GroupTags.Rows.Add(groupSeq, tag.Key, tag.Value);
+            return groupSeq;
+        }
+
+        private int addPoint(ISystemConfiguration sysConfig, object group)
+        {
+            var hc = sysConfig as IHyperCube<double>;
+            if (hc == null)
+                throw new NotSupportedException("Can only represent system configurations that are hypercubes, as yet");
+            int seq = Points.Rows.Count;
+            Points.Rows.Add(seq, group, hc.GetConfigurationDescription());
+            var indexed = hc as IIndexedHyperCube<double>;
+            var names = hc.GetVariableNames();
+            for (int k = 0; k < names.Length; k++)
+            {
+                var name = names[k];
+                if (indexed == null)
+                    Variables.Rows.Add(seq, name, hc.GetMinValue(name), hc.GetMaxValue(name), hc.GetValue(name));
+                else
+                    Variables.Rows.Add(seq, name, indexed.GetMinValue(k), indexed.GetMaxValue(k), indexed.GetValue(k));
+            }
+            return seq;
+        }
+    }
+}
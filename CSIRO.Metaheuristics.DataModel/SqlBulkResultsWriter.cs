@@ -0,0 +1,248 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Data;
+using System.Data.SqlClient;
+
+namespace CSIRO.Metaheuristics.DataModel
+{
+    /// <summary>
+    /// Writes a results set to a SQL Server database of the data model in bulk, bypassing the change tracking of Entity Framework.
+    /// </summary>
+    /// <remarks>
+    /// <para>The results set is created with its tags by the constructor; the points are then appended in batches.
+    /// Each batch is copied with <see cref="SqlBulkCopy"/> into temporary staging tables, from which a single
+    /// set-based statement per table inserts the rows and maps the keys generated by the database,
+    /// so that the number of round trips does not depend on the number of points.</para>
+    /// <para>Each batch is written in a transaction of its own: an interrupted run leaves the batches written so far.
+    /// This class is not thread safe; <see cref="DatabaseLogger"/> feeds it from a background thread.</para>
+    /// </remarks>
+    public sealed class SqlBulkResultsWriter : IDisposable
+    {
+        /// <summary>
+        /// The default number of points per batch
+        /// </summary>
+        public const int DefaultBatchSize = 10000;
+
+        /// <summary>
+        /// Creates a results set in the database of the default connection string, MH.Results
+        /// </summary>
+        /// <param name="resultsSetName">The name of the results set</param>
+        /// <param name="attributes">The tags of the results set, or null</param>
+        public SqlBulkResultsWriter(string resultsSetName = "", IDictionary<string, string> attributes = null)
+            : this(new OptimizationResultsContext(), resultsSetName, attributes)
+        {
+        }
+
+        /// <summary>
+        /// Creates a results set in the database of a context, which is disposed of with this writer
+        /// </summary>
+        /// <param name="context">The context of the database, which must be a SQL Server database</param>
+        /// <param name="resultsSetName">The name of the results set</param>
+        /// <param name="attributes">The tags of the results set, or null</param>
+        public SqlBulkResultsWriter(OptimizationResultsContext context, string resultsSetName = "", IDictionary<string, string> attributes = null)
+        {
+            if (context == null)
+                throw new ArgumentNullException("context");
+            this.context = context;
+            try
+            {
+                connection = context.Database.Connection as SqlConnection;
+                if (connection == null)
+                    throw new NotSupportedException("Bulk inserts of results require a SQL Server database");
+                // Creates the database if need be, before opening the connection that the context will then leave open.
+                context.Database.Initialize(false);
+                connection.Open();
+                execute(createTagsIndex, null);
+                execute(createStagingTables, null);
+                collectionId = createResultsSet(resultsSetName, attributes);
+            }
+            catch
+            {
+                context.Dispose();
+                throw;
+            }
+        }
+
+        private readonly OptimizationResultsContext context;
+        private readonly SqlConnection connection;
+        private readonly int collectionId;
+        private long pointCount = 0;
+
+        /// <summary>
+        /// Gets the key of the results set in the database, as for <see cref="DbContextOperations.SaveObjectiveResultsSet(ObjectivesResultsCollection)"/>
+        /// </summary>
+        public int CollectionId
+        {
+            get { return collectionId; }
+        }
+
+        /// <summary>
+        /// Gets the number of points written so far
+        /// </summary>
+        public long PointCount
+        {
+            get { return pointCount; }
+        }
+
+        /// <summary>
+        /// Creates an empty batch to fill and pass to <see cref="Write(ResultsBatch)"/>
+        /// </summary>
+        public ResultsBatch CreateBatch()
+        {
+            return new ResultsBatch();
+        }
+
+        /// <summary>
+        /// Writes points with their scores, in batches
+        /// </summary>
+        /// <param name="scores">The scores, whose system configurations must be hypercubes</param>
+        /// <param name="tags">The tags of all these points, or null</param>
+        /// <param name="batchSize">The number of points per batch</param>
+        public void Write(IEnumerable<IObjectiveScores> scores, IDictionary<string, string> tags = null, int batchSize = DefaultBatchSize)
+        {
+            if (batchSize < 1)
+                throw new ArgumentOutOfRangeException("batchSize", batchSize, "There must be at least one point per batch");
+            var batch = CreateBatch();
+            var points = new List<IObjectiveScores>(Math.Min(batchSize, 1024));
+            foreach (var item in scores)
+            {
+                points.Add(item);
+                if (points.Count == batchSize)
+                {
+                    batch.Add(points, tags);
+                    Write(batch);
+                    batch.Clear();
+                    points.Clear();
+                }
+            }
+            if (points.Count > 0)
+            {
+                batch.Add(points, tags);
+                Write(batch);
+            }
+        }
+
+        /// <summary>
+        /// Writes a batch of points to the results set, in a transaction
+        /// </summary>
+        public void Write(ResultsBatch batch)
+        {
+            if (batch.PointCount == 0)
+                return;
+            using (var transaction = connection.BeginTransaction())
+            {
+                copy(batch.Groups, "#mhGroups", transaction);
+                copy(batch.GroupTags, "#mhGroupTags", transaction);
+                copy(batch.Points, "#mhPoints", transaction);
+                copy(batch.Variables, "#mhVariables", transaction);
+                copy(batch.Scores, "#mhScores", transaction);
+                execute(insertFromStagingTables, transaction, new SqlParameter("@collectionId", collectionId));
+                transaction.Commit();
+            }
+            pointCount += batch.PointCount;
+        }
+
+        public void Dispose()
+        {
+            context.Dispose();
+        }
+
+        private void copy(DataTable table, string destination, SqlTransaction transaction)
+        {
+            if (table.Rows.Count == 0)
+                return;
+            using (var bulkCopy = new SqlBulkCopy(connection, SqlBulkCopyOptions.Default, transaction))
+            {
+                bulkCopy.DestinationTableName = destination;
+                bulkCopy.BulkCopyTimeout = 0;
+                foreach (DataColumn column in table.Columns)
+                    bulkCopy.ColumnMappings.Add(column.ColumnName, column.ColumnName);
+                bulkCopy.WriteToServer(table);
+            }
+        }
+
+        private int createResultsSet(string resultsSetName, IDictionary<string, string> attributes)
+        {
+            using (var transaction = connection.BeginTransaction())
+            {
+                object tagsId = DBNull.Value;
+                if (attributes != null)
+                {
+                    tagsId = executeScalar("INSERT INTO " + ResultsSchema.TagCollectionsTable + " DEFAULT VALUES; SELECT CAST(SCOPE_IDENTITY() AS int);", transaction);
+                    foreach (var tag in attributes)
+                        execute("INSERT INTO " + ResultsSchema.TagsTable + " (Name, Value, " + ResultsSchema.TagTagCollectionKey + ") VALUES (@name, @value, @tags);", transaction,
+                            new SqlParameter("@name", tag.Key), new SqlParameter("@value", (object)tag.Value ?? DBNull.Value), new SqlParameter("@tags", tagsId));
+                }
+                var id = executeScalar("INSERT INTO " + ResultsSchema.ResultsCollectionsTable + " (Name, " + ResultsSchema.ResultsCollectionTagsKey + ") VALUES (@name, @tags); SELECT CAST(SCOPE_IDENTITY() AS int);", transaction,
+                    new SqlParameter("@name", (object)resultsSetName ?? DBNull.Value), new SqlParameter("@tags", SqlDbType.Int) { Value = tagsId });
+                transaction.Commit();
+                return (int)id;
+            }
+        }
+
+        private void execute(string sql, SqlTransaction transaction, params SqlParameter[] parameters)
+        {
+            using (var command = createCommand(sql, transaction, parameters))
+                command.ExecuteNonQuery();
+        }
+
+        private object executeScalar(string sql, SqlTransaction transaction, params SqlParameter[] parameters)
+        {
+            using (var command = createCommand(sql, transaction, parameters))
+                return command.ExecuteScalar();
+        }
+
+        private SqlCommand createCommand(string sql, SqlTransaction transaction, SqlParameter[] parameters)
+        {
+            var command = new SqlCommand(sql, connection, transaction);
+            command.CommandTimeout = 0;
+            command.Parameters.AddRange(parameters);
+            return command;
+        }
+
+        // Covers the lookups of results sets by tag of DbContextOperations.FindResultsTagged, which match the tags of a collection by name and value.
+        // Name and Value are nvarchar(max) columns, which cannot be index keys but can be included. Created once per database, outside of the model of Entity Framework.
+        private const string tagsIndexName = "IX_Tags_Collection_NameValue";
+        private static readonly string createTagsIndex = @"
+IF NOT EXISTS (SELECT 1 FROM sys.indexes WHERE name = '" + tagsIndexName + "' AND object_id = OBJECT_ID('" + ResultsSchema.TagsTable + @"'))
+    CREATE INDEX " + tagsIndexName + " ON " + ResultsSchema.TagsTable + " (" + ResultsSchema.TagTagCollectionKey + @") INCLUDE (Name, Value);";
+
+        // Temporary tables live as long as the connection; the identifiers of the inserted rows are output to the *Ids tables.
+        private static readonly string createStagingTables = @"
+CREATE TABLE #mhGroups (GroupSeq int NOT NULL PRIMARY KEY);
+CREATE TABLE #mhGroupTags (GroupSeq int NOT NULL, Name nvarchar(max), Value nvarchar(max));
+CREATE TABLE #mhPoints (Seq int NOT NULL PRIMARY KEY, GroupSeq int NULL, Name nvarchar(max));
+CREATE TABLE #mhVariables (Seq int NOT NULL, Name nvarchar(max), Minimum float NOT NULL, Maximum float NOT NULL, Value float NOT NULL);
+CREATE TABLE #mhScores (Seq int NOT NULL, Name nvarchar(max), Maximize bit NOT NULL, Value nvarchar(max));
+CREATE TABLE #mhGroupIds (GroupSeq int NOT NULL PRIMARY KEY, TagCollectionId int NOT NULL);
+CREATE TABLE #mhConfigIds (Seq int NOT NULL PRIMARY KEY, SystemConfigurationId int NOT NULL);
+CREATE TABLE #mhPointIds (Seq int NOT NULL PRIMARY KEY, ObjectiveScoreCollectionId int NOT NULL);";
+
+        // MERGE rather than INSERT, as only its OUTPUT clause can refer to the source rows, i.e. to their sequence numbers.
+        private static readonly string insertFromStagingTables = @"
+MERGE " + ResultsSchema.TagCollectionsTable + @" AS t USING #mhGroups AS s ON 1 = 0
+WHEN NOT MATCHED THEN INSERT DEFAULT VALUES
+OUTPUT s.GroupSeq, inserted.TagCollectionId INTO #mhGroupIds (GroupSeq, TagCollectionId);
+
+INSERT INTO " + ResultsSchema.TagsTable + @" (Name, Value, " + ResultsSchema.TagTagCollectionKey + @")
+SELECT s.Name, s.Value, g.TagCollectionId FROM #mhGroupTags AS s JOIN #mhGroupIds AS g ON g.GroupSeq = s.GroupSeq;
+
+MERGE " + ResultsSchema.SystemConfigurationsTable + @" AS t
+USING (SELECT p.Seq, p.Name, g.TagCollectionId FROM #mhPoints AS p LEFT JOIN #mhGroupIds AS g ON g.GroupSeq = p.GroupSeq) AS s ON 1 = 0
+WHEN NOT MATCHED THEN INSERT (Name, " + ResultsSchema.Discriminator + ", " + ResultsSchema.SystemConfigurationTagsKey + @") VALUES (s.Name, '" + ResultsSchema.HyperCubeDiscriminator + @"', s.TagCollectionId)
+OUTPUT s.Seq, inserted.SystemConfigurationId INTO #mhConfigIds (Seq, SystemConfigurationId);
+
+INSERT INTO " + ResultsSchema.VariablesTable + @" (Name, Minimum, Maximum, Value, " + ResultsSchema.VariableHyperCubeKey + @")
+SELECT v.Name, v.Minimum, v.Maximum, v.Value, c.SystemConfigurationId FROM #mhVariables AS v JOIN #mhConfigIds AS c ON c.Seq = v.Seq;
+
+MERGE " + ResultsSchema.ScoreCollectionsTable + @" AS t USING #mhConfigIds AS s ON 1 = 0
+WHEN NOT MATCHED THEN INSERT (" + ResultsSchema.ScoreCollectionConfigurationKey + ", " + ResultsSchema.ScoreCollectionResultsKey + @") VALUES (s.SystemConfigurationId, @collectionId)
+OUTPUT s.Seq, inserted.ObjectiveScoreCollectionId INTO #mhPointIds (Seq, ObjectiveScoreCollectionId);
+
+INSERT INTO " + ResultsSchema.ScoresTable + @" (Name, Maximize, Value, " + ResultsSchema.ScoreScoreCollectionKey + @")
+SELECT s.Name, s.Maximize, s.Value, p.ObjectiveScoreCollectionId FROM #mhScores AS s JOIN #mhPointIds AS p ON p.Seq = s.Seq;
+
+TRUNCATE TABLE #mhGroups; TRUNCATE TABLE #mhGroupTags; TRUNCATE TABLE #mhPoints; TRUNCATE TABLE #mhVariables;
+TRUNCATE TABLE #mhScores; TRUNCATE TABLE #mhGroupIds; TRUNCATE TABLE #mhConfigIds; TRUNCATE TABLE #mhPointIds;";
+    }
+}
@@ -0,0 +1,43 @@
+﻿using System;
+using CSIRO.Metaheuristics.Parallel.SystemConfigurations;
+
+namespace CSIRO.Metaheuristics.Parallel.Objectives
+{
+    /// <summary>
+    /// The evaluation of one system configuration on one system of an ensemble, sent by the master to a worker process.
+    /// </summary>
+    [Serializable]
+    public struct MpiEvaluationTask
+    {
+        /// <summary>Identifier of the task, echoed back in the <see cref="MpiEvaluationResult"/></summary>
+        public int taskId;
+        /// <summary>Index of the system (e.g. catchment) of the ensemble to evaluate</summary>
+        public int systemIndex;
+        public MpiSysConfig sysConfig;
+    }
+
+    /// <summary>
+    /// The scores of an <see cref="MpiEvaluationTask"/>, sent back by a worker to the master process.
+    /// </summary>
+    [Serializable]
+    public struct MpiEvaluationResult
+    {
+        public int taskId;
+        /// <summary>
+        /// The scores calculated by the worker. The system configuration is not sent back 
+        /// (the master process already has it), so the field <see cref="MpiObjectiveScores.config"/> is null on reception.
+        /// </summary>
+        public MpiObjectiveScores scores;
+    }
+
+    /// <summary>
+    /// The failure of an <see cref="MpiEvaluationTask"/>, packed or not, sent back by a worker to the master process instead of its scores.
+    /// </summary>
+    [Serializable]
+    public struct MpiEvaluationFailure
+    {
+        public int taskId;
+        /// <summary>The exception thrown by the evaluation, with its stack trace; exceptions themselves may not be serializable</summary>
+        public string message;
+    }
+}
@@ -13,7 +13,11 @@ namespace CSIRO.Metaheuristics.Parallel.Objectives
     /// An objective evaluator for the 'master' MPI process, 
     /// that gathers all the individual scores from the 'slaves' to calculate one or more "global" scores
     /// </summary>
-    public class MpiObjectiveEvaluator : IClonableObjectiveEvaluator<MpiSysConfig>, IDisposable
+    /// <remarks>
+    /// Batches of system configurations are evaluated in one round if the ensemble evaluator 
+    /// is an <see cref="IBatchEnsembleObjectiveEvaluator{T}"/>, e.g. an <see cref="MpiTaskFarmEvaluator"/>
+    /// </remarks>
+    public class MpiObjectiveEvaluator : IClonableObjectiveEvaluator<MpiSysConfig>, IBatchObjectiveEvaluator<MpiSysConfig>, IDisposable
     {
         //private class ArithmeticMeanObjective : CompositeObjectiveEvaluator<MpiSysConfig>
         //{
@@ -144,6 +148,23 @@ namespace CSIRO.Metaheuristics.Parallel.Objectives
             return evaluator.CalculateCompositeObjective(scores, systemConfiguration);
         }
 
+        public virtual IObjectiveScores<MpiSysConfig>[] EvaluateScores(MpiSysConfig[] systemConfigurations)
+        {
+            var batchEvaluator = systemsEvaluator as IBatchEnsembleObjectiveEvaluator<MpiSysConfig>;
+            simulationTimer.Start();
+            IObjectiveScores<MpiSysConfig>[][] allScores;
+            if (batchEvaluator != null)
+                allScores = batchEvaluator.EvaluateScores(systemConfigurations);
+            else
+                allScores = Array.ConvertAll(systemConfigurations, systemsEvaluator.EvaluateScore);
+            simulationTimer.Stop();
+            SimulationCount += systemConfigurations.Length;
+            var result = new IObjectiveScores<MpiSysConfig>[systemConfigurations.Length];
+            for (int i = 0; i < result.Length; i++)
+                result[i] = evaluator.CalculateCompositeObjective(allScores[i], systemConfigurations[i]);
+            return result;
+        }
+
         //protected virtual IObjectiveScores<MpiSysConfig> CalculateCompositeObjectives(IObjectiveScores[] allscores, MpiSysConfig sysConfig)
         //{
         //    return evaluator.CalculateCompositeObjective(allscores, sysConfig);
@@ -0,0 +1,239 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Reflection;
+using CSIRO.Metaheuristics.Parallel.SystemConfigurations;
+using MPI;
+
+namespace CSIRO.Metaheuristics.Parallel.Objectives
+{
+    /// <summary>
+    /// An ensemble evaluator for the 'master' MPI process, that hands out the evaluations of 
+    /// (system configuration, system) pairs to the worker processes as they become idle.
+    /// </summary>
+    /// <remarks>
+    /// Unlike the default MPI evaluator, where each process evaluates one system and the master waits for the processes in a fixed order, 
+    /// a slow system only keeps one worker busy while the others carry on with the rest of the queue. 
+    /// Evaluating a whole population per call (see <see cref="EvaluateScores"/>) also keeps more workers busy than there are systems in the ensemble.
+    /// The worker processes must run a <see cref="MpiTaskFarmWorker"/> able to evaluate any system of the ensemble.
+    /// Given an <see cref="MpiWireSchema"/>, tasks and results are exchanged as packed arrays of values rather than serialized objects.
+    /// Each worker reports at startup how many tasks it evaluates concurrently, e.g. one process per node with a thread per core, 
+    /// and is kept supplied with that many tasks plus a few sent ahead.
+    /// An evaluation that throws an exception on a worker is reported to this process, which stops dispatching tasks, 
+    /// receives the results of those already sent, then throws an <see cref="InvalidOperationException"/>; the workers carry on.
+    /// Disposing of this object tells the workers to stop.
+    /// </remarks>
+    public class MpiTaskFarmEvaluator : IBatchEnsembleObjectiveEvaluator<MpiSysConfig>, IDisposable
+    {
+        private static readonly log4net.ILog log = log4net.LogManager.GetLogger(MethodBase.GetCurrentMethod().DeclaringType);
+
+        private readonly Intracommunicator comm;
+        private readonly int numSystems;
+        private readonly int tasksAhead;
+        private readonly int[] capacities;
+        private readonly MpiWireSchema schema;
+        private bool disposed = false;
+
+        /// <summary>
+        /// Creates a task farm over the worker processes of a communicator
+        /// </summary>
+        /// <param name="numSystems">The number of systems (e.g. catchments) in the ensemble</param>
+        /// <param name="tasksAhead">The number of tasks sent to a worker beyond those it can evaluate concurrently, so that it need not wait for the next task after sending a result</param>
+        /// <param name="comm">The communicator; the world communicator if null. The worker processes are all the ranks other than 0.</param>
+        public MpiTaskFarmEvaluator(int numSystems, int tasksAhead = 1, Intracommunicator comm = null)
+        {
+            if (numSystems < 1) throw new ArgumentOutOfRangeException("numSystems", "There must be at least one system in the ensemble");
+            if (tasksAhead < 0) throw new ArgumentOutOfRangeException("tasksAhead", "The number of tasks sent ahead cannot be negative");
+            this.comm = (comm == null ? Communicator.world : comm);
+            if (this.comm.Rank != 0) throw new NotSupportedException("MpiTaskFarmEvaluator is designed to work with MPI process rank 0 only");
+            if (this.comm.Size < 2) throw new NotSupportedException("MpiTaskFarmEvaluator needs at least one worker process");
+            this.numSystems = numSystems;
+            this.tasksAhead = tasksAhead;
+            capacities = new int[this.comm.Size];
+            for (int w = 1; w < this.comm.Size; w++)
+                this.comm.Receive(w, Convert.ToInt32(MpiMessageTags.WorkerCapacityMsgTag), out capacities[w]);
+        }
+
+        /// <summary>
+        /// Creates a task farm exchanging packed messages with the worker processes, and sends them the schema of the messages.
+        /// </summary>
+        /// <param name="numSystems">The number of systems (e.g. catchments) in the ensemble</param>
+        /// <param name="schema">The layout of the parameters and scores in the messages</param>
+        /// <param name="tasksAhead">The number of tasks sent to a worker beyond those it can evaluate concurrently, so that it need not wait for the next task after sending a result</param>
+        /// <param name="comm">The communicator; the world communicator if null. The worker processes are all the ranks other than 0.</param>
+        public MpiTaskFarmEvaluator(int numSystems, MpiWireSchema schema, int tasksAhead = 1, Intracommunicator comm = null)
+            : this(numSystems, tasksAhead, comm)
+        {
+            if (schema == null) throw new ArgumentNullException("schema");
+            this.schema = schema;
+            for (int w = 1; w < this.comm.Size; w++)
+                this.comm.Send(schema, w, Convert.ToInt32(MpiMessageTags.WireSchemaMsgTag));
+        }
+
+        public int NumSystems
+        {
+            get { return numSystems; }
+        }
+
+        public int NumWorkers
+        {
+            get { return comm.Size - 1; }
+        }
+
+        /// <summary>
+        /// Gets the number of tasks evaluated concurrently by all the workers
+        /// </summary>
+        public int TotalCapacity
+        {
+            get
+            {
+                int result = 0;
+                for (int w = 1; w < capacities.Length; w++)
+                    result += capacities[w];
+                return result;
+            }
+        }
+
+        public IObjectiveScores<MpiSysConfig>[] EvaluateScore(MpiSysConfig systemConfiguration)
+        {
+            return EvaluateScores(new[] { systemConfiguration })[0];
+        }
+
+        public IObjectiveScores<MpiSysConfig>[][] EvaluateScores(MpiSysConfig[] systemConfigurations)
+        {
+            if (disposed) throw new ObjectDisposedException("MpiTaskFarmEvaluator", "The worker processes have already been released");
+            var result = new IObjectiveScores<MpiSysConfig>[systemConfigurations.Length][];
+            for (int i = 0; i < result.Length; i++)
+                result[i] = new IObjectiveScores<MpiSysConfig>[numSystems];
+            int numTasks = systemConfigurations.Length * numSystems;
+            if (numTasks == 0)
+                return result;
+
+            // The sends not yet known to be complete, in the order they were posted to each worker. 
+            var sends = new Queue<Request>[comm.Size];
+            for (int w = 1; w < comm.Size; w++)
+                sends[w] = new Queue<Request>();
+            int nextTask = 0;
+            int pending = 0;
+            // Round robin over the workers, so that a population smaller than the total capacity is spread over all the nodes
+            int maxInFlight = 0;
+            for (int w = 1; w < comm.Size; w++)
+                maxInFlight = Math.Max(maxInFlight, capacities[w] + tasksAhead);
+            for (int k = 0; k < maxInFlight; k++)
+            {
+                for (int w = 1; w < comm.Size && nextTask < numTasks; w++)
+                {
+                    if (k >= capacities[w] + tasksAhead)
+                        continue;
+                    dispatch(systemConfigurations, nextTask++, w, sends[w]);
+                    pending++;
+                }
+            }
+            if (log.IsDebugEnabled)
+                log.Debug("Process " + comm.Rank + " has dispatched the first " + nextTask + " of " + numTasks + " tasks");
+
+            string failure = null;
+            while (pending > 0)
+            {
+                int worker, taskId;
+                string error;
+                var scores = receiveResult(out worker, out taskId, out error);
+                pending--;
+                // The worker has received its oldest task, since it returned a result; messages between two processes are not overtaken.
+                if (sends[worker].Count > 0)
+                    sends[worker].Dequeue().Wait();
+
+                if (error != null)
+                {
+                    // The tasks in flight are still received, so that their results are not taken for those of the next call.
+                    log.Error("The evaluation of task " + taskId + " failed on the worker process " + worker + ": " + error);
+                    if (failure == null)
+                        failure = "The evaluation of task " + taskId + " failed on the worker process " + worker + ": " + error;
+                }
+                else
+                {
+                    int i = taskId / numSystems;
+                    scores.config = systemConfigurations[i];
+                    result[i][taskId % numSystems] = scores;
+                }
+
+                if (failure == null && nextTask < numTasks)
+                {
+                    dispatch(systemConfigurations, nextTask++, worker, sends[worker]);
+                    pending++;
+                }
+            }
+            for (int w = 1; w < comm.Size; w++)
+                while (sends[w].Count > 0)
+                    sends[w].Dequeue().Wait();
+            if (failure != null)
+                throw new InvalidOperationException(failure);
+            if (log.IsDebugEnabled)
+                log.Debug("Process " + comm.Rank + " has received the scores of all " + numTasks + " tasks");
+            return result;
+        }
+
+        private void dispatch(MpiSysConfig[] systemConfigurations, int taskId, int worker, Queue<Request> sends)
+        {
+            if (schema != null)
+            {
+                // The array must not be modified until the send is complete; it is not reused.
+                var packed = schema.PackTask(taskId, taskId % numSystems, systemConfigurations[taskId / numSystems]);
+                sends.Enqueue(comm.ImmediateSend(packed, worker, Convert.ToInt32(MpiMessageTags.PackedEvaluationTaskMsgTag)));
+                return;
+            }
+            var task = new MpiEvaluationTask
+            {
+                taskId = taskId,
+                systemIndex = taskId % numSystems,
+                sysConfig = systemConfigurations[taskId / numSystems]
+            };
+            sends.Enqueue(comm.ImmediateSend(task, worker, Convert.ToInt32(MpiMessageTags.EvaluationTaskMsgTag)));
+        }
+
+        /// <summary>
+        /// Receives the next result from any worker
+        /// </summary>
+        /// <param name="error">The description of the exception thrown by the evaluation if it failed, in which case there are no scores; null otherwise</param>
+        private MpiObjectiveScores receiveResult(out int worker, out int taskId, out string error)
+        {
+            error = null;
+            Status status = comm.Probe(Communicator.anySource, Communicator.anyTag);
+            worker = status.Source;
+            if (status.Tag == Convert.ToInt32(MpiMessageTags.EvaluationFailureMsgTag))
+            {
+                MpiEvaluationFailure taskFailure;
+                comm.Receive(worker, status.Tag, out taskFailure);
+                taskId = taskFailure.taskId;
+                error = taskFailure.message;
+                return default(MpiObjectiveScores);
+            }
+            int expectedTag = Convert.ToInt32(schema != null ? MpiMessageTags.PackedEvaluationResultMsgTag : MpiMessageTags.EvaluationResultMsgTag);
+            if (status.Tag != expectedTag)
+                throw new NotSupportedException("Unexpected message tag received from the worker process " + worker + ": " + status.Tag);
+            if (schema != null)
+            {
+                var packed = new double[schema.ResultLength];
+                comm.Receive(worker, status.Tag, ref packed);
+                var scores = schema.UnpackResult(packed, out taskId);
+                scores.CatchmentId = schema.GetSystemId(taskId % numSystems);
+                return scores;
+            }
+            MpiEvaluationResult taskResult;
+            comm.Receive(worker, status.Tag, out taskResult);
+            taskId = taskResult.taskId;
+            return taskResult.scores;
+        }
+
+        /// <summary>
+        /// Tells the worker processes that there are no more tasks to evaluate.
+        /// </summary>
+        public void Dispose()
+        {
+            if (disposed)
+                return;
+            for (int w = 1; w < comm.Size; w++)
+                comm.Send(true, w, Convert.ToInt32(MpiMessageTags.WorkerTerminationMsgTag));
+            disposed = true;
+        }
+    }
+}
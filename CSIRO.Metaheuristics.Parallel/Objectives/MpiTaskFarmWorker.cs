@@ -0,0 +1,299 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Reflection;
+using System.Threading;
+using CSIRO.Metaheuristics.Objectives;
+using CSIRO.Metaheuristics.Parallel.SystemConfigurations;
+using MPI;
+
+namespace CSIRO.Metaheuristics.Parallel.Objectives
+{
+    /// <summary>
+    /// The loop run by the 'worker' MPI processes of a <see cref="MpiTaskFarmEvaluator"/>: 
+    /// evaluate the tasks received from the master process until told to stop.
+    /// </summary>
+    /// <remarks>
+    /// The format of the messages is set by the master process: tasks are packed arrays of values once it has sent an <see cref="MpiWireSchema"/>.
+    /// A worker may evaluate several tasks concurrently on a pool of threads, with clones of the system evaluators, 
+    /// typically running one process per node rather than per core, so that the input data and model setup are not duplicated in each process. 
+    /// All MPI calls are made from the thread calling <see cref="Run"/>.
+    /// An evaluation that throws an exception is reported to the master process instead of its scores, and the worker carries on.
+    /// </remarks>
+    public class MpiTaskFarmWorker
+    {
+        private static readonly log4net.ILog log = log4net.LogManager.GetLogger(MethodBase.GetCurrentMethod().DeclaringType);
+
+        private readonly Intracommunicator comm;
+        private readonly IObjectiveEvaluator<MpiSysConfig>[] systemEvaluators;
+        private readonly EvaluatorPool<MpiSysConfig>[] evaluatorPools;
+        private readonly int numThreads;
+        private readonly string[] systemIds;
+        private MpiWireSchema schema = null;
+        private int taskCount = 0;
+
+        /// <summary>
+        /// How long the thread making the MPI calls waits for an evaluation to complete, before checking for new messages from the master process.
+        /// </summary>
+        private const int pollIntervalMilliseconds = 1;
+
+        /// <summary>
+        /// Creates a worker evaluating one task at a time
+        /// </summary>
+        /// <param name="systemEvaluators">The evaluators of each of the systems of the ensemble, in the order known to the master process</param>
+        /// <param name="systemIds">Optional identifiers of the systems, e.g. catchment identifiers, set in the scores returned</param>
+        /// <param name="comm">The communicator; the world communicator if null.</param>
+        public MpiTaskFarmWorker(IObjectiveEvaluator<MpiSysConfig>[] systemEvaluators, string[] systemIds = null, Intracommunicator comm = null)
+        {
+            if (systemEvaluators == null || systemEvaluators.Length == 0) throw new ArgumentException("There must be at least one system evaluator", "systemEvaluators");
+            if (systemIds != null && systemIds.Length != systemEvaluators.Length) throw new ArgumentException("There must be as many system identifiers as system evaluators", "systemIds");
+            this.comm = (comm == null ? Communicator.world : comm);
+            if (this.comm.Rank == 0) throw new NotSupportedException("MpiTaskFarmWorker is designed to work with MPI processes other than rank 0");
+            this.systemEvaluators = systemEvaluators;
+            this.systemIds = systemIds;
+            this.numThreads = 1;
+        }
+
+        /// <summary>
+        /// Creates a worker evaluating several tasks concurrently
+        /// </summary>
+        /// <param name="systemEvaluators">The evaluators of each of the systems of the ensemble, in the order known to the master process. 
+        /// They must support thread safe cloning.</param>
+        /// <param name="numThreads">The number of tasks evaluated concurrently, e.g. the number of cores of the node</param>
+        /// <param name="systemIds">Optional identifiers of the systems, e.g. catchment identifiers, set in the scores returned</param>
+        /// <param name="comm">The communicator; the world communicator if null.</param>
+        public MpiTaskFarmWorker(IClonableObjectiveEvaluator<MpiSysConfig>[] systemEvaluators, int numThreads, string[] systemIds = null, Intracommunicator comm = null)
+            : this((IObjectiveEvaluator<MpiSysConfig>[])systemEvaluators, systemIds, comm)
+        {
+            if (numThreads < 1) throw new ArgumentOutOfRangeException("numThreads", "A worker needs at least one thread");
+            this.numThreads = numThreads;
+            if (numThreads > 1)
+                evaluatorPools = Array.ConvertAll(systemEvaluators, x => new EvaluatorPool<MpiSysConfig>(x));
+        }
+
+        /// <summary>
+        /// Gets the number of tasks evaluated by this worker so far
+        /// </summary>
+        public int TaskCount
+        {
+            get { return taskCount; }
+        }
+
+        /// <summary>
+        /// Gets the number of tasks this worker evaluates concurrently
+        /// </summary>
+        public int NumThreads
+        {
+            get { return numThreads; }
+        }
+
+        private class WorkItem
+        {
+            public int TaskId;
+            public int SystemIndex;
+            public MpiSysConfig SysConfig;
+            public IObjectiveScores<MpiSysConfig> Scores;
+            public Exception Error;
+        }
+
+        /// <summary>
+        /// Evaluates the tasks sent by the master process, until it sends the termination message.
+        /// </summary>
+        public void Run()
+        {
+            comm.Send(numThreads, 0, Convert.ToInt32(MpiMessageTags.WorkerCapacityMsgTag));
+            if (evaluatorPools == null)
+                runSerial();
+            else
+            {
+                try
+                {
+                    runThreaded();
+                }
+                finally
+                {
+                    foreach (var pool in evaluatorPools)
+                        pool.Dispose();
+                }
+            }
+            if (log.IsDebugEnabled)
+                log.Debug("Process " + comm.Rank + " has evaluated " + TaskCount + " tasks");
+        }
+
+        private void runSerial()
+        {
+            // The result of the previous task is sent while this one is evaluated
+            Request send = null;
+            WorkItem item;
+            while (receive(comm.Probe(0, Communicator.anyTag), out item))
+            {
+                if (item == null)
+                    continue;
+                try
+                {
+                    item.Scores = systemEvaluators[item.SystemIndex].EvaluateScore(item.SysConfig);
+                    Interlocked.Increment(ref taskCount);
+                }
+                catch (Exception e)
+                {
+                    item.Error = e;
+                }
+                sendResult(item, ref send);
+            }
+            if (send != null)
+                send.Wait();
+        }
+
+        private void runThreaded()
+        {
+            var queue = new BlockingCollection<WorkItem>();
+            var completed = new BlockingCollection<WorkItem>();
+            var threads = new Thread[numThreads];
+            for (int i = 0; i < threads.Length; i++)
+            {
+                threads[i] = new Thread(() => evaluateQueue(queue, completed)) { IsBackground = true, Name = "MpiTaskFarmWorker " + i };
+                threads[i].Start();
+            }
+
+            Request send = null;
+            int outstanding = 0;
+            bool finished = false;
+            try
+            {
+                WorkItem item;
+                while (!finished || outstanding > 0)
+                {
+                    bool idle = true;
+                    while (completed.TryTake(out item))
+                    {
+                        idle = false;
+                        outstanding--;
+                        sendResult(item, ref send);
+                    }
+                    if (!finished)
+                    {
+                        Status status = comm.ImmediateProbe(0, Communicator.anyTag);
+                        if (status != null)
+                        {
+                            idle = false;
+                            if (!receive(status, out item))
+                                finished = true;
+                            else if (item != null)
+                            {
+                                queue.Add(item);
+                                outstanding++;
+                            }
+                        }
+                    }
+                    if (idle && completed.TryTake(out item, pollIntervalMilliseconds))
+                    {
+                        outstanding--;
+                        sendResult(item, ref send);
+                    }
+                }
+            }
+            finally
+            {
+                queue.CompleteAdding();
+                foreach (var thread in threads)
+                    thread.Join();
+            }
+            if (send != null)
+                send.Wait();
+        }
+
+        private void evaluateQueue(BlockingCollection<WorkItem> queue, BlockingCollection<WorkItem> completed)
+        {
+            // Clones of the system evaluators rented by this thread, as needed
+            var evaluators = new IClonableObjectiveEvaluator<MpiSysConfig>[evaluatorPools.Length];
+            try
+            {
+                foreach (var item in queue.GetConsumingEnumerable())
+                {
+                    try
+                    {
+                        if (evaluators[item.SystemIndex] == null)
+                            evaluators[item.SystemIndex] = evaluatorPools[item.SystemIndex].Rent();
+                        item.Scores = evaluators[item.SystemIndex].EvaluateScore(item.SysConfig);
+                        Interlocked.Increment(ref taskCount);
+                    }
+                    catch (Exception e)
+                    {
+                        item.Error = e;
+                    }
+                    completed.Add(item);
+                }
+            }
+            finally
+            {
+                for (int i = 0; i < evaluators.Length; i++)
+                    if (evaluators[i] != null)
+                        evaluatorPools[i].Return(evaluators[i]);
+            }
+        }
+
+        /// <summary>
+        /// Receives the message probed
+        /// </summary>
+        /// <returns>false if the master process has no more tasks to evaluate</returns>
+        private bool receive(Status status, out WorkItem item)
+        {
+            item = null;
+            if (status.Tag == Convert.ToInt32(MpiMessageTags.WorkerTerminationMsgTag))
+            {
+                bool finished;
+                comm.Receive(0, status.Tag, out finished);
+                return false;
+            }
+            if (status.Tag == Convert.ToInt32(MpiMessageTags.WireSchemaMsgTag))
+            {
+                comm.Receive(0, status.Tag, out schema);
+                return true;
+            }
+            if (status.Tag == Convert.ToInt32(MpiMessageTags.PackedEvaluationTaskMsgTag))
+            {
+                if (schema == null)
+                    throw new NotSupportedException("The worker process " + comm.Rank + " received a packed task before the schema of the messages");
+                var packedTask = new double[schema.TaskLength];
+                comm.Receive(0, status.Tag, ref packedTask);
+                item = new WorkItem();
+                item.SysConfig = schema.UnpackTask(packedTask, out item.TaskId, out item.SystemIndex);
+            }
+            else if (status.Tag == Convert.ToInt32(MpiMessageTags.EvaluationTaskMsgTag))
+            {
+                MpiEvaluationTask task;
+                comm.Receive(0, status.Tag, out task);
+                item = new WorkItem { TaskId = task.taskId, SystemIndex = task.systemIndex, SysConfig = task.sysConfig };
+            }
+            else
+                throw new NotSupportedException("Unexpected message tag received by the worker process " + comm.Rank + ": " + status.Tag);
+
+            if (item.SystemIndex < 0 || item.SystemIndex >= systemEvaluators.Length)
+                throw new IndexOutOfRangeException("Task " + item.TaskId + " refers to the system index " + item.SystemIndex + ", but there are " + systemEvaluators.Length + " systems");
+            return true;
+        }
+
+        private void sendResult(WorkItem item, ref Request send)
+        {
+            // One send in flight at a time; the previous one has usually completed by now.
+            if (send != null)
+                send.Wait();
+            if (item.Error != null)
+            {
+                log.Error("The evaluation of task " + item.TaskId + " failed on the worker process " + comm.Rank, item.Error);
+                var failure = new MpiEvaluationFailure { taskId = item.TaskId, message = item.Error.ToString() };
+                send = comm.ImmediateSend(failure, 0, Convert.ToInt32(MpiMessageTags.EvaluationFailureMsgTag));
+            }
+            else if (schema != null)
+            {
+                var packedResult = schema.PackResult(item.TaskId, item.Scores);
+                send = comm.ImmediateSend(packedResult, 0, Convert.ToInt32(MpiMessageTags.PackedEvaluationResultMsgTag));
+            }
+            else
+            {
+                var scores = new MpiObjectiveScores(item.Scores, (systemIds == null ? string.Empty : systemIds[item.SystemIndex]));
+                scores.config = null;
+                send = comm.ImmediateSend(new MpiEvaluationResult { taskId = item.TaskId, scores = scores }, 0, Convert.ToInt32(MpiMessageTags.EvaluationResultMsgTag));
+            }
+        }
+    }
+}
@@ -0,0 +1,152 @@
+﻿using System;
+using CSIRO.Metaheuristics.Parallel.SystemConfigurations;
+
+namespace CSIRO.Metaheuristics.Parallel.Objectives
+{
+    /// <summary>
+    /// The fixed layout of the parameters and scores exchanged between MPI processes as packed arrays of doubles.
+    /// </summary>
+    /// <remarks>
+    /// The schema, with the names of the parameters and scores, is sent once to each worker process. 
+    /// Afterwards the messages only carry the values, sent with the native MPI datatype for doubles 
+    /// rather than through the serialization of MpiSysConfig and MpiObjectiveScores objects.
+    /// The system configurations packed must have their parameters in the order of the schema template.
+    /// </remarks>
+    [Serializable]
+    public class MpiWireSchema
+    {
+        /// <summary>
+        /// Number of leading values in a packed task: task identifier and system index
+        /// </summary>
+        public const int TaskHeaderLength = 2;
+
+        /// <summary>
+        /// Number of leading values in a packed result: task identifier
+        /// </summary>
+        public const int ResultHeaderLength = 1;
+
+        private readonly MpiSysConfig template;
+        private readonly string[] scoreNames;
+        private readonly bool[] maximise;
+        private readonly string[] systemIds;
+
+        /// <summary>
+        /// Creates a schema
+        /// </summary>
+        /// <param name="template">A system configuration, giving the names, bounds and order of the parameters, and the type of the configurations unpacked.</param>
+        /// <param name="scoreNames">The names of the scores calculated for each system, in the order the system evaluators return them</param>
+        /// <param name="maximise">Whether each score is maximised</param>
+        /// <param name="systemIds">Optional identifiers of the systems, e.g. catchment identifiers, set in the scores unpacked</param>
+        public MpiWireSchema(MpiSysConfig template, string[] scoreNames, bool[] maximise, string[] systemIds = null)
+        {
+            if (template == null) throw new ArgumentNullException("template");
+            if (scoreNames == null || scoreNames.Length == 0) throw new ArgumentException("There must be at least one score name", "scoreNames");
+            if (maximise == null || maximise.Length != scoreNames.Length) throw new ArgumentException("There must be as many maximisation flags as score names", "maximise");
+            this.template = (MpiSysConfig)template.Clone();
+            this.scoreNames = (string[])scoreNames.Clone();
+            this.maximise = (bool[])maximise.Clone();
+            this.systemIds = (systemIds == null ? null : (string[])systemIds.Clone());
+        }
+
+        public int ParameterCount
+        {
+            get { return template.parameters.Length; }
+        }
+
+        public int ScoreCount
+        {
+            get { return scoreNames.Length; }
+        }
+
+        public int TaskLength
+        {
+            get { return TaskHeaderLength + ParameterCount; }
+        }
+
+        public int ResultLength
+        {
+            get { return ResultHeaderLength + ScoreCount; }
+        }
+
+        public double[] PackTask(int taskId, int systemIndex, MpiSysConfig sysConfig)
+        {
+            var parameters = sysConfig.parameters;
+            var templateParameters = template.parameters;
+            if (parameters.Length != templateParameters.Length)
+                throw new ArgumentException("The system configuration has " + parameters.Length + " parameters, but the schema has " + templateParameters.Length);
+            var result = new double[TaskLength];
+            result[0] = taskId;
+            result[1] = systemIndex;
+            for (int i = 0; i < parameters.Length; i++)
+            {
+                if (parameters[i].name != templateParameters[i].name)
+                    throw new ArgumentException("Parameter " + i + " of the system configuration is " + parameters[i].name + ", but the schema expects " + templateParameters[i].name);
+                result[TaskHeaderLength + i] = parameters[i].value;
+            }
+            return result;
+        }
+
+        public MpiSysConfig UnpackTask(double[] packed, out int taskId, out int systemIndex)
+        {
+            checkLength(packed, TaskLength, "task");
+            taskId = (int)packed[0];
+            systemIndex = (int)packed[1];
+            var result = (MpiSysConfig)template.Clone();
+            for (int i = 0; i < result.parameters.Length; i++)
+                result.parameters[i].value = packed[TaskHeaderLength + i];
+            return result;
+        }
+
+        public double[] PackResult(int taskId, IObjectiveScores scores)
+        {
+            if (scores.ObjectiveCount != scoreNames.Length)
+                throw new ArgumentException("The scores have " + scores.ObjectiveCount + " objectives, but the schema has " + scoreNames.Length);
+            var result = new double[ResultLength];
+            result[0] = taskId;
+            for (int i = 0; i < scoreNames.Length; i++)
+            {
+                var score = scores.GetObjective(i);
+                if (score.Name != scoreNames[i])
+                    throw new ArgumentException("Score " + i + " is " + score.Name + ", but the schema expects " + scoreNames[i]);
+                result[ResultHeaderLength + i] = Convert.ToDouble(score.ValueComparable);
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// Unpacks the scores of a task. The system configuration evaluated is not part of the message, and is left null.
+        /// </summary>
+        public MpiObjectiveScores UnpackResult(double[] packed, out int taskId)
+        {
+            checkLength(packed, ResultLength, "result");
+            taskId = (int)packed[0];
+            var scores = new MpiObjectiveScore[scoreNames.Length];
+            for (int i = 0; i < scores.Length; i++)
+            {
+                double value = packed[ResultHeaderLength + i];
+                scores[i] = new MpiObjectiveScore
+                {
+                    name = scoreNames[i],
+                    maximise = maximise[i],
+                    text = scoreNames[i] + " " + value.ToString(),
+                    value = value
+                };
+            }
+            return new MpiObjectiveScores { scores = scores, config = null, CatchmentId = string.Empty };
+        }
+
+        /// <summary>
+        /// Gets the identifier of a system of the ensemble, or an empty string if the schema has no system identifiers
+        /// </summary>
+        public string GetSystemId(int systemIndex)
+        {
+            return (systemIds == null ? string.Empty : systemIds[systemIndex]);
+        }
+
+        private static void checkLength(double[] packed, int expected, string what)
+        {
+            if (packed.Length != expected)
+                throw new ArgumentException("A packed " + what + " should have " + expected + " values, but has " + packed.Length);
+        }
+    }
+}
@@ -20,7 +20,23 @@ namespace CSIRO.Metaheuristics.Parallel.SystemConfigurations
     {
         SystemConfigurationMsgTag = 1,
         EvalSlaveResultMsgTag = 2,
-        ModelDefinition = 3
+        ModelDefinition = 3,
+        /// <summary>An <see cref="CSIRO.Metaheuristics.Parallel.Objectives.MpiEvaluationTask"/> sent to a worker process</summary>
+        EvaluationTaskMsgTag = 4,
+        /// <summary>An <see cref="CSIRO.Metaheuristics.Parallel.Objectives.MpiEvaluationResult"/> sent back to the master process</summary>
+        EvaluationResultMsgTag = 5,
+        /// <summary>Tells a worker process that there are no more tasks to evaluate</summary>
+        WorkerTerminationMsgTag = 6,
+        /// <summary>The <see cref="CSIRO.Metaheuristics.Parallel.Objectives.MpiWireSchema"/> of the packed messages, sent once to each worker process</summary>
+        WireSchemaMsgTag = 7,
+        /// <summary>An evaluation task packed as an array of doubles</summary>
+        PackedEvaluationTaskMsgTag = 8,
+        /// <summary>An evaluation result packed as an array of doubles</summary>
+        PackedEvaluationResultMsgTag = 9,
+        /// <summary>The number of tasks a worker process evaluates concurrently, sent to the master process at startup</summary>
+        WorkerCapacityMsgTag = 10,
+        /// <summary>An <see cref="CSIRO.Metaheuristics.Parallel.Objectives.MpiEvaluationFailure"/> sent back to the master process instead of a result</summary>
+        EvaluationFailureMsgTag = 11
     }
 
     /// <summary>
@@ -31,6 +31,72 @@ namespace CSIRO.Metaheuristics.Tests
 
     }
 
+    [TestFixture]
+    public class TestGeometricOperationsDenseHypercube : AbstractTestGeometricOperations<DenseHyperCube>
+    {
+        protected override ITestHypercubeFactory<DenseHyperCube> createFactory()
+        {
+            return new DenseHypercubeFactory();
+        }
+
+        private class DenseHypercubeFactory : ITestHypercubeFactory<DenseHyperCube>
+        {
+            private HyperCubeSchema schema = null;
+            public DenseHyperCube Create(int dim, int value, int min, int max)
+            {
+                if (schema == null || schema.Dimensions != dim)
+                    schema = new HyperCubeSchema(Enumerable.Range(0, dim).Select(i => i.ToString()).ToArray());
+                var result = new DenseHyperCube(schema);
+                foreach (var varName in result.GetVariableNames())
+                    result.SetMinMaxValue(varName, min, max, value);
+                return result;
+            }
+        }
+
+        [Test]
+        public void TestSameAsHyperCube()
+        {
+            var hco = new HyperCubeOperations(new BasicRngFactory(0));
+            var hcoDense = new HyperCubeOperations(new BasicRngFactory(0));
+            var points = new IHyperCube<double>[4];
+            var densePoints = new IHyperCube<double>[4];
+            var template = DenseHyperCube.FromHyperCube(new TestHyperCube(3, 0, -5, 5));
+            for (int i = 0; i < points.Length; i++)
+            {
+                var p = new TestHyperCube(3, 0, -5, 5);
+                p.SetValues(i * 0.3 - 1, 1.7 - i * 0.9, i * i * 0.1);
+                points[i] = p;
+                densePoints[i] = template.Clone() as DenseHyperCube;
+                ((DenseHyperCube)densePoints[i]).SetValues(new[] { i * 0.3 - 1, 1.7 - i * 0.9, i * i * 0.1 }, 0);
+            }
+            var varNames = points[0].GetVariableNames();
+            assertSameValues(hco.GetCentroid(points), hcoDense.GetCentroid(densePoints), varNames);
+            assertSameValues(hco.GenerateRandomWithinHypercube(points), hcoDense.GenerateRandomWithinHypercube(densePoints), varNames);
+            assertSameValues(points[1].HomotheticTransform(points[0], -1.0), densePoints[1].HomotheticTransform(densePoints[0], -1.0), varNames);
+            assertSameValues(points[2].HomotheticTransform(points[3], 0.5), densePoints[2].HomotheticTransform(densePoints[3], 0.5), varNames);
+            Assert.IsNull(densePoints[0].HomotheticTransform(densePoints[3], 10.0));
+        }
+
+        [Test]
+        public void TestBoundsNotSharedOnceSet()
+        {
+            var a = factory.Create(2, 1, 0, 4);
+            var b = (DenseHyperCube)a.Clone();
+            b.SetMaxValue("0", 2);
+            Assert.AreEqual(4, a.GetMaxValue("0"));
+            Assert.AreEqual(2, b.GetMaxValue("0"));
+            Assert.Throws<ArgumentException>(() => b.SetValue("0", 3));
+            a.SetValue("0", 3);
+            Assert.AreEqual(1, b.GetValue("0"));
+        }
+
+        private static void assertSameValues(IHyperCube<double> expected, IHyperCube<double> actual, string[] varNames)
+        {
+            for (int i = 0; i < varNames.Length; i++)
+                Assert.AreEqual(expected.GetValue(varNames[i]), actual.GetValue(varNames[i]), "variable " + varNames[i]);
+        }
+    }
+
     public abstract class AbstractTestGeometricOperations<T> where T : IHyperCube<double>
     {
         protected AbstractTestGeometricOperations()
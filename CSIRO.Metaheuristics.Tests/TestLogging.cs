@@ -5,6 +5,10 @@ using System.Text;
 using NUnit.Framework;
 using CSIRO.Metaheuristics.Utils;
 using CSIRO.Metaheuristics.Logging;
+using CSIRO.Metaheuristics.Fitness;
+using CSIRO.Metaheuristics.CandidateFactories;
+using CSIRO.Metaheuristics.Optimization;
+using CSIRO.Metaheuristics.RandomNumberGenerators;
 
 namespace CSIRO.Metaheuristics.Tests
 {
@@ -71,6 +75,192 @@ namespace CSIRO.Metaheuristics.Tests
 
         }
 
+        [Test]
+        public void TestBinaryLogger()
+        {
+            var fileName = System.IO.Path.GetTempFileName();
+            try
+            {
+                Dictionary<string, string> strMsg;
+                Dictionary<string, string> popTags;
+                using (var logger = new BinaryLogger(fileName))
+                {
+                    LoggerMhTestHelper.WriteTestLogContent(logger, out strMsg, out popTags);
+                    Assert.AreEqual(2, logger.RecordCount);
+                }
+                var log = BinaryLogReader.Read(fileName);
+                Assert.AreEqual(2, log.Count);
+
+                // The content read back is the same as kept by the in memory logger
+                InMemoryLogger expected;
+                LoggerMhTestHelper.CreateTestLogContent(out expected, out strMsg, out popTags);
+                var expectedLines = expected.ExtractLog().Item2;
+                var lines = log.ExtractLog().Item2;
+                Assert.AreEqual(expectedLines.Count, lines.Count);
+                for (int i = 0; i < lines.Count; i++)
+                    AssertEquivalentDictionaries(expectedLines[i], lines[i]);
+
+                Dictionary<string, string[]> strInfo;
+                Dictionary<string, double[]> numericInfo;
+                log.ToColumns(out strInfo, out numericInfo);
+                var expectedNumeric = new Dictionary<string, double[]>(){
+                        {"0", new []   {double.NaN, 1.0,1.0,2.0}}, 
+                        {"1", new []   {double.NaN, 2.0,2.2,3.0}}, 
+                        {"2", new []   {double.NaN, 3.0,4.0,5.0}}, 
+                        {"0_s", new [] {double.NaN, 1.0,1.0,2.0}}, 
+                        {"1_s", new [] {double.NaN, 2.0,2.2,3.0}}, 
+                        {"2_s", new [] {double.NaN, 3.0,4.0,5.0}}
+                };
+                AssertEquivalentDictionaries(expectedNumeric, numericInfo);
+                Assert.AreEqual(new[] { "the string message", "initial population msg", "initial population msg", "initial population msg" }, strInfo["Message"]);
+            }
+            finally
+            {
+                System.IO.File.Delete(fileName);
+            }
+        }
+
+        [Test]
+        public void TestBinaryLoggerDisposedWhileLogging()
+        {
+            var fileName = System.IO.Path.GetTempFileName();
+            try
+            {
+                var logger = new BinaryLogger(fileName, chunkSize: 1024);
+                var tags = new Dictionary<string, string> { { "Category", "Test" } };
+                var started = new System.Threading.CountdownEvent(4);
+                var writers = Enumerable.Range(0, 4).Select(i => System.Threading.Tasks.Task.Run(() =>
+                {
+                    started.Signal();
+                    // Records logged once the logger is disposed of are dropped
+                    for (int k = 0; k < 200000; k++)
+                        logger.Write("message " + k, tags);
+                })).ToArray();
+                started.Wait();
+                System.Threading.Thread.Sleep(10);
+                logger.Dispose();
+                System.Threading.Tasks.Task.WaitAll(writers);
+                Assert.AreEqual(logger.RecordCount, BinaryLogReader.Read(fileName).Count);
+            }
+            finally
+            {
+                System.IO.File.Delete(fileName);
+            }
+        }
+
+        [Test]
+        public void TestColumnarLogger()
+        {
+            var directory = System.IO.Path.Combine(System.IO.Path.GetTempPath(), System.IO.Path.GetRandomFileName());
+            try
+            {
+                Dictionary<string, string> strMsg;
+                Dictionary<string, string> popTags;
+                // One row per chunk, so that the numeric columns first seen after the message row are back-filled
+                using (var logger = new ColumnarLogger(directory, rowsPerChunk: 1))
+                {
+                    LoggerMhTestHelper.WriteTestLogContent(logger, out strMsg, out popTags);
+                    Assert.AreEqual(4, logger.RowCount);
+                }
+                assertColumnarTestLogContent(directory);
+
+                InMemoryLogger logged;
+                LoggerMhTestHelper.CreateTestLogContent(out logged, out strMsg, out popTags);
+                Assert.AreEqual(4, logged.WriteColumnar(directory));
+                assertColumnarTestLogContent(directory);
+            }
+            finally
+            {
+                if (System.IO.Directory.Exists(directory))
+                    System.IO.Directory.Delete(directory, true);
+            }
+        }
+
+        private void assertColumnarTestLogContent(string directory)
+        {
+            Dictionary<string, string[]> strInfo;
+            Dictionary<string, double[]> numericInfo;
+            readColumnarLog(directory, out strInfo, out numericInfo);
+            var expectedNumeric = new Dictionary<string, double[]>(){
+                    {"0", new []   {double.NaN, 1.0,1.0,2.0}},
+                    {"1", new []   {double.NaN, 2.0,2.2,3.0}},
+                    {"2", new []   {double.NaN, 3.0,4.0,5.0}},
+                    {"0_s", new [] {double.NaN, 1.0,1.0,2.0}},
+                    {"1_s", new [] {double.NaN, 2.0,2.2,3.0}},
+                    {"2_s", new [] {double.NaN, 3.0,4.0,5.0}}
+            };
+            AssertEquivalentDictionaries(expectedNumeric, numericInfo);
+            Assert.AreEqual(new[] { "the string message", "initial population msg", "initial population msg", "initial population msg" }, strInfo["Message"]);
+        }
+
+        /// <summary>
+        /// Reads column files the way the R package does
+        /// </summary>
+        private static void readColumnarLog(string directory, out Dictionary<string, string[]> strInfo, out Dictionary<string, double[]> numericInfo)
+        {
+            var manifest = System.IO.File.ReadAllLines(System.IO.Path.Combine(directory, ColumnarLogWriter.ManifestFileName));
+            Assert.AreEqual("mhcolumns\t1", manifest[0]);
+            int numRows = int.Parse(manifest[1].Split('\t')[1]);
+            strInfo = new Dictionary<string, string[]>();
+            numericInfo = new Dictionary<string, double[]>();
+            for (int i = 2; i < manifest.Length; i++)
+            {
+                var fields = manifest[i].Split('\t');
+                var bytes = System.IO.File.ReadAllBytes(System.IO.Path.Combine(directory, fields[1]));
+                if (fields[0] == "numeric")
+                {
+                    Assert.AreEqual(numRows * sizeof(double), bytes.Length);
+                    var values = new double[numRows];
+                    Buffer.BlockCopy(bytes, 0, values, 0, bytes.Length);
+                    numericInfo.Add(fields[2], values);
+                }
+                else
+                {
+                    Assert.AreEqual("factor", fields[0]);
+                    Assert.AreEqual(numRows * sizeof(int), bytes.Length);
+                    var levels = System.IO.File.ReadAllLines(System.IO.Path.Combine(directory, fields[1] + ".levels"));
+                    var values = new string[numRows];
+                    for (int j = 0; j < numRows; j++)
+                    {
+                        int code = BitConverter.ToInt32(bytes, j * sizeof(int));
+                        values[j] = (code == 0 ? null : levels[code - 1]);
+                    }
+                    strInfo.Add(fields[2], values);
+                }
+            }
+        }
+
+        [Test]
+        public void TestLoggerLevelFiltering()
+        {
+            var logger = new InMemoryLogger();
+            var engine = createSce(logger);
+            engine.Evolve();
+            int numEntries = logger.Count();
+            Assert.IsTrue(logger.Any(x => x.Tags["Message"] == "Reflected point in subcomplex"));
+
+            logger = new InMemoryLogger() { Level = LoggerMhLevel.Summary };
+            engine = createSce(logger);
+            engine.Evolve();
+            Assert.IsTrue(logger.Any(x => x.Tags["Message"] == "Initial Population"));
+            Assert.IsFalse(logger.Any(x => x.Tags["Message"] == "Reflected point in subcomplex"));
+            Assert.IsTrue(logger.Count() < numEntries);
+        }
+
+        private static ShuffledComplexEvolution<TestHyperCube> createSce(ILoggerMh logger)
+        {
+            var rng = new BasicRngFactory(0);
+            var engine = new ShuffledComplexEvolution<TestHyperCube>(
+                new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2)),
+                new UniformRandomSamplingFactory<TestHyperCube>(rng.CreateFactory(), new TestHyperCube(2, 0, -10, 10)),
+                new ShuffledComplexEvolution<TestHyperCube>.MaxShuffleTerminationCondition(),
+                3, 10, 5, 3, 10, 2,
+                rng,
+                new DefaultFitnessAssignment());
+            engine.Logger = logger;
+            return engine;
+        }
+
         private static void AssertEquivalentDictionaries<T>(Dictionary<string, T> a, Dictionary<string, T> b)
         {
             if (a.Count() != b.Count()) throw new AssertionException("Dictionaries have a different length - cannot be equivalent in content");
@@ -41,6 +41,24 @@ namespace CSIRO.Metaheuristics.Tests
             Assert.AreEqual(3.4, points[1].GetValue("1"));
         }
 
+        [Test]
+        public void TestRunningStatistics()
+        {
+            var values = new double[] { 1024.0471, 980.6007, 1006.0446, 972.9169, 1000.0527, 1004.0899, 1008.8202 };
+            var statistics = new RunningStatistics();
+            Assert.IsTrue(double.IsNaN(statistics.Mean));
+            foreach (var x in values)
+                statistics.Add(x);
+            Assert.AreEqual(values.Length, statistics.Count);
+            double mean = values.Average();
+            Assert.AreEqual(mean, statistics.Mean, 1e-9);
+            Assert.AreEqual(values.Sum(x => (x - mean) * (x - mean)) / (values.Length - 1), statistics.Variance, 1e-9);
+            Assert.AreEqual(0.01741291, statistics.StandardDeviation / statistics.Mean, 1e-8);
+            statistics.Reset();
+            statistics.Add(1);
+            Assert.IsTrue(double.IsNaN(statistics.Variance));
+        }
+
         [Test]
         public void TestMakeBins()
         {
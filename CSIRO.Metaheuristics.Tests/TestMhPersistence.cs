@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Data.Entity;
 using System.Linq;
 using System.Text;
 using NUnit.Framework;
@@ -103,6 +104,57 @@ namespace CSIRO.Metaheuristics.DataModel.Tests
     
         }
 
+        [Test]
+        public void TestResultsBatch()
+        {
+            var batch = new ResultsBatch();
+            var tags = new Dictionary<string, string> { { "Category", "Initial population" } };
+            batch.Add(new IObjectiveScores[] { createScores(0.5, 0.1), createScores(0.6, 0.3) }, tags);
+            batch.Add(new TestHyperCube(3, 0.2, 0, 1), null);
+            Assert.AreEqual(3, batch.PointCount);
+            Assert.AreEqual(4, batch.ScoreCount);
+            batch.Clear();
+            Assert.AreEqual(0, batch.PointCount);
+            Assert.AreEqual(0, batch.ScoreCount);
+            Assert.Throws<NotSupportedException>(() => batch.Add(new IObjectiveScores[] { new MockObjScores { scores = new List<MockObjScore>() } }, tags));
+        }
+
+        [Test]
+        public void TestBulkWrite()
+        {
+            if (Environment.MachineName.ToLower() != "chrome-bu")
+                Assert.Ignore("Needs the SQL server of the MH.Results connection string");
+            var scores = new List<IObjectiveScores>();
+            for (int i = 0; i < 25; i++)
+                scores.Add(createScores(i / 25.0, 0.5));
+            var attributes = new Dictionary<string, string> { { "ModelId", "GR4J" }, { "CatchmentId", Guid.NewGuid().ToString() } };
+            int id = DbContextOperations.BulkSaveObjectiveResultsSet(scores, "bulk result set", attributes, batchSize: 10);
+
+            var found = DbContextOperations.FindResultsTagged(attributes);
+            Assert.AreEqual(1, found.Length);
+            Assert.AreEqual(id, found[0].ObjectivesResultsCollectionId);
+            Assert.AreEqual(2, found[0].Tags.Tags.Count);
+            using (var db = new OptimizationResultsContext())
+            {
+                var points = db.ObjectiveScoresSet.Where(x => x.Collection.ObjectivesResultsCollectionId == id).Include(x => x.Scores).ToList();
+                Assert.AreEqual(25, points.Count);
+                Assert.IsTrue(points.All(x => x.Scores.Count == 2));
+            }
+        }
+
+        private static MockObjScores createScores(double nse, double value)
+        {
+            return new MockObjScores
+            {
+                scores = new List<MockObjScore>
+                {
+                    new MockObjScore { maximize = true, name = "NSE", value = nse },
+                    new MockObjScore { maximize = false, name = "Bias", value = 0.1 }
+                },
+                sysConfig = new TestHyperCube(3, value, 0, 1)
+            };
+        }
+
         private class MockOptResults : IOptimizationResults<TestHyperCube>
         {
             public List<IObjectiveScores<TestHyperCube>> objectives;
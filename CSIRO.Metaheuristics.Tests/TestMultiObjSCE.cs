@@ -8,6 +8,7 @@ using CSIRO.Metaheuristics.Optimization;
 using CSIRO.Metaheuristics.CandidateFactories;
 using CSIRO.Metaheuristics.Fitness;
 using CSIRO.Metaheuristics.Objectives;
+using CSIRO.Metaheuristics.Logging;
 using System.Threading;
 using System.Diagnostics;
 
@@ -48,6 +49,252 @@ namespace CSIRO.Metaheuristics.Tests
             results = engine.Evolve();
         }
 
+        [Test]
+        public void TestSceAsynchronousShuffling()
+        {
+            var termination = new ShuffledComplexEvolution<TestHyperCube>.CoefficientOfVariationTerminationCondition(threshold: 2.5e-2, maxHours: 0.1);
+            var rng = new BasicRngFactory(0);
+            var evaluator = new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2));
+            var engine = createSce(termination, rng, evaluator);
+            engine.AsynchronousShuffling = true;
+            engine.MaxDegreeOfParallelism = 3;
+            var results = engine.Evolve();
+            Assert.IsFalse(termination.HasReachedMaxTime());
+            Assert.IsTrue(engine.CurrentShuffle > 1);
+            // No point is lost or duplicated by the incremental shuffles: p = 5 complexes of m = 20 points.
+            var population = results.ToArray();
+            Assert.AreEqual(5 * 20, population.Length);
+            Assert.AreEqual(population.Length, population.Distinct().Count());
+        }
+
+        [Test]
+        public void TestSceAsynchronousShufflingCancelled()
+        {
+            // Cancelled by the 300th evaluation, after the 100 points of the initial population
+            var termination = new ShuffledComplexEvolution<TestHyperCube>.CoefficientOfVariationTerminationCondition(threshold: 1e-12, maxHours: 0.1);
+            var evaluator = new CancellingEvaluator(new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2)), 300);
+            var engine = createSce(termination, new BasicRngFactory(0), null, evaluator, maxShuffle: 1000);
+            evaluator.Counter.Engine = engine;
+            engine.AsynchronousShuffling = true;
+            engine.MaxDegreeOfParallelism = 3;
+            var population = engine.Evolve().ToArray();
+            // The complexes evolving stop at their next step: at most two candidates each after the one cancelling, 
+            // instead of the rest of their alpha * beta steps.
+            Assert.IsTrue(evaluator.Counter.Count <= 300 + 3 * 3, evaluator.Counter.Count.ToString());
+            Assert.IsFalse(termination.HasReachedMaxTime());
+            Assert.AreEqual(5 * 20, population.Length);
+            Assert.AreEqual(population.Length, population.Distinct().Count());
+        }
+
+        [Test]
+        public void TestSceEngineMetrics()
+        {
+            var evaluator = new SCH1ObjectiveEvaluator(true);
+            var engine = createSce(evaluator);
+            engine.Evolve();
+            // Disabled by default
+            Assert.AreEqual(0, engine.Metrics.GetSnapshot().Total[EnginePhase.Run].Count);
+
+            engine = createSce(evaluator);
+            engine.Metrics.Enabled = true;
+            engine.Evolve();
+            var snapshot = engine.Metrics.GetSnapshot();
+            var total = snapshot.Total;
+            Assert.AreEqual(1, total[EnginePhase.Run].Count);
+            Assert.IsTrue(total[EnginePhase.Shuffling].Count > 1);
+            Assert.IsTrue(total[EnginePhase.FitnessAssignment].Count > 0);
+            // The initial population of p * m points is not evaluated by a complex
+            var evaluations = total[EnginePhase.Evaluation];
+            Assert.IsTrue(evaluations.Count > 5 * 20);
+            Assert.AreEqual(5, snapshot.Complexes.Length);
+            Assert.AreEqual(evaluations.Count - 5 * 20, snapshot.Complexes.Sum(c => c[EnginePhase.Evaluation].Count));
+            Assert.AreEqual(evaluations.Count, snapshot.Threads.Sum(t => t[EnginePhase.Evaluation].Count));
+            Assert.AreEqual(evaluations.Count, evaluations.GetHistogram().Sum());
+            Assert.IsTrue(evaluations.GetQuantile(0.5) <= evaluations.MaxTime);
+            Assert.IsTrue(total[EnginePhase.Run].TotalTime <= snapshot.Elapsed);
+            Assert.IsTrue(engine is IInstrumentedEngine);
+
+            engine.Metrics.Reset();
+            Assert.AreEqual(0, engine.Metrics.GetSnapshot().Total[EnginePhase.Evaluation].Count);
+        }
+
+        [Test]
+        public void TestSceCheckpointResume()
+        {
+            var fileName = System.IO.Path.GetTempFileName();
+            try
+            {
+                var expected = createSce(numShuffle: 8, m: 20).Evolve().ToArray();
+
+                // An optimisation stopped after 4 shuffles, then resumed from its last checkpoint, as if the process had been killed
+                var interrupted = createSce(numShuffle: 4, m: 20);
+                interrupted.CheckpointFileName = fileName;
+                interrupted.Evolve();
+                var resumed = createSce(numShuffle: 8, m: 20);
+                resumed.ResumeFrom(fileName);
+                Assert.AreEqual(3, resumed.CurrentShuffle);
+                var actual = resumed.Evolve().ToArray();
+
+                Assert.AreEqual(expected.Length, actual.Length);
+                for (int i = 0; i < expected.Length; i++)
+                {
+                    Assert.AreEqual((double)expected[i].GetObjective(0).ValueComparable, (double)actual[i].GetObjective(0).ValueComparable);
+                    var e = (TestHyperCube)expected[i].GetSystemConfiguration();
+                    var a = (TestHyperCube)actual[i].GetSystemConfiguration();
+                    foreach (var name in e.GetVariableNames())
+                        Assert.AreEqual(e.GetValue(name), a.GetValue(name));
+                }
+
+                Assert.Throws<System.IO.InvalidDataException>(() => createSce(numShuffle: 8, m: 21).ResumeFrom(fileName));
+            }
+            finally
+            {
+                System.IO.File.Delete(fileName);
+            }
+        }
+
+        private static ShuffledComplexEvolution<TestHyperCube> createSce(int numShuffle, int m)
+        {
+            // Fewer complexes as the optimisation progresses, so that the checkpoint must restore their number
+            var rng = new BasicRngFactory(0);
+            return new ShuffledComplexEvolution<TestHyperCube>(
+                new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2)),
+                new UniformRandomSamplingFactory<TestHyperCube>(rng.CreateFactory(), new TestHyperCube(2, 0, -10, 10)),
+                new ShuffledComplexEvolution<TestHyperCube>.MaxShuffleTerminationCondition(),
+                p: 5, m: m, q: 10, alpha: 3, beta: 20, numShuffle: numShuffle,
+                rng: rng,
+                fitnessAssignment: new DefaultFitnessAssignment(),
+                pmin: 2);
+        }
+
+        [Test]
+        public void TestSceSpeculativeBatchEvaluation()
+        {
+            var rng = new BasicRngFactory(0);
+            var evaluator = new BatchObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2));
+            var engine = new ShuffledComplexEvolution<TestHyperCube>(
+                evaluator,
+                new UniformRandomSamplingFactory<TestHyperCube>(rng.CreateFactory(), new TestHyperCube(2, 0, -10, 10)),
+                new ShuffledComplexEvolution<TestHyperCube>.MaxShuffleTerminationCondition(),
+                5, 20, 10, 3, 20, 7,
+                rng,
+                new DefaultFitnessAssignment(),
+                options: SceOptions.SpeculativeBatchEvaluation);
+            // Complexes evolve one after the other, so that the log follows the order of the batches
+            engine.MaxDegreeOfParallelism = 1;
+            var logger = new InMemoryLogger();
+            engine.Logger = logger;
+            var results = engine.Evolve();
+            var best = results.Select(x => (double)x.GetObjective(0).ValueComparable).Min();
+            Assert.IsTrue(best < 1e-2);
+
+            // The evolution steps of the complexes, each starting with its worst point
+            var steps = new List<List<ILogInfo>>();
+            foreach (var info in logger)
+            {
+                string message, category;
+                if (!info.Tags.TryGetValue("Message", out message) || !info.Tags.TryGetValue("Category", out category) || !category.StartsWith("Complex No"))
+                    continue;
+                if (message == "Worst point in subcomplex")
+                    steps.Add(new List<ILogInfo>());
+                if (steps.Count > 0)
+                    steps[steps.Count - 1].Add(info);
+            }
+            // Steps with a feasible reflected point evaluate all their candidates in one batch: reflected, contracted if feasible, then random
+            var batchSteps = steps.Where(x => x.Any(i => messageOf(i).StartsWith("Reflected point in subcomplex"))).ToList();
+            var batches = evaluator.Batches;
+            Assert.IsTrue(batches.Count > 0);
+            Assert.AreEqual(batchSteps.Count, batches.Count);
+            for (int k = 0; k < batches.Count; k++)
+            {
+                var batch = batches[k];
+                var step = batchSteps[k].Where(i => messageOf(i) != "Subcomplex without worst point").ToList();
+                double worst = objectiveOf(step[0]);
+                Assert.IsTrue(batch.Length == 2 || batch.Length == 3);
+
+                // Reflection, then contraction, then the random point, each accepted only if the previous ones are not
+                Assert.IsTrue(sameValues(batch[0], step[1]));
+                if (messageOf(step[1]) == "Reflected point in subcomplex")
+                {
+                    Assert.IsTrue(objectiveOf(step[1]) <= worst);
+                    Assert.AreEqual(2, step.Count);
+                    continue;
+                }
+                Assert.AreEqual("Reflected point in subcomplex - Failed", messageOf(step[1]));
+                Assert.IsTrue(objectiveOf(step[1]) > worst);
+                int next = 2;
+                if (messageOf(step[2]) == "Contracted point unfeasible")
+                    next = 3;
+                else
+                {
+                    Assert.IsTrue(sameValues(batch[1], step[2]));
+                    if (messageOf(step[2]) == "Contracted point in subcomplex")
+                    {
+                        Assert.IsTrue(objectiveOf(step[2]) <= worst);
+                        Assert.AreEqual(3, step.Count);
+                        continue;
+                    }
+                    Assert.AreEqual("Contracted point in subcomplex-Failed", messageOf(step[2]));
+                    Assert.IsTrue(objectiveOf(step[2]) > worst);
+                    next = 3;
+                }
+                Assert.AreEqual("Adding a random point in hypercube", messageOf(step[next]));
+                Assert.IsTrue(sameValues(batch[batch.Length - 1], step[next]));
+                Assert.AreEqual(next + 1, step.Count);
+            }
+        }
+
+        private static string messageOf(ILogInfo info)
+        {
+            string message;
+            return (info.Tags.TryGetValue("Message", out message) ? message : null);
+        }
+
+        private static double objectiveOf(ILogInfo info)
+        {
+            return (double)info.Scores[0].GetObjective(0).ValueComparable;
+        }
+
+        private static bool sameValues(TestHyperCube expected, ILogInfo info)
+        {
+            var actual = (IHyperCube<double>)info.Scores[0].GetSystemConfiguration();
+            return expected.GetVariableNames().All(v => expected.GetValue(v) == actual.GetValue(v));
+        }
+
+        private class BatchObjEvalTestHyperCube : ObjEvalTestHyperCube, IBatchObjectiveEvaluator<TestHyperCube>, IClonableObjectiveEvaluator<TestHyperCube>
+        {
+            // The candidates of each batch, over this evaluator and its clones
+            private readonly List<TestHyperCube[]> batches;
+            private TestObjEval<TestHyperCube> innerObjCalc;
+
+            public BatchObjEvalTestHyperCube(TestObjEval<TestHyperCube> innerObjCalc) : this(innerObjCalc, new List<TestHyperCube[]>())
+            {
+            }
+
+            private BatchObjEvalTestHyperCube(TestObjEval<TestHyperCube> innerObjCalc, List<TestHyperCube[]> batches) : base(innerObjCalc)
+            {
+                this.innerObjCalc = innerObjCalc;
+                this.batches = batches;
+            }
+
+            public List<TestHyperCube[]> Batches
+            {
+                get { lock (batches) return new List<TestHyperCube[]>(batches); }
+            }
+
+            public IObjectiveScores<TestHyperCube>[] EvaluateScores(TestHyperCube[] systemConfigurations)
+            {
+                lock (batches)
+                    batches.Add((TestHyperCube[])systemConfigurations.Clone());
+                return Array.ConvertAll(systemConfigurations, EvaluateScore);
+            }
+
+            public new IClonableObjectiveEvaluator<TestHyperCube> Clone()
+            {
+                return new BatchObjEvalTestHyperCube((TestObjEval<TestHyperCube>)innerObjCalc.Clone(), batches);
+            }
+        }
+
         [Test]
         public void TestCoeffVariationTerminationCriteria()
         {
@@ -135,9 +382,14 @@ namespace CSIRO.Metaheuristics.Tests
         }
 
         private static ShuffledComplexEvolution<TestHyperCube> createSce(ShuffledComplexEvolution<TestHyperCube>.CoefficientOfVariationTerminationCondition termination, BasicRngFactory rng, ObjEvalTestHyperCube evaluator, int maxShuffle = 15)
+        {
+            return createSce(termination, rng, evaluator, null, maxShuffle);
+        }
+
+        private static ShuffledComplexEvolution<TestHyperCube> createSce(ShuffledComplexEvolution<TestHyperCube>.CoefficientOfVariationTerminationCondition termination, BasicRngFactory rng, ObjEvalTestHyperCube evaluator, IClonableObjectiveEvaluator<TestHyperCube> wrapper, int maxShuffle = 15)
         {
             var engine = new ShuffledComplexEvolution<TestHyperCube>(
-                evaluator,
+                (wrapper == null ? evaluator : wrapper),
                 new UniformRandomSamplingFactory<TestHyperCube>(rng.CreateFactory(), new TestHyperCube(2, 0, -10, 10)),
                 termination,
                 5, 20, 10, 3, 20, maxShuffle,
@@ -197,6 +449,41 @@ namespace CSIRO.Metaheuristics.Tests
             }
         }
 
+        /// <summary>
+        /// Counts the evaluations made by all its clones, and cancels the optimiser at a given count
+        /// </summary>
+        private class CancellingEvaluator : IClonableObjectiveEvaluator<TestHyperCube>
+        {
+            public class SharedCounter
+            {
+                public int Count;
+                public int CancelAt;
+                public IEvolutionEngine<TestHyperCube> Engine;
+            }
+
+            public CancellingEvaluator(IClonableObjectiveEvaluator<TestHyperCube> inner, int cancelAt)
+                : this(inner, new SharedCounter { CancelAt = cancelAt }) { }
+            private CancellingEvaluator(IClonableObjectiveEvaluator<TestHyperCube> inner, SharedCounter counter) { this.inner = inner; this.Counter = counter; }
+
+            private readonly IClonableObjectiveEvaluator<TestHyperCube> inner;
+            public readonly SharedCounter Counter;
+
+            public IObjectiveScores<TestHyperCube> EvaluateScore(TestHyperCube systemConfiguration)
+            {
+                if (Interlocked.Increment(ref Counter.Count) == Counter.CancelAt)
+                    Counter.Engine.Cancel();
+                return inner.EvaluateScore(systemConfiguration);
+            }
+
+            public bool SupportsDeepCloning { get { return inner.SupportsDeepCloning; } }
+            public bool SupportsThreadSafeCloning { get { return inner.SupportsThreadSafeCloning; } }
+
+            public IClonableObjectiveEvaluator<TestHyperCube> Clone()
+            {
+                return new CancellingEvaluator(inner.Clone(), Counter);
+            }
+        }
+
         [Test]
         public void TestMargnalImprovementTerminationCriterion()
         {
@@ -229,6 +516,36 @@ namespace CSIRO.Metaheuristics.Tests
             Assert.IsTrue(termination.IsFinished()); // 9, 
         }
 
+        [Test]
+        public void TestMarginalImprovementPopulationUpdates()
+        {
+            var termination = new ShuffledComplexEvolution<ICloneableSystemConfiguration>.MarginalImprovementTerminationCondition(maxHours: 1.0, tolerance: 1e-6, cutoffNoImprovement: 2);
+            var algo = new TestPopulationAlgorithm(new double[] { 1 });
+            termination.SetEvolutionEngine(algo);
+            foreach (var best in new double[] { 3, 2, 2, 2 })
+            {
+                termination.OnPopulationChanged(new[] { new FitnessAssignedScores<double>(null, best) });
+                // Polling does not count populations once they are reported
+                for (int i = 0; i < 10; i++)
+                    Assert.IsFalse(termination.IsFinished());
+            }
+            termination.OnPopulationChanged(new[] { new FitnessAssignedScores<double>(null, 2) });
+            Assert.IsTrue(termination.IsFinished());
+
+            // The shuffled complex evolution reports its populations, at each shuffle
+            var rng = new BasicRngFactory(0);
+            var sceTermination = new ShuffledComplexEvolution<TestHyperCube>.MarginalImprovementTerminationCondition(maxHours: 1.0, tolerance: 1e-6, cutoffNoImprovement: 2);
+            var engine = new ShuffledComplexEvolution<TestHyperCube>(
+                new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2)),
+                new UniformRandomSamplingFactory<TestHyperCube>(rng.CreateFactory(), new TestHyperCube(2, 0, -10, 10)),
+                sceTermination,
+                5, 20, 10, 3, 20, 1000,
+                rng,
+                new DefaultFitnessAssignment());
+            engine.Evolve();
+            Assert.IsTrue(engine.CurrentShuffle < 1000);
+        }
+
         private IObjectiveScores[] createSample(bool converged = false)
         {
             /*
@@ -0,0 +1,248 @@
+﻿using System;
+using System.Globalization;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Text;
+using NUnit.Framework;
+using CSIRO.Utilities;
+
+namespace CSIRO.Metaheuristics.Tests
+{
+    [TestFixture]
+    public class TestNumericColumns
+    {
+        private const double missing = -9999;
+
+        [Test]
+        public void TestParsedValuesMatchDoubleParse()
+        {
+            var rand = new Random(42);
+            var formats = new[] { "R", "G17", "G6", "F3", "E5", "0.###" };
+            var texts = new System.Collections.Generic.List<string>
+            {
+                "0", "-0", "+5", "1e22", "1e23", "0.000001", "1.5E-300", "1.7976931348623157E308", "4.9E-324",
+                "123456789012345678901234", "0.1234567890123456789012", "9007199254740993", "  3.25 ", "007.50"
+            };
+            for (int i = 0; i < 2000; i++)
+            {
+                double x = (rand.NextDouble() - 0.5) * Math.Pow(10, rand.Next(-30, 30));
+                texts.Add(x.ToString(formats[i % formats.Length], CultureInfo.InvariantCulture));
+            }
+            // Two columns, the second one the same numbers in reverse order
+            var csv = new StringBuilder();
+            for (int i = 0; i < texts.Count; i++)
+                csv.Append(texts[i]).Append(',').Append(texts[texts.Count - 1 - i]).Append('\n');
+            var columns = load(csv.ToString(), null, ',');
+
+            Assert.AreEqual(2, columns.Length);
+            Assert.AreEqual(texts.Count, columns[0].Length);
+            for (int i = 0; i < texts.Count; i++)
+            {
+                double expected = double.Parse(texts[i], NumberStyles.Float, CultureInfo.InvariantCulture);
+                Assert.AreEqual(BitConverter.DoubleToInt64Bits(expected), BitConverter.DoubleToInt64Bits(columns[0][i]), texts[i]);
+                Assert.AreEqual(BitConverter.DoubleToInt64Bits(expected), BitConverter.DoubleToInt64Bits(columns[1][texts.Count - 1 - i]), texts[i]);
+            }
+        }
+
+        [Test]
+        public void TestValuesOutOfRange()
+        {
+            var columns = load("1e400,-1E+400,1e-400\n2.5e308,-1797693134862315799999,5\n", null, ',');
+            Assert.AreEqual(new[] { double.PositiveInfinity, double.PositiveInfinity }, columns[0]);
+            Assert.AreEqual(new[] { double.NegativeInfinity, -1.797693134862315799999e21 }, columns[1]);
+            Assert.AreEqual(new[] { 0.0, 5 }, columns[2]);
+        }
+
+        [Test]
+        public void TestMissingValues()
+        {
+            var columns = load("1,NA,3\n,na, \n", null, ',', missingValue: missing);
+            Assert.AreEqual(new[] { 1, missing }, columns[0]);
+            Assert.AreEqual(new[] { missing, missing }, columns[1]);
+            Assert.AreEqual(new[] { 3, missing }, columns[2]);
+
+            columns = load("NA\t2\n", null, '\t');
+            Assert.IsTrue(double.IsNaN(columns[0][0]));
+            Assert.AreEqual(2.0, columns[1][0]);
+        }
+
+        [Test]
+        public void TestLineEndings()
+        {
+            var expected = new[] { new[] { 1.0, 3.0, 5.0 }, new[] { 2.0, 4.0, 6.5 } };
+            Assert.AreEqual(expected, load("1,2\r\n3,4\r\n5,6.5\r\n", null, ','));
+            Assert.AreEqual(expected, load("1,2\r\n3,4\r\n5,6.5", null, ','));
+            Assert.AreEqual(expected, load("1,2\n3,4\n5,6.5", null, ','));
+            // Header lines are skipped, and the data ends at the first empty line
+            Assert.AreEqual(expected, load("a,b\r\nc,d\r\n1,2\r\n3,4\r\n5,6.5\r\n\r\n7,8\r\n", null, ',', startLineIndex: 2));
+            Assert.AreEqual(0, load("", null, ',').Length);
+        }
+
+        [Test]
+        public void TestLinesLongerThanBuffer()
+        {
+            // Lines of more than 100K characters, beyond the 64K buffer of the reader
+            const int numFields = 10000;
+            const int numLines = 5;
+            var csv = new StringBuilder();
+            for (int line = 0; line < numLines; line++)
+            {
+                for (int field = 0; field < numFields; field++)
+                {
+                    if (field > 0)
+                        csv.Append(';');
+                    csv.Append(((line * numFields + field) / 8.0 + 1000).ToString(CultureInfo.InvariantCulture));
+                }
+                csv.Append("\r\n");
+            }
+            Assert.IsTrue(csv.Length / numLines > 1 << 16);
+            var text = csv.ToString();
+
+            var columns = load(text, null, ';');
+            Assert.AreEqual(numFields, columns.Length);
+            for (int field = 0; field < numFields; field++)
+                for (int line = 0; line < numLines; line++)
+                    Assert.AreEqual((line * numFields + field) / 8.0 + 1000, columns[field][line]);
+
+            columns = load(text, new[] { numFields, 1 }, ';');
+            Assert.AreEqual(2, columns.Length);
+            for (int line = 0; line < numLines; line++)
+            {
+                Assert.AreEqual((line * numFields + numFields - 1) / 8.0 + 1000, columns[0][line]);
+                Assert.AreEqual(line * numFields / 8.0 + 1000, columns[1][line]);
+            }
+        }
+
+        [Test]
+        public void TestColumnSelection()
+        {
+            const string csv = "1,2,3,4\n5,6,7,8\n";
+            var columns = load(csv, new[] { 4, 2 }, ',');
+            Assert.AreEqual(2, columns.Length);
+            Assert.AreEqual(new[] { 4.0, 8.0 }, columns[0]);
+            Assert.AreEqual(new[] { 2.0, 6.0 }, columns[1]);
+
+            // Fields that are not loaded are not parsed
+            columns = load("x,2\ny,6\n", new[] { 2 }, ',');
+            Assert.AreEqual(new[] { 2.0, 6.0 }, columns[0]);
+
+            Assert.Throws<ArgumentOutOfRangeException>(() => load(csv, new[] { 0 }, ','));
+            var e = Assert.Throws<ArgumentException>(() => load(csv, new[] { 3, 3 }, ','));
+            Assert.IsTrue(e.Message.StartsWith("Column 3 is requested more than once"), e.Message);
+        }
+
+        [Test]
+        public void TestErrorsGiveLineAndFieldNumbers()
+        {
+            var e = Assert.Throws<FormatException>(() => load("a,b\n1,2\n3,x4\n", null, ',', startLineIndex: 1));
+            Assert.AreEqual("Line 3, field 2: 'x4' is not a number", e.Message);
+
+            e = Assert.Throws<FormatException>(() => load("1,2\n3\n", null, ','));
+            Assert.AreEqual("Line 2 does not have the 2 fields of the first line of data", e.Message);
+
+            e = Assert.Throws<FormatException>(() => load("1,2\n3,4\r\n5,6,7\r\n", null, ','));
+            Assert.AreEqual("Line 3 does not have the 2 fields of the first line of data", e.Message);
+
+            e = Assert.Throws<FormatException>(() => load("h\n1,2\n", new[] { 1, 3 }, ',', startLineIndex: 1));
+            Assert.AreEqual("Line 2 has 2 fields, but column 3 is requested", e.Message);
+
+            Assert.Throws<ArgumentException>(() => NumericColumnsReader.LoadColumns(Path.Combine(Path.GetTempPath(), Path.GetRandomFileName()), ','));
+        }
+
+        [Test]
+        public void TestCacheWriteAndReuse()
+        {
+            var fileName = Path.GetTempFileName();
+            var cacheFileName = fileName + NumericColumnsCache.DefaultExtension;
+            try
+            {
+                File.WriteAllText(fileName, "1,2\n3,NA\n5,6\n");
+                var columns = NumericColumnsCache.LoadColumns(fileName, ',', missingValue: missing);
+                Assert.IsTrue(File.Exists(cacheFileName));
+                Assert.AreEqual(new[] { new[] { 1.0, 3, 5 }, new[] { 2, missing, 6 } }, columns);
+                Assert.AreEqual(columns, NumericColumnsCache.Read(cacheFileName));
+
+                // A current cache is read instead of the delimited file
+                patchFirstValue(cacheFileName, 42);
+                Assert.AreEqual(42.0, NumericColumnsCache.LoadColumns(fileName, ',', missingValue: missing)[0][0]);
+                using (var mapped = NumericColumnsCache.Map(fileName, ',', missingValue: missing))
+                {
+                    Assert.AreEqual(2, mapped.ColumnCount);
+                    Assert.AreEqual(3, mapped.RowCount);
+                    Assert.AreEqual(new[] { 42.0, 3, 5 }, mapped.CopyColumn(0));
+                    var second = new double[3];
+                    Marshal.Copy(mapped.GetColumnPointer(1), second, 0, second.Length);
+                    Assert.AreEqual(new[] { 2, missing, 6 }, second);
+                }
+            }
+            finally
+            {
+                File.Delete(fileName);
+                File.Delete(cacheFileName);
+            }
+        }
+
+        [Test]
+        public void TestCacheInvalidation()
+        {
+            var fileName = Path.GetTempFileName();
+            var cacheFileName = Path.GetTempFileName();
+            Func<char, int, double, double[][]> loadCached = (delimiter, startLineIndex, missingValue) =>
+                NumericColumnsCache.LoadColumns(fileName, delimiter, startLineIndex, missingValue, cacheFileName);
+            try
+            {
+                // A file that is not a cache is replaced
+                File.WriteAllText(cacheFileName, "not a cache");
+                Assert.Throws<InvalidDataException>(() => NumericColumnsCache.Read(cacheFileName));
+                File.WriteAllText(fileName, "1,2\n3,NA\n");
+                Assert.AreEqual(new[] { new[] { 1.0, 3 }, new[] { 2, missing } }, loadCached(',', 0, missing));
+
+                // Different options
+                patchFirstValue(cacheFileName, 42);
+                Assert.AreEqual(42.0, loadCached(',', 0, missing)[0][0]);
+                Assert.IsTrue(double.IsNaN(loadCached(',', 0, double.NaN)[1][1]));
+                patchFirstValue(cacheFileName, 42);
+                Assert.AreEqual(new[] { new[] { 3.0 }, new[] { missing } }, loadCached(',', 1, missing));
+                patchFirstValue(cacheFileName, 42);
+                Assert.AreEqual(new[] { new[] { 1.0, 3 }, new[] { 2, missing } }, loadCached(',', 0, missing));
+                patchFirstValue(cacheFileName, 42);
+                Assert.Throws<FormatException>(() => loadCached('\t', 0, missing));
+
+                // A changed source, of the same length but another last write time
+                patchFirstValue(cacheFileName, 42);
+                var lastWriteTime = File.GetLastWriteTimeUtc(fileName);
+                File.WriteAllText(fileName, "7,2\n3,NA\n");
+                File.SetLastWriteTimeUtc(fileName, lastWriteTime.AddSeconds(-10));
+                Assert.AreEqual(7.0, loadCached(',', 0, missing)[0][0]);
+
+                // A changed source, of a different length
+                File.WriteAllText(fileName, "8,2\n3,NA\n5,6\n");
+                Assert.AreEqual(new[] { new[] { 8.0, 3, 5 }, new[] { 2, missing, 6 } }, loadCached(',', 0, missing));
+            }
+            finally
+            {
+                File.Delete(fileName);
+                File.Delete(cacheFileName);
+            }
+        }
+
+        private static double[][] load(string text, int[] columnNumbers, char delimiter, int startLineIndex = 0, double missingValue = double.NaN)
+        {
+            using (var reader = new StringReader(text))
+                return NumericColumnsReader.LoadColumns(reader, columnNumbers, delimiter, startLineIndex, missingValue);
+        }
+
+        /// <summary>
+        /// Overwrites the first value of a cache file, leaving its header, to tell whether it is read or rewritten
+        /// </summary>
+        private static void patchFirstValue(string cacheFileName, double value)
+        {
+            using (var stream = new FileStream(cacheFileName, FileMode.Open, FileAccess.Write))
+            using (var writer = new BinaryWriter(stream))
+            {
+                stream.Seek(64, SeekOrigin.Begin);
+                writer.Write(value);
+            }
+        }
+    }
+}
@@ -5,6 +5,7 @@ using System.Text;
 using NUnit.Framework;
 using CSIRO.Metaheuristics.Objectives;
 using CSIRO.Metaheuristics.Fitness;
+using CSIRO.Metaheuristics.Utils;
 
 namespace CSIRO.Metaheuristics.Tests
 {
@@ -61,6 +62,322 @@ namespace CSIRO.Metaheuristics.Tests
             Assert.AreEqual( 13.0 / 7, getFitness( fittedScores, d4 ), 1e-12 );
         }
 
+        [Test]
+        public void TestNonDominatedSortingSameAsPairwise()
+        {
+            var rand = new Random(42);
+            foreach (var numObjectives in new[] { 1, 2, 3 })
+            {
+                // Rounded values, so that ties, which preclude strict dominance, are common.
+                var scores = new MockObjectives[60];
+                for (int i = 0; i < scores.Length; i++)
+                    scores[i] = new MockObjectives(Enumerable.Range(0, numObjectives).Select(o => Math.Round(rand.NextDouble() * 10)).ToArray(), maximiseLast: true);
+                scores[7] = new MockObjectives(Enumerable.Repeat(double.NaN, numObjectives).ToArray(), maximiseLast: true);
+
+                var fast = new ParetoRanking<MockObjectives>(scores);
+                var pairwise = new ParetoRanking<MockObjectives>(scores, new DerivedParetoComparer());
+                int rank = 1;
+                for (; rank < scores.Length; rank++)
+                {
+                    var expected = pairwise.GetParetoRank(rank);
+                    CollectionAssert.AreEqual(expected, fast.GetParetoRank(rank));
+                    if (pairwise.GetDominatedByParetoRank(rank).Length == 0)
+                        break;
+                }
+                Assert.AreEqual(0, fast.GetDominatedByParetoRank(rank).Length);
+
+                var fitted = new ZitlerThieleFitnessAssignment().AssignFitness(scores);
+                var expectedFitted = zitlerThieleFitness(scores, pairwise);
+                Assert.AreEqual(expectedFitted.Length, fitted.Length);
+                for (int i = 0; i < fitted.Length; i++)
+                {
+                    Assert.AreSame(expectedFitted[i].Scores, fitted[i].Scores);
+                    Assert.AreEqual(expectedFitted[i].FitnessValue, fitted[i].FitnessValue);
+                }
+            }
+        }
+
+        private class DerivedParetoComparer : ParetoComparer<MockObjectives> { }
+
+        // The fitness assignment as calculated from pairwise comparisons
+        private static FitnessAssignedScores<double>[] zitlerThieleFitness(MockObjectives[] scores, ParetoRanking<MockObjectives> ranking)
+        {
+            var nonDominated = ranking.GetParetoRank(1);
+            var dominated = ranking.GetDominatedByParetoRank(1);
+            var result = new List<FitnessAssignedScores<double>>();
+            var fitnessNonDominated = Array.ConvertAll(nonDominated, x => (double)ranking.GetNumDominated(x, dominated) / scores.Length);
+            for (int j = 0; j < nonDominated.Length; j++)
+                result.Add(new FitnessAssignedScores<double>(nonDominated[j], fitnessNonDominated[j]));
+            foreach (var d in dominated)
+            {
+                double fitness = 1.0;
+                for (int k = 0; k < nonDominated.Length; k++)
+                    if (ranking.IsDominated(d, nonDominated[k]))
+                        fitness += fitnessNonDominated[k];
+                result.Add(new FitnessAssignedScores<double>(d, fitness));
+            }
+            return result.ToArray();
+        }
+
+        private class MockObjectives : IObjectiveScores
+        {
+            private IObjectiveScore[] values;
+            public MockObjectives(double[] values, bool maximiseLast)
+            {
+                this.values = new IObjectiveScore[values.Length];
+                for (int i = 0; i < values.Length; i++)
+                    this.values[i] = new DoubleObjectiveScore("obj" + i, values[i], maximiseLast && i == values.Length - 1);
+            }
+
+            public int ObjectiveCount
+            {
+                get { return values.Length; }
+            }
+
+            public IObjectiveScore GetObjective(int i)
+            {
+                return values[i];
+            }
+
+            public ISystemConfiguration GetSystemConfiguration()
+            {
+                throw new NotImplementedException();
+            }
+        }
+
+        [Test]
+        public void TestPointwiseFitnessAssignment()
+        {
+            var scores = new IObjectiveScores[] { new MockDualObjective(0.5, 2), new MockDualObjective(-1, 0.1), new MockDualObjective(3, 1, true) };
+            foreach (var assignment in new IPointwiseFitnessAssignment<double>[] { new DefaultFitnessAssignment(), new NseOnlyFitnessAssignment(), new NseBiasFitnessAssignment() })
+            {
+                var fitted = assignment.AssignFitness(scores);
+                var buffer = new FitnessAssignedScores<double>[scores.Length + 1];
+                assignment.AssignFitness(scores, buffer);
+                Assert.IsNull(buffer[scores.Length]);
+                for (int i = 0; i < scores.Length; i++)
+                {
+                    var point = assignment.AssignFitness(scores[i]);
+                    Assert.AreSame(scores[i], point.Scores);
+                    Assert.AreEqual(fitted[i].FitnessValue, point.FitnessValue);
+                    Assert.AreSame(scores[i], buffer[i].Scores);
+                    Assert.AreEqual(fitted[i].FitnessValue, buffer[i].FitnessValue);
+                }
+            }
+            Assert.AreEqual(0.5, new DefaultFitnessAssignment().AssignFitness(new MockDualObjective(0.5, 2)).FitnessValue);
+            Assert.AreEqual(-0.5, new NseOnlyFitnessAssignment().AssignFitness(new MockDualObjective(0.5, 2)).FitnessValue);
+        }
+
+        [Test]
+        public void TestEvaluateScoresWithEvaluatorPool()
+        {
+            var evaluator = new CountingEvaluator();
+            var population = Enumerable.Range(0, 50).Select(i => TestHyperCube.CreatePoint(0, -100, 100, i, -i)).ToArray();
+            var options = new System.Threading.Tasks.ParallelOptions() { MaxDegreeOfParallelism = 2 };
+            for (int k = 0; k < 3; k++)
+            {
+                var scores = Evaluations.EvaluateScores(evaluator, population, () => false, options);
+                for (int i = 0; i < population.Length; i++)
+                    Assert.AreEqual(2.0 * i * i, (double)scores[i].GetObjective(0).ValueComparable);
+            }
+            // Clones are kept from one call to the next
+            Assert.IsTrue(evaluator.NumClones <= 2);
+            Assert.AreEqual(evaluator.NumClones, Evaluations.GetPool(evaluator).NumIdle);
+
+            var cancelled = Evaluations.EvaluateScores(evaluator, population, () => true, options);
+            Assert.IsTrue(cancelled.All(x => x == null));
+        }
+
+        [Test]
+        public void TestEvaluatorPoolDisposesClones()
+        {
+            var evaluator = new CountingEvaluator();
+            var pool = new EvaluatorPool<TestHyperCube>(evaluator);
+            var a = pool.Rent();
+            var b = pool.Rent();
+            pool.Return(a);
+            pool.Clear();
+            Assert.AreEqual(1, evaluator.NumDisposed);
+            pool.Dispose();
+            pool.Return(b);
+            Assert.AreEqual(2, evaluator.NumDisposed);
+            Assert.AreEqual(0, pool.NumIdle);
+            Assert.Throws<ObjectDisposedException>(() => pool.Rent());
+
+            // The clones used by an optimiser are disposed of at the end of Evolve, not the evaluator given to it
+            evaluator = new CountingEvaluator();
+            var urs = new CSIRO.Metaheuristics.Optimization.UniformRandomSampling<TestHyperCube>(evaluator,
+                new CSIRO.Metaheuristics.CandidateFactories.UniformRandomSamplingFactory<TestHyperCube>(
+                    new CSIRO.Metaheuristics.RandomNumberGenerators.CounterBasedRngFactory(0), new TestHyperCube(2, 0, -10, 10)), 100);
+            urs.Evolve();
+            Assert.IsTrue(evaluator.NumClones > 0);
+            Assert.AreEqual(evaluator.NumClones, evaluator.NumDisposed);
+            Assert.AreEqual(0, Evaluations.GetPool(evaluator).NumIdle);
+        }
+
+        [Test]
+        public void TestCachingObjectiveEvaluator()
+        {
+            var evaluator = new CountingEvaluator();
+            var cached = new CachingObjectiveEvaluator<TestHyperCube>(evaluator, capacity: 2, relativeTolerance: 1e-6);
+            var p1 = TestHyperCube.CreatePoint(0, -100, 100, 1, 2);
+            var p2 = TestHyperCube.CreatePoint(0, -100, 100, 3, 4);
+            var p3 = TestHyperCube.CreatePoint(0, -100, 100, 5, 6);
+
+            var s1 = cached.EvaluateScore(p1);
+            // Within the quantisation step of p1
+            var nearP1 = TestHyperCube.CreatePoint(0, -100, 100, 1 + 1e-9, 2);
+            var s1b = cached.EvaluateScore(nearP1);
+            Assert.AreEqual(1, evaluator.NumEvaluations);
+            Assert.AreEqual(1, cached.Hits);
+            Assert.AreEqual(1, cached.Misses);
+            Assert.AreEqual(s1.GetObjective(0).ValueComparable, s1b.GetObjective(0).ValueComparable);
+            Assert.AreSame(nearP1, s1b.SystemConfiguration);
+
+            cached.EvaluateScore(p2);
+            // p1 was used more recently than p2, so p2 is the one discarded
+            cached.EvaluateScore(p1);
+            cached.EvaluateScore(p3);
+            Assert.AreEqual(2, cached.Count);
+            Assert.AreEqual(3, evaluator.NumEvaluations);
+            cached.EvaluateScore(p1);
+            Assert.AreEqual(3, evaluator.NumEvaluations);
+            cached.EvaluateScore(p2);
+            Assert.AreEqual(4, evaluator.NumEvaluations);
+
+            // Clones share the cache: the lookup of p2 by the clone is a hit, without evaluating it again
+            var clone = (CachingObjectiveEvaluator<TestHyperCube>)cached.Clone();
+            long hits = cached.Hits;
+            clone.EvaluateScore(p2);
+            Assert.AreEqual(4, evaluator.NumEvaluations);
+            Assert.AreEqual(hits + 1, clone.Hits);
+            Assert.AreEqual(hits + 1, cached.Hits);
+
+            cached.Clear();
+            Assert.AreEqual(0, clone.Count);
+            Assert.AreEqual(0, clone.Hits);
+        }
+
+        [Test]
+        public void TestCachingKeysOfDifferentPoints()
+        {
+            Func<string, double, double, double, IHyperCube<double>> point = (name, min, max, value) =>
+            {
+                var p = new CSIRO.Metaheuristics.SystemConfigurations.BasicHyperCube(new[] { name });
+                p.SetMinMaxValue(name, min, max, value);
+                return p;
+            };
+            Func<IHyperCube<double>, CachingObjectiveEvaluator<IHyperCube<double>>.ParameterKey> key = p =>
+                CachingObjectiveEvaluator<IHyperCube<double>>.CreateKey(p, 1e-6);
+
+            // One quantisation step above the minimum, and a value that cannot be quantised whose bits are 1
+            Assert.AreNotEqual(key(point("a", 0, 1, 1.5e-6)), key(point("a", double.Epsilon, double.Epsilon, double.Epsilon)));
+            // The same values of different variables
+            Assert.AreNotEqual(key(point("a", 0, 1, 0.5)), key(point("b", 0, 1, 0.5)));
+            Assert.AreEqual(key(point("a", 0, 1, 0.5)), key(point("a", 0, 1, 0.5 + 1e-9)));
+            var dense = new CSIRO.Metaheuristics.SystemConfigurations.DenseHyperCube(new[] { "a" });
+            dense.SetMinMaxValue("a", 0, 1, 0.5);
+            Assert.AreEqual(key(point("a", 0, 1, 0.5)), key(dense));
+        }
+
+        [Test]
+        public void TestCompositeOfParallelEnsemble()
+        {
+            // One paraboloid per "catchment", each with its own optimum
+            var systems = Enumerable.Range(0, 5).Select(j => (IClonableObjectiveEvaluator<TestHyperCube>)new ParaboloidObjEval<TestHyperCube>(bestParam: j)).ToArray();
+            var ensemble = new ParallelEnsembleObjectiveEvaluator<TestHyperCube>(systems,
+                new System.Threading.Tasks.ParallelOptions() { MaxDegreeOfParallelism = 3 });
+            var evaluator = new CompositeObjectiveEvaluator<TestHyperCube>(ensemble, new[] { "paraboloid" },
+                values => values[0].Average(), "Mean paraboloid", maximise: false);
+
+            var population = Enumerable.Range(0, 20).Select(i => TestHyperCube.CreatePoint(0, -100, 100, i, -i)).ToArray();
+            Func<TestHyperCube, double> expected = p => systems.Average(s => (double)s.EvaluateScore(p).GetObjective(0).ValueComparable);
+
+            var perSystem = ensemble.EvaluateScore(population[3]);
+            Assert.AreEqual(systems.Length, perSystem.Length);
+            for (int j = 0; j < systems.Length; j++)
+                Assert.AreEqual(systems[j].EvaluateScore(population[3]).GetObjective(0).ValueComparable, perSystem[j].GetObjective(0).ValueComparable);
+
+            var single = evaluator.EvaluateScore(population[3]);
+            Assert.AreEqual("Mean paraboloid", single.GetObjective(0).Name);
+            Assert.AreEqual(expected(population[3]), (double)single.GetObjective(0).ValueComparable, 1e-12);
+
+            // The optimisers hand the whole population to the ensemble, the composite evaluator not being clonable
+            var scores = Evaluations.EvaluateScores(evaluator, population, () => false);
+            for (int i = 0; i < population.Length; i++)
+            {
+                Assert.AreSame(population[i], scores[i].GetSystemConfiguration());
+                Assert.AreEqual(expected(population[i]), (double)scores[i].GetObjective(0).ValueComparable, 1e-12);
+            }
+
+            var twoObjectives = new CompositeObjectiveEvaluator<TestHyperCube>(ensemble, new[] { "a", "b" }, values => 0, "", maximise: false);
+            Assert.Throws<ArgumentException>(() => twoObjectives.EvaluateScore(population[0]));
+        }
+
+        [Test]
+        public void TestDesignEvaluator()
+        {
+            var evaluator = new CountingEvaluator();
+            var template = TestHyperCube.CreatePoint(0, -100, 100, 0, 7, 0);
+            // The second parameter is not in the design, and keeps the value of the template
+            var designEvaluator = new DesignEvaluator<TestHyperCube>(evaluator, template, new[] { "0", "2" });
+            designEvaluator.ChunkSize = 16;
+            designEvaluator.ParallelOptions = new System.Threading.Tasks.ParallelOptions() { MaxDegreeOfParallelism = 2 };
+            Assert.IsNull(designEvaluator.ObjectiveNames);
+
+            int n = 50;
+            var design = new double[n, 2];
+            for (int i = 0; i < n; i++)
+            {
+                design[i, 0] = i;
+                design[i, 1] = -i;
+            }
+            var scores = designEvaluator.Evaluate(design);
+            Assert.AreEqual(n, scores.GetLength(0));
+            Assert.AreEqual(1, scores.GetLength(1));
+            Assert.AreEqual(new[] { "Paraboloid" }, designEvaluator.ObjectiveNames);
+            for (int i = 0; i < n; i++)
+                Assert.AreEqual(2.0 * i * i + 49, scores[i, 0]);
+            Assert.IsTrue(evaluator.NumClones <= 2);
+
+            Assert.Throws<ArgumentException>(() => designEvaluator.Evaluate(new double[3, 3]));
+            Assert.Throws<ArgumentException>(() => new DesignEvaluator<TestHyperCube>(evaluator, template, new[] { "0", "x" }));
+        }
+
+        private class CountingEvaluator : IClonableObjectiveEvaluator<TestHyperCube>, IDisposable
+        {
+            // Counters shared by all the clones
+            private int[] numClones;
+            private int[] numEvaluations;
+            private int[] numDisposed;
+            public CountingEvaluator() : this(new int[1], new int[1], new int[1]) { }
+            private CountingEvaluator(int[] numClones, int[] numEvaluations, int[] numDisposed) { this.numClones = numClones; this.numEvaluations = numEvaluations; this.numDisposed = numDisposed; }
+
+            public int NumClones { get { return numClones[0]; } }
+            public int NumEvaluations { get { return numEvaluations[0]; } }
+            public int NumDisposed { get { return numDisposed[0]; } }
+
+            public void Dispose()
+            {
+                System.Threading.Interlocked.Increment(ref numDisposed[0]);
+            }
+
+            public IObjectiveScores<TestHyperCube> EvaluateScore(TestHyperCube systemConfiguration)
+            {
+                System.Threading.Interlocked.Increment(ref numEvaluations[0]);
+                return MetaheuristicsHelper.CreateSingleObjective(systemConfiguration, TestHyperCube.CalculateParaboloid(systemConfiguration, 0), "Paraboloid");
+            }
+
+            public bool SupportsDeepCloning { get { return true; } }
+            public bool SupportsThreadSafeCloning { get { return true; } }
+
+            public IClonableObjectiveEvaluator<TestHyperCube> Clone()
+            {
+                System.Threading.Interlocked.Increment(ref numClones[0]);
+                return new CountingEvaluator(numClones, numEvaluations, numDisposed);
+            }
+        }
+
         private double getFitness( FitnessAssignedScores<double>[] fittedScores, MockDualObjective objective )
         {
             foreach( var item in fittedScores )
@@ -0,0 +1,77 @@
+﻿using System;
+using System.Linq;
+using NUnit.Framework;
+using CSIRO.Metaheuristics.Optimization;
+
+namespace CSIRO.Metaheuristics.Tests
+{
+    [TestFixture]
+    public class TestRosenbrock
+    {
+        [Test]
+        public void TestDenseBaseOrthonormalize()
+        {
+            var provider = new DenseAlgebraProvider();
+            var b = provider.CreateBase(4);
+            var path = provider.CreateVector(4);
+            path[0] = 1; path[1] = 2; path[3] = -1;
+            Assert.IsFalse(b.GetBaseVector(0).IsOrthogonal(path));
+            b.SetBaseVector(0, path);
+            b.Orthonormalize(0);
+            assertOrthonormal(b);
+            // The direction of the vector orthonormalized against is kept
+            double norm = Math.Sqrt(6);
+            for (int i = 0; i < 4; i++)
+                Assert.AreEqual(path[i] / norm, b[0][i], 1e-12);
+
+            // A base vector linearly dependent on the others is replaced
+            b.SetBaseVector(2, b.GetBaseVector(1));
+            b.Orthonormalize(1);
+            assertOrthonormal(b);
+        }
+
+        private static void assertOrthonormal(IBase b)
+        {
+            int n = b.NumDimensions;
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                {
+                    double dot = Enumerable.Range(0, n).Sum(k => b[i][k] * b[j][k]);
+                    Assert.AreEqual(i == j ? 1.0 : 0.0, dot, 1e-12);
+                }
+        }
+
+        [Test]
+        public void TestSpeculativeParallelMoves()
+        {
+            var sequential = createRosenbrock(false);
+            var expected = sequential.Evolve().ToArray();
+            var speculative = createRosenbrock(true);
+            var actual = speculative.Evolve().ToArray();
+
+            // The same search, with some evaluations wasted
+            Assert.AreEqual(expected.Length, actual.Length);
+            for (int i = 0; i < expected.Length; i++)
+            {
+                Assert.AreEqual((double)expected[i].GetObjective(0).ValueComparable, (double)actual[i].GetObjective(0).ValueComparable);
+                var e = (TestHyperCube)expected[i].GetSystemConfiguration();
+                var a = (TestHyperCube)actual[i].GetSystemConfiguration();
+                foreach (var name in e.GetVariableNames())
+                    Assert.AreEqual(e.GetValue(name), a.GetValue(name));
+            }
+            Assert.AreEqual(0, sequential.DiscardedEvaluations);
+            Assert.IsTrue(speculative.DiscardedEvaluations > 0);
+            var best = actual.Min(x => (double)x.GetObjective(0).ValueComparable);
+            Assert.IsTrue(best < 1e-2);
+        }
+
+        private static RosenbrockOptimizer<TestHyperCube, double> createRosenbrock(bool speculative)
+        {
+            var evaluator = new ObjEvalTestHyperCube(new ParaboloidObjEval<TestHyperCube>(bestParam: 2));
+            var engine = new RosenbrockOptimizer<TestHyperCube, double>(evaluator, new TestHyperCube(5, 7, -10, 10),
+                new RosenbrockOptimizer<TestHyperCube, double>.RosenbrockOptimizerIterationTermination(500));
+            engine.SpeculativeParallelMoves = speculative;
+            return engine;
+        }
+    }
+}
@@ -44,5 +44,78 @@ namespace CSIRO.Metaheuristics.Tests
                 Assert.IsTrue(p.IsWithinBounds);                
             }
         }
+
+        [Test]
+        public void TestRandomStreamsReproducible()
+        {
+            var a = new CounterBasedRngFactory(42);
+            var b = new CounterBasedRngFactory(42);
+            // Streams depend on their index only, not on the order in which they are created
+            var a5 = a.CreateRandom(5).NextDouble();
+            var a2 = a.CreateRandom(2).NextDouble();
+            Assert.AreEqual(a2, b.CreateRandom(2).NextDouble());
+            Assert.AreEqual(a5, b.CreateRandom(5).NextDouble());
+            Assert.AreNotEqual(a2, a5);
+            Assert.AreEqual(a.CreateFactory(3).CreateRandom(0).Next(), b.CreateFactory(3).CreateRandom(0).Next());
+            Assert.AreNotEqual(new CounterBasedRngFactory(43).CreateRandom(2).NextDouble(), a2);
+        }
+
+        [Test]
+        public void TestBatchCandidatesIndependentOfThreads()
+        {
+            int n = 3000;
+            var sequential = createUrs(1).CreateRandomCandidates(n);
+            var parallel = createUrs(-1).CreateRandomCandidates(n);
+            Assert.AreEqual(n, parallel.Length);
+            assertSameValues(sequential, parallel);
+            foreach (var p in parallel)
+                foreach (var v in p.GetVariableNames())
+                    Assert.IsTrue(p.GetValue(v) >= -10 && p.GetValue(v) <= 10);
+            // Successive batches differ
+            var urs = createUrs(-1);
+            Assert.AreNotEqual(urs.CreateRandomCandidates(1)[0].GetValue("0"), urs.CreateRandomCandidates(1)[0].GetValue("0"));
+
+            var lhsSequential = createLhs(1).CreateRandomCandidates(n);
+            var lhs = createLhs(-1).CreateRandomCandidates(n);
+            assertSameValues(lhsSequential, lhs);
+            // Each of the n intervals of each variable holds exactly one point
+            foreach (var v in lhs[0].GetVariableNames())
+            {
+                var intervals = lhs.Select(p => (int)Math.Floor((p.GetValue(v) + 10) / 20 * n)).OrderBy(x => x).ToArray();
+                CollectionAssert.AreEqual(Enumerable.Range(0, n).ToArray(), intervals);
+            }
+        }
+
+        [Test]
+        public void TestLhsBatchCandidatesKeepSeededSequences()
+        {
+            // Factories other than random number streams give the candidates of successive calls to CreateRandomCandidate
+            var template = new TestHyperCube(3, 0, -10, 10);
+            var batch = new LatinHypercubeSampling<TestHyperCube>(new BasicRngFactory(0), template).CreateRandomCandidates(50);
+            var serial = new LatinHypercubeSampling<TestHyperCube>(new BasicRngFactory(0), template);
+            assertSameValues(Enumerable.Range(0, 50).Select(i => serial.CreateRandomCandidate()).ToArray(), batch);
+        }
+
+        private static UniformRandomSamplingFactory<TestHyperCube> createUrs(int maxDegreeOfParallelism)
+        {
+            var urs = new UniformRandomSamplingFactory<TestHyperCube>(new CounterBasedRngFactory(0), new TestHyperCube(3, 0, -10, 10));
+            urs.MaxDegreeOfParallelism = maxDegreeOfParallelism;
+            return urs;
+        }
+
+        private static LatinHypercubeSampling<TestHyperCube> createLhs(int maxDegreeOfParallelism)
+        {
+            var lhs = new LatinHypercubeSampling<TestHyperCube>(new CounterBasedRngFactory(0), new TestHyperCube(3, 0, -10, 10));
+            lhs.MaxDegreeOfParallelism = maxDegreeOfParallelism;
+            return lhs;
+        }
+
+        private static void assertSameValues(TestHyperCube[] expected, TestHyperCube[] actual)
+        {
+            Assert.AreEqual(expected.Length, actual.Length);
+            for (int i = 0; i < expected.Length; i++)
+                foreach (var v in expected[i].GetVariableNames())
+                    Assert.AreEqual(expected[i].GetValue(v), actual[i].GetValue(v));
+        }
     }
 }
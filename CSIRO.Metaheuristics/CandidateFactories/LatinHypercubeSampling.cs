@@ -2,12 +2,14 @@
 using System.Collections.Generic;
 using System.Linq;
 using System.Text;
+using System.Threading.Tasks;
 using CSIRO.Metaheuristics.Optimization;
 using CSIRO.Metaheuristics.SystemConfigurations;
+using CSIRO.Metaheuristics.RandomNumberGenerators;
 
 namespace CSIRO.Metaheuristics.CandidateFactories
 {
-    public class LatinHypercubeSampling<TSysConfig> : ICandidateFactory<TSysConfig>, IHyperCubeOperationsFactory 
+    public class LatinHypercubeSampling<TSysConfig> : IBatchCandidateFactory<TSysConfig>, IHyperCubeOperationsFactory 
         where TSysConfig : IHyperCube<double>, ICloneableSystemConfiguration
     {
         public LatinHypercubeSampling(IRandomNumberGeneratorFactory rng, TSysConfig template, int nDiv=5)
@@ -52,5 +54,79 @@ namespace CSIRO.Metaheuristics.CandidateFactories
         {
             return new HyperCubeOperations(rng.CreateFactory());
         }
+
+        /// <summary>
+        /// Gets or sets the maximum number of threads generating candidates in <see cref="CreateRandomCandidates"/>
+        /// </summary>
+        public int MaxDegreeOfParallelism
+        {
+            get { return parallelOptions.MaxDegreeOfParallelism; }
+            set { parallelOptions.MaxDegreeOfParallelism = value; }
+        }
+        private ParallelOptions parallelOptions = new ParallelOptions();
+
+        /// <summary>
+        /// Creates candidates; if the random number generator factory of this object is an <see cref="IRandomNumberStreamFactory"/>, 
+        /// as a latin hypercube design of n points: the range of each variable is divided into n intervals of equal width, 
+        /// and each interval holds the value of exactly one point.
+        /// </summary>
+        /// <remarks>
+        /// Unlike successive calls to <see cref="CreateRandomCandidate"/>, which sample within nDiv intervals independently, 
+        /// the intervals of the points of the design are random permutations drawn for each variable. 
+        /// The design is generated in parallel from independent random number streams, with the same results whatever the number of threads.
+        /// With other factories the candidates are created one at a time, as by <see cref="CreateRandomCandidate"/>, 
+        /// which preserves the sequences of calibrations seeded with these factories.
+        /// </remarks>
+        public TSysConfig[] CreateRandomCandidates(int n)
+        {
+            if (!(rng is IRandomNumberStreamFactory))
+            {
+                var candidates = new TSysConfig[n];
+                for (int i = 0; i < n; i++)
+                    candidates[i] = CreateRandomCandidate();
+                return candidates;
+            }
+            var varNames = template.GetVariableNames();
+            var streams = CounterBasedRngFactory.AsStreamFactory(rng.CreateFactory());
+            // The permutations use the streams 0 to varNames.Length-1 of the design, and the chunks of points the streams that follow.
+            var permutations = new int[varNames.Length][];
+            Parallel.For(0, varNames.Length, parallelOptions, v =>
+            {
+                permutations[v] = createPermutation(n, streams.CreateRandom(v));
+            });
+            var pointStreams = streams.CreateFactory(varNames.Length);
+            var result = new TSysConfig[n];
+            Sampling.ForEachChunk(n, pointStreams, parallelOptions, (from, to, random) =>
+            {
+                for (int i = from; i < to; i++)
+                {
+                    var point = (TSysConfig)this.template.Clone();
+                    for (int v = 0; v < varNames.Length; v++)
+                    {
+                        // The bounds of the point itself, to cater for cascading parameter constraints.
+                        double pMin = point.GetMinValue(varNames[v]);
+                        double d = (point.GetMaxValue(varNames[v]) - pMin) / n;
+                        point.SetValue(varNames[v], pMin + d * (permutations[v][i] + random.NextDouble()));
+                    }
+                    result[i] = point;
+                }
+            });
+            return result;
+        }
+
+        private static int[] createPermutation(int n, Random random)
+        {
+            var result = new int[n];
+            for (int i = 0; i < n; i++)
+                result[i] = i;
+            for (int i = n - 1; i > 0; i--)
+            {
+                int j = random.Next(i + 1);
+                int tmp = result[i];
+                result[i] = result[j];
+                result[j] = tmp;
+            }
+            return result;
+        }
     }
 }
@@ -0,0 +1,44 @@
+﻿using System;
+using System.Threading.Tasks;
+
+namespace CSIRO.Metaheuristics.CandidateFactories
+{
+    public static class Sampling
+    {
+        /// <summary>
+        /// The number of consecutive candidates of a batch drawn from the same random number stream
+        /// </summary>
+        internal const int ChunkSize = 256;
+
+        /// <summary>
+        /// Creates candidates, in one call if the factory is an <see cref="IBatchCandidateFactory{T}"/>, otherwise one at a time
+        /// </summary>
+        public static T[] CreateRandomCandidates<T>(ICandidateFactory<T> factory, int n) where T : ISystemConfiguration
+        {
+            if (n < 0)
+                throw new ArgumentOutOfRangeException("n", n, "The number of candidates must be positive");
+            var batchFactory = factory as IBatchCandidateFactory<T>;
+            if (batchFactory != null)
+                return batchFactory.CreateRandomCandidates(n);
+            T[] result = new T[n];
+            for (int i = 0; i < result.Length; i++)
+                result[i] = factory.CreateRandomCandidate();
+            return result;
+        }
+
+        /// <summary>
+        /// Processes in parallel the chunks of <see cref="ChunkSize"/> consecutive indices of [0, n), 
+        /// each with the random number generator of the stream of the same index as the chunk.
+        /// </summary>
+        /// <param name="body">The action processing the indices [from, to) of a chunk, with its random number generator</param>
+        internal static void ForEachChunk(int n, IRandomNumberStreamFactory streams, ParallelOptions parallelOptions, Action<int, int, Random> body)
+        {
+            int numChunks = (n + ChunkSize - 1) / ChunkSize;
+            Parallel.For(0, numChunks, parallelOptions, c =>
+            {
+                int from = c * ChunkSize;
+                body(from, Math.Min(n, from + ChunkSize), streams.CreateRandom(c));
+            });
+        }
+    }
+}
@@ -2,12 +2,14 @@
 using System.Collections.Generic;
 using System.Linq;
 using System.Text;
+using System.Threading.Tasks;
 using CSIRO.Metaheuristics.Optimization;
 using CSIRO.Metaheuristics.SystemConfigurations;
+using CSIRO.Metaheuristics.RandomNumberGenerators;
 
 namespace CSIRO.Metaheuristics.CandidateFactories
 {
-    public class UniformRandomSamplingFactory<TSysConfig> : ICandidateFactory<TSysConfig>, IHyperCubeOperationsFactory 
+    public class UniformRandomSamplingFactory<TSysConfig> : IBatchCandidateFactory<TSysConfig>, IHyperCubeOperationsFactory 
         where TSysConfig : IHyperCube<double>, ICloneableSystemConfiguration
     {
         public UniformRandomSamplingFactory( IRandomNumberGeneratorFactory rng, TSysConfig template)
@@ -35,5 +37,41 @@ namespace CSIRO.Metaheuristics.CandidateFactories
         {
             return (TSysConfig) hcOps.GenerateRandom( template );
         }
+
+        /// <summary>
+        /// Gets or sets the maximum number of threads generating candidates in <see cref="CreateRandomCandidates"/>
+        /// </summary>
+        public int MaxDegreeOfParallelism
+        {
+            get { return parallelOptions.MaxDegreeOfParallelism; }
+            set { parallelOptions.MaxDegreeOfParallelism = value; }
+        }
+        private ParallelOptions parallelOptions = new ParallelOptions( );
+
+        /// <summary>
+        /// Creates candidates; in parallel if the random number generator factory of this object is an <see cref="IRandomNumberStreamFactory"/>, 
+        /// with the same results whatever the number of threads.
+        /// </summary>
+        /// <remarks>
+        /// Otherwise the candidates are created one at a time, as by <see cref="CreateRandomCandidate"/>, 
+        /// which preserves the sequences of calibrations seeded with other factories.
+        /// </remarks>
+        public TSysConfig[] CreateRandomCandidates( int n )
+        {
+            var result = new TSysConfig[n];
+            if( !( rng is IRandomNumberStreamFactory ) )
+            {
+                for( int i = 0; i < n; i++ )
+                    result[i] = CreateRandomCandidate( );
+                return result;
+            }
+            var streams = CounterBasedRngFactory.AsStreamFactory( rng.CreateFactory( ) );
+            Sampling.ForEachChunk( n, streams, parallelOptions, ( from, to, random ) =>
+            {
+                for( int i = from; i < to; i++ )
+                    result[i] = (TSysConfig) HyperCubeOperations.GenerateRandom( template, random );
+            } );
+            return result;
+        }
     }
 }
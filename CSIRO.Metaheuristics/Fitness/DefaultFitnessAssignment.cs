@@ -6,7 +6,7 @@ using System.Text;
 namespace CSIRO.Metaheuristics.Fitness
 {
     //this fitness assignment is for a single objective search.
-    public class DefaultFitnessAssignment : IFitnessAssignment<double>
+    public class DefaultFitnessAssignment : IPointwiseFitnessAssignment<double>
     {
         public DefaultFitnessAssignment( )
         {
@@ -15,17 +15,22 @@ namespace CSIRO.Metaheuristics.Fitness
         public FitnessAssignedScores<double>[] AssignFitness( IObjectiveScores[] scores )
         {
             FitnessAssignedScores<double>[] result = new FitnessAssignedScores<double>[scores.Length];
+            AssignFitness( scores, result );
+            return result;
+        }
 
-            for( int i = 0; i < result.Length; i++ )
-            {
-                if( scores[i].GetObjective( 0 ).Maximise )
-                    result[i] = new FitnessAssignedScores<double>( scores[i], ( - (double)scores[i].GetObjective(0).ValueComparable ) );
-                else
-                    result[i] = new FitnessAssignedScores<double>( scores[i], ( (double)scores[i].GetObjective( 0 ).ValueComparable ) );
-
-            }
+        public void AssignFitness( IObjectiveScores[] scores, FitnessAssignedScores<double>[] result )
+        {
+            for( int i = 0; i < scores.Length; i++ )
+                result[i] = AssignFitness( scores[i] );
+        }
 
-            return result;
+        public FitnessAssignedScores<double> AssignFitness( IObjectiveScores scores )
+        {
+            if( scores.GetObjective( 0 ).Maximise )
+                return new FitnessAssignedScores<double>( scores, ( - (double)scores.GetObjective(0).ValueComparable ) );
+            else
+                return new FitnessAssignedScores<double>( scores, ( (double)scores.GetObjective( 0 ).ValueComparable ) );
         }
     }
 }
@@ -5,7 +5,7 @@ using System.Text;
 
 namespace CSIRO.Metaheuristics.Fitness
 {
-    public class NseBiasFitnessAssignment : IFitnessAssignment<double>
+    public class NseBiasFitnessAssignment : IPointwiseFitnessAssignment<double>
     {
         public NseBiasFitnessAssignment( )
         {
@@ -14,15 +14,21 @@ namespace CSIRO.Metaheuristics.Fitness
         public FitnessAssignedScores<double>[] AssignFitness( IObjectiveScores[] scores )
         {
             FitnessAssignedScores<double>[] result = new FitnessAssignedScores<double>[scores.Length];
+            AssignFitness( scores, result );
+            return result;
+        }
 
-            for( int i = 0; i < result.Length; i++ )
-            {
-                double fitness = (double)scores[i].GetObjective( 0 ).ValueComparable
-                    - 5 * Math.Pow( Math.Abs( Math.Log( 1 + (double)scores[i].GetObjective( 1 ).ValueComparable ) ), 2.5 );
-                result[i] = new FitnessAssignedScores<double>( scores[i], ( -fitness ) );
-            }
+        public void AssignFitness( IObjectiveScores[] scores, FitnessAssignedScores<double>[] result )
+        {
+            for( int i = 0; i < scores.Length; i++ )
+                result[i] = AssignFitness( scores[i] );
+        }
 
-            return result;
+        public FitnessAssignedScores<double> AssignFitness( IObjectiveScores scores )
+        {
+            double fitness = (double)scores.GetObjective( 0 ).ValueComparable
+                - 5 * Math.Pow( Math.Abs( Math.Log( 1 + (double)scores.GetObjective( 1 ).ValueComparable ) ), 2.5 );
+            return new FitnessAssignedScores<double>( scores, ( -fitness ) );
         }
     }
 }
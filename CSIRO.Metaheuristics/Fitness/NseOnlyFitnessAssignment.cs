@@ -5,7 +5,7 @@ using System.Text;
 
 namespace CSIRO.Metaheuristics.Fitness
 {
-    public class NseOnlyFitnessAssignment : IFitnessAssignment<double>
+    public class NseOnlyFitnessAssignment : IPointwiseFitnessAssignment<double>
     {
         public NseOnlyFitnessAssignment()
         {
@@ -14,13 +14,19 @@ namespace CSIRO.Metaheuristics.Fitness
         public FitnessAssignedScores<double>[] AssignFitness(IObjectiveScores[] scores)
         {
             FitnessAssignedScores<double>[] result = new FitnessAssignedScores<double>[scores.Length];
+            AssignFitness(scores, result);
+            return result;
+        }
 
-            for (int i = 0; i < result.Length; i++)
-            {
-                result[i] = new FitnessAssignedScores<double>(scores[i], (- (double)scores[i].GetObjective(0).ValueComparable));
-            }
+        public void AssignFitness(IObjectiveScores[] scores, FitnessAssignedScores<double>[] result)
+        {
+            for (int i = 0; i < scores.Length; i++)
+                result[i] = AssignFitness(scores[i]);
+        }
 
-            return result;
+        public FitnessAssignedScores<double> AssignFitness(IObjectiveScores scores)
+        {
+            return new FitnessAssignedScores<double>(scores, (- (double)scores.GetObjective(0).ValueComparable));
         }
     }
 }
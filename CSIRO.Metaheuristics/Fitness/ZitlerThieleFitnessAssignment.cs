@@ -14,6 +14,9 @@ namespace CSIRO.Metaheuristics.Fitness
         }
         public FitnessAssignedScores<double>[] AssignFitness( IObjectiveScores[] scores )
         {
+            var sorting = NonDominatedSorting<IObjectiveScores>.Create( scores, computeDominated: true );
+            if( sorting != null )
+                return assignFitness( scores, sorting );
             var paretoRanking = new ParetoRanking<IObjectiveScores>( scores );
             IObjectiveScores[] nonDominated = paretoRanking.GetParetoRank( 1 );
             IObjectiveScores[] dominated = paretoRanking.GetDominatedByParetoRank( 1 );
@@ -42,5 +45,29 @@ namespace CSIRO.Metaheuristics.Fitness
                 result[i] = new FitnessAssignedScores<double>( orderedScores[i], fitnesses[i] );
             return result;
         }
+
+        // Same fitness as the above, in the same order, reusing the dominance relations computed by the sorting.
+        private static FitnessAssignedScores<double>[] assignFitness( IObjectiveScores[] scores, NonDominatedSorting<IObjectiveScores> sorting )
+        {
+            var result = new FitnessAssignedScores<double>[scores.Length];
+            int[] nonDominated = sorting.GetFront( 1 );
+            var fitnessDominated = new double[scores.Length];
+            for( int i = 0; i < fitnessDominated.Length; i++ )
+                fitnessDominated[i] = 1.0;
+            for( int j = 0; j < nonDominated.Length; j++ )
+            {
+                // A non-dominated point dominates only dominated points
+                int[] dominatedByPoint = sorting.GetDominated( nonDominated[j] );
+                double fitness = (double)dominatedByPoint.Length / scores.Length;
+                result[j] = new FitnessAssignedScores<double>( scores[nonDominated[j]], fitness );
+                foreach( var k in dominatedByPoint )
+                    fitnessDominated[k] += fitness;
+            }
+            int count = nonDominated.Length;
+            for( int f = 2; f <= sorting.NumFronts; f++ )
+                foreach( var k in sorting.GetFront( f ) )
+                    result[count++] = new FitnessAssignedScores<double>( scores[k], fitnessDominated[k] );
+            return result;
+        }
     }
 }
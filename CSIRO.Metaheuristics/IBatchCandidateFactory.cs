@@ -0,0 +1,19 @@
+﻿namespace CSIRO.Metaheuristics
+{
+    /// <summary>
+    /// Interface for candidate factories that can create many candidate system configurations in one call.
+    /// </summary>
+    /// <typeparam name="T">The type of ISystemConfiguration this factory creates</typeparam>
+    /// <remarks>
+    /// This lets implementations generate large designs, e.g. the initial population of an optimiser, over several threads, 
+    /// or as a whole as for a latin hypercube design. Implementations should give the same candidates whatever the number of threads.
+    /// </remarks>
+    public interface IBatchCandidateFactory<out T> : ICandidateFactory<T> where T : ISystemConfiguration
+    {
+        /// <summary>
+        /// Gets randomly generated candidate system configurations
+        /// </summary>
+        /// <param name="n">The number of candidates</param>
+        T[] CreateRandomCandidates(int n);
+    }
+}
@@ -0,0 +1,20 @@
+﻿namespace CSIRO.Metaheuristics
+{
+    /// <summary>
+    /// Interface for ensemble evaluators that can calculate the scores of several candidate system configurations in one call.
+    /// </summary>
+    /// <remarks>
+    /// Implementations can schedule all the (configuration, system) evaluations of a population together, 
+    /// e.g. over a pool of MPI processes, where evaluating one configuration at a time would leave some processes idle.
+    /// </remarks>
+    /// <typeparam name="T">A type implementing ISystemConfiguration</typeparam>
+    public interface IBatchEnsembleObjectiveEvaluator<T> : IEnsembleObjectiveEvaluator<T> where T : ISystemConfiguration
+    {
+        /// <summary>
+        /// Given a set of system configurations, evaluate the scores for each of the systems in this ensemble.
+        /// </summary>
+        /// <param name="systemConfigurations">The system configurations to assess.</param>
+        /// <returns>For each system configuration in the same order, the set of scores, one set for each system in this ensemble.</returns>
+        IObjectiveScores<T>[][] EvaluateScores(T[] systemConfigurations);
+    }
+}
@@ -0,0 +1,20 @@
+﻿namespace CSIRO.Metaheuristics
+{
+    /// <summary>
+    /// Interface for objective evaluators that can calculate the scores of several candidate system configurations in one call.
+    /// </summary>
+    /// <typeparam name="T">A type implementing ISystemConfiguration</typeparam>
+    /// <remarks>
+    /// This lets implementations process candidates together, e.g. as the lanes of a vectorised model or over several threads, 
+    /// where evaluating one candidate at a time would leave resources idle.
+    /// </remarks>
+    public interface IBatchObjectiveEvaluator<T> : IObjectiveEvaluator<T> where T : ISystemConfiguration
+    {
+        /// <summary>
+        /// Evaluate the objective values for a batch of candidate system configurations
+        /// </summary>
+        /// <param name="systemConfigurations">candidate system configurations</param>
+        /// <returns>The objective scores, in the same order as the candidates</returns>
+        IObjectiveScores<T>[] EvaluateScores(T[] systemConfigurations);
+    }
+}
@@ -1,14 +1,16 @@
 using System;
+using CSIRO.Metaheuristics.Optimization;
 
 namespace CSIRO.Metaheuristics
 {
     /// <summary>
     /// An interface for constructs where the optimization problem is given to a solver, and ready to execute.
     /// </summary>
+    /// <remarks>
+    /// Solvers that can report where the time of their execution goes also implement <see cref="IInstrumentedEngine"/>
+    /// </remarks>
     public interface IEvolutionEngine<out T> where T : ISystemConfiguration
     {
-        /// TODO: think of ways to monitor the execution.
-
         /// <summary>
         /// Solve the metaheuristic this object defines.
         /// </summary>
@@ -28,6 +30,18 @@ namespace CSIRO.Metaheuristics
 
     }
 
+    /// <summary>
+    /// A solver timing the phases of its execution, e.g. to tell whether time is spent in the objective evaluator or in the solver itself.
+    /// </summary>
+    public interface IInstrumentedEngine
+    {
+        /// <summary>
+        /// Gets the metrics of this solver. They are disabled until <see cref="EngineMetrics.Enabled"/> is set, 
+        /// and can be read with <see cref="EngineMetrics.GetSnapshot"/> while the solver runs.
+        /// </summary>
+        EngineMetrics Metrics { get; }
+    }
+
     /// <summary>
     /// An interface for population based search algorithms
     /// </summary>
@@ -16,6 +16,32 @@ namespace CSIRO.Metaheuristics
         FitnessAssignedScores<T>[] AssignFitness(IObjectiveScores[] scores);
     }
 
+    /// <summary>
+    /// Interface for fitness assignments where the fitness of a result depends only on its own objective scores, not on the rest of the population.
+    /// </summary>
+    /// <remarks>
+    /// Callers can then keep the fitness already assigned to the points of a population when some of these points are replaced, 
+    /// rather than assigning fitness to the whole population again, and provide the arrays written to, reusing them from one call to the next.
+    /// The fitness records themselves are still created by each call, <see cref="FitnessAssignedScores{T}"/> being a class.
+    /// </remarks>
+    /// <typeparam name="T">The type of fitness used to compare system configuration.</typeparam>
+    public interface IPointwiseFitnessAssignment<T> : IFitnessAssignment<T> where T : IComparable
+    {
+        /// <summary>
+        /// Assign a fitness score to one result.
+        /// </summary>
+        /// <param name="scores"></param>
+        /// <returns></returns>
+        FitnessAssignedScores<T> AssignFitness(IObjectiveScores scores);
+
+        /// <summary>
+        /// Given a population of objective results, assign fitness scores to each result, in an array provided by the caller.
+        /// </summary>
+        /// <param name="scores"></param>
+        /// <param name="result">The array where the fitness of scores[i] is written at index i; at least as long as scores.</param>
+        void AssignFitness(IObjectiveScores[] scores, FitnessAssignedScores<T>[] result);
+    }
+
     /// <summary>
     /// Capture a fitness score derived from a candidate system configuration and its objective scores.
     /// </summary>
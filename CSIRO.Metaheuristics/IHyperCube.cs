@@ -64,4 +64,35 @@ namespace CSIRO.Metaheuristics
         void SetMinMaxValue(string variableName, T min, T max, T value);
     }
 
+    /// <summary>
+    /// Interface for hypercubes whose variables can also be addressed by their ordinal position, 
+    /// i.e. the index of the variable name in <see cref="IHyperCube{T}.GetVariableNames"/>, without a lookup by name.
+    /// </summary>
+    public interface IIndexedHyperCube<T> : IHyperCubeSetBounds<T> where T : IComparable
+    {
+        /// <summary>
+        /// Gets the ordinal position of a variable
+        /// </summary>
+        int IndexOf(string variableName);
+
+        T GetValue(int index);
+        T GetMaxValue(int index);
+        T GetMinValue(int index);
+        void SetValue(int index, T value);
+
+        /// <summary>
+        /// Copies all the values of this hypercube, in ordinal order, to an array
+        /// </summary>
+        /// <param name="destination">The array to write to, of length at least offset + Dimensions</param>
+        /// <param name="offset">The position in the destination of the value of the first variable</param>
+        void CopyValuesTo(T[] destination, int offset);
+
+        /// <summary>
+        /// Sets all the values of this hypercube, in ordinal order, from an array
+        /// </summary>
+        /// <param name="source">The array to read from, of length at least offset + Dimensions</param>
+        /// <param name="offset">The position in the source of the value of the first variable</param>
+        void SetValues(T[] source, int offset);
+    }
+
 }
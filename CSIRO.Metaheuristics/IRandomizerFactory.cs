@@ -1,5 +1,6 @@
 
 using System;
+using System.IO;
 
 namespace CSIRO.Metaheuristics
 {
@@ -29,4 +30,45 @@ namespace CSIRO.Metaheuristics
         /// </summary>
         int Next( );
     }
+
+    /// <summary>
+    /// A random number generator factory that can create the generators and child factories of numbered, independent, streams
+    /// </summary>
+    /// <remarks>
+    /// A stream depends only on this factory and its index, not on the order in which streams are created, 
+    /// so that work split into numbered pieces gives the same results whichever thread, and however many threads, process them.
+    /// </remarks>
+    public interface IRandomNumberStreamFactory : IRandomNumberGeneratorFactory
+    {
+        /// <summary>
+        /// Creates the random number generator of a stream
+        /// </summary>
+        /// <param name="streamIndex">The index of the stream, zero or more</param>
+        Random CreateRandom(long streamIndex);
+
+        /// <summary>
+        /// Creates the factory of a stream, for a piece of work that itself needs several random number generators
+        /// </summary>
+        /// <param name="streamIndex">The index of the stream, zero or more</param>
+        IRandomNumberStreamFactory CreateFactory(long streamIndex);
+    }
+
+    /// <summary>
+    /// A random number generator factory whose state can be saved, and restored to continue the same sequence of random numbers
+    /// </summary>
+    /// <remarks>
+    /// The state saved is that of this factory only, not that of the generators and child factories it already created.
+    /// </remarks>
+    public interface ICheckpointableRandomFactory
+    {
+        /// <summary>
+        /// Writes the state of this factory
+        /// </summary>
+        void WriteState(BinaryWriter writer);
+
+        /// <summary>
+        /// Restores a state written by <see cref="WriteState"/>
+        /// </summary>
+        void ReadState(BinaryReader reader);
+    }
 }
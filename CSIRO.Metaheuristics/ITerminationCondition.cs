@@ -1,3 +1,4 @@
+using System.IO;
 
 namespace CSIRO.Metaheuristics
 {
@@ -20,4 +21,38 @@ namespace CSIRO.Metaheuristics
         /// <returns></returns>
         bool IsFinished();
     }
+
+    /// <summary>
+    /// A termination condition told by its evolution engine of each new population, e.g. at each shuffle of the complexes, 
+    /// so that it updates its statistics once per population rather than each time <see cref="ITerminationCondition{T}.IsFinished"/> is called.
+    /// </summary>
+    /// <remarks>
+    /// Engines may call <see cref="ITerminationCondition{T}.IsFinished"/> very often, e.g. as the cancellation check 
+    /// of each evaluation of an initial population. Conditions updated this way should answer it in constant time.
+    /// </remarks>
+    public interface IIncrementalTerminationCondition
+    {
+        /// <summary>
+        /// Updates the statistics of this termination condition with a new population
+        /// </summary>
+        /// <param name="sortedPopulation">The population, sorted by fitness from the best point</param>
+        void OnPopulationChanged(FitnessAssignedScores<double>[] sortedPopulation);
+    }
+
+    /// <summary>
+    /// A termination condition with a state, such as the elapsed time or a count of iterations without improvement, 
+    /// that can be saved with a checkpoint of an optimisation and restored to resume it.
+    /// </summary>
+    public interface ICheckpointableTerminationCondition
+    {
+        /// <summary>
+        /// Writes the state of this termination condition
+        /// </summary>
+        void WriteState(BinaryWriter writer);
+
+        /// <summary>
+        /// Restores a state written by <see cref="WriteState"/>
+        /// </summary>
+        void ReadState(BinaryReader reader);
+    }
 }
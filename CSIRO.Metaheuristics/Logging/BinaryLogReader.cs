@@ -0,0 +1,300 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Text;
+using CSIRO.Metaheuristics.Objectives;
+using CSIRO.Metaheuristics.SystemConfigurations;
+
+namespace CSIRO.Metaheuristics.Logging
+{
+    /// <summary>
+    /// The content of a log written by a <see cref="BinaryLogger"/>, in the order the records were written.
+    /// </summary>
+    /// <remarks>
+    /// This can be enumerated as log entries, e.g. for <see cref="LoggerMhHelper.ExtractLog"/>; 
+    /// <see cref="ToColumns"/> builds the columns directly from the raw values instead.
+    /// </remarks>
+    public class BinaryLogReader : IEnumerable<ILogInfo>
+    {
+        private class Point
+        {
+            public int[] Names;
+            public double[] Values;
+            public int[] ScoreNames;
+            public bool[] Maximise;
+            public double[] ScoreValues;
+        }
+
+        private class Record
+        {
+            public long Sequence;
+            public int[] Tags;
+            public int MessageId;
+            /// <summary>null for string messages</summary>
+            public Point[] Points;
+        }
+
+        private readonly List<Record> records = new List<Record>();
+        private readonly Dictionary<int, string> strings = new Dictionary<int, string>();
+
+        private BinaryLogReader()
+        {
+        }
+
+        /// <summary>
+        /// Reads a log file written by a <see cref="BinaryLogger"/>
+        /// </summary>
+        public static BinaryLogReader Read(string fileName)
+        {
+            using (var stream = new FileStream(fileName, FileMode.Open, FileAccess.Read, FileShare.ReadWrite))
+                return Read(stream);
+        }
+
+        public static BinaryLogReader Read(Stream stream)
+        {
+            var result = new BinaryLogReader();
+            using (var reader = new BinaryReader(stream, Encoding.UTF8, true))
+            {
+                var magic = reader.ReadBytes(BinaryLogger.Magic.Length);
+                if (!magic.SequenceEqual(BinaryLogger.Magic))
+                    throw new InvalidDataException("This is not a binary log of an optimisation");
+                int version = reader.ReadInt32();
+                if (version != BinaryLogger.FormatVersion)
+                    throw new InvalidDataException("Unsupported binary log format version: " + version);
+                while (true)
+                {
+                    var lengthBytes = reader.ReadBytes(4);
+                    if (lengthBytes.Length == 0)
+                        break;
+                    if (lengthBytes.Length < 4)
+                        throw new InvalidDataException("The binary log is truncated");
+                    int length = BitConverter.ToInt32(lengthBytes, 0);
+                    var chunk = reader.ReadBytes(length);
+                    if (chunk.Length < length)
+                        throw new InvalidDataException("The binary log is truncated");
+                    result.readChunk(chunk);
+                }
+            }
+            result.records.Sort((a, b) => a.Sequence.CompareTo(b.Sequence));
+            return result;
+        }
+
+        private void readChunk(byte[] chunk)
+        {
+            using (var reader = new BinaryReader(new MemoryStream(chunk), Encoding.UTF8))
+            {
+                while (reader.BaseStream.Position < chunk.Length)
+                {
+                    byte kind = reader.ReadByte();
+                    if (kind == BinaryLogger.StringRecord)
+                    {
+                        int id = reader.ReadInt32();
+                        strings[id] = reader.ReadString();
+                        continue;
+                    }
+                    var record = new Record { Sequence = reader.ReadInt64(), Tags = readInts(reader, 2 * reader.ReadInt32()) };
+                    if (kind == BinaryLogger.MessageRecord)
+                        record.MessageId = reader.ReadInt32();
+                    else if (kind == BinaryLogger.ScoresRecord)
+                        record.Points = readPoints(reader);
+                    else
+                        throw new InvalidDataException("Unknown record type in the binary log: " + kind);
+                    records.Add(record);
+                }
+            }
+        }
+
+        private static int[] readInts(BinaryReader reader, int count)
+        {
+            var result = new int[count];
+            for (int i = 0; i < count; i++)
+                result[i] = reader.ReadInt32();
+            return result;
+        }
+
+        private static Point[] readPoints(BinaryReader reader)
+        {
+            var result = new Point[reader.ReadInt32()];
+            for (int i = 0; i < result.Length; i++)
+            {
+                var p = new Point();
+                int n = reader.ReadInt32();
+                p.Names = new int[n];
+                p.Values = new double[n];
+                for (int k = 0; k < n; k++)
+                {
+                    p.Names[k] = reader.ReadInt32();
+                    p.Values[k] = reader.ReadDouble();
+                }
+                n = reader.ReadInt32();
+                p.ScoreNames = new int[n];
+                p.Maximise = new bool[n];
+                p.ScoreValues = new double[n];
+                for (int k = 0; k < n; k++)
+                {
+                    p.ScoreNames[k] = reader.ReadInt32();
+                    p.Maximise[k] = reader.ReadBoolean();
+                    p.ScoreValues[k] = reader.ReadDouble();
+                }
+                result[i] = p;
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the number of records in the log
+        /// </summary>
+        public int Count
+        {
+            get { return records.Count; }
+        }
+
+        private string getString(int id)
+        {
+            if (id == BinaryLogger.NullStringId)
+                return null;
+            string result;
+            if (!strings.TryGetValue(id, out result))
+                throw new InvalidDataException("The binary log has no definition for the string identifier " + id);
+            return result;
+        }
+
+        private Dictionary<string, string> getTags(Record record)
+        {
+            var result = new Dictionary<string, string>();
+            for (int i = 0; i < record.Tags.Length; i += 2)
+                result[getString(record.Tags[i])] = getString(record.Tags[i + 1]);
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the columns of the log, one line per point logged and per string message, without going through string representations of the values.
+        /// </summary>
+        /// <param name="strInfo">The tags, by key. Missing values are null.</param>
+        /// <param name="numericInfo">The parameter and score values, by name. Missing values are NaN.</param>
+        /// <remarks>
+        /// Unlike <see cref="LoggerMhHelper.ToColumns"/>, the numeric columns are all the parameters and scores found in the log, 
+        /// not only those of the first point.
+        /// </remarks>
+        public void ToColumns(out Dictionary<string, string[]> strInfo, out Dictionary<string, double[]> numericInfo)
+        {
+            var numericIds = new List<int>();
+            var numericIndex = new Dictionary<int, int>();
+            var tagIds = new HashSet<int>();
+            int numLines = 0;
+            foreach (var record in records)
+            {
+                for (int i = 0; i < record.Tags.Length; i += 2)
+                    tagIds.Add(record.Tags[i]);
+                if (record.Points == null || record.Points.Length == 0)
+                {
+                    numLines++;
+                    continue;
+                }
+                numLines += record.Points.Length;
+                foreach (var p in record.Points)
+                {
+                    foreach (var id in p.Names.Concat(p.ScoreNames))
+                    {
+                        if (!numericIndex.ContainsKey(id))
+                        {
+                            numericIndex.Add(id, numericIds.Count);
+                            numericIds.Add(id);
+                        }
+                    }
+                }
+            }
+
+            var numeric = new double[numericIds.Count][];
+            numericInfo = new Dictionary<string, double[]>();
+            for (int j = 0; j < numeric.Length; j++)
+            {
+                numeric[j] = new double[numLines];
+                for (int i = 0; i < numLines; i++)
+                    numeric[j][i] = double.NaN;
+                numericInfo.Add(getString(numericIds[j]), numeric[j]);
+            }
+            var stringColumns = new Dictionary<int, string[]>();
+            strInfo = new Dictionary<string, string[]>();
+            foreach (var id in tagIds.OrderBy(x => getString(x), StringComparer.Ordinal))
+            {
+                if (numericIndex.ContainsKey(id))
+                    continue;
+                var column = new string[numLines];
+                stringColumns.Add(id, column);
+                strInfo.Add(getString(id), column);
+            }
+
+            int line = 0;
+            foreach (var record in records)
+            {
+                int numRecordLines = (record.Points == null || record.Points.Length == 0 ? 1 : record.Points.Length);
+                for (int k = 0; k < numRecordLines; k++, line++)
+                {
+                    for (int i = 0; i < record.Tags.Length; i += 2)
+                    {
+                        string[] column;
+                        int j;
+                        if (stringColumns.TryGetValue(record.Tags[i], out column))
+                            column[line] = getString(record.Tags[i + 1]);
+                        else if (numericIndex.TryGetValue(record.Tags[i], out j))
+                        {
+                            double d;
+                            numeric[j][line] = double.TryParse(getString(record.Tags[i + 1]), out d) ? d : double.NaN;
+                        }
+                    }
+                    if (record.Points == null || record.Points.Length == 0)
+                        continue;
+                    var p = record.Points[k];
+                    for (int v = 0; v < p.Names.Length; v++)
+                        numeric[numericIndex[p.Names[v]]][line] = p.Values[v];
+                    for (int v = 0; v < p.ScoreNames.Length; v++)
+                        numeric[numericIndex[p.ScoreNames[v]]][line] = p.ScoreValues[v];
+                }
+            }
+        }
+
+        public IEnumerator<ILogInfo> GetEnumerator()
+        {
+            var schemas = new Dictionary<string, HyperCubeSchema>();
+            foreach (var record in records)
+            {
+                var tags = getTags(record);
+                if (record.Points == null)
+                {
+                    yield return new StringOnlyLogInfo(getString(record.MessageId), tags);
+                    continue;
+                }
+                var scores = new IObjectiveScores[record.Points.Length];
+                for (int i = 0; i < scores.Length; i++)
+                    scores[i] = createScores(record.Points[i], schemas);
+                yield return new SysConfigLogInfo(scores, tags);
+            }
+        }
+
+        System.Collections.IEnumerator System.Collections.IEnumerable.GetEnumerator()
+        {
+            return GetEnumerator();
+        }
+
+        private IObjectiveScores createScores(Point p, Dictionary<string, HyperCubeSchema> schemas)
+        {
+            string key = string.Join(",", p.Names);
+            HyperCubeSchema schema;
+            if (!schemas.TryGetValue(key, out schema))
+            {
+                schema = new HyperCubeSchema(Array.ConvertAll(p.Names, getString));
+                schemas.Add(key, schema);
+            }
+            // The bounds are not logged
+            var hc = new DenseHyperCube(schema);
+            for (int k = 0; k < p.Values.Length; k++)
+                hc.SetMinMaxValue(schema.GetVariableName(k), double.NegativeInfinity, double.PositiveInfinity, p.Values[k]);
+            var objectives = new IObjectiveScore[p.ScoreNames.Length];
+            for (int k = 0; k < objectives.Length; k++)
+                objectives[k] = new DoubleObjectiveScore(getString(p.ScoreNames[k]), p.ScoreValues[k], maximise: p.Maximise[k]);
+            return new MultipleScores<DenseHyperCube>(objectives, hc);
+        }
+    }
+}
@@ -0,0 +1,451 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Threading;
+
+namespace CSIRO.Metaheuristics.Logging
+{
+    /// <summary>
+    /// A logger streaming compact binary records to a file, for long optimisation runs where an <see cref="InMemoryLogger"/> would be too large or too slow.
+    /// </summary>
+    /// <remarks>
+    /// Each thread encodes its records into its own preallocated chunk of memory; full chunks are written to the file by a background thread, 
+    /// and recycled. Tag keys and values and the names of parameters and scores are interned, written once, 
+    /// and records carry the parameter and score values as raw doubles. 
+    /// The file is read back with <see cref="BinaryLogReader"/>. Records carry a sequence number giving their order across threads, 
+    /// as the chunks of different threads are interleaved in the file.
+    /// </remarks>
+    public sealed class BinaryLogger : ILoggerMh, ILoggerMhLevelFilter, IDisposable
+    {
+        internal static readonly byte[] Magic = Encoding.ASCII.GetBytes("MHLOGBIN");
+        internal const int FormatVersion = 1;
+        internal const byte StringRecord = 0;
+        internal const byte MessageRecord = 1;
+        internal const byte ScoresRecord = 2;
+        internal const int NullStringId = -1;
+
+        /// <summary>
+        /// Creates a logger writing to a file
+        /// </summary>
+        /// <param name="fileName">The file to create, or overwrite</param>
+        /// <param name="level">The most detailed level of information recorded</param>
+        /// <param name="chunkSize">The size in bytes beyond which the records of a thread are handed to the background writer</param>
+        /// <param name="maxPendingChunks">The number of full chunks waiting to be written beyond which logging threads wait for the writer</param>
+        public BinaryLogger(string fileName, LoggerMhLevel level = LoggerMhLevel.Detailed, int chunkSize = 1 << 16, int maxPendingChunks = 64)
+            : this(new FileStream(fileName, FileMode.Create, FileAccess.Write, FileShare.Read), level, chunkSize, maxPendingChunks)
+        {
+        }
+
+        /// <summary>
+        /// Creates a logger writing to a stream, which is closed when this logger is disposed of
+        /// </summary>
+        public BinaryLogger(Stream output, LoggerMhLevel level = LoggerMhLevel.Detailed, int chunkSize = 1 << 16, int maxPendingChunks = 64)
+        {
+            if (output == null)
+                throw new ArgumentNullException("output");
+            if (chunkSize < 1024)
+                throw new ArgumentOutOfRangeException("chunkSize", "The chunk size must be at least 1024 bytes");
+            if (maxPendingChunks < 1)
+                throw new ArgumentOutOfRangeException("maxPendingChunks", "There must be at least one pending chunk allowed");
+            this.output = output;
+            this.Level = level;
+            this.chunkSize = chunkSize;
+            pending = new BlockingCollection<Chunk>(maxPendingChunks);
+            buffers = new ThreadLocal<ThreadBuffer>(() => new ThreadBuffer(), trackAllValues: true);
+
+            output.Write(Magic, 0, Magic.Length);
+            var version = BitConverter.GetBytes(FormatVersion);
+            output.Write(version, 0, version.Length);
+
+            writerThread = new Thread(writeChunks) { IsBackground = true, Name = "BinaryLogger writer" };
+            writerThread.Start();
+        }
+
+        private readonly Stream output;
+        private readonly int chunkSize;
+        private readonly BlockingCollection<Chunk> pending;
+        private readonly ConcurrentBag<MemoryStream> free = new ConcurrentBag<MemoryStream>();
+        private readonly ThreadLocal<ThreadBuffer> buffers;
+        private readonly ConcurrentDictionary<string, int> strings = new ConcurrentDictionary<string, int>();
+        private readonly Thread writerThread;
+        private int nextStringId = 0;
+        private long sequence = 0;
+        private volatile bool disposed = false;
+        // Held for reading by the logging calls and for writing by Dispose, so that no record is being added while the logger closes.
+        private readonly ReaderWriterLockSlim disposeLock = new ReaderWriterLockSlim();
+        private volatile Exception writerError = null;
+
+        private class ThreadBuffer
+        {
+            public readonly object SyncRoot = new object();
+            public MemoryStream Stream;
+            public BinaryWriter Writer;
+        }
+
+        private class Chunk
+        {
+            public MemoryStream Stream;
+            /// <summary>Set by the writer once all the chunks before this one are written, if not null</summary>
+            public ManualResetEventSlim Flushed;
+        }
+
+        /// <summary>
+        /// Gets or sets the most detailed level of information recorded
+        /// </summary>
+        public LoggerMhLevel Level { get; set; }
+
+        public bool IsEnabled(LoggerMhLevel level)
+        {
+            return level <= Level;
+        }
+
+        /// <summary>
+        /// Gets the number of records written so far
+        /// </summary>
+        public long RecordCount
+        {
+            get { return Interlocked.Read(ref sequence); }
+        }
+
+        public void Write(IObjectiveScores[] scores, IDictionary<string, string> tags)
+        {
+            writeScores(scores, null, tags);
+        }
+
+        public void Write(FitnessAssignedScores<double> worstPoint, IDictionary<string, string> tags)
+        {
+            writeScores(new[] { worstPoint.Scores }, null, tags);
+        }
+
+        public void Write(IHyperCube<double> newPoint, IDictionary<string, string> tags)
+        {
+            writeScores(null, newPoint, tags);
+        }
+
+        public void Write(string message, IDictionary<string, string> tags)
+        {
+            if (!enterWrite())
+                return;
+            try
+            {
+                var buffer = buffers.Value;
+                lock (buffer.SyncRoot)
+                {
+                    var writer = getWriter(buffer);
+                    int messageId = intern(writer, message);
+                    var tagIds = internTags(writer, tags);
+                    writer.Write(MessageRecord);
+                    writer.Write(Interlocked.Increment(ref sequence));
+                    writeTags(writer, tagIds);
+                    writer.Write(messageId);
+                    release(buffer);
+                }
+            }
+            finally
+            {
+                disposeLock.ExitReadLock();
+            }
+        }
+
+        /// <summary>
+        /// Writes the records logged so far by all the threads to the file
+        /// </summary>
+        public void Flush()
+        {
+            if (!enterWrite())
+                throw new ObjectDisposedException("BinaryLogger");
+            try
+            {
+                flushBuffers();
+                using (var flushed = new ManualResetEventSlim(false))
+                {
+                    pending.Add(new Chunk { Flushed = flushed });
+                    flushed.Wait();
+                }
+            }
+            finally
+            {
+                disposeLock.ExitReadLock();
+            }
+            throwOnWriterError();
+        }
+
+        /// <summary>
+        /// Writes the remaining records and closes the file.
+        /// </summary>
+        /// <remarks>Records logged concurrently with, or after, this call may be dropped.</remarks>
+        public void Dispose()
+        {
+            disposeLock.EnterWriteLock();
+            try
+            {
+                if (disposed)
+                    return;
+                disposed = true;
+            }
+            finally
+            {
+                disposeLock.ExitWriteLock();
+            }
+            flushBuffers();
+            pending.CompleteAdding();
+            writerThread.Join();
+            output.Dispose();
+            buffers.Dispose();
+            pending.Dispose();
+            throwOnWriterError();
+        }
+
+        private void writeScores(IObjectiveScores[] scores, IHyperCube<double> point, IDictionary<string, string> tags)
+        {
+            if (!enterWrite())
+                return;
+            try
+            {
+                writeScores(buffers.Value, scores, point, tags);
+            }
+            finally
+            {
+                disposeLock.ExitReadLock();
+            }
+        }
+
+        private void writeScores(ThreadBuffer buffer, IObjectiveScores[] scores, IHyperCube<double> point, IDictionary<string, string> tags)
+        {
+            lock (buffer.SyncRoot)
+            {
+                var writer = getWriter(buffer);
+                var tagIds = internTags(writer, tags);
+                int numPoints = (scores == null ? 1 : scores.Length);
+                // Names are interned before the record starts, since their definitions are records of their own
+                var names = new int[numPoints][];
+                var scoreNames = new int[numPoints][];
+                for (int i = 0; i < numPoints; i++)
+                {
+                    var hc = (scores == null ? point : scores[i].GetSystemConfiguration() as IHyperCube<double>);
+                    names[i] = internAll(writer, hc == null ? null : hc.GetVariableNames());
+                    if (scores != null)
+                    {
+                        scoreNames[i] = new int[scores[i].ObjectiveCount];
+                        for (int j = 0; j < scoreNames[i].Length; j++)
+                            scoreNames[i][j] = intern(writer, scores[i].GetObjective(j).Name);
+                    }
+                }
+
+                writer.Write(ScoresRecord);
+                writer.Write(Interlocked.Increment(ref sequence));
+                writeTags(writer, tagIds);
+                writer.Write(numPoints);
+                for (int i = 0; i < numPoints; i++)
+                {
+                    var hc = (scores == null ? point : scores[i].GetSystemConfiguration() as IHyperCube<double>);
+                    writeValues(writer, hc, names[i]);
+                    if (scores == null)
+                    {
+                        writer.Write(0);
+                        continue;
+                    }
+                    writer.Write(scoreNames[i].Length);
+                    for (int j = 0; j < scoreNames[i].Length; j++)
+                    {
+                        var score = scores[i].GetObjective(j);
+                        writer.Write(scoreNames[i][j]);
+                        writer.Write(score.Maximise);
+                        writer.Write(ToDouble(score.ValueComparable));
+                    }
+                }
+                release(buffer);
+            }
+        }
+
+        private static void writeValues(BinaryWriter writer, IHyperCube<double> hc, int[] nameIds)
+        {
+            writer.Write(nameIds.Length);
+            if (nameIds.Length == 0)
+                return;
+            var indexed = hc as IIndexedHyperCube<double>;
+            var names = (indexed == null ? hc.GetVariableNames() : null);
+            for (int k = 0; k < nameIds.Length; k++)
+            {
+                writer.Write(nameIds[k]);
+                writer.Write(indexed == null ? hc.GetValue(names[k]) : indexed.GetValue(k));
+            }
+        }
+
+        internal static double ToDouble(IComparable value)
+        {
+            if (value is double)
+                return (double)value;
+            var convertible = value as IConvertible;
+            if (convertible == null)
+                return double.NaN;
+            try
+            {
+                return convertible.ToDouble(CultureInfo.InvariantCulture);
+            }
+            catch (FormatException)
+            {
+                return double.NaN;
+            }
+            catch (InvalidCastException)
+            {
+                return double.NaN;
+            }
+        }
+
+        /// <summary>
+        /// Enters the read lock of the logging calls, unless this logger is disposed of
+        /// </summary>
+        /// <returns>False if the logger is disposed of, in which case the lock is not held</returns>
+        private bool enterWrite()
+        {
+            disposeLock.EnterReadLock();
+            if (!disposed)
+                return true;
+            disposeLock.ExitReadLock();
+            return false;
+        }
+
+        private BinaryWriter getWriter(ThreadBuffer buffer)
+        {
+            if (buffer.Stream == null)
+            {
+                MemoryStream stream;
+                if (!free.TryTake(out stream))
+                    stream = new MemoryStream(chunkSize + chunkSize / 4);
+                buffer.Stream = stream;
+                buffer.Writer = new BinaryWriter(stream, Encoding.UTF8, true);
+            }
+            return buffer.Writer;
+        }
+
+        private void release(ThreadBuffer buffer)
+        {
+            if (buffer.Stream.Length >= chunkSize)
+                handOff(buffer);
+        }
+
+        private void handOff(ThreadBuffer buffer)
+        {
+            if (buffer.Stream == null || buffer.Stream.Length == 0)
+                return;
+            buffer.Writer.Flush();
+            pending.Add(new Chunk { Stream = buffer.Stream });
+            buffer.Writer.Dispose();
+            buffer.Writer = null;
+            buffer.Stream = null;
+        }
+
+        private void flushBuffers()
+        {
+            foreach (var buffer in buffers.Values)
+            {
+                lock (buffer.SyncRoot)
+                    handOff(buffer);
+            }
+        }
+
+        private void writeChunks()
+        {
+            var lengthBytes = new byte[4];
+            foreach (var chunk in pending.GetConsumingEnumerable())
+            {
+                if (chunk.Stream == null)
+                {
+                    try
+                    {
+                        output.Flush();
+                    }
+                    catch (Exception e)
+                    {
+                        writerError = e;
+                    }
+                    chunk.Flushed.Set();
+                    continue;
+                }
+                if (writerError == null)
+                {
+                    try
+                    {
+                        int length = (int)chunk.Stream.Length;
+                        lengthBytes[0] = (byte)length;
+                        lengthBytes[1] = (byte)(length >> 8);
+                        lengthBytes[2] = (byte)(length >> 16);
+                        lengthBytes[3] = (byte)(length >> 24);
+                        output.Write(lengthBytes, 0, 4);
+                        output.Write(chunk.Stream.GetBuffer(), 0, length);
+                    }
+                    catch (Exception e)
+                    {
+                        // Logging threads carry on; the error is reported on Flush or Dispose
+                        writerError = e;
+                    }
+                }
+                chunk.Stream.SetLength(0);
+                free.Add(chunk.Stream);
+            }
+        }
+
+        private void throwOnWriterError()
+        {
+            if (writerError != null)
+                throw new IOException("The binary log could not be written", writerError);
+        }
+
+        /// <summary>
+        /// Gets the identifier of a string, writing its definition to the buffer of the current thread if this is its first use.
+        /// </summary>
+        /// <remarks>
+        /// A definition may be written to the file after a record of another thread using it; readers resolve identifiers once the whole file is read.
+        /// </remarks>
+        private int intern(BinaryWriter writer, string s)
+        {
+            if (s == null)
+                return NullStringId;
+            int id;
+            if (strings.TryGetValue(s, out id))
+                return id;
+            id = Interlocked.Increment(ref nextStringId) - 1;
+            if (!strings.TryAdd(s, id))
+                return strings[s];
+            writer.Write(StringRecord);
+            writer.Write(id);
+            writer.Write(s);
+            return id;
+        }
+
+        private int[] internAll(BinaryWriter writer, string[] values)
+        {
+            if (values == null)
+                return new int[0];
+            var result = new int[values.Length];
+            for (int i = 0; i < values.Length; i++)
+                result[i] = intern(writer, values[i]);
+            return result;
+        }
+
+        private int[] internTags(BinaryWriter writer, IDictionary<string, string> tags)
+        {
+            if (tags == null)
+                return new int[0];
+            var result = new int[tags.Count * 2];
+            int k = 0;
+            foreach (var tag in tags)
+            {
+                result[k++] = intern(writer, tag.Key);
+                result[k++] = intern(writer, tag.Value);
+            }
+            return result;
+        }
+
+        private static void writeTags(BinaryWriter writer, int[] tagIds)
+        {
+            writer.Write(tagIds.Length / 2);
+            for (int i = 0; i < tagIds.Length; i++)
+                writer.Write(tagIds[i]);
+        }
+    }
+}
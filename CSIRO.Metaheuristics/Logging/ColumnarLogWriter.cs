@@ -0,0 +1,284 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+
+namespace CSIRO.Metaheuristics.Logging
+{
+    /// <summary>
+    /// Writes tabular log information as a directory of column files, appended to in chunks of rows,
+    /// so that the table can be read lazily, one column or range of rows at a time, while it is still being written.
+    /// </summary>
+    /// <remarks>
+    /// <para>
+    /// Numeric columns are files of raw little-endian 64 bits floating point values, NaN where missing.
+    /// String columns are stored as factors: files of little-endian 32 bits integer codes, one-based and 0 where missing,
+    /// and a companion UTF-8 text file of the levels, one per line. Columns first seen after some rows were written
+    /// are back-filled with missing values, so all the column files always have the same number of rows.
+    /// </para>
+    /// <para>
+    /// The manifest file lists the columns and the number of rows written; it is replaced after each chunk is written,
+    /// and readers should not read beyond this number of rows. Its first line is the format identifier and version,
+    /// the second the number of rows, then one line per column with the type, file name and column name, separated by tabs.
+    /// Line breaks and tabs in column names and string values are replaced by spaces.
+    /// </para>
+    /// <para>
+    /// This class is not thread safe; see <see cref="ColumnarLogger"/> for a logger writing to it for concurrent optimisers.
+    /// </para>
+    /// </remarks>
+    public sealed class ColumnarLogWriter : IDisposable
+    {
+        public const string ManifestFileName = "columns.txt";
+        internal const string FormatName = "mhcolumns";
+        internal const int FormatVersion = 1;
+        internal const string NumericType = "numeric";
+        internal const string FactorType = "factor";
+        internal const string LevelsExtension = ".levels";
+
+        private static readonly Encoding utf8 = new UTF8Encoding(false);
+
+        /// <summary>
+        /// Creates a writer to a directory, created if need be; existing column files of a previous log in this directory are deleted.
+        /// </summary>
+        /// <param name="directory">The directory of the column files</param>
+        /// <param name="rowsPerChunk">The number of rows buffered in memory before they are appended to the files</param>
+        public ColumnarLogWriter(string directory, int rowsPerChunk = 4096)
+        {
+            if (string.IsNullOrEmpty(directory))
+                throw new ArgumentNullException("directory");
+            if (rowsPerChunk < 1)
+                throw new ArgumentOutOfRangeException("rowsPerChunk", "There must be at least one row per chunk");
+            if (!BitConverter.IsLittleEndian)
+                throw new NotSupportedException("Columnar logs can only be written on little-endian platforms");
+            this.Directory = directory;
+            this.rowsPerChunk = rowsPerChunk;
+            System.IO.Directory.CreateDirectory(directory);
+            deletePreviousLog();
+            writeManifest();
+        }
+
+        private readonly int rowsPerChunk;
+        private readonly List<Column> columns = new List<Column>();
+        private readonly Dictionary<string, Column> columnsByName = new Dictionary<string, Column>();
+        private byte[] bytes = new byte[0];
+        private int bufferedRows = 0;
+        private long flushedRows = 0;
+        private bool disposed = false;
+
+        private class Column
+        {
+            public string Name;
+            public bool IsNumeric;
+            public string FileName;
+            public FileStream Stream;
+            public double[] Numbers;
+            public int[] Codes;
+            public Dictionary<string, int> Levels;
+            public StreamWriter LevelsWriter;
+        }
+
+        /// <summary>
+        /// Gets the directory of the column files
+        /// </summary>
+        public string Directory { get; private set; }
+
+        /// <summary>
+        /// Gets the number of rows completed so far, including those not yet written to the files
+        /// </summary>
+        public long RowCount
+        {
+            get { return flushedRows + bufferedRows; }
+        }
+
+        /// <summary>
+        /// Sets a value of the current row in a numeric column, created if need be
+        /// </summary>
+        public void SetNumber(string column, double value)
+        {
+            var c = getColumn(column, true);
+            if (c.IsNumeric)
+                c.Numbers[bufferedRows] = value;
+            else
+                c.Codes[bufferedRows] = getCode(c, value.ToString("R", CultureInfo.InvariantCulture));
+        }
+
+        /// <summary>
+        /// Sets a value of the current row in a string column, created if need be
+        /// </summary>
+        public void SetString(string column, string value)
+        {
+            var c = getColumn(column, false);
+            if (c.IsNumeric)
+            {
+                double d;
+                c.Numbers[bufferedRows] = double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out d) ? d : double.NaN;
+            }
+            else
+                c.Codes[bufferedRows] = (value == null ? 0 : getCode(c, value));
+        }
+
+        /// <summary>
+        /// Completes the current row; values not set are missing. The rows are written to the files once a chunk is full.
+        /// </summary>
+        public void EndRow()
+        {
+            checkNotDisposed();
+            bufferedRows++;
+            if (bufferedRows == rowsPerChunk)
+                Flush();
+        }
+
+        /// <summary>
+        /// Writes the completed rows to the files and updates the manifest
+        /// </summary>
+        public void Flush()
+        {
+            checkNotDisposed();
+            foreach (var c in columns)
+            {
+                if (c.IsNumeric)
+                {
+                    writeValues(c.Stream, c.Numbers, bufferedRows * sizeof(double));
+                    fill(c.Numbers, double.NaN);
+                }
+                else
+                {
+                    writeValues(c.Stream, c.Codes, bufferedRows * sizeof(int));
+                    Array.Clear(c.Codes, 0, c.Codes.Length);
+                    c.LevelsWriter.Flush();
+                }
+                c.Stream.Flush();
+            }
+            flushedRows += bufferedRows;
+            bufferedRows = 0;
+            writeManifest();
+        }
+
+        public void Dispose()
+        {
+            if (disposed)
+                return;
+            Flush();
+            disposed = true;
+            foreach (var c in columns)
+            {
+                c.Stream.Dispose();
+                if (c.LevelsWriter != null)
+                    c.LevelsWriter.Dispose();
+            }
+        }
+
+        private Column getColumn(string name, bool isNumeric)
+        {
+            checkNotDisposed();
+            Column c;
+            if (columnsByName.TryGetValue(name, out c))
+                return c;
+            c = new Column
+            {
+                Name = name,
+                IsNumeric = isNumeric,
+                FileName = "c" + columns.Count + (isNumeric ? ".f64" : ".i32"),
+            };
+            c.Stream = new FileStream(Path.Combine(Directory, c.FileName), FileMode.Create, FileAccess.Write, FileShare.Read);
+            if (isNumeric)
+            {
+                c.Numbers = new double[rowsPerChunk];
+                fill(c.Numbers, double.NaN);
+                backFill(c.Stream, BitConverter.GetBytes(double.NaN));
+            }
+            else
+            {
+                c.Codes = new int[rowsPerChunk];
+                c.Levels = new Dictionary<string, int>();
+                c.LevelsWriter = new StreamWriter(new FileStream(Path.Combine(Directory, c.FileName + LevelsExtension), FileMode.Create, FileAccess.Write, FileShare.Read), utf8);
+                c.LevelsWriter.NewLine = "\n";
+                backFill(c.Stream, new byte[sizeof(int)]);
+            }
+            columns.Add(c);
+            columnsByName.Add(name, c);
+            return c;
+        }
+
+        private static int getCode(Column c, string value)
+        {
+            value = sanitise(value);
+            int code;
+            if (!c.Levels.TryGetValue(value, out code))
+            {
+                code = c.Levels.Count + 1;
+                c.Levels.Add(value, code);
+                c.LevelsWriter.WriteLine(value);
+            }
+            return code;
+        }
+
+        private void backFill(FileStream stream, byte[] missingValue)
+        {
+            if (flushedRows == 0)
+                return;
+            var block = new byte[missingValue.Length * (int)Math.Min(flushedRows, rowsPerChunk)];
+            for (int i = 0; i < block.Length; i += missingValue.Length)
+                Buffer.BlockCopy(missingValue, 0, block, i, missingValue.Length);
+            long remaining = flushedRows * missingValue.Length;
+            while (remaining > 0)
+            {
+                int n = (int)Math.Min(remaining, block.Length);
+                stream.Write(block, 0, n);
+                remaining -= n;
+            }
+        }
+
+        private void writeValues(FileStream stream, Array values, int numBytes)
+        {
+            if (numBytes == 0)
+                return;
+            if (bytes.Length < numBytes)
+                bytes = new byte[numBytes];
+            Buffer.BlockCopy(values, 0, bytes, 0, numBytes);
+            stream.Write(bytes, 0, numBytes);
+        }
+
+        private static void fill(double[] values, double value)
+        {
+            for (int i = 0; i < values.Length; i++)
+                values[i] = value;
+        }
+
+        private static string sanitise(string s)
+        {
+            return s.Replace("\r\n", " ").Replace('\n', ' ').Replace('\r', ' ').Replace('\t', ' ');
+        }
+
+        private void writeManifest()
+        {
+            var sb = new StringBuilder();
+            sb.Append(FormatName).Append('\t').Append(FormatVersion.ToString(CultureInfo.InvariantCulture)).Append('\n');
+            sb.Append("rows\t").Append(flushedRows.ToString(CultureInfo.InvariantCulture)).Append('\n');
+            foreach (var c in columns)
+                sb.Append(c.IsNumeric ? NumericType : FactorType).Append('\t').Append(c.FileName).Append('\t').Append(sanitise(c.Name)).Append('\n');
+            // Readers polling a log being written always find a complete manifest
+            var manifest = Path.Combine(Directory, ManifestFileName);
+            var temp = manifest + ".tmp";
+            File.WriteAllText(temp, sb.ToString(), utf8);
+            if (File.Exists(manifest))
+                File.Replace(temp, manifest, null);
+            else
+                File.Move(temp, manifest);
+        }
+
+        private void deletePreviousLog()
+        {
+            foreach (var pattern in new[] { ManifestFileName, "c*.f64", "c*.i32", "c*.i32" + LevelsExtension })
+                foreach (var f in System.IO.Directory.GetFiles(Directory, pattern))
+                    File.Delete(f);
+        }
+
+        private void checkNotDisposed()
+        {
+            if (disposed)
+                throw new ObjectDisposedException("ColumnarLogWriter");
+        }
+    }
+}
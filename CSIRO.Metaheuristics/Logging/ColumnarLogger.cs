@@ -0,0 +1,140 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace CSIRO.Metaheuristics.Logging
+{
+    /// <summary>
+    /// A logger writing the log as columns during the optimisation, with the layout of <see cref="LoggerMhHelper.ToColumns"/>:
+    /// one row per point, the parameters and scores in numeric columns and the tags in string columns.
+    /// </summary>
+    /// <remarks>
+    /// The columns are written by a <see cref="ColumnarLogWriter"/>; the R package reads them lazily with loadMhColumnarLog,
+    /// so that large logs are never held in memory as a whole.
+    /// Writes from concurrent threads are serialised; messages without points are rows with only the tags.
+    /// </remarks>
+    public sealed class ColumnarLogger : ILoggerMh, ILoggerMhLevelFilter, IDisposable
+    {
+        /// <summary>
+        /// Creates a logger writing to a directory of column files
+        /// </summary>
+        /// <param name="directory">The directory of the column files, created if need be</param>
+        /// <param name="level">The most detailed level of information recorded</param>
+        /// <param name="rowsPerChunk">The number of rows buffered in memory before they are appended to the files</param>
+        public ColumnarLogger(string directory, LoggerMhLevel level = LoggerMhLevel.Detailed, int rowsPerChunk = 4096)
+        {
+            writer = new ColumnarLogWriter(directory, rowsPerChunk);
+            Level = level;
+        }
+
+        private readonly ColumnarLogWriter writer;
+        private readonly object syncRoot = new object();
+
+        /// <summary>
+        /// Gets or sets the most detailed level of information recorded
+        /// </summary>
+        public LoggerMhLevel Level { get; set; }
+
+        public bool IsEnabled(LoggerMhLevel level)
+        {
+            return level <= Level;
+        }
+
+        /// <summary>
+        /// Gets the directory of the column files
+        /// </summary>
+        public string Directory
+        {
+            get { return writer.Directory; }
+        }
+
+        /// <summary>
+        /// Gets the number of rows logged so far
+        /// </summary>
+        public long RowCount
+        {
+            get { lock (syncRoot) return writer.RowCount; }
+        }
+
+        public void Write(IObjectiveScores[] scores, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+                WriteRows(writer, scores, null, tags);
+        }
+
+        public void Write(FitnessAssignedScores<double> worstPoint, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+                WriteRows(writer, new[] { worstPoint.Scores }, null, tags);
+        }
+
+        public void Write(IHyperCube<double> newPoint, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+                WriteRows(writer, null, newPoint, tags);
+        }
+
+        public void Write(string message, IDictionary<string, string> tags)
+        {
+            lock (syncRoot)
+                WriteRows(writer, new IObjectiveScores[0], null, tags);
+        }
+
+        /// <summary>
+        /// Writes the rows logged so far to the files, so that they can be read while the optimisation carries on
+        /// </summary>
+        public void Flush()
+        {
+            lock (syncRoot)
+                writer.Flush();
+        }
+
+        public void Dispose()
+        {
+            lock (syncRoot)
+                writer.Dispose();
+        }
+
+        /// <summary>
+        /// Writes one row per score, or a row for a point if scores is null, or a row of tags only if there are no scores.
+        /// </summary>
+        internal static void WriteRows(ColumnarLogWriter writer, IObjectiveScores[] scores, IHyperCube<double> point, IDictionary<string, string> tags)
+        {
+            if (scores != null && scores.Length == 0)
+            {
+                writeTags(writer, tags);
+                writer.EndRow();
+                return;
+            }
+            int numRows = (scores == null ? 1 : scores.Length);
+            for (int i = 0; i < numRows; i++)
+            {
+                var hc = (scores == null ? point : scores[i].GetSystemConfiguration() as IHyperCube<double>);
+                if (hc != null)
+                {
+                    var names = hc.GetVariableNames();
+                    var indexed = hc as IIndexedHyperCube<double>;
+                    for (int k = 0; k < names.Length; k++)
+                        writer.SetNumber(names[k], indexed == null ? hc.GetValue(names[k]) : indexed.GetValue(k));
+                }
+                if (scores != null)
+                {
+                    for (int j = 0; j < scores[i].ObjectiveCount; j++)
+                    {
+                        var score = scores[i].GetObjective(j);
+                        writer.SetNumber(score.Name, BinaryLogger.ToDouble(score.ValueComparable));
+                    }
+                }
+                writeTags(writer, tags);
+                writer.EndRow();
+            }
+        }
+
+        private static void writeTags(ColumnarLogWriter writer, IDictionary<string, string> tags)
+        {
+            if (tags == null)
+                return;
+            foreach (var tag in tags)
+                writer.SetString(tag.Key, tag.Value);
+        }
+    }
+}
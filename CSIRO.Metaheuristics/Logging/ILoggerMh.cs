@@ -15,4 +15,28 @@ namespace CSIRO.Metaheuristics.Logging
         void Write(IHyperCube<double> newPoint, IDictionary<string, string> tags);
         void Write(string message, IDictionary<string, string> tags);
     }
+
+    /// <summary>
+    /// The level of detail of the information written to a logger
+    /// </summary>
+    public enum LoggerMhLevel
+    {
+        /// <summary>
+        /// Information written once per generation of an optimiser, e.g. the population at each shuffle of the SCE
+        /// </summary>
+        Summary = 0,
+        /// <summary>
+        /// Information written at each step of the evolution within a generation, e.g. the reflected and contracted points in SCE subcomplexes
+        /// </summary>
+        Detailed = 1
+    }
+
+    /// <summary>
+    /// A logger that may discard information below a level of detail. 
+    /// Optimisers check it beforehand, so that they do not build the tags of messages that would be discarded.
+    /// </summary>
+    public interface ILoggerMhLevelFilter
+    {
+        bool IsEnabled(LoggerMhLevel level);
+    }
 }
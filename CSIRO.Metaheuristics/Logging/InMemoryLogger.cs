@@ -6,10 +6,25 @@ using System.Collections.Concurrent;
 
 namespace CSIRO.Metaheuristics.Logging
 {
-    public class InMemoryLogger : ILoggerMh, IEnumerable<ILogInfo>
+    public class InMemoryLogger : ILoggerMh, ILoggerMhLevelFilter, IEnumerable<ILogInfo>
     {
         ConcurrentQueue<ILogInfo> queue = new ConcurrentQueue<ILogInfo>();
 
+        public InMemoryLogger()
+        {
+            Level = LoggerMhLevel.Detailed;
+        }
+
+        /// <summary>
+        /// Gets or sets the most detailed level of information recorded; by default all.
+        /// </summary>
+        public LoggerMhLevel Level { get; set; }
+
+        public bool IsEnabled(LoggerMhLevel level)
+        {
+            return level <= Level;
+        }
+
         public void Write(IObjectiveScores[] scores, IDictionary<string, string> tags)
         {
             queue.Enqueue(new SysConfigLogInfo(scores, tags));
@@ -27,6 +27,17 @@ namespace CSIRO.Metaheuristics.Logging
                 logger.Write(infoMsg, tags);
         }
 
+        /// <summary>
+        /// Gets whether a logger records information at a level of detail; false if the logger is null.
+        /// </summary>
+        public static bool IsEnabled(ILoggerMh logger, LoggerMhLevel level)
+        {
+            if (logger == null)
+                return false;
+            var filter = logger as ILoggerMhLevelFilter;
+            return (filter == null || filter.IsEnabled(level));
+        }
+
         public  static IDictionary<string, string> MergeDictionaries(params IDictionary<string, string>[] dicts)
         {
             var d = dicts[0].AsEnumerable();
@@ -146,6 +157,25 @@ namespace CSIRO.Metaheuristics.Logging
             }
         }
 
+        /// <summary>
+        /// Writes a log as column files, one entry at a time, e.g. to export a <see cref="BinaryLogReader"/> for the R package
+        /// without building the columns in memory as <see cref="ToColumns"/> does.
+        /// </summary>
+        /// <param name="logger">The log entries</param>
+        /// <param name="directory">The directory of the column files, created if need be</param>
+        /// <returns>The number of rows written</returns>
+        /// <seealso cref="ColumnarLogWriter"/>
+        public static long WriteColumnar(this IEnumerable<ILogInfo> logger, string directory)
+        {
+            using (var writer = new ColumnarLogWriter(directory))
+            {
+                foreach (var item in logger)
+                    ColumnarLogger.WriteRows(writer, item.Scores ?? new IObjectiveScores[0], null, item.Tags);
+                writer.Flush();
+                return writer.RowCount;
+            }
+        }
+
         /// <summary>
         /// Writes to CSV.
         /// With a bit more work, this could become an extension method to dictionary
@@ -0,0 +1,309 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Threading;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// An objective evaluator that remembers the scores of the most recently evaluated parameter sets, 
+    /// and returns them instead of repeating an evaluation at the same, or nearly the same, point.
+    /// </summary>
+    /// <typeparam name="T">A type of hypercube</typeparam>
+    /// <remarks>
+    /// Parameter values are quantised to a tolerance relative to the feasible range of each parameter; 
+    /// two points fall in the same cache entry if they have the same variable names and all their quantised values are equal. 
+    /// The cache is bounded, discarding the least recently used entries first, and is shared by all the clones of this evaluator, 
+    /// so that parallel optimisers benefit from each other's evaluations. 
+    /// Two threads may both evaluate a point not yet cached, if they ask for it at the same time.
+    /// The scores returned for a cached point are those of the first point evaluated, but refer to the system configuration asked for.
+    /// </remarks>
+    public class CachingObjectiveEvaluator<T> : IClonableObjectiveEvaluator<T>
+        where T : IHyperCube<double>
+    {
+        /// <summary>
+        /// Creates a caching evaluator
+        /// </summary>
+        /// <param name="evaluator">The objective evaluator to call on cache misses</param>
+        /// <param name="capacity">The maximum number of parameter sets remembered</param>
+        /// <param name="relativeTolerance">The width of the quantisation steps, as a fraction of the range of each parameter. 
+        /// If zero, only points with exactly the same values share an entry.</param>
+        public CachingObjectiveEvaluator(IClonableObjectiveEvaluator<T> evaluator, int capacity = 10000, double relativeTolerance = 0)
+            : this(evaluator, new ScoresCache(capacity), relativeTolerance)
+        {
+        }
+
+        private CachingObjectiveEvaluator(IClonableObjectiveEvaluator<T> evaluator, ScoresCache cache, double relativeTolerance)
+        {
+            if (evaluator == null)
+                throw new ArgumentNullException("evaluator");
+            if (double.IsNaN(relativeTolerance) || relativeTolerance < 0 || relativeTolerance >= 1)
+                throw new ArgumentOutOfRangeException("relativeTolerance", "The relative tolerance must be in [0, 1)");
+            this.evaluator = evaluator;
+            this.cache = cache;
+            this.relativeTolerance = relativeTolerance;
+        }
+
+        private readonly IClonableObjectiveEvaluator<T> evaluator;
+        private readonly ScoresCache cache;
+        private readonly double relativeTolerance;
+
+        /// <summary>
+        /// Gets the evaluator called on cache misses
+        /// </summary>
+        public IClonableObjectiveEvaluator<T> Evaluator
+        {
+            get { return evaluator; }
+        }
+
+        public int Capacity
+        {
+            get { return cache.Capacity; }
+        }
+
+        /// <summary>
+        /// Gets the number of parameter sets currently remembered
+        /// </summary>
+        public int Count
+        {
+            get { return cache.Count; }
+        }
+
+        /// <summary>
+        /// Gets the number of evaluations answered from the cache, over this evaluator and its clones
+        /// </summary>
+        public long Hits
+        {
+            get { return Interlocked.Read(ref cache.Hits); }
+        }
+
+        /// <summary>
+        /// Gets the number of evaluations delegated to the decorated evaluator, over this evaluator and its clones
+        /// </summary>
+        public long Misses
+        {
+            get { return Interlocked.Read(ref cache.Misses); }
+        }
+
+        /// <summary>
+        /// Forgets all the scores remembered, and resets the hit and miss counters
+        /// </summary>
+        public void Clear()
+        {
+            cache.Clear();
+        }
+
+        public IObjectiveScores<T> EvaluateScore(T systemConfiguration)
+        {
+            var key = CreateKey(systemConfiguration, relativeTolerance);
+            IObjectiveScores<T> cached;
+            if (cache.TryGet(key, out cached))
+            {
+                Interlocked.Increment(ref cache.Hits);
+                var objectives = new IObjectiveScore[cached.ObjectiveCount];
+                for (int i = 0; i < objectives.Length; i++)
+                    objectives[i] = cached.GetObjective(i);
+                return new MultipleScores<T>(objectives, systemConfiguration);
+            }
+            Interlocked.Increment(ref cache.Misses);
+            var result = evaluator.EvaluateScore(systemConfiguration);
+            cache.Add(key, result);
+            return result;
+        }
+
+        /// <summary>
+        /// Clones the decorated evaluator; the clone shares the cache of this evaluator.
+        /// </summary>
+        public IClonableObjectiveEvaluator<T> Clone()
+        {
+            return new CachingObjectiveEvaluator<T>(evaluator.Clone(), cache, relativeTolerance);
+        }
+
+        public bool SupportsDeepCloning
+        {
+            get { return evaluator.SupportsDeepCloning; }
+        }
+
+        public bool SupportsThreadSafeCloning
+        {
+            get { return evaluator.SupportsThreadSafeCloning; }
+        }
+
+        /// <summary>
+        /// Creates the cache key of a point: its variable names, and its values quantised in the order of the names
+        /// </summary>
+        public static ParameterKey CreateKey(T point, double relativeTolerance)
+        {
+            var indexed = point as IIndexedHyperCube<double>;
+            var names = point.GetVariableNames();
+            int n = names.Length;
+            var values = new long[n];
+            var exact = new bool[n];
+            for (int i = 0; i < n; i++)
+            {
+                double value, min, max;
+                if (indexed != null)
+                {
+                    value = indexed.GetValue(i); min = indexed.GetMinValue(i); max = indexed.GetMaxValue(i);
+                }
+                else
+                {
+                    value = point.GetValue(names[i]); min = point.GetMinValue(names[i]); max = point.GetMaxValue(names[i]);
+                }
+                values[i] = quantise(value, min, max, relativeTolerance, out exact[i]);
+            }
+            return new ParameterKey(names, values, exact);
+        }
+
+        /// <summary>
+        /// Gets the number of quantisation steps from the minimum to a value, or the bits of the value itself if it cannot be quantised
+        /// </summary>
+        private static long quantise(double value, double min, double max, double relativeTolerance, out bool exact)
+        {
+            double step = (max - min) * relativeTolerance;
+            if (step > 0 && !double.IsInfinity(step) && !double.IsNaN(value) && !double.IsInfinity(value))
+            {
+                double steps = Math.Floor((value - min) / step);
+                if (Math.Abs(steps) < long.MaxValue / 2)
+                {
+                    exact = false;
+                    return (long)steps;
+                }
+            }
+            // Exact match; +0.0 and -0.0 are the same parameter value
+            exact = true;
+            return (value == 0 ? 0L : BitConverter.DoubleToInt64Bits(value));
+        }
+
+        /// <summary>
+        /// The key to the scores of a point in the cache
+        /// </summary>
+        /// <remarks>
+        /// Keys are equal if they have the same variable names in the same order, and the same values of the same kind:
+        /// a number of quantisation steps never equals the bits of a value that could not be quantised.
+        /// </remarks>
+        public sealed class ParameterKey : IEquatable<ParameterKey>
+        {
+            private readonly string[] names;
+            private readonly long[] values;
+            private readonly bool[] exact;
+            private readonly int hashCode;
+
+            public ParameterKey(string[] names, long[] values, bool[] exact)
+            {
+                if (names.Length != values.Length || exact.Length != values.Length)
+                    throw new ArgumentException("There must be one value and one kind of value per variable name");
+                this.names = names;
+                this.values = values;
+                this.exact = exact;
+                unchecked
+                {
+                    int h = 17;
+                    for (int i = 0; i < values.Length; i++)
+                    {
+                        h = h * 31 + names[i].GetHashCode();
+                        h = h * 31 + values[i].GetHashCode();
+                        h = h * 2 + (exact[i] ? 1 : 0);
+                    }
+                    hashCode = h;
+                }
+            }
+
+            public bool Equals(ParameterKey other)
+            {
+                if (other == null || other.hashCode != hashCode || other.values.Length != values.Length)
+                    return false;
+                for (int i = 0; i < values.Length; i++)
+                    if (values[i] != other.values[i] || exact[i] != other.exact[i] || !string.Equals(names[i], other.names[i]))
+                        return false;
+                return true;
+            }
+
+            public override bool Equals(object obj)
+            {
+                return Equals(obj as ParameterKey);
+            }
+
+            public override int GetHashCode()
+            {
+                return hashCode;
+            }
+        }
+
+        /// <summary>
+        /// A least recently used cache of scores, safe for concurrent use.
+        /// </summary>
+        private class ScoresCache
+        {
+            public ScoresCache(int capacity)
+            {
+                if (capacity < 1)
+                    throw new ArgumentOutOfRangeException("capacity", "The cache capacity must be strictly positive");
+                this.Capacity = capacity;
+            }
+
+            public readonly int Capacity;
+            public long Hits;
+            public long Misses;
+
+            private readonly object syncRoot = new object();
+            private readonly Dictionary<ParameterKey, LinkedListNode<KeyValuePair<ParameterKey, IObjectiveScores<T>>>> entries = new Dictionary<ParameterKey, LinkedListNode<KeyValuePair<ParameterKey, IObjectiveScores<T>>>>();
+            // Most recently used first
+            private readonly LinkedList<KeyValuePair<ParameterKey, IObjectiveScores<T>>> usage = new LinkedList<KeyValuePair<ParameterKey, IObjectiveScores<T>>>();
+
+            public int Count
+            {
+                get { lock (syncRoot) return entries.Count; }
+            }
+
+            public bool TryGet(ParameterKey key, out IObjectiveScores<T> scores)
+            {
+                lock (syncRoot)
+                {
+                    LinkedListNode<KeyValuePair<ParameterKey, IObjectiveScores<T>>> node;
+                    if (!entries.TryGetValue(key, out node))
+                    {
+                        scores = null;
+                        return false;
+                    }
+                    usage.Remove(node);
+                    usage.AddFirst(node);
+                    scores = node.Value.Value;
+                    return true;
+                }
+            }
+
+            public void Add(ParameterKey key, IObjectiveScores<T> scores)
+            {
+                lock (syncRoot)
+                {
+                    LinkedListNode<KeyValuePair<ParameterKey, IObjectiveScores<T>>> node;
+                    if (entries.TryGetValue(key, out node))
+                    {
+                        // Evaluated concurrently by another thread; keep the first scores
+                        usage.Remove(node);
+                        usage.AddFirst(node);
+                        return;
+                    }
+                    if (entries.Count >= Capacity)
+                    {
+                        var last = usage.Last;
+                        usage.RemoveLast();
+                        entries.Remove(last.Value.Key);
+                    }
+                    entries.Add(key, usage.AddFirst(new KeyValuePair<ParameterKey, IObjectiveScores<T>>(key, scores)));
+                }
+            }
+
+            public void Clear()
+            {
+                lock (syncRoot)
+                {
+                    entries.Clear();
+                    usage.Clear();
+                    Interlocked.Exchange(ref Hits, 0);
+                    Interlocked.Exchange(ref Misses, 0);
+                }
+            }
+        }
+    }
+}
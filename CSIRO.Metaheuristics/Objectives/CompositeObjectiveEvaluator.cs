@@ -0,0 +1,126 @@
+﻿using System;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// An objective evaluator calculating a single composite score, with a compiled function,
+    /// from the scores of all the systems of an ensemble, e.g. an aggregate of the NSE of each catchment.
+    /// </summary>
+    /// <typeparam name="T">A type implementing ISystemConfiguration</typeparam>
+    /// <remarks>
+    /// This is the in-process counterpart of the MPI objective evaluator with a composite objective calculation of CSIRO.Metaheuristics.Parallel.
+    /// The composite function is given the values of the scores by variable, in the order of the variable names,
+    /// then by system: values[k][j] is the k-th objective of the j-th system. As for these calculations,
+    /// a maximisable composite that is not a number is replaced by -999.
+    /// </remarks>
+    public class CompositeObjectiveEvaluator<T> : IClonableObjectiveEvaluator<T>, IBatchObjectiveEvaluator<T> where T : ISystemConfiguration
+    {
+        /// <summary>
+        /// Creates a composite objective evaluator
+        /// </summary>
+        /// <param name="systemsEvaluator">The evaluator of the scores of the systems of the ensemble, e.g. a <see cref="ParallelEnsembleObjectiveEvaluator{T}"/></param>
+        /// <param name="variableNames">The names of the objectives of each system, in the order of their scores</param>
+        /// <param name="composite">The function calculating the composite score from the values of the objectives of all the systems</param>
+        /// <param name="objectiveName">The name of the composite score</param>
+        /// <param name="maximise">Whether the composite score is to be maximised</param>
+        public CompositeObjectiveEvaluator(IEnsembleObjectiveEvaluator<T> systemsEvaluator, string[] variableNames,
+            Func<double[][], double> composite, string objectiveName, bool maximise)
+        {
+            if (systemsEvaluator == null)
+                throw new ArgumentNullException("systemsEvaluator");
+            if (variableNames == null || variableNames.Length == 0)
+                throw new ArgumentException("There must be at least one variable name", "variableNames");
+            if (composite == null)
+                throw new ArgumentNullException("composite");
+            this.systemsEvaluator = systemsEvaluator;
+            this.variableNames = (string[])variableNames.Clone();
+            this.composite = composite;
+            this.objectiveName = objectiveName;
+            this.maximise = maximise;
+        }
+
+        /// <summary>
+        /// Creates a composite objective evaluator with the names and the sense of the composite of an objective definition,
+        /// calculated with a compiled function equivalent to its compounding function instead of an R expression
+        /// </summary>
+        public CompositeObjectiveEvaluator(IEnsembleObjectiveEvaluator<T> systemsEvaluator, RexpObjectiveDefinition objectiveDefinition,
+            Func<double[][], double> composite)
+            : this(systemsEvaluator, objectiveDefinition.VariableNames, composite,
+                objectiveDefinition.CompoundingFunctionName, objectiveDefinition.CompoundingFunctionIsMaximizable)
+        {
+        }
+
+        private readonly IEnsembleObjectiveEvaluator<T> systemsEvaluator;
+        private readonly string[] variableNames;
+        private readonly Func<double[][], double> composite;
+        private readonly string objectiveName;
+        private readonly bool maximise;
+
+        /// <summary>
+        /// Gets the evaluator of the scores of the systems of the ensemble
+        /// </summary>
+        public IEnsembleObjectiveEvaluator<T> SystemsEvaluator
+        {
+            get { return systemsEvaluator; }
+        }
+
+        public IObjectiveScores<T> EvaluateScore(T systemConfiguration)
+        {
+            return CalculateCompositeObjective(systemsEvaluator.EvaluateScore(systemConfiguration), systemConfiguration);
+        }
+
+        public IObjectiveScores<T>[] EvaluateScores(T[] systemConfigurations)
+        {
+            var batchEvaluator = systemsEvaluator as IBatchEnsembleObjectiveEvaluator<T>;
+            IObjectiveScores<T>[][] allScores;
+            if (batchEvaluator != null)
+                allScores = batchEvaluator.EvaluateScores(systemConfigurations);
+            else
+                allScores = Array.ConvertAll(systemConfigurations, systemsEvaluator.EvaluateScore);
+            var result = new IObjectiveScores<T>[systemConfigurations.Length];
+            for (int i = 0; i < result.Length; i++)
+                result[i] = CalculateCompositeObjective(allScores[i], systemConfigurations[i]);
+            return result;
+        }
+
+        /// <summary>
+        /// Calculates the composite score of a system configuration from the scores of each system of the ensemble
+        /// </summary>
+        public IObjectiveScores<T> CalculateCompositeObjective(IObjectiveScores[] allScores, T sysConfig)
+        {
+            if (!Array.TrueForAll(allScores, x => x.ObjectiveCount == variableNames.Length))
+                throw new ArgumentException("Inconsistent length between at least one score set, and the number of variable names specified");
+
+            var values = new double[variableNames.Length][];
+            for (int k = 0; k < values.Length; k++)
+            {
+                var v = new double[allScores.Length];
+                for (int j = 0; j < v.Length; j++)
+                    v[j] = Convert.ToDouble(allScores[j].GetObjective(k).ValueComparable);
+                values[k] = v;
+            }
+            double score = composite(values);
+            if (double.IsNaN(score) && maximise)
+                score = -999;
+            return new MultipleScores<T>(new IObjectiveScore[] { new DoubleObjectiveScore(objectiveName, score, maximise: maximise) }, sysConfig);
+        }
+
+        public bool SupportsDeepCloning
+        {
+            get { return false; }
+        }
+
+        /// <summary>
+        /// Gets false: the systems of the ensemble are already evaluated in parallel, by the systems evaluator.
+        /// </summary>
+        public bool SupportsThreadSafeCloning
+        {
+            get { return false; }
+        }
+
+        public IClonableObjectiveEvaluator<T> Clone()
+        {
+            throw new NotSupportedException();
+        }
+    }
+}
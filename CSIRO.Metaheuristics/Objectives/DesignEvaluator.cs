@@ -0,0 +1,137 @@
+﻿using System;
+using System.Threading.Tasks;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// Evaluates the scores of all the points of an experimental design, e.g. the sample of a Sobol sensitivity analysis,
+    /// given as a matrix of parameter values, and returns them as a matrix.
+    /// </summary>
+    /// <typeparam name="T">A type of hypercube</typeparam>
+    /// <remarks>
+    /// The points are created from a template and evaluated in chunks, with <see cref="Evaluations.EvaluateScores{T}(IClonableObjectiveEvaluator{T}, T[], Func{bool}, ParallelOptions, Optimization.EngineMetrics)"/>:
+    /// in parallel with clones of the evaluator if it supports thread safe cloning, or in one call if it evaluates batches.
+    /// Only one chunk of points and scores is held in memory at a time, whatever the size of the design.
+    /// </remarks>
+    public class DesignEvaluator<T> where T : IHyperCube<double>
+    {
+        /// <summary>
+        /// The default number of points created and evaluated at once
+        /// </summary>
+        public const int DefaultChunkSize = 10000;
+
+        /// <summary>
+        /// Creates a design evaluator
+        /// </summary>
+        /// <param name="evaluator">The objective evaluator</param>
+        /// <param name="template">The template of the points, whose values of the parameters not in the design are left unchanged</param>
+        /// <param name="variableNames">The names of the parameters, in the order of the columns of the designs; if null, the variables of the template</param>
+        public DesignEvaluator(IClonableObjectiveEvaluator<T> evaluator, T template, string[] variableNames = null)
+        {
+            if (evaluator == null)
+                throw new ArgumentNullException("evaluator");
+            if (template == null)
+                throw new ArgumentNullException("template");
+            this.evaluator = evaluator;
+            this.template = template;
+            this.variableNames = (variableNames == null ? template.GetVariableNames() : (string[])variableNames.Clone());
+            var known = template.GetVariableNames();
+            foreach (var name in this.variableNames)
+                if (Array.IndexOf(known, name) < 0)
+                    throw new ArgumentException("Incorrect variable name: " + name, "variableNames");
+            ChunkSize = DefaultChunkSize;
+        }
+
+        private readonly IClonableObjectiveEvaluator<T> evaluator;
+        private readonly T template;
+        private readonly string[] variableNames;
+        private string[] objectiveNames = null;
+        private int chunkSize;
+
+        /// <summary>
+        /// Gets the names of the parameters, in the order of the columns of the designs
+        /// </summary>
+        public string[] VariableNames
+        {
+            get { return (string[])variableNames.Clone(); }
+        }
+
+        /// <summary>
+        /// Gets the names of the objectives, in the order of the columns of the scores; null before the first evaluation
+        /// </summary>
+        public string[] ObjectiveNames
+        {
+            get { return (objectiveNames == null ? null : (string[])objectiveNames.Clone()); }
+        }
+
+        /// <summary>
+        /// Gets or sets the number of points created and evaluated at once
+        /// </summary>
+        public int ChunkSize
+        {
+            get { return chunkSize; }
+            set
+            {
+                if (value < 1)
+                    throw new ArgumentOutOfRangeException("value", value, "There must be at least one point per chunk");
+                chunkSize = value;
+            }
+        }
+
+        /// <summary>
+        /// Gets or sets the options of the parallel evaluations; may be null for the default options
+        /// </summary>
+        public ParallelOptions ParallelOptions { get; set; }
+
+        /// <summary>
+        /// Evaluates the scores of the points of a design
+        /// </summary>
+        /// <param name="design">The values of the parameters, one row per point and one column per variable name</param>
+        /// <returns>The values of the objectives, one row per point and one column per objective name</returns>
+        public double[,] Evaluate(double[,] design)
+        {
+            int runCount = design.GetLength(0);
+            if (design.GetLength(1) != variableNames.Length)
+                throw new ArgumentException(string.Format("The design has {0} columns but there are {1} variables", design.GetLength(1), variableNames.Length), "design");
+            double[,] result = null;
+            for (int from = 0; from < runCount; from += chunkSize)
+            {
+                int n = Math.Min(chunkSize, runCount - from);
+                var points = new T[n];
+                for (int i = 0; i < n; i++)
+                    points[i] = createPoint(design, from + i);
+                var scores = Evaluations.EvaluateScores(evaluator, points, () => false, ParallelOptions);
+                if (result == null)
+                {
+                    objectiveNames = getObjectiveNames(scores[0]);
+                    result = new double[runCount, objectiveNames.Length];
+                }
+                for (int i = 0; i < n; i++)
+                {
+                    var s = scores[i];
+                    if (s.ObjectiveCount != objectiveNames.Length)
+                        throw new InvalidOperationException(string.Format("Point {0} has {1} objectives instead of {2}", from + i, s.ObjectiveCount, objectiveNames.Length));
+                    for (int k = 0; k < objectiveNames.Length; k++)
+                        result[from + i, k] = Convert.ToDouble(s.GetObjective(k).ValueComparable);
+                }
+            }
+            return result ?? new double[0, (objectiveNames == null ? 0 : objectiveNames.Length)];
+        }
+
+        private T createPoint(double[,] design, int row)
+        {
+            var point = (T)template.Clone();
+            for (int j = 0; j < variableNames.Length; j++)
+                point.SetValue(variableNames[j], design[row, j]);
+            return point;
+        }
+
+        private static string[] getObjectiveNames(IObjectiveScores scores)
+        {
+            var names = new string[scores.ObjectiveCount];
+            for (int k = 0; k < names.Length; k++)
+                names[k] = scores.GetObjective(k).Name;
+            return names;
+        }
+    }
+}
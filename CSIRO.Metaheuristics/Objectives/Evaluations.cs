@@ -3,53 +3,37 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Text;
 using System.Threading.Tasks;
+using System.Collections.Concurrent;
+using System.Runtime.CompilerServices;
 using CSIRO.Metaheuristics.Utils;
+using CSIRO.Metaheuristics.Optimization;
 
 namespace CSIRO.Metaheuristics.Objectives
 {
     public static class Evaluations
     {
-        public static IObjectiveScores[] EvaluateScores<T>(IClonableObjectiveEvaluator<T> evaluator, T[] population, Func<bool> isCancelled, ParallelOptions parallelOptions = null) where T : ISystemConfiguration
+        /// <summary>
+        /// Evaluates the scores of a population, in parallel if the evaluator supports thread safe cloning
+        /// </summary>
+        /// <param name="metrics">The metrics of the calling optimiser, to record the evaluations; may be null</param>
+        public static IObjectiveScores[] EvaluateScores<T>(IClonableObjectiveEvaluator<T> evaluator, T[] population, Func<bool> isCancelled, ParallelOptions parallelOptions = null, EngineMetrics metrics = null) where T : ISystemConfiguration
         {
             if (population.Length == 0)
                 return new IObjectiveScores[0];
-            if(parallelOptions == null)
-                parallelOptions = new ParallelOptions() { MaxDegreeOfParallelism = -1 };
-
-            var procCount = System.Environment.ProcessorCount;
 
             IObjectiveScores[] result;
             if (evaluator.SupportsThreadSafeCloning) {
-                // There is presumably no point cloning 
-                // the system more times than the max level of parallelism
-                int nParallel=procCount;
-                if (parallelOptions.MaxDegreeOfParallelism > 0)
-                    nParallel = Math.Min(nParallel, parallelOptions.MaxDegreeOfParallelism);
-                T[][] subPop = MetaheuristicsHelper.MakeBins(population, nParallel);
-                var taskPkgs = new List<Tuple<T[],IClonableObjectiveEvaluator<T>>>();
-                taskPkgs.Add(Tuple.Create(subPop[0], evaluator));
-                for (int i = 1; i < subPop.Length; i++)
-                    taskPkgs.Add(Tuple.Create(subPop[i], evaluator.Clone()));
-                // Need to use Parallel.ForEach rather than Parallel.For to work around a Parallel.For 
-                // oddity in Mono 3.12.1. Need an identity to iterate over...
-                var ramp = new int[subPop.Length];
-                // Map of index of subpopulations to indices in the variable result:
-                //var offsets = new int[subPop.Length];
-                var resultBins = new IObjectiveScores[ramp.Length][];
-                for (int i = 1; i < ramp.Length; i++)
-                    ramp[i] = i;
-                Parallel.ForEach(ramp, parallelOptions, 
-                    (i => {
-                        resultBins[i] = EvaluateScoresSerial(taskPkgs[i], isCancelled);
-                    } )
-				);
-                result = Gather(resultBins);
-                    
+                result = EvaluateScores(GetPool(evaluator), population, isCancelled, parallelOptions, metrics);
+			} else if (evaluator is IBatchObjectiveEvaluator<T> && !isCancelled()) {
+                // The evaluator is in charge of distributing the work, e.g. over MPI processes
+                long start = (metrics == null ? 0 : metrics.Start());
+                result = ((IBatchObjectiveEvaluator<T>)evaluator).EvaluateScores(population);
+                if (metrics != null) metrics.Stop(EnginePhase.BatchEvaluation, start);
 			} else {
                 result = new IObjectiveScores[population.Length];
 				for (int i = 0; i < population.Length; i++) {
                     if (!isCancelled ())
-                        result [i] = evaluator.EvaluateScore (population [i]);
+                        result [i] = evaluate(evaluator, population [i], metrics);
                     else
                         result [i] = null;
 				}
@@ -57,37 +41,83 @@ namespace CSIRO.Metaheuristics.Objectives
             return result;
         }
 
-        static IObjectiveScores[] Gather(IObjectiveScores[][] resultBins)
+        private static IObjectiveScores evaluate<T>(IObjectiveEvaluator<T> evaluator, T point, EngineMetrics metrics) where T : ISystemConfiguration
+        {
+            if (metrics == null)
+                return evaluator.EvaluateScore(point);
+            long start = metrics.Start();
+            var result = evaluator.EvaluateScore(point);
+            metrics.Stop(EnginePhase.Evaluation, start);
+            return result;
+        }
+
+        /// <summary>
+        /// Evaluates the scores of a population in parallel, with evaluators from a pool.
+        /// </summary>
+        /// <remarks>
+        /// Points are handed out one at a time to the worker threads as they become free, 
+        /// so that points slower to evaluate than others do not leave threads idle. 
+        /// Each worker rents one evaluator for the duration of the call.
+        /// </remarks>
+        /// <returns>The scores in the order of the population; null for points not evaluated because of a cancellation</returns>
+        public static IObjectiveScores[] EvaluateScores<T>(EvaluatorPool<T> pool, T[] population, Func<bool> isCancelled, ParallelOptions parallelOptions = null, EngineMetrics metrics = null) where T : ISystemConfiguration
         {
-            var result = new List<IObjectiveScores>();
-            for (int i = 0; i < resultBins.Length; i++)
+            var result = new IObjectiveScores[population.Length];
+            if (population.Length == 0)
+                return result;
+            if(parallelOptions == null)
+                parallelOptions = new ParallelOptions() { MaxDegreeOfParallelism = -1 };
+
+            // There is presumably no point cloning 
+            // the system more times than the max level of parallelism
+            int nParallel = System.Environment.ProcessorCount;
+            if (parallelOptions.MaxDegreeOfParallelism > 0)
+                nParallel = Math.Min(nParallel, parallelOptions.MaxDegreeOfParallelism);
+            nParallel = Math.Min(nParallel, population.Length);
+            var options = new ParallelOptions()
             {
-                for (int j = 0; j < resultBins[i].Length; j++)
+                MaxDegreeOfParallelism = nParallel,
+                CancellationToken = parallelOptions.CancellationToken,
+                TaskScheduler = parallelOptions.TaskScheduler
+            };
+            // Parallel.ForEach rather than Parallel.For, to work around a Parallel.For 
+            // oddity in Mono 3.12.1.
+            var indices = Partitioner.Create(Enumerable.Range(0, population.Length), EnumerablePartitionerOptions.NoBuffering);
+            Parallel.ForEach(indices, options,
+                () => pool.Rent(metrics),
+                (i, loopState, evaluator) =>
                 {
-                    result.Add(resultBins[i][j]);
-                }
-            }
-            return result.ToArray();
+                    if (!isCancelled())
+                        result[i] = evaluate(evaluator, population[i], metrics);
+                    return evaluator;
+                },
+                evaluator => pool.Return(evaluator));
+            return result;
         }
 
-        static IObjectiveScores[] EvaluateScoresSerial<T>(Tuple<T[],IClonableObjectiveEvaluator<T>> task, Func<bool> isCancelled) where T : ISystemConfiguration
+        /// <summary>
+        /// Gets the pool of clones of an evaluator used by <see cref="EvaluateScores{T}(IClonableObjectiveEvaluator{T}, T[], Func{bool}, ParallelOptions, EngineMetrics)"/>.
+        /// The pool lives as long as the evaluator.
+        /// </summary>
+        public static EvaluatorPool<T> GetPool<T>(IClonableObjectiveEvaluator<T> evaluator) where T : ISystemConfiguration
         {
-            var pop = task.Item1;
-            var eval = task.Item2;
-            return EvaluateScoresSerial(pop, isCancelled, eval);
+            return Pools<T>.Table.GetValue(evaluator, e => new EvaluatorPool<T>(e));
         }
 
-        static IObjectiveScores[] EvaluateScoresSerial<T>(T[] population, Func<bool> isCancelled, 
-            IClonableObjectiveEvaluator<T> evaluator) where T : ISystemConfiguration
+        /// <summary>
+        /// Discards the clones of an evaluator kept in its pool, if it has one, e.g. at the end of an optimisation; see <see cref="EvaluatorPool{T}.Clear"/>.
+        /// </summary>
+        public static void ClearPool<T>(IClonableObjectiveEvaluator<T> evaluator) where T : ISystemConfiguration
         {
-            IObjectiveScores[] result = new IObjectiveScores[population.Length];
-            for (int j = 0; j < population.Length; j++) {
-                if (!isCancelled ())
-                    result [j] = evaluator.EvaluateScore (population [j]);
-                else
-                    result [j] = null;
-            }
-            return result;
+            EvaluatorPool<T> pool;
+            if (evaluator != null && Pools<T>.Table.TryGetValue(evaluator, out pool))
+                pool.Clear();
+        }
+
+        private static class Pools<T> where T : ISystemConfiguration
+        {
+            public static readonly ConditionalWeakTable<IClonableObjectiveEvaluator<T>, EvaluatorPool<T>> Table = 
+                new ConditionalWeakTable<IClonableObjectiveEvaluator<T>, EvaluatorPool<T>>();
         }
     }
 }
@@ -0,0 +1,108 @@
+﻿using System;
+using System.Collections.Concurrent;
+using CSIRO.Metaheuristics.Optimization;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// A pool of clones of an objective evaluator, each used by one thread at a time, 
+    /// kept across evaluations so that the cost of cloning is not repaid at each generation of an optimiser.
+    /// </summary>
+    /// <typeparam name="T">A type implementing ISystemConfiguration</typeparam>
+    /// <remarks>
+    /// The clones that are <see cref="IDisposable"/>, e.g. evaluators of native models, are disposed of when they are discarded 
+    /// by <see cref="Clear"/> or <see cref="Dispose"/>. The prototype is not; it belongs to the caller.
+    /// </remarks>
+    public class EvaluatorPool<T> : IDisposable where T : ISystemConfiguration
+    {
+        public EvaluatorPool(IClonableObjectiveEvaluator<T> prototype)
+        {
+            if (prototype == null)
+                throw new ArgumentNullException("prototype");
+            if (!prototype.SupportsThreadSafeCloning)
+                throw new ArgumentException("The evaluator must support thread safe cloning to be used from a pool", "prototype");
+            this.prototype = prototype;
+        }
+
+        private readonly IClonableObjectiveEvaluator<T> prototype;
+        private readonly ConcurrentStack<IClonableObjectiveEvaluator<T>> idle = new ConcurrentStack<IClonableObjectiveEvaluator<T>>();
+        private volatile bool disposed = false;
+
+        /// <summary>
+        /// Gets the evaluator cloned for the pool. It is not itself handed out.
+        /// </summary>
+        public IClonableObjectiveEvaluator<T> Prototype
+        {
+            get { return prototype; }
+        }
+
+        /// <summary>
+        /// Gets the number of clones available for reuse
+        /// </summary>
+        public int NumIdle
+        {
+            get { return idle.Count; }
+        }
+
+        /// <summary>
+        /// Gets an evaluator for the exclusive use of the caller until it is returned to the pool
+        /// </summary>
+        public IClonableObjectiveEvaluator<T> Rent()
+        {
+            return Rent(null);
+        }
+
+        /// <summary>
+        /// Gets an evaluator for the exclusive use of the caller, recording in the metrics of an optimiser the time of cloning a new one if need be
+        /// </summary>
+        public IClonableObjectiveEvaluator<T> Rent(EngineMetrics metrics)
+        {
+            if (disposed)
+                throw new ObjectDisposedException("EvaluatorPool");
+            IClonableObjectiveEvaluator<T> result;
+            if (idle.TryPop(out result))
+                return result;
+            long start = (metrics == null ? 0 : metrics.Start());
+            result = prototype.Clone();
+            if (metrics != null)
+                metrics.Stop(EnginePhase.Cloning, start);
+            return result;
+        }
+
+        /// <summary>
+        /// Makes an evaluator obtained with <see cref="Rent"/> available to other callers, or disposes of it if this pool is disposed of
+        /// </summary>
+        public void Return(IClonableObjectiveEvaluator<T> evaluator)
+        {
+            if (evaluator == null)
+                return;
+            idle.Push(evaluator);
+            if (disposed)
+                Clear();
+        }
+
+        /// <summary>
+        /// Discards the clones available for reuse, disposing of those that are disposable. 
+        /// The pool clones the prototype again for the next callers.
+        /// </summary>
+        public void Clear()
+        {
+            IClonableObjectiveEvaluator<T> evaluator;
+            while (idle.TryPop(out evaluator))
+            {
+                var disposable = evaluator as IDisposable;
+                if (disposable != null)
+                    disposable.Dispose();
+            }
+        }
+
+        /// <summary>
+        /// Discards the clones available for reuse, and those returned later on
+        /// </summary>
+        public void Dispose()
+        {
+            disposed = true;
+            Clear();
+        }
+    }
+}
@@ -0,0 +1,242 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// Non-dominated sorting of points whose objectives are doubles, packed in a matrix.
+    /// Dominance is the strict one of <see cref="ParetoComparer{T}"/>: a point dominates another if it is better for every objective.
+    /// </summary>
+    /// <remarks>
+    /// With the dominance relations, the sorting is the fast non-dominated sort of Deb et al. (2002), 
+    /// comparing each pair of points once. Without, problems with two objectives are ranked by a sweep in O(n log n) 
+    /// in the manner of Jensen (2003); other problems fall back on the pairwise comparisons.
+    /// Points of a front are in the order of the input points, the same as <see cref="ParetoRanking{T}"/>.
+    /// </remarks>
+    public class NonDominatedSorting<T> where T : IObjectiveScores
+    {
+        private NonDominatedSorting(double[] objectives, bool[] maximise, int numPoints, bool computeDominated)
+        {
+            this.objectives = objectives;
+            this.maximise = maximise;
+            this.numPoints = numPoints;
+            this.numObjectives = maximise.Length;
+            if (computeDominated || numObjectives != 2)
+                fastNonDominatedSort();
+            else
+                sweepTwoObjectives();
+        }
+
+        /// <summary>
+        /// Sorts points by Pareto rank
+        /// </summary>
+        /// <param name="scores">The points to sort</param>
+        /// <param name="computeDominated">If true, keep the points dominated by each point, see <see cref="GetDominated"/></param>
+        /// <returns>null if the points do not all have the same number of objectives, with double values and the same sense of optimisation</returns>
+        public static NonDominatedSorting<T> Create(IList<T> scores, bool computeDominated = false)
+        {
+            int n = scores.Count;
+            if (n == 0)
+                return null;
+            int k = scores[0].ObjectiveCount;
+            if (k < 1)
+                return null;
+            var maximise = new bool[k];
+            for (int o = 0; o < k; o++)
+                maximise[o] = scores[0].GetObjective(o).Maximise;
+            var objectives = new double[n * k];
+            for (int i = 0; i < n; i++)
+            {
+                if (scores[i].ObjectiveCount != k)
+                    return null;
+                for (int o = 0; o < k; o++)
+                {
+                    var score = scores[i].GetObjective(o);
+                    if (score.Maximise != maximise[o] || !(score.ValueComparable is double))
+                        return null;
+                    objectives[i * k + o] = (double)score.ValueComparable;
+                }
+            }
+            return new NonDominatedSorting<T>(objectives, maximise, n, computeDominated);
+        }
+
+        private readonly double[] objectives;
+        private readonly bool[] maximise;
+        private readonly int numPoints;
+        private readonly int numObjectives;
+        private int[] ranks;
+        private int[][] fronts;
+        private int[][] dominated = null;
+
+        public int NumPoints
+        {
+            get { return numPoints; }
+        }
+
+        /// <summary>
+        /// Gets the Pareto rank of each point, starting at 1 for the non-dominated points
+        /// </summary>
+        public int GetRank(int point)
+        {
+            return ranks[point] + 1;
+        }
+
+        public int NumFronts
+        {
+            get { return fronts.Length; }
+        }
+
+        /// <summary>
+        /// Gets the indices of the points with a Pareto rank
+        /// </summary>
+        /// <param name="rankNumber">The rank, starting at 1 for the non-dominated points</param>
+        public int[] GetFront(int rankNumber)
+        {
+            return (int[])fronts[rankNumber - 1].Clone();
+        }
+
+        /// <summary>
+        /// Gets the indices of the points dominated by a point, in increasing order
+        /// </summary>
+        public int[] GetDominated(int point)
+        {
+            if (dominated == null)
+                throw new InvalidOperationException("The dominance relations were not kept by this sorting");
+            return dominated[point];
+        }
+
+        /// <summary>
+        /// Compares two points with the same convention as <see cref="ParetoComparer{T}"/>: negative if the first dominates the second
+        /// </summary>
+        public int Compare(int x, int y)
+        {
+            int result = compareObjective(x, y, 0);
+            if (result == 0)
+                return 0;
+            for (int o = 1; o < numObjectives; o++)
+            {
+                int comparison = compareObjective(x, y, o);
+                if (comparison == 0 || comparison * result < 0)
+                    return 0;
+            }
+            return result;
+        }
+
+        private int compareObjective(int x, int y, int o)
+        {
+            // double.CompareTo, as used by ParetoComparer, so that NaN values are ordered identically.
+            int comparison = objectives[x * numObjectives + o].CompareTo(objectives[y * numObjectives + o]);
+            return (maximise[o] ? -comparison : comparison);
+        }
+
+        private void fastNonDominatedSort()
+        {
+            var dominatedLists = new List<int>[numPoints];
+            var dominatorCount = new int[numPoints];
+            for (int i = 0; i < numPoints; i++)
+                dominatedLists[i] = new List<int>();
+            for (int i = 0; i < numPoints; i++)
+            {
+                for (int j = i + 1; j < numPoints; j++)
+                {
+                    int comparison = Compare(i, j);
+                    if (comparison < 0)
+                    {
+                        dominatedLists[i].Add(j);
+                        dominatorCount[j]++;
+                    }
+                    else if (comparison > 0)
+                    {
+                        dominatedLists[j].Add(i);
+                        dominatorCount[i]++;
+                    }
+                }
+            }
+            dominated = new int[numPoints][];
+            for (int i = 0; i < numPoints; i++)
+                dominated[i] = dominatedLists[i].ToArray();
+
+            ranks = new int[numPoints];
+            var result = new List<int[]>();
+            var front = new List<int>();
+            for (int i = 0; i < numPoints; i++)
+                if (dominatorCount[i] == 0)
+                    front.Add(i);
+            while (front.Count > 0)
+            {
+                var next = new List<int>();
+                foreach (var p in front)
+                {
+                    ranks[p] = result.Count;
+                    foreach (var q in dominated[p])
+                    {
+                        dominatorCount[q]--;
+                        if (dominatorCount[q] == 0)
+                            next.Add(q);
+                    }
+                }
+                result.Add(front.ToArray());
+                next.Sort();
+                front = next;
+            }
+            fronts = result.ToArray();
+        }
+
+        private void sweepTwoObjectives()
+        {
+            var order = new int[numPoints];
+            for (int i = 0; i < numPoints; i++)
+                order[i] = i;
+            Array.Sort(order, (x, y) =>
+            {
+                int comparison = compareObjective(x, y, 0);
+                return (comparison != 0 ? comparison : x.CompareTo(y));
+            });
+
+            // The points processed so far are all strictly better on the first objective than the current one; 
+            // for each front, the point best on the second objective. These get strictly worse from one front to the next.
+            var bestOnSecond = new List<int>();
+            ranks = new int[numPoints];
+            int start = 0;
+            while (start < numPoints)
+            {
+                // Points equal on the first objective cannot dominate each other: rank them all before updating the fronts.
+                int end = start + 1;
+                while (end < numPoints && compareObjective(order[start], order[end], 0) == 0)
+                    end++;
+                for (int s = start; s < end; s++)
+                {
+                    int point = order[s];
+                    int lo = 0, hi = bestOnSecond.Count;
+                    // First front with no point strictly better on the second objective
+                    while (lo < hi)
+                    {
+                        int mid = (lo + hi) / 2;
+                        if (compareObjective(bestOnSecond[mid], point, 1) < 0)
+                            lo = mid + 1;
+                        else
+                            hi = mid;
+                    }
+                    ranks[point] = lo;
+                }
+                for (int s = start; s < end; s++)
+                {
+                    int point = order[s];
+                    int f = ranks[point];
+                    if (f == bestOnSecond.Count)
+                        bestOnSecond.Add(point);
+                    else if (compareObjective(point, bestOnSecond[f], 1) < 0)
+                        bestOnSecond[f] = point;
+                }
+                start = end;
+            }
+
+            var frontLists = new List<int>[bestOnSecond.Count];
+            for (int f = 0; f < frontLists.Length; f++)
+                frontLists[f] = new List<int>();
+            for (int i = 0; i < numPoints; i++)
+                frontLists[ranks[i]].Add(i);
+            fronts = Array.ConvertAll(frontLists, x => x.ToArray());
+        }
+    }
+}
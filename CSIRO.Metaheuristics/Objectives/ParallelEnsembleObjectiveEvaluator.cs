@@ -0,0 +1,126 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+
+namespace CSIRO.Metaheuristics.Objectives
+{
+    /// <summary>
+    /// An ensemble objective evaluator running the evaluators of all the systems of the ensemble, e.g. one per catchment,
+    /// in parallel on the thread pool of the current process.
+    /// </summary>
+    /// <typeparam name="T">A type implementing ISystemConfiguration</typeparam>
+    /// <remarks>
+    /// <para>This is the in-process counterpart of the MPI ensemble evaluators of CSIRO.Metaheuristics.Parallel.
+    /// The evaluator of each system is used by one thread at a time: the evaluations of a system run concurrently
+    /// only on clones from the pool of its evaluator, see <see cref="Evaluations.GetPool{T}"/>, if it supports thread safe cloning.</para>
+    /// <para>When evaluating several system configurations, the evaluators of systems that are <see cref="IBatchObjectiveEvaluator{T}"/>
+    /// are given all the configurations in one call, e.g. one batched native model run per catchment.</para>
+    /// </remarks>
+    public class ParallelEnsembleObjectiveEvaluator<T> : IBatchEnsembleObjectiveEvaluator<T> where T : ISystemConfiguration
+    {
+        /// <summary>
+        /// Creates an ensemble evaluator
+        /// </summary>
+        /// <param name="systemEvaluators">The evaluators of the systems of the ensemble, in the order of the scores returned</param>
+        /// <param name="parallelOptions">The options of the parallel loops; may be null for the default options</param>
+        public ParallelEnsembleObjectiveEvaluator(IClonableObjectiveEvaluator<T>[] systemEvaluators, ParallelOptions parallelOptions = null)
+        {
+            if (systemEvaluators == null)
+                throw new ArgumentNullException("systemEvaluators");
+            if (systemEvaluators.Length == 0 || Array.Exists(systemEvaluators, x => x == null))
+                throw new ArgumentException("There must be at least one system evaluator, and none may be null", "systemEvaluators");
+            this.systemEvaluators = (IClonableObjectiveEvaluator<T>[])systemEvaluators.Clone();
+            this.ParallelOptions = parallelOptions ?? new ParallelOptions() { MaxDegreeOfParallelism = -1 };
+        }
+
+        private readonly IClonableObjectiveEvaluator<T>[] systemEvaluators;
+
+        /// <summary>
+        /// Gets the number of systems in this ensemble
+        /// </summary>
+        public int SystemCount
+        {
+            get { return systemEvaluators.Length; }
+        }
+
+        /// <summary>
+        /// Gets or sets the options of the parallel loops over the systems
+        /// </summary>
+        public ParallelOptions ParallelOptions { get; set; }
+
+        public IObjectiveScores<T>[] EvaluateScore(T systemConfiguration)
+        {
+            return EvaluateScores(new[] { systemConfiguration })[0];
+        }
+
+        public IObjectiveScores<T>[][] EvaluateScores(T[] systemConfigurations)
+        {
+            var result = new IObjectiveScores<T>[systemConfigurations.Length][];
+            for (int i = 0; i < result.Length; i++)
+                result[i] = new IObjectiveScores<T>[systemEvaluators.Length];
+            if (systemConfigurations.Length == 0)
+                return result;
+
+            // One work item per (system, configuration), or per system for batch evaluators given several configurations
+            var items = new List<KeyValuePair<int, int>>();
+            for (int j = 0; j < systemEvaluators.Length; j++)
+            {
+                if (systemConfigurations.Length > 1 && systemEvaluators[j] is IBatchObjectiveEvaluator<T>)
+                    items.Add(new KeyValuePair<int, int>(j, -1));
+                else
+                    for (int i = 0; i < systemConfigurations.Length; i++)
+                        items.Add(new KeyValuePair<int, int>(j, i));
+            }
+
+            var options = ParallelOptions;
+            int nParallel = System.Environment.ProcessorCount;
+            if (options.MaxDegreeOfParallelism > 0)
+                nParallel = Math.Min(nParallel, options.MaxDegreeOfParallelism);
+            nParallel = Math.Min(nParallel, items.Count);
+            var loopOptions = new ParallelOptions()
+            {
+                MaxDegreeOfParallelism = nParallel,
+                CancellationToken = options.CancellationToken,
+                TaskScheduler = options.TaskScheduler
+            };
+            // Items are handed out one at a time, the evaluations of the systems of an ensemble often being of uneven lengths.
+            var indices = Partitioner.Create(Enumerable.Range(0, items.Count), EnumerablePartitionerOptions.NoBuffering);
+            Parallel.ForEach(indices, loopOptions, k =>
+            {
+                int j = items[k].Key;
+                int i = items[k].Value;
+                if (i < 0)
+                {
+                    var scores = evaluate(j, e => ((IBatchObjectiveEvaluator<T>)e).EvaluateScores(systemConfigurations));
+                    for (int c = 0; c < scores.Length; c++)
+                        result[c][j] = scores[c];
+                }
+                else
+                    result[i][j] = evaluate(j, e => e.EvaluateScore(systemConfigurations[i]));
+            });
+            return result;
+        }
+
+        private TResult evaluate<TResult>(int system, Func<IClonableObjectiveEvaluator<T>, TResult> evaluation)
+        {
+            var evaluator = systemEvaluators[system];
+            if (!evaluator.SupportsThreadSafeCloning)
+            {
+                lock (evaluator)
+                    return evaluation(evaluator);
+            }
+            var pool = Evaluations.GetPool(evaluator);
+            var clone = pool.Rent();
+            try
+            {
+                return evaluation(clone);
+            }
+            finally
+            {
+                pool.Return(clone);
+            }
+        }
+    }
+}
@@ -17,6 +17,19 @@ namespace CSIRO.Metaheuristics.Objectives
 
         private T[][] doParetoRanking( IEnumerable<T> scores, IComparer<T> comparer )
         {
+            // The packed sorting implements the dominance of ParetoComparer; a derived or other comparer may differ.
+            if (comparer.GetType() == typeof(ParetoComparer<T>))
+            {
+                var points = scores.ToArray();
+                var sorting = NonDominatedSorting<T>.Create(points);
+                if (sorting != null)
+                {
+                    var fronts = new T[sorting.NumFronts][];
+                    for (int f = 0; f < fronts.Length; f++)
+                        fronts[f] = Array.ConvertAll(sorting.GetFront(f + 1), i => points[i]);
+                    return fronts;
+                }
+            }
             List<T[]> result = new List<T[]>();
             var rankOne = doOneRanking(scores, comparer);
             while (rankOne.Dominated.Length > 0) // Warning Expects the comparer to not be buggy!
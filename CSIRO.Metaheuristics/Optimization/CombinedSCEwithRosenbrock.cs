@@ -23,6 +23,11 @@ namespace CSIRO.Metaheuristics.Optimization
 
         }
 
+        /// <summary>
+        /// Gets or sets whether the Rosenbrock search evaluates its moves concurrently, see <see cref="RosenbrockOptimizer{T, U}.SpeculativeParallelMoves"/>
+        /// </summary>
+        public bool SpeculativeParallelMoves { get; set; }
+
         private ITerminationCondition<T> rosenTerminationCondition;
         private IClonableObjectiveEvaluator<T> evaluator;
         private object rosenAlgabraProvider;
@@ -44,7 +49,8 @@ namespace CSIRO.Metaheuristics.Optimization
             var startingPoint = (T) results.FirstOrDefault().GetSystemConfiguration();
             rosenbrock = new RosenbrockOptimizer<T, U>( evaluator, startingPoint,
                                                         rosenTerminationCondition )
-                         { AlgebraProvider = (IAlgebraProvider) rosenAlgabraProvider };
+                         { AlgebraProvider = (IAlgebraProvider) rosenAlgabraProvider,
+                           SpeculativeParallelMoves = this.SpeculativeParallelMoves };
             ////Run Rosenbrock
             try
             {
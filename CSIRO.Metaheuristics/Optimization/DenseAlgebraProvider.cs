@@ -0,0 +1,251 @@
+﻿using System;
+
+namespace CSIRO.Metaheuristics.Optimization
+{
+    /// <summary>
+    /// An algebra provider storing vectors and bases in contiguous arrays, with the base vectors as the rows of one array.
+    /// </summary>
+    /// <remarks>
+    /// New bases are the canonical base. The base vectors returned by the indexer of a <see cref="DenseBase"/> are views
+    /// on its storage, not copies, so that reading their components does not allocate.
+    /// </remarks>
+    public class DenseAlgebraProvider : IAlgebraProvider
+    {
+        public IBase CreateBase(int numDim)
+        {
+            return new DenseBase(numDim);
+        }
+
+        public IVector CreateVector(int numDim)
+        {
+            return new DenseVector(numDim);
+        }
+
+        /// <summary>
+        /// The scalar product of two arrays segments; four partial sums break the dependency chain of the additions.
+        /// </summary>
+        internal static double Dot(double[] a, int offsetA, double[] b, int offsetB, int length)
+        {
+            double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            int k = 0;
+            for (; k <= length - 4; k += 4)
+            {
+                s0 += a[offsetA + k] * b[offsetB + k];
+                s1 += a[offsetA + k + 1] * b[offsetB + k + 1];
+                s2 += a[offsetA + k + 2] * b[offsetB + k + 2];
+                s3 += a[offsetA + k + 3] * b[offsetB + k + 3];
+            }
+            for (; k < length; k++)
+                s0 += a[offsetA + k] * b[offsetB + k];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        /// <summary>
+        /// y = y + factor * x, on arrays segments
+        /// </summary>
+        internal static void AddScaled(double[] y, int offsetY, double factor, double[] x, int offsetX, int length)
+        {
+            for (int k = 0; k < length; k++)
+                y[offsetY + k] += factor * x[offsetX + k];
+        }
+    }
+
+    /// <summary>
+    /// A vector of a <see cref="DenseAlgebraProvider"/>, possibly a view on a segment of a larger array
+    /// </summary>
+    public class DenseVector : IVector
+    {
+        /// <summary>
+        /// Creates a null vector
+        /// </summary>
+        public DenseVector(int length) : this(new double[length], 0, length)
+        {
+        }
+
+        internal DenseVector(double[] data, int offset, int length)
+        {
+            this.data = data;
+            this.offset = offset;
+            this.length = length;
+        }
+
+        private readonly double[] data;
+        private readonly int offset;
+        private readonly int length;
+
+        public double this[int i]
+        {
+            get { return data[offset + i]; }
+            set { data[offset + i] = value; }
+        }
+
+        public int Length
+        {
+            get { return length; }
+        }
+
+        /// <summary>
+        /// Gets whether the scalar product with another vector is negligible relative to the product of their norms
+        /// </summary>
+        public bool IsOrthogonal(IVector pathOfStage)
+        {
+            var other = asDense(pathOfStage);
+            double dot = DenseAlgebraProvider.Dot(data, offset, other.data, other.offset, length);
+            double norms = Math.Sqrt(DenseAlgebraProvider.Dot(data, offset, data, offset, length) * DenseAlgebraProvider.Dot(other.data, other.offset, other.data, other.offset, length));
+            return Math.Abs(dot) <= Tolerance * norms;
+        }
+
+        internal const double Tolerance = 1e-12;
+
+        public bool IsNullVector
+        {
+            get
+            {
+                for (int k = 0; k < length; k++)
+                    if (data[offset + k] != 0.0)
+                        return false;
+                return true;
+            }
+        }
+
+        public void SetAllComponents(double value)
+        {
+            for (int k = 0; k < length; k++)
+                data[offset + k] = value;
+        }
+
+        private DenseVector asDense(IVector v)
+        {
+            if (v.Length != length)
+                throw new ArgumentException(string.Format("Vector of length {0} where {1} is expected", v.Length, length));
+            var result = v as DenseVector;
+            if (result != null)
+                return result;
+            result = new DenseVector(length);
+            for (int k = 0; k < length; k++)
+                result[k] = v[k];
+            return result;
+        }
+    }
+
+    /// <summary>
+    /// A base of a <see cref="DenseAlgebraProvider"/>
+    /// </summary>
+    public class DenseBase : IBase
+    {
+        /// <summary>
+        /// Creates the canonical base of a space
+        /// </summary>
+        public DenseBase(int numDim)
+        {
+            if (numDim < 1)
+                throw new ArgumentOutOfRangeException("numDim", numDim, "A base must have at least one dimension");
+            this.numDim = numDim;
+            this.data = new double[numDim * numDim];
+            for (int i = 0; i < numDim; i++)
+                data[i * numDim + i] = 1.0;
+        }
+
+        private readonly int numDim;
+        // The base vectors are the rows
+        private readonly double[] data;
+
+        public IVector CreateVector()
+        {
+            return new DenseVector(numDim);
+        }
+
+        public int NumDimensions
+        {
+            get { return numDim; }
+        }
+
+        public IVector this[int i]
+        {
+            get { return GetBaseVector(i); }
+        }
+
+        public IVector GetBaseVector(int p)
+        {
+            checkIndex(p);
+            return new DenseVector(data, p * numDim, numDim);
+        }
+
+        public void SetBaseVector(int p, IVector pathOfStage)
+        {
+            checkIndex(p);
+            if (pathOfStage.Length != numDim)
+                throw new ArgumentException(string.Format("Vector of length {0} where {1} is expected", pathOfStage.Length, numDim));
+            for (int k = 0; k < numDim; k++)
+                data[p * numDim + k] = pathOfStage[k];
+        }
+
+        /// <summary>
+        /// Makes this base orthonormal with the modified Gram-Schmidt process, keeping the direction of the base vector p.
+        /// </summary>
+        /// <remarks>
+        /// The vector p is processed first, then the others in their order. A vector found to be linearly dependent on the
+        /// vectors before it is replaced by the first canonical base vector that is not.
+        /// </remarks>
+        public void Orthonormalize(int p)
+        {
+            checkIndex(p);
+            var order = new int[numDim];
+            order[0] = p;
+            for (int i = 0, k = 1; i < numDim; i++)
+                if (i != p)
+                    order[k++] = i;
+            for (int k = 0; k < numDim; k++)
+            {
+                int row = order[k] * numDim;
+                if (!orthonormalize(row, order, k))
+                {
+                    if (k == 0)
+                        throw new InvalidOperationException("The base vector to orthonormalize against is a null vector");
+                    bool replaced = false;
+                    for (int c = 0; c < numDim && !replaced; c++)
+                    {
+                        Array.Clear(data, row, numDim);
+                        data[row + c] = 1.0;
+                        replaced = orthonormalize(row, order, k);
+                    }
+                    if (!replaced)
+                        throw new InvalidOperationException("Failed to complete an orthonormal base");
+                }
+            }
+        }
+
+        /// <summary>
+        /// Removes from the row the projections on the first k rows of the order, and normalises it.
+        /// </summary>
+        /// <returns>false if the row is, numerically, linearly dependent on these rows</returns>
+        private bool orthonormalize(int row, int[] order, int k)
+        {
+            double initialNorm = Math.Sqrt(DenseAlgebraProvider.Dot(data, row, data, row, numDim));
+            for (int j = 0; j < k; j++)
+            {
+                int other = order[j] * numDim;
+                double projection = DenseAlgebraProvider.Dot(data, row, data, other, numDim);
+                DenseAlgebraProvider.AddScaled(data, row, -projection, data, other, numDim);
+            }
+            double norm = Math.Sqrt(DenseAlgebraProvider.Dot(data, row, data, row, numDim));
+            if (norm == 0.0 || norm <= 1e-10 * initialNorm)
+                return false;
+            double inverse = 1.0 / norm;
+            for (int c = 0; c < numDim; c++)
+                data[row + c] *= inverse;
+            return true;
+        }
+
+        public IBase CreateNew(int numDim)
+        {
+            return new DenseBase(numDim);
+        }
+
+        private void checkIndex(int p)
+        {
+            if (p < 0 || p >= numDim)
+                throw new ArgumentOutOfRangeException("p", p, "Index of a base vector out of range");
+        }
+    }
+}
@@ -0,0 +1,428 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Linq;
+using System.Text;
+using System.Threading;
+
+namespace CSIRO.Metaheuristics.Optimization
+{
+    /// <summary>
+    /// Phases of the execution of an optimiser timed by <see cref="EngineMetrics"/>
+    /// </summary>
+    /// <remarks>
+    /// A run contains all the other phases, and the evolution of a complex contains the phases of this complex.
+    /// Cloning an evaluator may happen while shuffling. The other phases do not overlap each other on a given thread,
+    /// so that the time of a run not spent in them is the bookkeeping of the optimiser itself.
+    /// </remarks>
+    public enum EnginePhase
+    {
+        /// <summary>A call to Evolve</summary>
+        Run = 0,
+        /// <summary>The evolution of a complex between two shuffles</summary>
+        ComplexEvolution,
+        /// <summary>The evaluation of one point by an objective evaluator</summary>
+        Evaluation,
+        /// <summary>The evaluation of several points by a batch evaluator, e.g. over MPI processes</summary>
+        BatchEvaluation,
+        /// <summary>The assignment of fitness to, and sorting of, a set of points</summary>
+        FitnessAssignment,
+        /// <summary>A write to the logger of the optimiser</summary>
+        Logging,
+        /// <summary>The partition of a population into new complexes</summary>
+        Shuffling,
+        /// <summary>The creation of a new clone of an objective evaluator</summary>
+        Cloning
+    }
+
+    /// <summary>
+    /// Counts and durations of the phases of an optimiser, per thread and per complex, readable during a run.
+    /// </summary>
+    /// <remarks>
+    /// Metrics are disabled by default: an instrumented phase then costs a test of a flag. When enabled, each phase
+    /// costs two reads of the high resolution timer and a few uncontended atomic additions to counters of the current thread.
+    /// The optimiser brackets each phase as follows:
+    /// <code>
+    /// long start = metrics.Start();
+    /// var score = evaluator.EvaluateScore(point);
+    /// metrics.Stop(EnginePhase.Evaluation, start, complexIndex);
+    /// </code>
+    /// </remarks>
+    public sealed class EngineMetrics
+    {
+        public EngineMetrics()
+        {
+            Reset();
+        }
+
+        /// <summary>
+        /// Number of buckets of the histograms of durations. Bucket 0 counts durations under one microsecond,
+        /// bucket i durations in [2^(i-1), 2^i) microseconds, and the last bucket any longer duration.
+        /// </summary>
+        public const int NumBuckets = 32;
+
+        internal static readonly int NumPhases = Enum.GetValues(typeof(EnginePhase)).Length;
+
+        private volatile bool enabled = false;
+        private volatile State state;
+
+        /// <summary>
+        /// Gets or sets whether phases are timed. Phases started while disabled are not recorded.
+        /// </summary>
+        public bool Enabled
+        {
+            get { return enabled; }
+            set { enabled = value; }
+        }
+
+        /// <summary>
+        /// Starts timing a phase
+        /// </summary>
+        /// <returns>The timestamp to give to <see cref="Stop"/>, or zero if metrics are disabled</returns>
+        public long Start()
+        {
+            return (enabled ? Stopwatch.GetTimestamp() : 0);
+        }
+
+        /// <summary>
+        /// Records the end of a phase started with <see cref="Start"/>
+        /// </summary>
+        /// <param name="phase">The phase that ends</param>
+        /// <param name="start">The value returned by <see cref="Start"/></param>
+        /// <param name="complexIndex">The index of the complex the phase belongs to, or a negative value for the optimiser as a whole</param>
+        public void Stop(EnginePhase phase, long start, int complexIndex = -1)
+        {
+            if (start == 0)
+                return;
+            long elapsed = Stopwatch.GetTimestamp() - start;
+            var s = state;
+            s.Threads.Value.Add((int)phase, elapsed);
+            if (complexIndex >= 0)
+                s.GetComplex(complexIndex).Add((int)phase, elapsed);
+        }
+
+        /// <summary>
+        /// Discards the metrics recorded so far. The elapsed time and garbage collections of snapshots are counted from this call.
+        /// </summary>
+        public void Reset()
+        {
+            state = new State();
+        }
+
+        /// <summary>
+        /// Gets a copy of the metrics recorded so far. Safe to call from any thread while the optimiser runs;
+        /// phases in progress are not included.
+        /// </summary>
+        public EngineMetricsSnapshot GetSnapshot()
+        {
+            var s = state;
+            var threads = s.Threads.Values.OrderBy(c => c.Id).Select(c => c.ToGroup()).ToArray();
+            var complexes = s.GetComplexes().Select(c => c.ToGroup()).ToArray();
+            var total = new Counters(-1, "Total");
+            foreach (var c in s.Threads.Values)
+                total.AddAll(c);
+            var gcCollections = new int[s.GcBaseline.Length];
+            for (int gen = 0; gen < gcCollections.Length; gen++)
+                gcCollections[gen] = GC.CollectionCount(gen) - s.GcBaseline[gen];
+            return new EngineMetricsSnapshot(
+                ticksToTimeSpan(Stopwatch.GetTimestamp() - s.StartTimestamp),
+                gcCollections, total.ToGroup(), threads, complexes);
+        }
+
+        private static TimeSpan ticksToTimeSpan(long stopwatchTicks)
+        {
+            return TimeSpan.FromTicks((long)(stopwatchTicks * ((double)TimeSpan.TicksPerSecond / Stopwatch.Frequency)));
+        }
+
+        private static readonly double microsecondsPerTick = 1e6 / Stopwatch.Frequency;
+
+        private static int bucketIndex(long ticks)
+        {
+            long us = (long)(ticks * microsecondsPerTick);
+            int result = 0;
+            while (us > 0 && result < NumBuckets - 1)
+            {
+                us >>= 1;
+                result++;
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// The counters of one run, swapped as a whole on reset so that phases in flight do not need a lock
+        /// </summary>
+        private sealed class State
+        {
+            public State()
+            {
+                StartTimestamp = Stopwatch.GetTimestamp();
+                GcBaseline = new int[GC.MaxGeneration + 1];
+                for (int gen = 0; gen < GcBaseline.Length; gen++)
+                    GcBaseline[gen] = GC.CollectionCount(gen);
+            }
+
+            public readonly long StartTimestamp;
+            public readonly int[] GcBaseline;
+            public readonly ThreadLocal<Counters> Threads = new ThreadLocal<Counters>(
+                () => new Counters(Thread.CurrentThread.ManagedThreadId, Thread.CurrentThread), trackAllValues: true);
+
+            private Counters[] complexes = new Counters[0];
+            private readonly object complexesLock = new object();
+
+            public Counters GetComplex(int index)
+            {
+                var current = complexes;
+                if (index < current.Length && current[index] != null)
+                    return current[index];
+                lock (complexesLock)
+                {
+                    current = complexes;
+                    if (index >= current.Length)
+                    {
+                        var grown = new Counters[Math.Max(index + 1, current.Length * 2)];
+                        Array.Copy(current, grown, current.Length);
+                        current = grown;
+                    }
+                    if (current[index] == null)
+                        current[index] = new Counters(index, "Complex " + index.ToString(CultureInfo.InvariantCulture));
+                    complexes = current;
+                    return current[index];
+                }
+            }
+
+            public IEnumerable<Counters> GetComplexes()
+            {
+                return complexes.Where(c => c != null);
+            }
+        }
+
+        /// <summary>
+        /// Counters of all the phases, for one thread or complex. Updated with atomic operations, so that they can be read while updated.
+        /// </summary>
+        private sealed class Counters
+        {
+            public Counters(int id, string name)
+            {
+                Id = id;
+                this.name = name;
+            }
+
+            public Counters(int id, Thread thread)
+            {
+                Id = id;
+                this.thread = thread;
+            }
+
+            public readonly int Id;
+            private readonly string name;
+            // The name of a thread may be set after its first phase, e.g. by a complex.
+            private readonly Thread thread;
+
+            private readonly long[] counts = new long[NumPhases];
+            private readonly long[] totalTicks = new long[NumPhases];
+            private readonly long[] maxTicks = new long[NumPhases];
+            private readonly long[] buckets = new long[NumPhases * NumBuckets];
+
+            public void Add(int phase, long ticks)
+            {
+                Interlocked.Increment(ref counts[phase]);
+                Interlocked.Add(ref totalTicks[phase], ticks);
+                Interlocked.Increment(ref buckets[phase * NumBuckets + bucketIndex(ticks)]);
+                long max = Interlocked.Read(ref maxTicks[phase]);
+                while (ticks > max)
+                {
+                    long previous = Interlocked.CompareExchange(ref maxTicks[phase], ticks, max);
+                    if (previous == max)
+                        break;
+                    max = previous;
+                }
+            }
+
+            public void AddAll(Counters other)
+            {
+                for (int p = 0; p < NumPhases; p++)
+                {
+                    counts[p] += Interlocked.Read(ref other.counts[p]);
+                    totalTicks[p] += Interlocked.Read(ref other.totalTicks[p]);
+                    maxTicks[p] = Math.Max(maxTicks[p], Interlocked.Read(ref other.maxTicks[p]));
+                }
+                for (int i = 0; i < buckets.Length; i++)
+                    buckets[i] += Interlocked.Read(ref other.buckets[i]);
+            }
+
+            public EngineMetricsGroup ToGroup()
+            {
+                var phases = new PhaseMetrics[NumPhases];
+                for (int p = 0; p < NumPhases; p++)
+                {
+                    var histogram = new long[NumBuckets];
+                    for (int i = 0; i < NumBuckets; i++)
+                        histogram[i] = Interlocked.Read(ref buckets[p * NumBuckets + i]);
+                    phases[p] = new PhaseMetrics((EnginePhase)p,
+                        Interlocked.Read(ref counts[p]),
+                        ticksToTimeSpan(Interlocked.Read(ref totalTicks[p])),
+                        ticksToTimeSpan(Interlocked.Read(ref maxTicks[p])),
+                        histogram);
+                }
+                string groupName = (thread != null ? (thread.Name ?? "Thread " + Id.ToString(CultureInfo.InvariantCulture)) : name);
+                return new EngineMetricsGroup(Id, groupName, phases);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Count and durations of one phase of an optimiser
+    /// </summary>
+    public sealed class PhaseMetrics
+    {
+        internal PhaseMetrics(EnginePhase phase, long count, TimeSpan totalTime, TimeSpan maxTime, long[] histogram)
+        {
+            Phase = phase;
+            Count = count;
+            TotalTime = totalTime;
+            MaxTime = maxTime;
+            this.histogram = histogram;
+        }
+
+        private readonly long[] histogram;
+
+        public EnginePhase Phase { get; private set; }
+        public long Count { get; private set; }
+        public TimeSpan TotalTime { get; private set; }
+        public TimeSpan MaxTime { get; private set; }
+
+        public TimeSpan MeanTime
+        {
+            get { return (Count == 0 ? TimeSpan.Zero : TimeSpan.FromTicks(TotalTime.Ticks / Count)); }
+        }
+
+        /// <summary>
+        /// Gets a copy of the histogram of durations; see <see cref="EngineMetrics.NumBuckets"/> for the bounds of the buckets
+        /// </summary>
+        public long[] GetHistogram()
+        {
+            return (long[])histogram.Clone();
+        }
+
+        /// <summary>
+        /// Gets the upper bound, in microseconds, of the durations counted in a bucket of the histogram
+        /// </summary>
+        public static double GetBucketUpperBound(int bucket)
+        {
+            return (bucket >= EngineMetrics.NumBuckets - 1 ? double.PositiveInfinity : Math.Pow(2, bucket));
+        }
+
+        /// <summary>
+        /// Estimates a quantile of the durations from the histogram, as the upper bound of the bucket containing it
+        /// </summary>
+        /// <param name="probability">The probability of the quantile, e.g. 0.99</param>
+        public TimeSpan GetQuantile(double probability)
+        {
+            if (probability < 0 || probability > 1)
+                throw new ArgumentOutOfRangeException("probability", "The probability must be between 0 and 1");
+            if (Count == 0)
+                return TimeSpan.Zero;
+            long rank = Math.Max(1, (long)Math.Ceiling(probability * Count));
+            long cumulated = 0;
+            for (int i = 0; i < histogram.Length; i++)
+            {
+                cumulated += histogram[i];
+                if (cumulated >= rank)
+                {
+                    double us = GetBucketUpperBound(i);
+                    if (double.IsInfinity(us) || us * TimeSpan.TicksPerMillisecond / 1000 > MaxTime.Ticks)
+                        return MaxTime;
+                    return TimeSpan.FromTicks((long)(us * TimeSpan.TicksPerMillisecond / 1000));
+                }
+            }
+            return MaxTime;
+        }
+    }
+
+    /// <summary>
+    /// The metrics of all the phases, for a thread, a complex, or the optimiser as a whole
+    /// </summary>
+    public sealed class EngineMetricsGroup
+    {
+        internal EngineMetricsGroup(int id, string name, PhaseMetrics[] phases)
+        {
+            Id = id;
+            Name = name;
+            this.phases = phases;
+        }
+
+        private readonly PhaseMetrics[] phases;
+
+        /// <summary>
+        /// Gets the managed thread id, the index of the complex, or -1 for the optimiser as a whole
+        /// </summary>
+        public int Id { get; private set; }
+        public string Name { get; private set; }
+
+        public PhaseMetrics this[EnginePhase phase]
+        {
+            get { return phases[(int)phase]; }
+        }
+
+        public IEnumerable<PhaseMetrics> Phases
+        {
+            get { return phases; }
+        }
+    }
+
+    /// <summary>
+    /// A copy of the metrics of an optimiser at a point in time
+    /// </summary>
+    public sealed class EngineMetricsSnapshot
+    {
+        internal EngineMetricsSnapshot(TimeSpan elapsed, int[] gcCollections, EngineMetricsGroup total, EngineMetricsGroup[] threads, EngineMetricsGroup[] complexes)
+        {
+            Elapsed = elapsed;
+            this.gcCollections = gcCollections;
+            Total = total;
+            Threads = threads;
+            Complexes = complexes;
+        }
+
+        private readonly int[] gcCollections;
+
+        /// <summary>
+        /// Gets the wall clock time since the metrics were created or last reset
+        /// </summary>
+        public TimeSpan Elapsed { get; private set; }
+
+        /// <summary>
+        /// Gets the metrics summed over all threads
+        /// </summary>
+        public EngineMetricsGroup Total { get; private set; }
+
+        public EngineMetricsGroup[] Threads { get; private set; }
+
+        public EngineMetricsGroup[] Complexes { get; private set; }
+
+        /// <summary>
+        /// Gets the number of garbage collections of a generation in the process since the metrics were created or last reset
+        /// </summary>
+        public int GetGcCollections(int generation)
+        {
+            return gcCollections[generation];
+        }
+
+        /// <summary>
+        /// A table of the total metrics per phase, for a human reader
+        /// </summary>
+        public override string ToString()
+        {
+            var sb = new StringBuilder();
+            sb.AppendFormat(CultureInfo.InvariantCulture, "Elapsed {0:F3} s, {1} thread(s), GC collections {2}",
+                Elapsed.TotalSeconds, Threads.Length, string.Join("/", gcCollections));
+            sb.AppendLine();
+            sb.AppendLine(string.Format(CultureInfo.InvariantCulture, "{0,-18} {1,12} {2,12} {3,12} {4,12} {5,12}", "Phase", "Count", "Total (s)", "Mean (ms)", "p99 (ms)", "Max (ms)"));
+            foreach (var p in Total.Phases.Where(x => x.Count > 0))
+                sb.AppendLine(string.Format(CultureInfo.InvariantCulture, "{0,-18} {1,12} {2,12:F3} {3,12:F3} {4,12:F3} {5,12:F3}",
+                    p.Phase, p.Count, p.TotalTime.TotalSeconds, p.MeanTime.TotalMilliseconds, p.GetQuantile(0.99).TotalMilliseconds, p.MaxTime.TotalMilliseconds));
+            return sb.ToString();
+        }
+    }
+}
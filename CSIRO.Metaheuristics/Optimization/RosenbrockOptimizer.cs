@@ -3,12 +3,13 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Text;
 using System.Globalization;
+using System.Threading.Tasks;
 using CSIRO.Metaheuristics.Objectives;
 using CSIRO.Metaheuristics.Logging;
 
 namespace CSIRO.Metaheuristics.Optimization
 {
-    public class RosenbrockOptimizer<T, U> : IEvolutionEngine<T>
+    public class RosenbrockOptimizer<T, U> : IEvolutionEngine<T>, IInstrumentedEngine
         where T : IHyperCube<U>, ICloneableSystemConfiguration
         where U : struct, IComparable, IConvertible
     {
@@ -20,7 +21,7 @@ namespace CSIRO.Metaheuristics.Optimization
             IAlgebraProvider algebraprovider = null,
             IDictionary<string, string> logTags = null)
         {
-            this.countingEvaluator = new CountingEvaluator(evaluator);
+            this.countingEvaluator = new CountingEvaluator(evaluator, metrics);
             this.startingPoint = evaluator.EvaluateScore( startingPoint );
             this.terminationCondition = terminationCondition;
             terminationCondition.SetEvolutionEngine( this );
@@ -34,14 +35,54 @@ namespace CSIRO.Metaheuristics.Optimization
         IObjectiveScores<T> currentPoint;
         ITerminationCondition<T> terminationCondition;
 
+        /// <summary>
+        /// Gets or sets the provider of the vectors and bases of the search; a <see cref="DenseAlgebraProvider"/> is used if null.
+        /// </summary>
         public IAlgebraProvider AlgebraProvider
         {
             get;
             set;
         }
 
+        /// <summary>
+        /// Gets or sets whether the moves along the directions of the base are evaluated concurrently.
+        /// </summary>
+        /// <remarks>
+        /// The moves along all the directions not yet tried in a sweep of the base are evaluated together, from the current point.
+        /// Moves are then accepted in order as the sequential algorithm would: the moves after the first success had started 
+        /// from a point that is no longer current, and are discarded and tried again from the new point. 
+        /// The search is thus the same as the sequential one, at the cost of the evaluations discarded, see <see cref="DiscardedEvaluations"/>.
+        /// This is used only if the evaluator is an <see cref="IClonableObjectiveEvaluator{T}"/> supporting thread safe cloning, 
+        /// or an <see cref="IBatchObjectiveEvaluator{T}"/>.
+        /// </remarks>
+        public bool SpeculativeParallelMoves { get; set; }
+
+        public int MaxDegreeOfParallelism
+        {
+            get { return countingEvaluator.ParallelOptions.MaxDegreeOfParallelism; }
+            set { countingEvaluator.ParallelOptions.MaxDegreeOfParallelism = value; }
+        }
+
+        /// <summary>
+        /// Gets the number of evaluations of moves that were discarded by <see cref="SpeculativeParallelMoves"/>.
+        /// These are not counted by the <see cref="RosenbrockOptimizerIterationTermination"/>.
+        /// </summary>
+        public int DiscardedEvaluations
+        {
+            get { return countingEvaluator.Discarded; }
+        }
+
         public ILoggerMh Logger { get; set; }
 
+        private readonly EngineMetrics metrics = new EngineMetrics();
+        /// <summary>
+        /// Gets the timings of the phases of this optimiser
+        /// </summary>
+        public EngineMetrics Metrics
+        {
+            get { return metrics; }
+        }
+
         double alpha;
         double beta;
         double initialStep = 0.1;
@@ -50,9 +91,24 @@ namespace CSIRO.Metaheuristics.Optimization
         private IDictionary<string, string> logTags;
 
         public IOptimizationResults<T> Evolve( )
+        {
+            long start = metrics.Start();
+            try
+            {
+                return evolve();
+            }
+            finally
+            {
+                countingEvaluator.ClearClones();
+                metrics.Stop(EnginePhase.Run, start);
+            }
+        }
+
+        private IOptimizationResults<T> evolve( )
         {
             if (this.AlgebraProvider == null)
-                throw new ArgumentNullException("The Rosenbrock optimizer must have its AlgebraProvider property not set to 'null'");
+                this.AlgebraProvider = new DenseAlgebraProvider();
+            countingEvaluator.Speculative = SpeculativeParallelMoves;
             currentPoint = startingPoint;
             IBase b = createNewBase( currentPoint );
             IVector stepsLength = b.CreateVector( );
@@ -89,14 +145,58 @@ namespace CSIRO.Metaheuristics.Optimization
             public IObjectiveScores<T> Evaluate( T sysConfig )
             {
                 Counter++;
-                return evaluator.EvaluateScore( sysConfig );
+                long start = Metrics.Start();
+                var result = evaluator.EvaluateScore( sysConfig );
+                Metrics.Stop(EnginePhase.Evaluation, start);
+                return result;
+            }
+
+            /// <summary>
+            /// Evaluates points concurrently; these are not counted until <see cref="Use"/> says how many are part of the search.
+            /// </summary>
+            public IObjectiveScores<T>[] EvaluateConcurrently( T[] sysConfigs )
+            {
+                var scores = Evaluations.EvaluateScores( (IClonableObjectiveEvaluator<T>)evaluator, sysConfigs, () => false, ParallelOptions, Metrics );
+                return Array.ConvertAll( scores, x => (IObjectiveScores<T>)x );
+            }
+
+            /// <summary>
+            /// Discards the clones of the evaluator used for the concurrent evaluations
+            /// </summary>
+            public void ClearClones( )
+            {
+                Evaluations.ClearPool( evaluator as IClonableObjectiveEvaluator<T> );
+            }
+
+            public void Use( int used, int discarded )
+            {
+                Counter += used;
+                Discarded += discarded;
+            }
+
+            /// <summary>
+            /// Gets whether moves are evaluated speculatively, if the evaluator can evaluate several points concurrently
+            /// </summary>
+            public bool Speculative
+            {
+                get { return speculative && canEvaluateConcurrently; }
+                set { speculative = value; }
             }
+            private bool speculative = false;
+            private readonly bool canEvaluateConcurrently;
+
             public int Counter { get; private set; }
+            public int Discarded { get; private set; }
+            public EngineMetrics Metrics { get; private set; }
+            public readonly ParallelOptions ParallelOptions = new ParallelOptions( );
 
-            public CountingEvaluator( IObjectiveEvaluator<T> evaluator )
+            public CountingEvaluator( IObjectiveEvaluator<T> evaluator, EngineMetrics metrics )
             {
                 Counter = 0;
                 this.evaluator = evaluator;
+                this.Metrics = metrics;
+                var clonable = evaluator as IClonableObjectiveEvaluator<T>;
+                this.canEvaluateConcurrently = clonable != null && ( clonable.SupportsThreadSafeCloning || evaluator is IBatchObjectiveEvaluator<T> );
             }
         }
 
@@ -156,6 +256,11 @@ namespace CSIRO.Metaheuristics.Optimization
 
             public ILoggerMh Logger { get; set; }
 
+            private EngineMetrics metrics
+            {
+                get { return countingEvaluator.Metrics; }
+            }
+
             public Tuple<IBase, IObjectiveScores<T>, IObjectiveScores<T>[]> Evolve()
             {
                 moveFailedOnce = createNegBoolArray( b.NumDimensions );
@@ -166,15 +271,22 @@ namespace CSIRO.Metaheuristics.Optimization
                     var triedPoints = makeAMove( b, currentPoint );
                     currentPoint = triedPoints.Last();
                     scores.AddRange(triedPoints);
-                    LoggerMhHelper.Write(new IObjectiveScores[]{ currentPoint },
-                        createTag(), 
-                        Logger);
+                    if (Logger != null)
+                    {
+                        long start = metrics.Start();
+                        LoggerMhHelper.Write(new IObjectiveScores[]{ currentPoint },
+                            createTag(), 
+                            Logger);
+                        metrics.Stop(EnginePhase.Logging, start);
+                    }
                 }
                 endPoint = currentPoint;
                 b = createNewBase( b, startingPoint, endPoint );
 
+                long rankingStart = metrics.Start();
                 var paretoRanking = new ParetoRanking<IObjectiveScores<T>>(scores, new ParetoComparer<IObjectiveScores<T>>());
                 IObjectiveScores<T>[] paretoScores = paretoRanking.GetDominatedByParetoRank(0);
+                metrics.Stop(EnginePhase.FitnessAssignment, rankingStart);
  
                 return Tuple.Create( b, currentPoint, paretoScores);
             }
@@ -251,6 +363,8 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private IObjectiveScores<T>[] makeAMove( IBase b, IObjectiveScores<T> startPoint )
             {
+                if( countingEvaluator.Speculative )
+                    return makeSpeculativeMoves( b, startPoint );
                 IObjectiveScores<T> newPoint = startPoint;
                 int d = b.NumDimensions;
                 IObjectiveScores<T>[] points = new IObjectiveScores<T>[d];
@@ -262,11 +376,49 @@ namespace CSIRO.Metaheuristics.Optimization
                 return points;
             }
 
+            private IObjectiveScores<T>[] makeSpeculativeMoves( IBase b, IObjectiveScores<T> startPoint )
+            {
+                IObjectiveScores<T> newPoint = startPoint;
+                int d = b.NumDimensions;
+                IObjectiveScores<T>[] points = new IObjectiveScores<T>[d];
+                int i = 0;
+                while( i < d )
+                {
+                    // All the remaining moves start from the current point; each is valid only if all the moves before it failed.
+                    int n = d - i;
+                    var candidates = new T[n];
+                    var metConstraint = new bool[n];
+                    for( int k = 0; k < n; k++ )
+                        candidates[k] = createMove( i + k, b, newPoint, out metConstraint[k] );
+                    var scores = countingEvaluator.EvaluateConcurrently( candidates );
+                    int used = 0;
+                    while( used < n )
+                    {
+                        var previous = newPoint;
+                        newPoint = acceptMove( i + used, previous, scores[used], metConstraint[used] );
+                        points[i + used] = newPoint;
+                        used++;
+                        if( !object.ReferenceEquals( newPoint, previous ) )
+                            break;
+                    }
+                    countingEvaluator.Use( used, n - used );
+                    i += used;
+                }
+                return points;
+            }
+
             private IObjectiveScores<T> makeAMove( int baseVectorIndex, IBase b, IObjectiveScores<T> startingPoint )
+            {
+                bool moveMetConstraint;
+                var sysConfig = createMove( baseVectorIndex, b, startingPoint, out moveMetConstraint );
+                IObjectiveScores<T> candidatePoint = evaluate( sysConfig );
+                return acceptMove( baseVectorIndex, startingPoint, candidatePoint, moveMetConstraint );
+            }
+
+            private T createMove( int baseVectorIndex, IBase b, IObjectiveScores<T> startingPoint, out bool moveMetConstraint )
             {
                 double stepSize = stepsLength[baseVectorIndex];
-                bool success = false;
-                bool moveMetConstraint = false;
+                moveMetConstraint = false;
                 bool bumped = false;
                 var sysConfig = (T)startingPoint.SystemConfiguration.Clone( );
                 var varnames = sysConfig.GetVariableNames( );
@@ -278,7 +430,12 @@ namespace CSIRO.Metaheuristics.Optimization
                     if( bumped )
                         moveMetConstraint = true;
                 }
-                IObjectiveScores<T> candidatePoint = evaluate( sysConfig );
+                return sysConfig;
+            }
+
+            private IObjectiveScores<T> acceptMove( int baseVectorIndex, IObjectiveScores<T> startingPoint, IObjectiveScores<T> candidatePoint, bool moveMetConstraint )
+            {
+                bool success = false;
                 var compareResult = compareObjScores( candidatePoint, startingPoint );
                 success = compareResult <= 0;
                 var result = success ? candidatePoint : startingPoint;
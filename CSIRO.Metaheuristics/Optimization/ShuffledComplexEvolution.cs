@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Globalization;
 using System.Linq;
 using System.Text;
 using CSIRO.Metaheuristics.Fitness;
@@ -9,6 +10,8 @@ using CSIRO.Metaheuristics.Logging;
 using CSIRO.Metaheuristics.CandidateFactories;
 using CSIRO.Metaheuristics.RandomNumberGenerators;
 using System.Diagnostics;
+using System.IO;
+using System.Collections.Concurrent;
 using CSIRO.Metaheuristics.Utils;
 using CSIRO.Metaheuristics.Objectives;
 
@@ -86,14 +89,18 @@ namespace CSIRO.Metaheuristics.Optimization
         None = 0x00,
         ReflectionRandomization = 0x01,
         RndInSubComplex = 0x02,
-        FutureOption_1 = 0x04,
+        /// <summary>
+        /// Generate the reflected, contracted and random candidates of a complex evolution step up front 
+        /// and evaluate them in one batch, if the evaluator is an <see cref="IBatchObjectiveEvaluator{T}"/>.
+        /// </summary>
+        SpeculativeBatchEvaluation = 0x04,
         FutureOption_2 = 0x08
     }
 
 
     // TODO: should there be a further type constraint such that T can only be a HyperCube? 
     // problem is that the HyperCube is generic itself, makes things complex
-    public class ShuffledComplexEvolution<T> : IEvolutionEngine<T>, IPopulation<double>
+    public class ShuffledComplexEvolution<T> : IEvolutionEngine<T>, IPopulation<double>, IInstrumentedEngine
         where T : ICloneableSystemConfiguration
     {
         public ShuffledComplexEvolution(IClonableObjectiveEvaluator<T> evaluator,
@@ -141,6 +148,9 @@ namespace CSIRO.Metaheuristics.Optimization
                 throw new ArgumentException("Q must be less than or equal to M");
 
             this.evaluator = evaluator;
+            // The clones of the evaluator given to complexes are reused from one shuffle to the next, and discarded at the end of Evolve.
+            if (evaluator.SupportsThreadSafeCloning)
+                this.evaluatorPool = Evaluations.GetPool(evaluator);
             this.populationInitializer = populationInitializer;
             this.terminationCondition = terminationCondition;
             if (this.terminationCondition == null)
@@ -168,6 +178,7 @@ namespace CSIRO.Metaheuristics.Optimization
 
         IDictionary<string, string> logTags = null;
         IClonableObjectiveEvaluator<T> evaluator;
+        EvaluatorPool<T> evaluatorPool = null;
         ICandidateFactory<T> populationInitializer;
         ITerminationCondition<T> terminationCondition;
         IRandomNumberGeneratorFactory rng;
@@ -181,6 +192,15 @@ namespace CSIRO.Metaheuristics.Optimization
             set { logger = value; }
         }
 
+        private readonly EngineMetrics metrics = new EngineMetrics();
+        /// <summary>
+        /// Gets the timings of the phases of this optimiser, per thread and per complex. Complexes are indexed by their position in a shuffle.
+        /// </summary>
+        public EngineMetrics Metrics
+        {
+            get { return metrics; }
+        }
+
         int pmin = 5;
         int p = 5, m = 27, q = 14, alpha = 3, beta = 27;
         int numShuffle = -1;
@@ -211,7 +231,14 @@ namespace CSIRO.Metaheuristics.Optimization
             #endregion
         }
 
-        public class MarginalImprovementTerminationCondition : MaxWalltimeCheck, ITerminationCondition<T>
+        /// <summary>
+        /// Terminates when the fitness of the best point has not improved by more than a relative tolerance for a number of successive populations.
+        /// </summary>
+        /// <remarks>
+        /// With an engine reporting its populations, such as <see cref="ShuffledComplexEvolution{T}"/>, each population is counted once,
+        /// and <see cref="IsFinished"/> only reads the count. Otherwise each call to <see cref="IsFinished"/> inspects the current population of the engine.
+        /// </remarks>
+        public class MarginalImprovementTerminationCondition : MaxWalltimeCheck, ITerminationCondition<T>, ICheckpointableTerminationCondition, IIncrementalTerminationCondition
         {
             public MarginalImprovementTerminationCondition(double maxHours, double tolerance, int cutoffNoImprovement)
                 : base(maxHours)
@@ -231,23 +258,41 @@ namespace CSIRO.Metaheuristics.Optimization
             double tolerance = 1e-6;
             int converge = 0;
             int maxConverge = 10;
+            // Whether the engine reports its populations with OnPopulationChanged, rather than being polled.
+            bool receivesUpdates = false;
+
             public bool IsFinished()
+            {
+                if (this.HasReachedMaxTime())
+                    return true;
+                if (!receivesUpdates)
+                {
+                    FitnessAssignedScores<double>[] currentPopulation = algorithm.Population;
+                    if (currentPopulation == null)
+                        return false;
+                    update(currentPopulation.First().FitnessValue);
+                }
+                return converge > maxConverge;
+            }
+
+            public void OnPopulationChanged(FitnessAssignedScores<double>[] sortedPopulation)
+            {
+                receivesUpdates = true;
+                if (sortedPopulation == null || sortedPopulation.Length == 0)
+                    return;
+                update(sortedPopulation[0].FitnessValue);
+            }
+
+            private void update(double currentBest)
             {
                 // https://jira.csiro.au/browse/WIRADA-129
 //current SWIFT SCE implementation uses this algorithm to define convergence and it normally guarantees 
 // reproducible optimum is found. It needs two parameters, Tolerance (normally of the order of 10e-6) 
 // and maxConverge (normally of the order of 10)
-
-                if (this.HasReachedMaxTime())
-                    return true;
-                FitnessAssignedScores<double>[] currentPopulation = algorithm.Population;
-                if (currentPopulation == null)
-                    return false;
-                var currentBest = currentPopulation.First().FitnessValue;
                 if (double.IsNaN(oldBest))
                 {
                     oldBest = currentBest; 
-                    return false;
+                    return;
                 }
                 if (Math.Abs(currentBest - oldBest) <= Math.Abs(oldBest * tolerance))
                 {
@@ -258,17 +303,35 @@ namespace CSIRO.Metaheuristics.Optimization
                     converge = 0;
                 }
                 oldBest = currentBest;
-                if (converge > maxConverge) return true;
-                return false;
+            }
+
+            public void WriteState(BinaryWriter writer)
+            {
+                WriteElapsed(writer);
+                writer.Write(oldBest);
+                writer.Write(converge);
+                writer.Write(receivesUpdates);
+            }
+
+            public void ReadState(BinaryReader reader)
+            {
+                ReadElapsed(reader);
+                oldBest = reader.ReadDouble();
+                converge = reader.ReadInt32();
+                receivesUpdates = reader.ReadBoolean();
             }
         }
 
-        public class CoefficientOfVariationTerminationCondition : ITerminationCondition<T>
+        public class CoefficientOfVariationTerminationCondition : ITerminationCondition<T>, ICheckpointableTerminationCondition
         {
             private ShuffledComplexEvolution<T> algorithm;
             private double threshold;
             private double maxHours;
             private Stopwatch stopWatch;
+            private TimeSpan previouslyElapsed = TimeSpan.Zero;
+            // The population at the shuffle last tested, and the result; the population only changes at shuffles.
+            private FitnessAssignedScores<double>[] testedPopulation = null;
+            private bool testedBelowThreshold = false;
             // FIXME: consider something where the termination criteria is customizable to an extent.
             // private Func<double[], double> statistic;
 
@@ -291,33 +354,41 @@ namespace CSIRO.Metaheuristics.Optimization
                     return true;
                 if (algorithm.numShuffle >= 0 && algorithm.CurrentShuffle >= algorithm.numShuffle)
                     return true;
-                if (algorithm.PopulationAtShuffling == null)
+                var population = algorithm.PopulationAtShuffling;
+                if (population == null)
                     return false; // start of the algorithm.
-                int n = (int) Math.Ceiling(algorithm.PopulationAtShuffling.Length/2.0);
-                var tmp = algorithm.PopulationAtShuffling.Where((x, i) => i < n).ToArray();
-                var popToTest = Array.ConvertAll<FitnessAssignedScores<double>, IObjectiveScores>(tmp, (x => x.Scores));
-                return IsBelowCvThreshold(popToTest);
+                if (!object.ReferenceEquals(population, testedPopulation))
+                {
+                    int n = (int)Math.Ceiling(population.Length / 2.0);
+                    var popToTest = new IObjectiveScores[n];
+                    for (int i = 0; i < n; i++)
+                        popToTest[i] = population[i].Scores;
+                    testedBelowThreshold = IsBelowCvThreshold(popToTest);
+                    testedPopulation = population;
+                }
+                return testedBelowThreshold;
             }
 
             public double GetMaxParameterCoeffVar(IObjectiveScores[] population)
             {
                 var pSets = ConvertAllToHyperCube(population);
                 var varNames = pSets[0].GetVariableNames();
-                double[] coeffVar = new double[varNames.Length];
+                var statistics = new RunningStatistics();
+                double result = double.NegativeInfinity;
                 for (int i = 0; i < varNames.Length; i++)
                 {
-                    coeffVar[i] = calcCoeffVar(MetaheuristicsHelper.GetValues(pSets, varNames[i]));
+                    statistics.Reset();
+                    for (int j = 0; j < pSets.Length; j++)
+                        statistics.Add(pSets[j].GetValue(varNames[i]));
+                    result = Math.Max(result, calcCoeffVar(statistics));
                 }
-                return MetaheuristicsHelper.GetMaximum(coeffVar);
+                return result;
             }
 
-            private double calcCoeffVar(double[] p)
+            private double calcCoeffVar(RunningStatistics statistics)
             {
-                double sum = p.Sum();
-                double mean = sum / p.Length;
-                double[] diffsMean = Array.ConvertAll(p, x => x - mean);
-                double sumSqrDiffs = Array.ConvertAll(diffsMean, x => x * x).Sum();
-                double sdev = Math.Sqrt(sumSqrDiffs / (p.Length - 1));
+                double mean = statistics.Mean;
+                double sdev = statistics.StandardDeviation;
                 if (mean == 0)
                     if (sdev == 0) return 0;
                     else return double.PositiveInfinity;
@@ -333,7 +404,7 @@ namespace CSIRO.Metaheuristics.Optimization
 
             public bool HasReachedMaxTime()
             {
-                double hoursElapsed = this.stopWatch.Elapsed.TotalHours;
+                double hoursElapsed = elapsed.TotalHours;
                 if (this.maxHours <= 0)
                     return true;
                 else if (this.maxHours < hoursElapsed)
@@ -346,9 +417,25 @@ namespace CSIRO.Metaheuristics.Optimization
             {
                 get
                 {
-                    return this.maxHours - this.stopWatch.Elapsed.TotalHours;
+                    return this.maxHours - elapsed.TotalHours;
                 }
             }
+
+            private TimeSpan elapsed
+            {
+                get { return previouslyElapsed + stopWatch.Elapsed; }
+            }
+
+            public void WriteState(BinaryWriter writer)
+            {
+                writer.Write(elapsed.Ticks);
+            }
+
+            public void ReadState(BinaryReader reader)
+            {
+                previouslyElapsed = TimeSpan.FromTicks(reader.ReadInt64());
+                stopWatch.Restart();
+            }
         }
 
         public class FalseTerminationCondition : ITerminationCondition<T>
@@ -368,6 +455,8 @@ namespace CSIRO.Metaheuristics.Optimization
         {
             private double maxHours;
             private Stopwatch stopWatch;
+            // The time elapsed before the optimisation was resumed from a checkpoint
+            private TimeSpan previouslyElapsed = TimeSpan.Zero;
 
             protected MaxWalltimeCheck(double maxHours)
             {
@@ -380,12 +469,23 @@ namespace CSIRO.Metaheuristics.Optimization
             {
                 if (this.maxHours <= 0)
                     return false;
-                double hoursElapsed = this.stopWatch.Elapsed.TotalHours;
+                double hoursElapsed = (previouslyElapsed + this.stopWatch.Elapsed).TotalHours;
                 return (this.maxHours < hoursElapsed);
             }
+
+            protected void WriteElapsed(BinaryWriter writer)
+            {
+                writer.Write((previouslyElapsed + stopWatch.Elapsed).Ticks);
+            }
+
+            protected void ReadElapsed(BinaryReader reader)
+            {
+                previouslyElapsed = TimeSpan.FromTicks(reader.ReadInt64());
+                stopWatch.Restart();
+            }
         }
 
-        public class MaxWalltimeTerminationCondition : MaxWalltimeCheck, ITerminationCondition<T>
+        public class MaxWalltimeTerminationCondition : MaxWalltimeCheck, ITerminationCondition<T>, ICheckpointableTerminationCondition
         {
             public MaxWalltimeTerminationCondition(double maxHours) : base(maxHours)
             {
@@ -399,6 +499,16 @@ namespace CSIRO.Metaheuristics.Optimization
             {
                 return this.HasReachedMaxTime();
             }
+
+            public void WriteState(BinaryWriter writer)
+            {
+                WriteElapsed(writer);
+            }
+
+            public void ReadState(BinaryReader reader)
+            {
+                ReadElapsed(reader);
+            }
         }
 
 
@@ -423,8 +533,23 @@ namespace CSIRO.Metaheuristics.Optimization
         }
         private ParallelOptions parallelOptions = new ParallelOptions();
 
+        /// <summary>
+        /// Gets or sets whether the complexes are shuffled incrementally, rather than all together once every complex has evolved.
+        /// </summary>
+        /// <remarks>
+        /// Only used if the evaluator supports thread safe cloning. Each complex then evolves in its own task, 
+        /// and complexes that complete their evolution are shuffled with each other without waiting for the slowest complex.
+        /// Every time the number of completed complex evolutions reaches the number of complexes, this counts as one shuffle
+        /// for logging and the termination condition. The results depend on the scheduling of the tasks and are not reproducible.
+        /// </remarks>
+        public bool AsynchronousShuffling { get; set; }
+        private bool evolvingAsynchronously = false;
+
         private bool isCancelled = false;
         private IComplex currentComplex;
+        // The complexes evolving asynchronously, told to stop at their next step when the optimisation is cancelled or terminated
+        private readonly HashSet<IComplex> evolvingComplexes = new HashSet<IComplex>();
+        private bool stopEvolvingComplexes = false;
 
         private CancellationTokenSource tokenSource = new CancellationTokenSource( );
         private SceOptions options = SceOptions.None;
@@ -438,27 +563,80 @@ namespace CSIRO.Metaheuristics.Optimization
             isCancelled = true;
             if( currentComplex != null )
                 currentComplex.IsCancelled = isCancelled;
+            stopComplexes( );
             tokenSource.Cancel( );
         }
 
+        private void stopComplexes( )
+        {
+            lock( evolvingComplexes )
+            {
+                stopEvolvingComplexes = true;
+                foreach( var c in evolvingComplexes )
+                    c.IsCancelled = true;
+            }
+        }
+
         public IOptimizationResults<T> Evolve( )
+        {
+            long start = metrics.Start();
+            try
+            {
+                return evolve();
+            }
+            finally
+            {
+                if (evaluatorPool != null)
+                    evaluatorPool.Clear();
+                metrics.Stop(EnginePhase.Run, start);
+            }
+        }
+
+        private IOptimizationResults<T> evolve( )
         {
             isCancelled = false;
-            IObjectiveScores[] scores = evaluateScores( evaluator, initialisePopulation( ) );
-            loggerWrite(scores, createSimpleMsg("Initial Population", "Initial Population"));
-            var isFinished = terminationCondition.IsFinished();
-            if (isFinished)
+            if( tokenSource.IsCancellationRequested )
+                tokenSource = new CancellationTokenSource( );
+            bool isFinished;
+            checkpointWatch = Stopwatch.StartNew();
+            if (resumedPopulation != null)
             {
-                logTerminationConditionMet();
-                return packageResults(scores);
+                // The state of this engine was restored by ResumeFrom, as it was just before partitioning into complexes
+                var population = resumedPopulation;
+                resumedPopulation = null;
+                this.complexes = partition(population);
+                // The termination condition was told of the population of a shuffle before its checkpoint, but not of the initial one
+                if (CurrentShuffle == 0)
+                    notifyPopulation(population);
+                CurrentShuffle++;
             }
-            this.complexes = partition(scores);
+            else
+            {
+                IObjectiveScores[] scores = evaluateScores( evaluator, initialisePopulation( ) );
+                loggerWrite(scores, createSimpleMsg("Initial Population", "Initial Population"));
+                isFinished = terminationCondition.IsFinished();
+                if (isFinished)
+                {
+                    logTerminationConditionMet();
+                    return packageResults(scores);
+                }
+                var population = sortByFitness(scores);
+                checkpoint(population);
+                this.complexes = partition(population);
+                notifyPopulation(population);
 
-            //OnAdvanced( new ComplexEvolutionEvent( complexes ) );
+                //OnAdvanced( new ComplexEvolutionEvent( complexes ) );
 
-            CurrentShuffle = 1;
+                CurrentShuffle = 1;
+            }
             isFinished = terminationCondition.IsFinished( );
             if(isFinished) logTerminationConditionMet();
+            if (!isFinished && AsynchronousShuffling && evaluator.SupportsThreadSafeCloning)
+            {
+                this.complexes = evolveAsynchronously(complexes);
+                releaseEvaluators(complexes);
+                return packageResults(complexes);
+            }
             while (!isFinished && !isCancelled)
             {
                 if( evaluator.SupportsThreadSafeCloning )
@@ -476,20 +654,349 @@ namespace CSIRO.Metaheuristics.Optimization
                     }
                 }
                 //OnAdvanced( new ComplexEvolutionEvent( complexes ) );
-                var shuffleMsg = "Shuffling No " + CurrentShuffle.ToString("D3");
-                var shufflePoints = aggregate(complexes);
-                loggerWrite(shufflePoints, createSimpleMsg(shuffleMsg, shuffleMsg));
-                this.PopulationAtShuffling = sortByFitness(shufflePoints);
-                loggerWrite(PopulationAtShuffling.First(), createSimpleMsg("Best point in shuffle", shuffleMsg));
-                complexes = shuffle(complexes);
+                logShuffle(aggregate(complexes));
+                releaseEvaluators(complexes);
+                if (!isCancelled)
+                    checkpoint(PopulationAtShuffling);
+                // The population is already sorted for the logging and termination condition; no need to assign fitness twice.
+                complexes = partition(PopulationAtShuffling);
 
                 CurrentShuffle++;
                 isFinished = terminationCondition.IsFinished();
                 if (isFinished) logTerminationConditionMet();
             }
+            releaseEvaluators(complexes);
             return packageResults(complexes);
         }
 
+        /// <summary>
+        /// Gets or sets the file to which the state of this optimiser is periodically saved, or null (the default) for no checkpoints.
+        /// </summary>
+        /// <remarks>
+        /// The state is saved just before the population is partitioned into complexes, i.e. after the initial population is evaluated
+        /// and after each shuffle, so that <see cref="ResumeFrom"/> followed by <see cref="Evolve"/> carries on exactly as the interrupted optimisation would have.
+        /// A checkpoint holds the population with its fitness and objective values, the number of complexes, the current shuffle, 
+        /// the state of the random number generator factory of this optimiser, which must implement <see cref="ICheckpointableRandomFactory"/>, 
+        /// and the state of the termination condition if it implements <see cref="ICheckpointableTerminationCondition"/>.
+        /// The file is replaced in one operation, so that a process interrupted while saving leaves the previous checkpoint intact.
+        /// With <see cref="AsynchronousShuffling"/> only the initial population is saved, as the complexes never all wait for a shuffle.
+        /// </remarks>
+        public string CheckpointFileName { get; set; }
+
+        /// <summary>
+        /// Gets or sets the minimum time between two checkpoints; the default, zero, saves the state at every shuffle.
+        /// </summary>
+        public TimeSpan CheckpointInterval { get; set; }
+
+        private Stopwatch checkpointWatch;
+        private FitnessAssignedScores<double>[] resumedPopulation = null;
+
+        internal static readonly byte[] CheckpointMagic = Encoding.ASCII.GetBytes("MHSCECKP");
+        internal const int CheckpointFormatVersion = 1;
+
+        /// <summary>
+        /// Restores the state of this optimiser saved in a checkpoint file; the next call to <see cref="Evolve"/> resumes the optimisation.
+        /// </summary>
+        /// <remarks>
+        /// This optimiser must be created with the same evaluator, population initialiser, and parameters as the one that wrote the checkpoint. 
+        /// The points are recreated from a candidate of the population initialiser, with the values and bounds saved, and the scores 
+        /// with the saved objective values as <see cref="DoubleObjectiveScore"/>s.
+        /// The state of a termination condition is restored if of the same type as the one saved.
+        /// </remarks>
+        /// <param name="fileName">A checkpoint file written by an optimiser with a <see cref="CheckpointFileName"/></param>
+        /// <exception cref="InvalidDataException">The file is not a checkpoint of a compatible optimiser</exception>
+        public void ResumeFrom(string fileName)
+        {
+            var rngState = getCheckpointableRng();
+            using (var reader = new BinaryReader(File.OpenRead(fileName), Encoding.UTF8))
+            {
+                var magic = reader.ReadBytes(CheckpointMagic.Length);
+                if (!magic.SequenceEqual(CheckpointMagic))
+                    throw new InvalidDataException("Not a checkpoint of a shuffled complex evolution: " + fileName);
+                int version = reader.ReadInt32();
+                if (version != CheckpointFormatVersion)
+                    throw new InvalidDataException(string.Format("Unsupported checkpoint format version {0} in {1}", version, fileName));
+                int savedM = reader.ReadInt32();
+                if (savedM != this.m)
+                    throw new InvalidDataException(string.Format("The checkpoint has {0} points per complex, but this optimiser {1}", savedM, this.m));
+                int savedP = reader.ReadInt32();
+                int savedSeed = reader.ReadInt32();
+                int savedShuffle = reader.ReadInt32();
+                rngState.ReadState(reader);
+                var terminationType = reader.ReadString();
+                var terminationState = reader.ReadBytes(reader.ReadInt32());
+                var population = readPopulation(reader);
+                if (population.Length < savedP * this.m)
+                    throw new InvalidDataException(string.Format("The checkpoint has {0} points, too few for {1} complexes", population.Length, savedP));
+
+                this.p = savedP;
+                this.seed = savedSeed;
+                this.CurrentShuffle = savedShuffle;
+                var t = terminationCondition as ICheckpointableTerminationCondition;
+                if (t != null && terminationCondition.GetType().FullName == terminationType)
+                {
+                    using (var stateReader = new BinaryReader(new MemoryStream(terminationState)))
+                        t.ReadState(stateReader);
+                }
+                this.PopulationAtShuffling = (savedShuffle > 0 ? population : null);
+                this.resumedPopulation = population;
+            }
+            var msg = string.Format("Resumed from {0} at shuffle {1}", fileName, CurrentShuffle.ToString("D3"));
+            loggerWrite(msg, createSimpleMsg(msg, "Checkpoint"));
+        }
+
+        private ICheckpointableRandomFactory getCheckpointableRng()
+        {
+            var result = rng as ICheckpointableRandomFactory;
+            if (result == null)
+                throw new NotSupportedException("Checkpoints need a random number generator factory implementing ICheckpointableRandomFactory, but this optimiser has a " + rng.GetType().Name);
+            return result;
+        }
+
+        private void checkpoint(FitnessAssignedScores<double>[] sortedPopulation)
+        {
+            if (string.IsNullOrEmpty(CheckpointFileName))
+                return;
+            if (checkpointWatch.Elapsed < CheckpointInterval)
+                return;
+            var rngState = getCheckpointableRng();
+            var temp = CheckpointFileName + ".tmp";
+            using (var writer = new BinaryWriter(File.Create(temp), Encoding.UTF8))
+            {
+                writer.Write(CheckpointMagic);
+                writer.Write(CheckpointFormatVersion);
+                writer.Write(m);
+                writer.Write(p);
+                writer.Write(seed);
+                writer.Write(CurrentShuffle);
+                rngState.WriteState(writer);
+                writer.Write(terminationCondition.GetType().FullName);
+                var t = terminationCondition as ICheckpointableTerminationCondition;
+                var terminationState = new MemoryStream();
+                if (t != null)
+                {
+                    using (var stateWriter = new BinaryWriter(terminationState))
+                        t.WriteState(stateWriter);
+                }
+                var bytes = terminationState.ToArray();
+                writer.Write(bytes.Length);
+                writer.Write(bytes);
+                writePopulation(writer, sortedPopulation);
+            }
+            if (File.Exists(CheckpointFileName))
+                File.Replace(temp, CheckpointFileName, null);
+            else
+                File.Move(temp, CheckpointFileName);
+            checkpointWatch.Restart();
+        }
+
+        private static void writePopulation(BinaryWriter writer, FitnessAssignedScores<double>[] population)
+        {
+            // The names of the variables and objectives, shared by all points, are written once.
+            var first = population[0].Scores;
+            var varNames = ((IHyperCube<double>)first.GetSystemConfiguration()).GetVariableNames();
+            writer.Write(varNames.Length);
+            foreach (var name in varNames)
+                writer.Write(name);
+            writer.Write(first.ObjectiveCount);
+            for (int j = 0; j < first.ObjectiveCount; j++)
+            {
+                var objective = first.GetObjective(j);
+                writer.Write(objective.Name);
+                writer.Write(objective.Maximise);
+            }
+            writer.Write(population.Length);
+            foreach (var point in population)
+            {
+                writer.Write(point.FitnessValue);
+                var hc = (IHyperCube<double>)point.Scores.GetSystemConfiguration();
+                foreach (var name in varNames)
+                {
+                    writer.Write(hc.GetValue(name));
+                    writer.Write(hc.GetMinValue(name));
+                    writer.Write(hc.GetMaxValue(name));
+                }
+                for (int j = 0; j < first.ObjectiveCount; j++)
+                    writer.Write(Convert.ToDouble(point.Scores.GetObjective(j).ValueComparable, CultureInfo.InvariantCulture));
+            }
+        }
+
+        private FitnessAssignedScores<double>[] readPopulation(BinaryReader reader)
+        {
+            var varNames = new string[reader.ReadInt32()];
+            for (int i = 0; i < varNames.Length; i++)
+                varNames[i] = reader.ReadString();
+            var objNames = new string[reader.ReadInt32()];
+            var maximise = new bool[objNames.Length];
+            for (int j = 0; j < objNames.Length; j++)
+            {
+                objNames[j] = reader.ReadString();
+                maximise[j] = reader.ReadBoolean();
+            }
+            var template = populationInitializer.CreateRandomCandidate();
+            var templateNames = ((IHyperCube<double>)template).GetVariableNames();
+            if (templateNames.Length != varNames.Length || templateNames.Except(varNames).Any())
+                throw new InvalidDataException("The variables of the checkpoint differ from those of the candidates of the population initialiser");
+            var result = new FitnessAssignedScores<double>[reader.ReadInt32()];
+            for (int i = 0; i < result.Length; i++)
+            {
+                double fitness = reader.ReadDouble();
+                T point = (T)template.Clone();
+                var hc = (IHyperCube<double>)point;
+                var bounded = hc as IHyperCubeSetBounds<double>;
+                foreach (var name in varNames)
+                {
+                    double value = reader.ReadDouble();
+                    double min = reader.ReadDouble();
+                    double max = reader.ReadDouble();
+                    if (bounded != null)
+                        bounded.SetMinMaxValue(name, min, max, value);
+                    else
+                        hc.SetValue(name, value);
+                }
+                var objectives = new IObjectiveScore[objNames.Length];
+                for (int j = 0; j < objectives.Length; j++)
+                    objectives[j] = new DoubleObjectiveScore(objNames[j], reader.ReadDouble(), maximise[j]);
+                result[i] = new FitnessAssignedScores<double>(new MultipleScores<T>(objectives, point), fitness);
+            }
+            return result;
+        }
+
+        private void logShuffle(IObjectiveScores[] shufflePoints)
+        {
+            var shuffleMsg = "Shuffling No " + CurrentShuffle.ToString("D3");
+            loggerWrite(shufflePoints, createSimpleMsg(shuffleMsg, shuffleMsg));
+            this.PopulationAtShuffling = sortByFitness(shufflePoints);
+            loggerWrite(PopulationAtShuffling.First(), createSimpleMsg("Best point in shuffle", shuffleMsg));
+            notifyPopulation(PopulationAtShuffling);
+        }
+
+        private void notifyPopulation(FitnessAssignedScores<double>[] sortedPopulation)
+        {
+            var t = terminationCondition as IIncrementalTerminationCondition;
+            if (t != null)
+                t.OnPopulationChanged(sortedPopulation);
+        }
+
+        /// <summary>
+        /// Evolves the complexes as independent tasks until the termination condition is met, 
+        /// shuffling together complexes as soon as at least two of them are idle.
+        /// </summary>
+        /// <remarks>
+        /// The tasks run on the scheduler of the parallel options. Once the optimisation is cancelled, or the termination condition met, 
+        /// the complexes still evolving stop at their next step, and those not started yet are not evolved.
+        /// </remarks>
+        /// <returns>The complexes at termination</returns>
+        private IComplex[] evolveAsynchronously(IComplex[] complexes)
+        {
+            int maxRunning = (MaxDegreeOfParallelism > 0 ? MaxDegreeOfParallelism : int.MaxValue);
+            var scheduler = parallelOptions.TaskScheduler ?? TaskScheduler.Default;
+            var completed = new BlockingCollection<IComplex>();
+            var errors = new ConcurrentQueue<Exception>();
+            // The points of the complexes as last seen from this thread; a complex must not be queried while it evolves.
+            var lastKnownPoints = new Dictionary<IComplex, IObjectiveScores[]>();
+            foreach (var c in complexes)
+                lastKnownPoints[c] = c.GetObjectiveScores().ToArray();
+            var ready = new Queue<IComplex>(complexes);
+            var idle = new List<IComplex>();
+            int running = 0;
+            int evolutionsSinceShuffle = 0;
+            bool reductionPending = false;
+            bool isFinished = false;
+            evolvingAsynchronously = true;
+            lock (evolvingComplexes)
+                stopEvolvingComplexes = false;
+            var cancellation = CancellationTokenSource.CreateLinkedTokenSource(tokenSource.Token, parallelOptions.CancellationToken);
+            var stopOnCancel = cancellation.Token.Register(stopComplexes);
+            try
+            {
+                while (true)
+                {
+                    bool stopping = isFinished || isCancelled || cancellation.IsCancellationRequested || !errors.IsEmpty;
+                    if (stopping)
+                        stopComplexes();
+                    while (!stopping && running < maxRunning && ready.Count > 0)
+                    {
+                        var c = ready.Dequeue();
+                        running++;
+                        lock (evolvingComplexes)
+                        {
+                            evolvingComplexes.Add(c);
+                            c.IsCancelled = stopEvolvingComplexes;
+                        }
+                        // The continuation also runs if the task is cancelled before it starts
+                        Task.Factory.StartNew(() =>
+                        {
+                            try { c.Evolve(); }
+                            catch (Exception e) { errors.Enqueue(e); }
+                        }, cancellation.Token, TaskCreationOptions.None, scheduler)
+                        .ContinueWith(t => completed.Add(c), CancellationToken.None, TaskContinuationOptions.ExecuteSynchronously, TaskScheduler.Default);
+                    }
+                    if (running == 0)
+                        break;
+                    var done = completed.Take();
+                    running--;
+                    lock (evolvingComplexes)
+                        evolvingComplexes.Remove(done);
+                    lastKnownPoints[done] = done.GetObjectiveScores().ToArray();
+                    idle.Add(done);
+                    if (stopping)
+                        continue; // draining the complexes still evolving.
+
+                    evolutionsSinceShuffle++;
+                    if (evolutionsSinceShuffle >= lastKnownPoints.Count)
+                    {
+                        evolutionsSinceShuffle = 0;
+                        logShuffle(lastKnownPoints.Values.SelectMany(x => x).ToArray());
+                        CurrentShuffle++;
+                        isFinished = terminationCondition.IsFinished();
+                        if (isFinished)
+                        {
+                            logTerminationConditionMet();
+                            continue;
+                        }
+                        // Same reduction of the number of complexes as the synchronous shuffle, applied at the next local shuffle.
+                        if (this.pmin < this.p)
+                            reductionPending = true;
+                    }
+                    if (idle.Count < 2 && running > 0)
+                        continue;
+                    var points = new List<IObjectiveScores>();
+                    foreach (var c in idle)
+                    {
+                        points.AddRange(lastKnownPoints[c]);
+                        lastKnownPoints.Remove(c);
+                    }
+                    int numComplexes = idle.Count;
+                    if (reductionPending && numComplexes > 1)
+                    {
+                        // The worst points are left out of the new, fewer, complexes.
+                        numComplexes--;
+                        this.p = this.p - 1;
+                        reductionPending = false;
+                    }
+                    releaseEvaluators(idle);
+                    idle.Clear();
+                    foreach (var c in partition(sortByFitness(points.ToArray()), numComplexes))
+                    {
+                        lastKnownPoints[c] = c.GetObjectiveScores().ToArray();
+                        ready.Enqueue(c);
+                    }
+                }
+            }
+            finally
+            {
+                evolvingAsynchronously = false;
+                stopOnCancel.Dispose();
+                cancellation.Dispose();
+                lock (evolvingComplexes)
+                    evolvingComplexes.Clear();
+            }
+            if (!errors.IsEmpty)
+                throw new AggregateException(errors);
+            return lastKnownPoints.Keys.ToArray();
+        }
+
         private static IOptimizationResults<T> packageResults(IComplex[] complexes)
         {
             //saveLog( logPopulation, fullLogFileName );
@@ -517,19 +1024,31 @@ namespace CSIRO.Metaheuristics.Optimization
 
         private void loggerWrite(string infoMsg, IDictionary<string, string> tags)
         {
+            if (logger == null)
+                return;
+            long start = metrics.Start();
             LoggerMhHelper.Write(infoMsg, tags, logger);
+            metrics.Stop(EnginePhase.Logging, start);
         }
 
         private void loggerWrite(IObjectiveScores[] scores, IDictionary<string, string> tags)
         {
+            if (logger == null)
+                return;
+            long start = metrics.Start();
             tags = LoggerMhHelper.MergeDictionaries(logTags, tags);
             LoggerMhHelper.Write(scores, tags, logger);
+            metrics.Stop(EnginePhase.Logging, start);
         }
 
         private void loggerWrite(FitnessAssignedScores<double> scores, IDictionary<string, string> tags)
         {
+            if (logger == null)
+                return;
+            long start = metrics.Start();
             tags = LoggerMhHelper.MergeDictionaries(logTags, tags);
             LoggerMhHelper.Write(scores, tags, logger);
+            metrics.Stop(EnginePhase.Logging, start);
         }
 
 
@@ -553,13 +1072,6 @@ namespace CSIRO.Metaheuristics.Optimization
             bool IsCancelled { get; set; }
         }
 
-        private IComplex[] shuffle( IComplex[] complexes )
-        {
-            IObjectiveScores[] population = aggregate( complexes );
-            IComplex[] newComplexes = partition( population );
-            return newComplexes;
-        }
-
         private static IObjectiveScores[] aggregate( IComplex[] complexes )
         {
             List<IObjectiveScores> scores = new List<IObjectiveScores>( );
@@ -571,52 +1083,76 @@ namespace CSIRO.Metaheuristics.Optimization
 
         private IObjectiveScores[] evaluateScores( IClonableObjectiveEvaluator<T> evaluator, T[] population )
         {
-            return Evaluations.EvaluateScores(evaluator, population, () => (this.isCancelled || terminationCondition.IsFinished()), parallelOptions);
+            return Evaluations.EvaluateScores(evaluator, population, () => (this.isCancelled || terminationCondition.IsFinished()), parallelOptions, metrics);
         }
 
         private T[] initialisePopulation( )
         {
-            T[] result = new T[p * m];
-            for( int i = 0; i < result.Length; i++ )
-                result[i] = populationInitializer.CreateRandomCandidate( );
-            return result;
+            return Sampling.CreateRandomCandidates( populationInitializer, p * m );
         }
 
         private IComplex[] partition( FitnessAssignedScores<double>[] sortedScores )
         {
-            List<IComplex> result = new List<IComplex>( );
             if (CurrentShuffle > 0)
                 if (this.pmin < this.p)
                     this.p = this.p - 1;
-            for( int a = 0; a < p; a++ )
+            return partition( sortedScores, p );
+        }
+
+        private IComplex[] partition( FitnessAssignedScores<double>[] sortedScores, int numComplexes )
+        {
+            long start = metrics.Start();
+            List<IComplex> result = new List<IComplex>( );
+            for( int a = 0; a < numComplexes; a++ )
             {
                 List<FitnessAssignedScores<double>> sample = new List<FitnessAssignedScores<double>>( );
                 for( int k = 1; k <= m; k++ )
-                    sample.Add( sortedScores[a + p * ( k - 1 )] );
+                    sample.Add( sortedScores[a + numComplexes * ( k - 1 )] );
                 IObjectiveScores[] scores = getScores( sample.ToArray( ) );
                 seed++;
-                IComplex complex = createComplex(scores);
+                IComplex complex = createComplex(scores, a);
                 complex.ComplexId = CurrentShuffle.ToString("D3") + "_" + Convert.ToString(a + 1);
                 result.Add( complex );
             }
+            metrics.Stop(EnginePhase.Shuffling, start);
             return result.ToArray( );
         }
 
-        private IComplex createComplex( IObjectiveScores[] scores )
+        /// <summary>
+        /// Returns to the pool the evaluators of complexes that will not evolve any more.
+        /// </summary>
+        private void releaseEvaluators( IEnumerable<IComplex> complexes )
+        {
+            if( evaluatorPool == null )
+                return;
+            foreach( var c in complexes )
+            {
+                var complex = c as DefaultComplex;
+                if( complex != null )
+                    evaluatorPool.Return( complex.Evaluator as IClonableObjectiveEvaluator<T> );
+            }
+        }
+
+        private IComplex createComplex( IObjectiveScores[] scores, int index )
         {
             IHyperCubeOperationsFactory hyperCubeOperationsFactory = populationInitializer as IHyperCubeOperationsFactory;
             if( hyperCubeOperationsFactory == null )
                 throw new NotSupportedException( "Currently SCE uses an implementation of a 'complex' that needs a population initializer that implements IHyperCubeOperationsFactory" );
 
-            var loggerTags = LoggerMhHelper.MergeDictionaries( logTags, LoggerMhHelper.CreateTag( LoggerMhHelper.MkTuple("CurrentShuffle", this.CurrentShuffle.ToString("D3")))); 
+            // Complexes only write detailed information, per step of their evolution
+            IDictionary<string, string> loggerTags = null;
+            if( LoggerMhHelper.IsEnabled( logger, LoggerMhLevel.Detailed ) )
+                loggerTags = LoggerMhHelper.MergeDictionaries( logTags, LoggerMhHelper.CreateTag( LoggerMhHelper.MkTuple("CurrentShuffle", this.CurrentShuffle.ToString("D3")))); 
 
             var complex = new DefaultComplex( scores, m, q, alpha, beta,
-                (evaluator.SupportsThreadSafeCloning ? evaluator.Clone( ) : evaluator), 
+                (evaluator.SupportsThreadSafeCloning ? evaluatorPool.Rent( metrics ) : evaluator), 
                 rng.CreateFactory( ),
                 getFitnessAssignment( ), hyperCubeOperationsFactory.CreateNew( this.rng ), logger: this.logger,
                 tags: loggerTags, factorTrapezoidalPDF: this.trapezoidalPdfParam, 
                 options: this.options, reflectionRatio: this.ReflectionRatio, contractionRatio: this.ContractionRatio);
 
+            complex.Metrics = this.metrics;
+            complex.Index = index;
             complex.TerminationCondition = createMaxWalltimeCondition(this.terminationCondition);
             return complex;
         }
@@ -631,19 +1167,13 @@ namespace CSIRO.Metaheuristics.Optimization
                 return new MaxWalltimeTerminationCondition(t.RemainingHours);
         }
 
-        private IComplex[] partition( IObjectiveScores[] scores )
-        {
-            var sortedScores = sortByFitness( scores );
-            //logPoints( CurrentShuffle, sortedScores );
-            IComplex[] complexes = partition( sortedScores );
-            return complexes;
-        }
-
         private FitnessAssignedScores<double>[] sortByFitness( IObjectiveScores[] scores )
         {
+            long start = metrics.Start();
             IFitnessAssignment<double> assignment = getFitnessAssignment( );
             var fittedScores = assignment.AssignFitness( scores );
             Array.Sort( fittedScores );
+            metrics.Stop(EnginePhase.FitnessAssignment, start);
             return fittedScores;
         }
 
@@ -823,6 +1353,8 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private IDictionary<string, string> createTagConcat(params Tuple<string, string>[] tuples)
             {
+                if (logger == null)
+                    return null;
                 return LoggerMhHelper.MergeDictionaries(LoggerMhHelper.CreateTag(tuples), this.tags);
             }
 
@@ -849,25 +1381,61 @@ namespace CSIRO.Metaheuristics.Optimization
                 this.alpha = alpha;
                 this.beta = beta;
                 this.fitnessAssignment = fitnessAssignment;
+                this.pointwiseFitness = fitnessAssignment as IPointwiseFitnessAssignment<double>;
                 this.hyperCubeOps = hyperCubeOperations;
                 this.evaluator = evaluator;
-                this.logger = logger;
+                // All the messages of a complex are detailed ones; no point building their tags otherwise.
+                this.logger = (LoggerMhHelper.IsEnabled(logger, LoggerMhLevel.Detailed) ? logger : null);
                 this.tags = tags;
                 this.factorTrapezoidalPDF = factorTrapezoidalPDF;
                 initialiseDiscreteGenerator(rng.Next());
                 this.options = options;
                 this.ReflectionRatio = reflectionRatio;
                 this.ContractionRatio = contractionRatio;
+                if ((options & SceOptions.SpeculativeBatchEvaluation) == SceOptions.SpeculativeBatchEvaluation)
+                    this.batchEvaluator = evaluator as IBatchObjectiveEvaluator<T>;
             }
 
+            // Set only for the speculative evaluation of candidates; null otherwise, including if the evaluator cannot process batches.
+            IBatchObjectiveEvaluator<T> batchEvaluator = null;
+
+            // Set if the fitness of a point does not depend on the other points; the fitness of the points kept in 
+            // the subcomplex is then reused when a new point replaces the worst one.
+            IPointwiseFitnessAssignment<double> pointwiseFitness = null;
+            FitnessAssignedScores<double>[] withoutWorstPointFitness = null;
+
+            // Arrays reused from one step to the next, if the fitness is pointwise. The subcomplex without its worst point 
+            // is only reused without a logger, which may keep it. The candidate subcomplex replaces the current one, which is 
+            // no longer needed once its worst point is removed.
+            FitnessAssignedScores<double>[] complexFitnessBuffer = null;
+            FitnessAssignedScores<double>[] sortBuffer = null;
+            IObjectiveScores[] withoutWorstPointBuffer = null;
+            FitnessAssignedScores<double>[] candidateBuffer = null;
+
             IDictionary<string, string> tags;
             private double factorTrapezoidalPDF;
             private SceOptions options;
 
-            public bool IsCancelled { get; set; }
+            // Set by the thread of the optimiser while the complex evolves asynchronously
+            private volatile bool isCancelled = false;
+
+            public bool IsCancelled
+            {
+                get { return isCancelled; }
+                set { isCancelled = value; }
+            }
+
+            public IObjectiveEvaluator<T> Evaluator
+            {
+                get { return evaluator; }
+            }
 
             public ITerminationCondition<T> TerminationCondition;
 
+            // The metrics of the optimiser, and the position of this complex in its shuffle to break them down per complex
+            public EngineMetrics Metrics;
+            public int Index = -1;
+
             public bool IsFinished
             {
                 get
@@ -880,6 +1448,19 @@ namespace CSIRO.Metaheuristics.Optimization
             }
 
             public void Evolve( )
+            {
+                long start = Metrics.Start();
+                try
+                {
+                    evolve();
+                }
+                finally
+                {
+                    Metrics.Stop(EnginePhase.ComplexEvolution, start, Index);
+                }
+            }
+
+            private void evolve( )
             {
                 if (Thread.CurrentThread.Name == null)
                 {
@@ -889,7 +1470,8 @@ namespace CSIRO.Metaheuristics.Optimization
                 b = 0;
                 while (b < beta && !IsCancelled && !IsFinished)
                 {
-                    IObjectiveScores[] bufferComplex = (IObjectiveScores[])this.scores.Clone( );
+                    // this.scores is replaced, never modified, by an evolution step: no need for a copy.
+                    IObjectiveScores[] bufferComplex = this.scores;
                     IObjectiveScores[] leftOutFromSubcomplex = null;
                     FitnessAssignedScores<double>[] subComplex = getSubComplex( bufferComplex, out leftOutFromSubcomplex );
                     a = 0;
@@ -899,7 +1481,7 @@ namespace CSIRO.Metaheuristics.Optimization
                         loggerWrite(worstPoint, createTagConcat( 
                             LoggerMhHelper.MkTuple("Message","Worst point in subcomplex"),
                             createTagCatComplexNo()));
-                        IObjectiveScores[] withoutWorstPoint = removePoint(subComplex, worstPoint);
+                        IObjectiveScores[] withoutWorstPoint = removePoint(subComplex, worstPoint, out withoutWorstPointFitness);
                         loggerWrite(withoutWorstPoint, createTagConcat(
                             LoggerMhHelper.MkTuple("Message", "Subcomplex without worst point"),
                             createTagCatComplexNo()
@@ -907,7 +1489,13 @@ namespace CSIRO.Metaheuristics.Optimization
                         T centroid = getCentroid(withoutWorstPoint);
 
                         T reflectedPoint = reflect( worstPoint, centroid );
-                        if (reflectedPoint != null)
+                        if (reflectedPoint != null && batchEvaluator != null)
+                        {
+                            subComplex = evaluateCandidatesBatch(reflectedPoint, withoutWorstPoint, worstPoint, centroid);
+                            if (subComplex == null)
+                                subComplex = assignFitness(bufferComplex);
+                        }
+                        else if (reflectedPoint != null)
                         {
                             FitnessAssignedScores<double>[] candidateSubcomplex = null;
                             FitnessAssignedScores<double> fitReflectedPoint = evaluateNewSet(reflectedPoint, withoutWorstPoint, out candidateSubcomplex);
@@ -924,7 +1512,7 @@ namespace CSIRO.Metaheuristics.Optimization
                                     createTagConcat(LoggerMhHelper.MkTuple("Message", "Reflected point in subcomplex - Failed"),createTagCatComplexNo()));
                                 subComplex = contractionOrRandom(withoutWorstPoint, worstPoint, centroid, bufferComplex);
                                 if (subComplex == null) // this can happen if the feasible region of the parameter space is not convex.
-                                    subComplex = fitnessAssignment.AssignFitness(bufferComplex);
+                                    subComplex = assignFitness(bufferComplex);
                             }
                         }
                         else
@@ -963,20 +1551,45 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private void loggerWrite(IObjectiveScores[] points, IDictionary<string, string> tags)
             {
-                if (logger != null)
-                    logger.Write(points, tags);
+                if (logger == null)
+                    return;
+                long start = Metrics.Start();
+                logger.Write(points, tags);
+                Metrics.Stop(EnginePhase.Logging, start, Index);
             }
 
             private void loggerWrite(FitnessAssignedScores<double> point, IDictionary<string, string> tags)
             {
-                if (logger != null)
-                    logger.Write(point, tags);
+                if (logger == null)
+                    return;
+                long start = Metrics.Start();
+                logger.Write(point, tags);
+                Metrics.Stop(EnginePhase.Logging, start, Index);
             }
 
             private void loggerWrite(string message, IDictionary<string, string> tags)
             {
-                if (logger != null)
-                    logger.Write(message, tags);
+                if (logger == null)
+                    return;
+                long start = Metrics.Start();
+                logger.Write(message, tags);
+                Metrics.Stop(EnginePhase.Logging, start, Index);
+            }
+
+            private IObjectiveScores<T> evaluate( T point )
+            {
+                long start = Metrics.Start();
+                var result = evaluator.EvaluateScore( point );
+                Metrics.Stop(EnginePhase.Evaluation, start, Index);
+                return result;
+            }
+
+            private FitnessAssignedScores<double>[] assignFitness( IObjectiveScores[] points )
+            {
+                long start = Metrics.Start();
+                var result = fitnessAssignment.AssignFitness( points );
+                Metrics.Stop(EnginePhase.FitnessAssignment, start, Index);
+                return result;
             }
 
             //private void loggerWrite(IHyperCube<double> point, IDictionary<string, string> tags)
@@ -999,11 +1612,13 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private FitnessAssignedScores<double> evaluateNewSet( T reflectedPoint, IObjectiveScores[] withoutWorstPoint, out FitnessAssignedScores<double>[] candidateSubcomplex )
             {
-                List<IObjectiveScores> scores = new List<IObjectiveScores>( );
-                scores.AddRange( withoutWorstPoint );
-                IObjectiveScores scoreNewPoint = evaluator.EvaluateScore( (T)reflectedPoint );
-                scores.Add( scoreNewPoint );
-                candidateSubcomplex = fitnessAssignment.AssignFitness( scores.ToArray( ) );
+                IObjectiveScores scoreNewPoint = evaluate( (T)reflectedPoint );
+                return assignNewSet( scoreNewPoint, withoutWorstPoint, out candidateSubcomplex );
+            }
+
+            private FitnessAssignedScores<double> assignNewSet( IObjectiveScores scoreNewPoint, IObjectiveScores[] withoutWorstPoint, out FitnessAssignedScores<double>[] candidateSubcomplex )
+            {
+                candidateSubcomplex = assignFitnessWithNewPoint( scoreNewPoint, withoutWorstPoint );
                 return Array.Find<FitnessAssignedScores<double>>( candidateSubcomplex, ( x => ( x.Scores == scoreNewPoint ) ) );
             }
 
@@ -1031,10 +1646,62 @@ namespace CSIRO.Metaheuristics.Optimization
                 return ConvertAllToHyperCube(withoutWorstPoint);
             }
 
-            private IObjectiveScores[] removePoint( FitnessAssignedScores<double>[] subComplex, FitnessAssignedScores<double> worstPoint )
+            private IObjectiveScores[] removePoint( FitnessAssignedScores<double>[] subComplex, FitnessAssignedScores<double> worstPoint, out FitnessAssignedScores<double>[] remaining )
+            {
+                if( pointwiseFitness != null && logger == null )
+                {
+                    withoutWorstPointFitness = getBuffer( withoutWorstPointFitness, subComplex.Length - 1 );
+                    withoutWorstPointBuffer = getBuffer( withoutWorstPointBuffer, subComplex.Length - 1 );
+                    int n = 0;
+                    for( int i = 0; i < subComplex.Length && n <= withoutWorstPointBuffer.Length; i++ )
+                    {
+                        if( object.ReferenceEquals( worstPoint, subComplex[i] ) )
+                            continue;
+                        if( n < withoutWorstPointBuffer.Length )
+                        {
+                            withoutWorstPointFitness[n] = subComplex[i];
+                            withoutWorstPointBuffer[n] = subComplex[i].Scores;
+                        }
+                        n++;
+                    }
+                    if( n == withoutWorstPointBuffer.Length )
+                    {
+                        remaining = withoutWorstPointFitness;
+                        return withoutWorstPointBuffer;
+                    }
+                }
+                remaining = Array.FindAll( subComplex, ( x => !object.ReferenceEquals( worstPoint, x ) ) );
+                return convertArrayToScores( remaining );
+            }
+
+            private static TItem[] getBuffer<TItem>( TItem[] buffer, int length )
             {
-                var tmp = Array.FindAll( subComplex, ( x => !object.ReferenceEquals( worstPoint, x ) ) );
-                return convertArrayToScores( tmp );
+                return ( buffer != null && buffer.Length == length ) ? buffer : new TItem[length];
+            }
+
+            /// <summary>
+            /// Assigns fitness to the points of the subcomplex without its worst point, followed by a new point
+            /// </summary>
+            private FitnessAssignedScores<double>[] assignFitnessWithNewPoint( IObjectiveScores newPoint, IObjectiveScores[] withoutWorstPoint )
+            {
+                if( pointwiseFitness == null || !isFitnessOf( withoutWorstPointFitness, withoutWorstPoint ) )
+                    return assignFitness( aggregate( newPoint, withoutWorstPoint ) );
+                long start = Metrics.Start();
+                var result = candidateBuffer = getBuffer( candidateBuffer, withoutWorstPoint.Length + 1 );
+                Array.Copy( withoutWorstPointFitness, result, withoutWorstPoint.Length );
+                result[withoutWorstPoint.Length] = pointwiseFitness.AssignFitness( newPoint );
+                Metrics.Stop(EnginePhase.FitnessAssignment, start, Index);
+                return result;
+            }
+
+            private static bool isFitnessOf( FitnessAssignedScores<double>[] fitness, IObjectiveScores[] points )
+            {
+                if( fitness == null || fitness.Length != points.Length )
+                    return false;
+                for( int i = 0; i < points.Length; i++ )
+                    if( !object.ReferenceEquals( fitness[i].Scores, points[i] ) )
+                        return false;
+                return true;
             }
 
             private static IObjectiveScores[] convertArrayToScores( FitnessAssignedScores<double>[] tmp )
@@ -1044,7 +1711,8 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private FitnessAssignedScores<double> findWorstPoint( FitnessAssignedScores<double>[] subComplex )
             {
-                FitnessAssignedScores<double>[] tmp = (FitnessAssignedScores<double>[])subComplex.Clone( );
+                FitnessAssignedScores<double>[] tmp = sortBuffer = getBuffer( sortBuffer, subComplex.Length );
+                Array.Copy( subComplex, tmp, subComplex.Length );
                 Array.Sort( tmp );
                 return tmp[tmp.Length - 1];
             }
@@ -1058,8 +1726,18 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private FitnessAssignedScores<double>[] getSubComplex( IObjectiveScores[] bufferComplex, out IObjectiveScores[] leftOutFromSubcomplex )
             {
-                var fitnessPoints = this.fitnessAssignment.AssignFitness( bufferComplex );
+                long start = Metrics.Start();
+                FitnessAssignedScores<double>[] fitnessPoints;
+                if( pointwiseFitness != null )
+                {
+                    // Only the records of the points drawn are kept, not this array
+                    fitnessPoints = complexFitnessBuffer = getBuffer( complexFitnessBuffer, bufferComplex.Length );
+                    pointwiseFitness.AssignFitness( bufferComplex, fitnessPoints );
+                }
+                else
+                    fitnessPoints = this.fitnessAssignment.AssignFitness( bufferComplex );
                 Array.Sort( fitnessPoints );
+                Metrics.Stop(EnginePhase.FitnessAssignment, start, Index);
 
                 IObjectiveScores[] result = new IObjectiveScores[q];
                 int[] selectedIndices = new int[q];
@@ -1087,7 +1765,9 @@ namespace CSIRO.Metaheuristics.Optimization
                         leftOut.Add( fitnessPoints[j].Scores );
                 }
                 leftOutFromSubcomplex = leftOut.ToArray( );
-                return fitnessAssignment.AssignFitness( result );
+                if( pointwiseFitness != null )
+                    return Array.ConvertAll( selectedIndices, j => fitnessPoints[j] );
+                return assignFitness( result );
             }
 
             private FitnessAssignedScores<double>[] contractionOrRandom( IObjectiveScores[] withoutWorstPoint,
@@ -1125,6 +1805,73 @@ namespace CSIRO.Metaheuristics.Optimization
                 return result;
             }
 
+            /// <summary>
+            /// Same outcome as the reflection, then if it fails the contraction, then the random point within the subcomplex,
+            /// except that all three candidates are generated beforehand and evaluated in one batch.
+            /// </summary>
+            /// <remarks>
+            /// Evaluations of the candidates not retained are wasted, in exchange for a single call to the evaluator.
+            /// The random point is always drawn, so the random number sequence differs from the sequential evaluation.
+            /// </remarks>
+            /// <returns>The new subcomplex, or null if no candidate is accepted and the random point is unfeasible</returns>
+            private FitnessAssignedScores<double>[] evaluateCandidatesBatch(T reflectedPoint, IObjectiveScores[] withoutWorstPoint,
+                FitnessAssignedScores<double> worstPoint, T centroid)
+            {
+                T contractionPoint = contract(worstPoint, centroid);
+                IHyperCube<double> randomPoint = hyperCubeOps.GenerateRandomWithinHypercube(convertAllToHyperCube(merge(withoutWorstPoint, worstPoint)));
+                var candidates = new List<T>() { reflectedPoint };
+                if (contractionPoint != null)
+                    candidates.Add(contractionPoint);
+                if (randomPoint != null)
+                    candidates.Add((T)randomPoint);
+                long start = Metrics.Start();
+                IObjectiveScores<T>[] candidateScores = batchEvaluator.EvaluateScores(candidates.ToArray());
+                Metrics.Stop(EnginePhase.BatchEvaluation, start, Index);
+
+                FitnessAssignedScores<double>[] candidateSubcomplex = null;
+                FitnessAssignedScores<double> fitReflectedPoint = assignNewSet(candidateScores[0], withoutWorstPoint, out candidateSubcomplex);
+                if (fitReflectedPoint.CompareTo(worstPoint) <= 0)
+                {
+                    loggerWrite(fitReflectedPoint, createTagConcat(
+                        LoggerMhHelper.MkTuple("Message", "Reflected point in subcomplex"),
+                        createTagCatComplexNo()));
+                    return candidateSubcomplex;
+                }
+                loggerWrite(fitReflectedPoint,
+                    createTagConcat(LoggerMhHelper.MkTuple("Message", "Reflected point in subcomplex - Failed"), createTagCatComplexNo()));
+                if (contractionPoint != null)
+                {
+                    FitnessAssignedScores<double> fitContractionPoint = assignNewSet(candidateScores[1], withoutWorstPoint, out candidateSubcomplex);
+                    if (fitContractionPoint.CompareTo(worstPoint) <= 0)
+                    {
+                        loggerWrite(fitContractionPoint, createTagConcat(
+                            LoggerMhHelper.MkTuple("Message", "Contracted point in subcomplex"),
+                            createTagCatComplexNo()));
+                        return candidateSubcomplex;
+                    }
+                    loggerWrite(fitContractionPoint, createTagConcat(
+                        LoggerMhHelper.MkTuple("Message", "Contracted point in subcomplex-Failed"),
+                        createTagCatComplexNo()));
+                }
+                else
+                {
+                    var msg = "Contracted point unfeasible";
+                    loggerWrite(msg, createTagConcat(LoggerMhHelper.MkTuple("Message", msg), createTagCatComplexNo()));
+                }
+                if (randomPoint == null)
+                {
+                    var msg = "Random point within hypercube bounds is unfeasible";
+                    loggerWrite(msg, createTagConcat(LoggerMhHelper.MkTuple("Message", msg), createTagCatComplexNo()));
+                    return null;
+                }
+                var newScore = candidateScores[candidateScores.Length - 1];
+                loggerWrite(newScore, createTagConcat(
+                    LoggerMhHelper.MkTuple("Message", "Adding a random point in hypercube"),
+                    createTagCatComplexNo()
+                    ));
+                return assignFitnessWithNewPoint(newScore, withoutWorstPoint);
+            }
+
             private FitnessAssignedScores<double>[] generateRandomWithinShuffleBounds(FitnessAssignedScores<double> worstPoint, T centroid, IObjectiveScores[] withoutWorstPoint)
             {
                 var ctr = centroid as IHyperCube<double>;
@@ -1142,12 +1889,12 @@ namespace CSIRO.Metaheuristics.Optimization
                     else
                         newPoint.SetValue(v, value);
                 }
-                var newScore = evaluator.EvaluateScore((T)newPoint);
+                var newScore = evaluate((T)newPoint);
                 loggerWrite(newScore, createTagConcat(
                     LoggerMhHelper.MkTuple("Message", "Adding a partially random point"),
                     LoggerMhHelper.MkTuple("Category", "Complex No " + complexId)
                     ));
-                return fitnessAssignment.AssignFitness(aggregate(newScore, withoutWorstPoint));
+                return assignFitnessWithNewPoint(newScore, withoutWorstPoint);
             }
 
             private FitnessAssignedScores<double>[] generateRandomWithinSubcomplex(IObjectiveScores[] withoutWorstPoint, FitnessAssignedScores<double> worstPoint)
@@ -1170,14 +1917,13 @@ namespace CSIRO.Metaheuristics.Optimization
                     loggerWrite(msg, createTagConcat(LoggerMhHelper.MkTuple("Message", msg), createTagCatComplexNo()));
                     return null;
                 }
-                var newScore = evaluator.EvaluateScore((T)newPoint);
+                var newScore = evaluate((T)newPoint);
                 loggerWrite(newScore, createTagConcat(
                     LoggerMhHelper.MkTuple("Message", "Adding a random point in hypercube"),
                     createTagCatComplexNo()
                     ));
 
-                IObjectiveScores[] newSubComplex = aggregate(newScore, withoutWorstPoint);
-                return fitnessAssignment.AssignFitness(newSubComplex);
+                return assignFitnessWithNewPoint(newScore, withoutWorstPoint);
             }
 
             private static IObjectiveScores[] merge(IObjectiveScores[] withoutWorstPoint, FitnessAssignedScores<double> worstPoint)
@@ -1189,7 +1935,7 @@ namespace CSIRO.Metaheuristics.Optimization
 
             private IObjectiveScores[] aggregatePoints( IHyperCube<double> newPoint, IObjectiveScores[] withoutWorstPoint )
             {
-                return aggregate( evaluator.EvaluateScore( (T)newPoint ), withoutWorstPoint );
+                return aggregate( evaluate( (T)newPoint ), withoutWorstPoint );
             }
 
             private IObjectiveScores[] aggregate( IObjectiveScores newPoint, IObjectiveScores[] withoutWorstPoint )
@@ -1249,6 +1995,8 @@ namespace CSIRO.Metaheuristics.Optimization
         { 
             get 
             {
+                // Evolving complexes cannot be queried; the population at the last shuffle is the most recent consistent one.
+                if (evolvingAsynchronously) return PopulationAtShuffling;
                 if (complexes == null) return null;
                 return sortByFitness(aggregate(complexes));
             }
@@ -12,7 +12,7 @@ using CSIRO.Metaheuristics.Utils;
 
 namespace CSIRO.Metaheuristics.Optimization
 {
-    public class UniformRandomSampling<T> : IEvolutionEngine<T> where T : IHyperCube<double>, ICloneableSystemConfiguration
+    public class UniformRandomSampling<T> : IEvolutionEngine<T>, IInstrumentedEngine where T : IHyperCube<double>, ICloneableSystemConfiguration
     {
         public UniformRandomSampling(IClonableObjectiveEvaluator<T> evaluator,
                                      IRandomNumberGeneratorFactory rng,
@@ -39,6 +39,14 @@ namespace CSIRO.Metaheuristics.Optimization
         ICandidateFactory<T> populationInitializer;
         public ILoggerMh Logger { get; set; }
 
+        private readonly EngineMetrics metrics = new EngineMetrics();
+        /// <summary>
+        /// Gets the timings of the phases of this optimiser
+        /// </summary>
+        public EngineMetrics Metrics
+        {
+            get { return metrics; }
+        }
 
         private readonly int numShuffle = 3000;
         private bool isCancelled = false;
@@ -46,20 +54,34 @@ namespace CSIRO.Metaheuristics.Optimization
 
         public IOptimizationResults<T> Evolve()
         {
-            IObjectiveScores[] scores = evaluateScores(initialisePopulation());
+            long start = metrics.Start();
+            IObjectiveScores[] scores;
+            try
+            {
+                scores = evaluateScores(initialisePopulation());
+            }
+            finally
+            {
+                Evaluations.ClearPool(evaluator);
+            }
             var tags = LoggerMhHelper.CreateTag(LoggerMhHelper.MkTuple("Category", "URS"));
             loggerWrite(scores, tags);
 
+            long rankingStart = metrics.Start();
             var paretoRanking = new ParetoRanking<IObjectiveScores>(scores, new ParetoComparer<IObjectiveScores>());
             IObjectiveScores[] paretoScores = paretoRanking.GetDominatedByParetoRank(0);
+            metrics.Stop(EnginePhase.FitnessAssignment, rankingStart);
+            metrics.Stop(EnginePhase.Run, start);
             return new BasicOptimizationResults<T>(paretoScores);
         }
 
         private void loggerWrite(IObjectiveScores[] scores, IDictionary<string, string> tags)
         {
+            long start = metrics.Start();
             if (logTags != null)
                 tags = LoggerMhHelper.MergeDictionaries(logTags, tags);
             LoggerMhHelper.Write(scores, tags, Logger);
+            metrics.Stop(EnginePhase.Logging, start);
         }
 
         public string GetDescription()
@@ -69,15 +91,12 @@ namespace CSIRO.Metaheuristics.Optimization
 
         private IObjectiveScores[] evaluateScores(T[] population)
         {
-            return Evaluations.EvaluateScores(evaluator, population, () => this.isCancelled);
+            return Evaluations.EvaluateScores(evaluator, population, () => this.isCancelled, metrics: metrics);
         }
 
         private T[] initialisePopulation()
         {
-            T[] result = new T[numShuffle];
-            for (int i = 0; i < result.Length; i++)
-                result[i] = populationInitializer.CreateRandomCandidate();
-            return result;
+            return Sampling.CreateRandomCandidates(populationInitializer, numShuffle);
         }
 
         public void Cancel()
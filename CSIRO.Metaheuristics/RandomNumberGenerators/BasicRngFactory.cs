@@ -2,16 +2,17 @@
 using System.Collections.Generic;
 using System.Linq;
 using System.Text;
+using System.IO;
 
 namespace CSIRO.Metaheuristics.RandomNumberGenerators
 {
-    public class BasicRngFactory : IRandomNumberGeneratorFactory
+    public class BasicRngFactory : IRandomNumberGeneratorFactory, ICheckpointableRandomFactory
     {
         public BasicRngFactory( int seed )
         {
-            random = new Random( seed );
+            random = new CheckpointableRandom( seed );
         }
-        private Random random;
+        private CheckpointableRandom random;
 
         public Random CreateRandom( )
         {
@@ -27,5 +28,15 @@ namespace CSIRO.Metaheuristics.RandomNumberGenerators
         {
             return random.Next( );
         }
+
+        public void WriteState( BinaryWriter writer )
+        {
+            random.WriteState( writer );
+        }
+
+        public void ReadState( BinaryReader reader )
+        {
+            random.ReadState( reader );
+        }
     }
 }
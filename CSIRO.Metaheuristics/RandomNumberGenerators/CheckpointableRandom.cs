@@ -0,0 +1,144 @@
+﻿using System;
+using System.IO;
+
+namespace CSIRO.Metaheuristics.RandomNumberGenerators
+{
+    /// <summary>
+    /// A random number generator producing the same sequences as <see cref="Random"/> for a given seed,
+    /// and whose state can be saved and restored, e.g. to resume an optimisation from a checkpoint.
+    /// </summary>
+    /// <remarks>
+    /// This is the subtractive generator of Knuth as implemented by the .NET Framework <see cref="Random"/>,
+    /// whose internal state is not accessible.
+    /// </remarks>
+    public class CheckpointableRandom : Random
+    {
+        private const int MBIG = int.MaxValue;
+        private const int MSEED = 161803398;
+        private const int StateLength = 56;
+
+        private readonly int[] seedArray = new int[StateLength];
+        private int inext;
+        private int inextp;
+
+        public CheckpointableRandom(int seed) : base(seed)
+        {
+            int subtraction = (seed == int.MinValue) ? int.MaxValue : Math.Abs(seed);
+            int mj = MSEED - subtraction;
+            seedArray[55] = mj;
+            int mk = 1;
+            for (int i = 1; i < 55; i++)
+            {
+                int ii = (21 * i) % 55;
+                seedArray[ii] = mk;
+                mk = mj - mk;
+                if (mk < 0) mk += MBIG;
+                mj = seedArray[ii];
+            }
+            for (int k = 1; k < 5; k++)
+            {
+                for (int i = 1; i < 56; i++)
+                {
+                    seedArray[i] -= seedArray[1 + (i + 30) % 55];
+                    if (seedArray[i] < 0) seedArray[i] += MBIG;
+                }
+            }
+            inext = 0;
+            inextp = 21;
+        }
+
+        /// <summary>
+        /// Writes the state of this generator
+        /// </summary>
+        public void WriteState(BinaryWriter writer)
+        {
+            writer.Write(inext);
+            writer.Write(inextp);
+            for (int i = 0; i < StateLength; i++)
+                writer.Write(seedArray[i]);
+        }
+
+        /// <summary>
+        /// Restores a state written by <see cref="WriteState"/>; this generator then continues the sequence of the generator the state was written from.
+        /// </summary>
+        public void ReadState(BinaryReader reader)
+        {
+            int n = reader.ReadInt32();
+            int np = reader.ReadInt32();
+            if (n < 0 || n >= StateLength || np < 0 || np >= StateLength)
+                throw new InvalidDataException("Invalid state of a random number generator");
+            inext = n;
+            inextp = np;
+            for (int i = 0; i < StateLength; i++)
+                seedArray[i] = reader.ReadInt32();
+        }
+
+        private int internalSample()
+        {
+            int locINext = inext;
+            int locINextp = inextp;
+            if (++locINext >= 56) locINext = 1;
+            if (++locINextp >= 56) locINextp = 1;
+            int retVal = seedArray[locINext] - seedArray[locINextp];
+            if (retVal == MBIG) retVal--;
+            if (retVal < 0) retVal += MBIG;
+            seedArray[locINext] = retVal;
+            inext = locINext;
+            inextp = locINextp;
+            return retVal;
+        }
+
+        protected override double Sample()
+        {
+            return internalSample() * (1.0 / MBIG);
+        }
+
+        private double getSampleForLargeRange()
+        {
+            int result = internalSample();
+            bool negative = (internalSample() % 2 == 0);
+            if (negative)
+                result = -result;
+            double d = result;
+            d += (int.MaxValue - 1);
+            d /= 2 * (uint)int.MaxValue - 1;
+            return d;
+        }
+
+        public override int Next()
+        {
+            return internalSample();
+        }
+
+        public override int Next(int maxValue)
+        {
+            if (maxValue < 0)
+                throw new ArgumentOutOfRangeException("maxValue", "maxValue must be positive");
+            return (int)(Sample() * maxValue);
+        }
+
+        public override int Next(int minValue, int maxValue)
+        {
+            if (minValue > maxValue)
+                throw new ArgumentOutOfRangeException("minValue", "minValue must be less than or equal to maxValue");
+            long range = (long)maxValue - minValue;
+            if (range <= int.MaxValue)
+                return (int)(Sample() * range) + minValue;
+            else
+                return (int)((long)(getSampleForLargeRange() * range) + minValue);
+        }
+
+        public override double NextDouble()
+        {
+            return Sample();
+        }
+
+        public override void NextBytes(byte[] buffer)
+        {
+            if (buffer == null)
+                throw new ArgumentNullException("buffer");
+            for (int i = 0; i < buffer.Length; i++)
+                buffer[i] = (byte)(internalSample() % (byte.MaxValue + 1));
+        }
+    }
+}
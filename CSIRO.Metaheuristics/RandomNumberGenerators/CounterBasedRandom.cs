@@ -0,0 +1,130 @@
+﻿using System;
+using System.IO;
+
+namespace CSIRO.Metaheuristics.RandomNumberGenerators
+{
+    /// <summary>
+    /// A counter-based random number generator: the i-th number of a sequence is a function of a key and of i only.
+    /// </summary>
+    /// <remarks>
+    /// This is the SplitMix64 generator of Steele, Lea and Flood (2014), whose i-th output is a bijective mixing function
+    /// of the key plus i times an odd constant. It is cheap to create and to restore at any point of its sequence,
+    /// and the keys of independent streams are derived with the same mixing function, see <see cref="CounterBasedRngFactory"/>.
+    /// </remarks>
+    public class CounterBasedRandom : Random
+    {
+        internal const ulong Golden = 0x9E3779B97F4A7C15UL;
+        private const double DoubleUnit = 1.0 / (1UL << 53);
+
+        /// <summary>
+        /// Creates the generator of the sequence of a key, positioned at a counter
+        /// </summary>
+        /// <param name="key">The key identifying the sequence</param>
+        /// <param name="counter">The number of values of the sequence to skip</param>
+        public CounterBasedRandom(ulong key, ulong counter = 0) : base(0)
+        {
+            this.key = key;
+            this.counter = counter;
+        }
+
+        private readonly ulong key;
+        private ulong counter;
+
+        /// <summary>
+        /// Gets the key identifying the sequence of this generator
+        /// </summary>
+        public ulong Key
+        {
+            get { return key; }
+        }
+
+        /// <summary>
+        /// Gets or sets the number of 64 bits values drawn so far; setting it jumps anywhere in the sequence
+        /// </summary>
+        public ulong Counter
+        {
+            get { return counter; }
+            set { counter = value; }
+        }
+
+        internal static ulong Mix(ulong z)
+        {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+            return z ^ (z >> 31);
+        }
+
+        /// <summary>
+        /// Gets the next 64 bits value of the sequence
+        /// </summary>
+        public ulong NextUInt64()
+        {
+            counter++;
+            return Mix(unchecked(key + counter * Golden));
+        }
+
+        protected override double Sample()
+        {
+            return (NextUInt64() >> 11) * DoubleUnit;
+        }
+
+        public override int Next()
+        {
+            // 31 bits; int.MaxValue itself is excluded, as for System.Random
+            int result = (int)(NextUInt64() >> 33);
+            return (result == int.MaxValue ? result - 1 : result);
+        }
+
+        public override int Next(int maxValue)
+        {
+            if (maxValue < 0)
+                throw new ArgumentOutOfRangeException("maxValue", "maxValue must be positive");
+            return (int)(Sample() * maxValue);
+        }
+
+        public override int Next(int minValue, int maxValue)
+        {
+            if (minValue > maxValue)
+                throw new ArgumentOutOfRangeException("minValue", "minValue must be less than or equal to maxValue");
+            long range = (long)maxValue - minValue;
+            return (int)((long)(Sample() * range) + minValue);
+        }
+
+        public override double NextDouble()
+        {
+            return Sample();
+        }
+
+        public override void NextBytes(byte[] buffer)
+        {
+            if (buffer == null)
+                throw new ArgumentNullException("buffer");
+            int i = 0;
+            while (i < buffer.Length)
+            {
+                ulong bits = NextUInt64();
+                for (int j = 0; j < 8 && i < buffer.Length; j++, i++)
+                {
+                    buffer[i] = (byte)bits;
+                    bits >>= 8;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Writes the state of this generator
+        /// </summary>
+        public void WriteState(BinaryWriter writer)
+        {
+            writer.Write(counter);
+        }
+
+        /// <summary>
+        /// Restores a state written by <see cref="WriteState"/> from a generator with the same key
+        /// </summary>
+        public void ReadState(BinaryReader reader)
+        {
+            counter = reader.ReadUInt64();
+        }
+    }
+}
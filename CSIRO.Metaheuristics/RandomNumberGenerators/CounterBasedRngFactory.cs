@@ -0,0 +1,93 @@
+﻿using System;
+using System.IO;
+
+namespace CSIRO.Metaheuristics.RandomNumberGenerators
+{
+    /// <summary>
+    /// A factory of <see cref="CounterBasedRandom"/> generators, handing out independent streams by index,
+    /// for reproducible results of work split over threads or processes whatever the number of them.
+    /// </summary>
+    /// <remarks>
+    /// The key of the stream of index i is a bijective mixing of the key of this factory and of i, so that streams never
+    /// share a key. <see cref="CreateRandom()"/> and <see cref="CreateFactory()"/> hand out the streams in sequence,
+    /// starting from the index zero, and <see cref="Next"/> draws from a stream of its own.
+    /// </remarks>
+    public class CounterBasedRngFactory : IRandomNumberStreamFactory, ICheckpointableRandomFactory
+    {
+        public CounterBasedRngFactory(int seed) : this(CounterBasedRandom.Mix(unchecked((ulong)seed + CounterBasedRandom.Golden)))
+        {
+        }
+
+        private CounterBasedRngFactory(ulong key)
+        {
+            setKey(key);
+        }
+
+        private ulong key;
+        private long nextStream = 0;
+        private CounterBasedRandom random;
+
+        private void setKey(ulong key)
+        {
+            this.key = key;
+            // Mix(0) is zero, hence this stream is the one of index -1, distinct from all the others
+            this.random = new CounterBasedRandom(CounterBasedRandom.Mix(key));
+        }
+
+        private ulong streamKey(long streamIndex)
+        {
+            if (streamIndex < 0)
+                throw new ArgumentOutOfRangeException("streamIndex", streamIndex, "The index of a stream must be positive");
+            return CounterBasedRandom.Mix(unchecked(key + CounterBasedRandom.Mix((ulong)streamIndex + 1)));
+        }
+
+        public Random CreateRandom()
+        {
+            return CreateRandom(nextStream++);
+        }
+
+        public IRandomNumberGeneratorFactory CreateFactory()
+        {
+            return CreateFactory(nextStream++);
+        }
+
+        public int Next()
+        {
+            return random.Next();
+        }
+
+        public Random CreateRandom(long streamIndex)
+        {
+            return new CounterBasedRandom(streamKey(streamIndex));
+        }
+
+        public IRandomNumberStreamFactory CreateFactory(long streamIndex)
+        {
+            return new CounterBasedRngFactory(streamKey(streamIndex));
+        }
+
+        /// <summary>
+        /// Gets a factory of independent streams drawing from a random number generator factory:
+        /// the factory itself if it creates streams, otherwise a new <see cref="CounterBasedRngFactory"/> seeded from it.
+        /// </summary>
+        public static IRandomNumberStreamFactory AsStreamFactory(IRandomNumberGeneratorFactory rng)
+        {
+            var result = rng as IRandomNumberStreamFactory;
+            return result ?? new CounterBasedRngFactory(rng.Next());
+        }
+
+        public void WriteState(BinaryWriter writer)
+        {
+            writer.Write(key);
+            writer.Write(nextStream);
+            random.WriteState(writer);
+        }
+
+        public void ReadState(BinaryReader reader)
+        {
+            setKey(reader.ReadUInt64());
+            nextStream = reader.ReadInt64();
+            random.ReadState(reader);
+        }
+    }
+}
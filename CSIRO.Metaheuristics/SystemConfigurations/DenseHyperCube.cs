@@ -0,0 +1,254 @@
+﻿using System;
+using System.Text;
+using CSIRO.Sys;
+
+namespace CSIRO.Metaheuristics.SystemConfigurations
+{
+    /// <summary>
+    /// A hypercube storing its values and bounds in arrays indexed by ordinal position, 
+    /// with the variable names held by a schema shared by all the points cloned from one another.
+    /// </summary>
+    /// <remarks>
+    /// Clones share the arrays of bounds with the original until either sets a bound, 
+    /// so that a large population costs one array of values per point. 
+    /// Centroids, random points and homothetic transforms of points with the same schema avoid any lookup by name.
+    /// </remarks>
+    [Serializable]
+    public class DenseHyperCube : IIndexedHyperCube<double>
+    {
+        public DenseHyperCube(string[] variableNames)
+            : this(new HyperCubeSchema(variableNames))
+        {
+        }
+
+        public DenseHyperCube(HyperCubeSchema schema)
+        {
+            if (schema == null)
+                throw new ArgumentNullException("schema");
+            this.ThrowOnOutOfBounds = false;
+            this.schema = schema;
+            this.values = new double[schema.Dimensions];
+            this.mins = new double[schema.Dimensions];
+            this.maxs = new double[schema.Dimensions];
+        }
+
+        /// <summary>
+        /// Creates a dense copy of the values and bounds of another hypercube
+        /// </summary>
+        /// <param name="point">The hypercube to copy</param>
+        /// <param name="schema">The schema of the result, to share with other points; by default one for the variables of the point</param>
+        public static DenseHyperCube FromHyperCube(IHyperCube<double> point, HyperCubeSchema schema = null)
+        {
+            if (schema == null)
+                schema = new HyperCubeSchema(point.GetVariableNames());
+            var result = new DenseHyperCube(schema);
+            for (int i = 0; i < schema.Dimensions; i++)
+            {
+                var name = schema.GetVariableName(i);
+                result.mins[i] = point.GetMinValue(name);
+                result.maxs[i] = point.GetMaxValue(name);
+                result.values[i] = point.GetValue(name);
+            }
+            return result;
+        }
+
+        private HyperCubeSchema schema;
+        private double[] values;
+        private double[] mins;
+        private double[] maxs;
+        private bool boundsShared = false;
+
+        public HyperCubeSchema Schema
+        {
+            get { return schema; }
+        }
+
+        public bool ThrowOnOutOfBounds { get; set; }
+
+        #region IHyperCube<double> Members
+
+        public string[] GetVariableNames()
+        {
+            return schema.GetVariableNames();
+        }
+
+        public int Dimensions
+        {
+            get { return values.Length; }
+        }
+
+        public int IndexOf(string variableName)
+        {
+            return schema.IndexOf(variableName);
+        }
+
+        public double GetValue(string variableName)
+        {
+            return values[schema.IndexOf(variableName)];
+        }
+
+        public double GetMaxValue(string variableName)
+        {
+            return maxs[schema.IndexOf(variableName)];
+        }
+
+        public double GetMinValue(string variableName)
+        {
+            return mins[schema.IndexOf(variableName)];
+        }
+
+        public void SetValue(string variableName, double value)
+        {
+            SetValue(schema.IndexOf(variableName), value);
+        }
+
+        public double GetValue(int index)
+        {
+            return values[index];
+        }
+
+        public double GetMaxValue(int index)
+        {
+            return maxs[index];
+        }
+
+        public double GetMinValue(int index)
+        {
+            return mins[index];
+        }
+
+        public void SetValue(int index, double value)
+        {
+            if (!IsInBounds(value, mins[index], maxs[index]))
+                throw new ArgumentException("Value to set is out of min-max bounds");
+            values[index] = value;
+        }
+
+        public void CopyValuesTo(double[] destination, int offset)
+        {
+            Array.Copy(values, 0, destination, offset, values.Length);
+        }
+
+        public void SetValues(double[] source, int offset)
+        {
+            for (int i = 0; i < values.Length; i++)
+                if (!IsInBounds(source[offset + i], mins[i], maxs[i]))
+                    throw new ArgumentException("Value to set is out of min-max bounds: " + schema.GetVariableName(i));
+            Array.Copy(source, offset, values, 0, values.Length);
+        }
+
+        public IHyperCube<double> HomotheticTransform(IHyperCube<double> point, double factor)
+        {
+            var result = (DenseHyperCube)this.Clone();
+            var dense = point as DenseHyperCube;
+            bool sameLayout = (dense != null && object.ReferenceEquals(dense.schema, this.schema));
+            for (int i = 0; i < values.Length; i++)
+            {
+                double p = (sameLayout ? dense.values[i] : point.GetValue(schema.GetVariableName(i)));
+                double newVal = HyperCubeOperations.Reflect(p, this.values[i], factor);
+                if (!IsInBounds(newVal, mins[i], maxs[i]))
+                {
+                    if (this.ThrowOnOutOfBounds)
+                        throw new ArgumentException("Value to set is out of min-max bounds");
+                    return null;
+                }
+                result.values[i] = newVal;
+            }
+            return result;
+        }
+
+        #endregion
+
+        #region IHyperCubeSetBounds<double> Members
+
+        public void SetMinValue(string variableName, double value)
+        {
+            int index = schema.IndexOf(variableName);
+            ownBounds();
+            mins[index] = value;
+        }
+
+        public void SetMaxValue(string variableName, double value)
+        {
+            int index = schema.IndexOf(variableName);
+            ownBounds();
+            maxs[index] = value;
+        }
+
+        public void SetMinMaxValue(string variableName, double min, double max, double value)
+        {
+            this.SetMinValue(variableName, min);
+            this.SetMaxValue(variableName, max);
+            this.SetValue(variableName, value);
+        }
+
+        #endregion
+
+        #region ISystemConfiguration Members
+
+        public virtual string GetConfigurationDescription()
+        {
+            StringBuilder sb = new StringBuilder();
+            for (int i = 0; i < values.Length; i++)
+            {
+                sb.Append(schema.GetVariableName(i));
+                sb.Append(": {");
+                sb.Append(values[i].ToString());
+                sb.Append(", ");
+                sb.Append(mins[i].ToString());
+                sb.Append(", ");
+                sb.Append(maxs[i].ToString());
+                sb.Append("} ");
+            }
+            return sb.ToString();
+        }
+
+        public virtual void ApplyConfiguration(object system)
+        {
+            var names = this.GetVariableNames();
+            var map = ReflectionHelper.GetAccessorMap(system.GetType(), names);
+            for (int i = 0; i < names.Length; i++)
+                map[names[i]].SetValue(system, values[i]);
+        }
+
+        #endregion
+
+        #region ICloningSupport<ICloneableSystemConfiguration> Members
+
+        public virtual bool SupportsDeepCloning
+        {
+            get { return true; }
+        }
+
+        public virtual bool SupportsThreadSafeCloning
+        {
+            get { return true; }
+        }
+
+        public virtual ICloneableSystemConfiguration Clone()
+        {
+            var result = this.MemberwiseClone() as DenseHyperCube;
+            result.values = this.values.Clone() as double[];
+            this.boundsShared = true;
+            result.boundsShared = true;
+            return result;
+        }
+
+        #endregion
+
+        private void ownBounds()
+        {
+            if (!boundsShared)
+                return;
+            mins = mins.Clone() as double[];
+            maxs = maxs.Clone() as double[];
+            boundsShared = false;
+        }
+
+        // Same as MetaheuristicsHelper.CheckInBounds for doubles; notably NaN is out of bounds.
+        internal static bool IsInBounds(double value, double min, double max)
+        {
+            return !(value.CompareTo(max) > 0 || value.CompareTo(min) < 0);
+        }
+    }
+}
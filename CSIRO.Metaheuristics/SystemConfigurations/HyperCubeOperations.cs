@@ -32,6 +32,25 @@ namespace CSIRO.Metaheuristics.SystemConfigurations
             return result;
         }
 
+        /// <summary>
+        /// Generates a point uniformly within the bounds of a point, drawing from a given random number generator
+        /// </summary>
+        /// <remarks>Unlike <see cref="GenerateRandom(IHyperCube{double})"/>, this does not create a generator for each value</remarks>
+        public static IHyperCube<double> GenerateRandom( IHyperCube<double> point, Random random )
+        {
+            string[] varNames = point.GetVariableNames( );
+            IHyperCube<double> result = point.Clone( ) as IHyperCube<double> ;
+            for( int i = 0; i < varNames.Length; i++ )
+            {
+                string v = varNames[i];
+                double min = result.GetMinValue(v); 
+                double max = result.GetMaxValue(v);
+                checkFeasibleInterval(min, max, v);
+                result.SetValue( v, min + random.NextDouble( ) * (max - min) );
+            }
+            return result;
+        }
+
         #region IHyperCubeOperations Members
 
         public IHyperCube<double> GetCentroid( IHyperCube<double>[] points )
@@ -48,6 +67,20 @@ namespace CSIRO.Metaheuristics.SystemConfigurations
 
             IHyperCube<double> p = points[0].Clone( ) as IHyperCube<double>;
 
+            DenseHyperCube[] densePoints = asDenseWithSameSchema( points );
+            if( densePoints != null )
+            {
+                var dense = (DenseHyperCube)p;
+                for( int k = 0; k < dense.Dimensions; k++ )
+                {
+                    double val = 0.0;
+                    for( int i = 0; i < densePoints.Length; i++ )
+                        val += densePoints[i].GetValue( k );
+                    dense.SetValue( k, val / ( (double)points.Length ) );
+                }
+                return dense;
+            }
+
             string[] varNames = p.GetVariableNames();
             foreach( string varName in varNames )
             {
@@ -71,6 +104,9 @@ namespace CSIRO.Metaheuristics.SystemConfigurations
             else
             {
                 IHyperCube<double> p = points[0].Clone() as IHyperCube<double>;
+                DenseHyperCube[] densePoints = asDenseWithSameSchema(points);
+                if (densePoints != null)
+                    return generateRandomWithinHypercube(densePoints, (DenseHyperCube)p);
                 string[] varNames = p.GetVariableNames();
                 for (int i = 0; i < varNames.Length; i++)
                 {
@@ -89,7 +125,42 @@ namespace CSIRO.Metaheuristics.SystemConfigurations
 
         }
 
-        private void checkFeasibleInterval(double minimum, double maximum, string varName)
+        private DenseHyperCube generateRandomWithinHypercube(DenseHyperCube[] points, DenseHyperCube p)
+        {
+            for (int k = 0; k < p.Dimensions; k++)
+            {
+                double minimum = double.PositiveInfinity;
+                double maximum = double.NegativeInfinity;
+                for (int j = 0; j < points.Length; j++)
+                {
+                    minimum = Math.Min(minimum, points[j].GetValue(k));
+                    maximum = Math.Max(maximum, points[j].GetValue(k));
+                }
+                minimum = Math.Max(minimum, p.GetMinValue(k));
+                maximum = Math.Min(maximum, p.GetMaxValue(k));
+                checkFeasibleInterval(minimum, maximum, p.Schema.GetVariableName(k));
+                p.SetValue(k, GetRandomisedValue(minimum, maximum));
+            }
+            return p;
+        }
+
+        /// <summary>
+        /// Gets the points as dense hypercubes if they all are, with the same schema, so that variables can be matched by position.
+        /// </summary>
+        /// <returns>null if the points need to be processed by variable names</returns>
+        private static DenseHyperCube[] asDenseWithSameSchema(IHyperCube<double>[] points)
+        {
+            var result = new DenseHyperCube[points.Length];
+            for (int i = 0; i < points.Length; i++)
+            {
+                result[i] = points[i] as DenseHyperCube;
+                if (result[i] == null || !object.ReferenceEquals(result[i].Schema, result[0].Schema))
+                    return null;
+            }
+            return result;
+        }
+
+        private static void checkFeasibleInterval(double minimum, double maximum, string varName)
         {
             if (maximum < minimum)
                 throw new NotSupportedException(string.Format("Impossible to generate random value for variable {0}: min={1}, max={2}", varName, minimum, maximum));
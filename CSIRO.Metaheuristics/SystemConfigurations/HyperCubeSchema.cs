@@ -0,0 +1,57 @@
+﻿using System;
+using System.Collections.Generic;
+
+namespace CSIRO.Metaheuristics.SystemConfigurations
+{
+    /// <summary>
+    /// An immutable map of variable names to ordinal positions, shared by all the points of a population of <see cref="DenseHyperCube"/>.
+    /// </summary>
+    [Serializable]
+    public sealed class HyperCubeSchema
+    {
+        public HyperCubeSchema(string[] variableNames)
+        {
+            if (variableNames == null)
+                throw new ArgumentNullException("variableNames");
+            this.variableNames = variableNames.Clone() as string[];
+            this.indices = new Dictionary<string, int>();
+            for (int i = 0; i < variableNames.Length; i++)
+            {
+                if (indices.ContainsKey(variableNames[i]))
+                    throw new ArgumentException("Duplicate variable name: " + variableNames[i]);
+                indices[variableNames[i]] = i;
+            }
+        }
+
+        private readonly string[] variableNames;
+        private readonly Dictionary<string, int> indices;
+
+        public int Dimensions
+        {
+            get { return variableNames.Length; }
+        }
+
+        public string[] GetVariableNames()
+        {
+            return variableNames.Clone() as string[];
+        }
+
+        public string GetVariableName(int index)
+        {
+            return variableNames[index];
+        }
+
+        public int IndexOf(string variableName)
+        {
+            int index;
+            if (!indices.TryGetValue(variableName, out index))
+                throw new ArgumentException("Incorrect variable name: " + variableName);
+            return index;
+        }
+
+        public bool Contains(string variableName)
+        {
+            return indices.ContainsKey(variableName);
+        }
+    }
+}
@@ -14,6 +14,11 @@ namespace CSIRO.Metaheuristics.Tests
         public static void CreateTestLogContent(out InMemoryLogger logger, out Dictionary<string, string> strMsg, out Dictionary<string, string> popTags)
         {
             logger = new InMemoryLogger();
+            WriteTestLogContent(logger, out strMsg, out popTags);
+        }
+
+        public static void WriteTestLogContent(ILoggerMh logger, out Dictionary<string, string> strMsg, out Dictionary<string, string> popTags)
+        {
             strMsg =
                       new Dictionary<string, string>()
                       {
@@ -233,7 +233,7 @@ namespace CSIRO.Metaheuristics.Tests
 
         protected override IClonableObjectiveEvaluator<T> deepClone()
         {
-            return new ParaboloidObjEval<T>(bestParam: this.bestParam);
+            return new ParaboloidObjEval<T>(bestParam: this.bestParam, addSine: this.addSine, sineFreq: this.sineFreq);
         }
     }
 
@@ -0,0 +1,55 @@
+﻿using System;
+
+namespace CSIRO.Metaheuristics.Utils
+{
+    /// <summary>
+    /// Running mean and variance of a stream of values, updated in constant time and memory per value (Welford's algorithm).
+    /// </summary>
+    public class RunningStatistics
+    {
+        private long count;
+        private double mean;
+        private double sumSquaredDiffs;
+
+        public void Add(double value)
+        {
+            count++;
+            double delta = value - mean;
+            mean += delta / count;
+            sumSquaredDiffs += delta * (value - mean);
+        }
+
+        public void Reset()
+        {
+            count = 0;
+            mean = 0;
+            sumSquaredDiffs = 0;
+        }
+
+        public long Count
+        {
+            get { return count; }
+        }
+
+        /// <summary>
+        /// Gets the mean of the values, NaN if there are none
+        /// </summary>
+        public double Mean
+        {
+            get { return count == 0 ? double.NaN : mean; }
+        }
+
+        /// <summary>
+        /// Gets the sample variance of the values, NaN if there are fewer than two
+        /// </summary>
+        public double Variance
+        {
+            get { return count < 2 ? double.NaN : sumSquaredDiffs / (count - 1); }
+        }
+
+        public double StandardDeviation
+        {
+            get { return Math.Sqrt(Variance); }
+        }
+    }
+}
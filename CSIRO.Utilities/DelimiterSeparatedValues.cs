@@ -106,6 +106,33 @@ namespace CSIRO.Utilities
             return FileInputOutputUtilities.LoadDelimitedFile( fileName, COMMA_CHARACTER );
         }
 
+        /// <summary>
+        /// Gets a set of numeric columns from a delimited file, parsed as the file is read.
+        /// </summary>
+        /// <param name="fileName"></param>
+        /// <param name="columnNumbers">A array of column numbers (one-based indexing) to extract</param>
+        /// <param name="delimiter">The field delimiter</param>
+        /// <param name="startLineIndex">The number of header lines to skip</param>
+        /// <returns>An array of arrays, i.e. an array of columns in the 
+        /// order specified by the indices passed as arguments to this function. Missing values are NaN.</returns>
+        /// <seealso cref="NumericColumnsReader"/>
+        public static double[][] GetNumericColumns( string fileName, int[] columnNumbers, char delimiter, int startLineIndex = 0 )
+        {
+            return NumericColumnsReader.LoadColumns( fileName, columnNumbers, delimiter, startLineIndex );
+        }
+
+        /// <summary>
+        /// Loads all the columns of a numeric CSV file, parsed as the file is read. Missing values are NaN.
+        /// </summary>
+        /// <param name="fileName"></param>
+        /// <param name="useCache">If true, the columns are read from a binary cache written on the first load, see <see cref="NumericColumnsCache"/></param>
+        public static double[][] LoadNumericFromCommaSeparated( string fileName, bool useCache = false )
+        {
+            if( useCache )
+                return NumericColumnsCache.LoadColumns( fileName, COMMA_CHARACTER );
+            return NumericColumnsReader.LoadColumns( fileName, COMMA_CHARACTER );
+        }
+
         public static string[][] MergeDictionaryTextFiles( string[] dictionaryFiles, string[] columnNames, char delimiter )
         {
             Dictionary<string, string>[] dicts = LoadDictionaries( dictionaryFiles, delimiter );
@@ -0,0 +1,340 @@
+﻿using System;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+
+namespace CSIRO.Utilities
+{
+    /// <summary>
+    /// A binary cache of the numeric columns of delimited text files, written on the first load of a file
+    /// and read back, or memory-mapped, by the following loads as long as the delimited file is unchanged.
+    /// </summary>
+    /// <remarks>
+    /// <para>The cache file has a header of 64 bytes followed by the columns one after the other, as little endian doubles.
+    /// The header records the length and last write time of the delimited file and the parsing settings, to detect stale caches.</para>
+    /// <para>The cache file is written next to the delimited file by default. Failing to write it, e.g. in a read-only
+    /// directory, is not an error; the columns are then parsed at each load.</para>
+    /// </remarks>
+    public static class NumericColumnsCache
+    {
+        /// <summary>
+        /// The extension appended to the name of a delimited file for its default cache file
+        /// </summary>
+        public const string DefaultExtension = ".mhcols";
+
+        internal const int HeaderLength = 64;
+        private static readonly byte[] magic = Encoding.ASCII.GetBytes( "MHNUMCOL" );
+        private const int formatVersion = 1;
+
+        /// <summary>
+        /// Loads all the columns of a delimited file, from its cache if it is current, otherwise parsing it and writing the cache.
+        /// </summary>
+        /// <param name="fileName">The delimited text file</param>
+        /// <param name="delimiter">The field delimiter</param>
+        /// <param name="startLineIndex">The number of header lines to skip</param>
+        /// <param name="missingValue">The value of the missing values</param>
+        /// <param name="cacheFileName">The cache file, by default the name of the delimited file with <see cref="DefaultExtension"/> appended</param>
+        /// <returns>The columns, in the order of the file</returns>
+        public static double[][] LoadColumns( string fileName, char delimiter, int startLineIndex = 0, double missingValue = double.NaN, string cacheFileName = null )
+        {
+            cacheFileName = cacheFileName ?? fileName + DefaultExtension;
+            var source = getSource( fileName, delimiter, startLineIndex, missingValue );
+            if( isCurrent( cacheFileName, source ) )
+                return Read( cacheFileName );
+            var columns = NumericColumnsReader.LoadColumns( fileName, delimiter, startLineIndex, missingValue );
+            tryWrite( cacheFileName, columns, source );
+            return columns;
+        }
+
+        /// <summary>
+        /// Maps in memory the cache of the columns of a delimited file, writing the cache first if it is not current.
+        /// </summary>
+        /// <remarks>The columns are then read from the file system cache, and can be passed to native code without copies,
+        /// see <see cref="MappedNumericColumns.GetColumnPointer"/>.</remarks>
+        /// <exception cref="IOException">The cache file cannot be written</exception>
+        public static MappedNumericColumns Map( string fileName, char delimiter, int startLineIndex = 0, double missingValue = double.NaN, string cacheFileName = null )
+        {
+            cacheFileName = cacheFileName ?? fileName + DefaultExtension;
+            var source = getSource( fileName, delimiter, startLineIndex, missingValue );
+            if( !isCurrent( cacheFileName, source ) )
+                write( cacheFileName, NumericColumnsReader.LoadColumns( fileName, delimiter, startLineIndex, missingValue ), source );
+            return new MappedNumericColumns( cacheFileName );
+        }
+
+        /// <summary>
+        /// Writes columns of equal length to a file in the format of the cache, without reference to a delimited file
+        /// </summary>
+        public static void Write( string cacheFileName, double[][] columns )
+        {
+            write( cacheFileName, columns, new SourceInfo( ) );
+        }
+
+        /// <summary>
+        /// Reads all the columns of a cache file
+        /// </summary>
+        public static double[][] Read( string cacheFileName )
+        {
+            using( var stream = File.OpenRead( cacheFileName ) )
+            using( var reader = new BinaryReader( stream ) )
+            {
+                int numColumns;
+                long numRows;
+                ReadHeader( reader, cacheFileName, out numColumns, out numRows );
+                CheckLength( stream.Length, numColumns, numRows, cacheFileName );
+                var result = new double[numColumns][];
+                byte[] bytes = new byte[(int)Math.Min( numRows * sizeof( double ), 1 << 16 )];
+                for( int i = 0; i < numColumns; i++ )
+                {
+                    result[i] = new double[numRows];
+                    int offset = 0;
+                    int remaining = (int)( numRows * sizeof( double ) );
+                    while( remaining > 0 )
+                    {
+                        int n = reader.Read( bytes, 0, Math.Min( remaining, bytes.Length ) );
+                        if( n == 0 )
+                            throw new EndOfStreamException( "Unexpected end of the cache file " + cacheFileName );
+                        Buffer.BlockCopy( bytes, 0, result[i], offset, n );
+                        offset += n;
+                        remaining -= n;
+                    }
+                }
+                return result;
+            }
+        }
+
+        internal static void ReadHeader( BinaryReader reader, string cacheFileName, out int numColumns, out long numRows )
+        {
+            SourceInfo ignored;
+            readHeader( reader, cacheFileName, out numColumns, out numRows, out ignored );
+        }
+
+        private static void readHeader( BinaryReader reader, string cacheFileName, out int numColumns, out long numRows, out SourceInfo source )
+        {
+            var m = reader.ReadBytes( magic.Length );
+            for( int i = 0; i < magic.Length; i++ )
+                if( m.Length != magic.Length || m[i] != magic[i] )
+                    throw new InvalidDataException( "Not a numeric columns cache file: " + cacheFileName );
+            int version = reader.ReadInt32( );
+            if( version != formatVersion )
+                throw new InvalidDataException( string.Format( "Unsupported version {0} of the numeric columns cache file {1}", version, cacheFileName ) );
+            numColumns = reader.ReadInt32( );
+            numRows = reader.ReadInt64( );
+            source = new SourceInfo
+            {
+                Length = reader.ReadInt64( ),
+                LastWriteTimeUtcTicks = reader.ReadInt64( ),
+                Delimiter = (char)reader.ReadInt32( ),
+                StartLineIndex = reader.ReadInt32( ),
+                MissingValueBits = reader.ReadInt64( )
+            };
+            reader.ReadInt64( );
+            if( numColumns < 0 || numRows < 0 )
+                throw new InvalidDataException( "Invalid header of the numeric columns cache file " + cacheFileName );
+        }
+
+        internal static void CheckLength( long fileLength, int numColumns, long numRows, string cacheFileName )
+        {
+            if( numRows * sizeof( double ) > int.MaxValue )
+                throw new InvalidDataException( "Columns too long in the numeric columns cache file " + cacheFileName );
+            if( fileLength != HeaderLength + numColumns * numRows * sizeof( double ) )
+                throw new InvalidDataException( "Unexpected length of the numeric columns cache file " + cacheFileName );
+        }
+
+        private struct SourceInfo
+        {
+            public long Length;
+            public long LastWriteTimeUtcTicks;
+            public char Delimiter;
+            public int StartLineIndex;
+            public long MissingValueBits;
+        }
+
+        private static SourceInfo getSource( string fileName, char delimiter, int startLineIndex, double missingValue )
+        {
+            var info = new FileInfo( fileName );
+            if( !info.Exists )
+                throw new ArgumentException( "Cannot find delimited file: " + fileName );
+            return new SourceInfo
+            {
+                Length = info.Length,
+                LastWriteTimeUtcTicks = info.LastWriteTimeUtc.Ticks,
+                Delimiter = delimiter,
+                StartLineIndex = startLineIndex,
+                MissingValueBits = BitConverter.DoubleToInt64Bits( missingValue )
+            };
+        }
+
+        private static bool isCurrent( string cacheFileName, SourceInfo source )
+        {
+            if( !File.Exists( cacheFileName ) )
+                return false;
+            try
+            {
+                using( var stream = File.OpenRead( cacheFileName ) )
+                using( var reader = new BinaryReader( stream ) )
+                {
+                    int numColumns;
+                    long numRows;
+                    SourceInfo cached;
+                    readHeader( reader, cacheFileName, out numColumns, out numRows, out cached );
+                    CheckLength( stream.Length, numColumns, numRows, cacheFileName );
+                    return cached.Equals( source );
+                }
+            }
+            catch( IOException )
+            {
+                return false;
+            }
+            catch( InvalidDataException )
+            {
+                return false;
+            }
+        }
+
+        private static void tryWrite( string cacheFileName, double[][] columns, SourceInfo source )
+        {
+            try
+            {
+                write( cacheFileName, columns, source );
+            }
+            catch( IOException ) { }
+            catch( UnauthorizedAccessException ) { }
+        }
+
+        private static void write( string cacheFileName, double[][] columns, SourceInfo source )
+        {
+            if( !BitConverter.IsLittleEndian )
+                throw new NotSupportedException( "Numeric columns cache files are only supported on little endian platforms" );
+            long numRows = ( columns.Length == 0 ? 0 : columns[0].Length );
+            for( int i = 0; i < columns.Length; i++ )
+                if( columns[i].Length != numRows )
+                    throw new ArgumentException( "All the columns must have the same length", "columns" );
+            var temp = cacheFileName + ".tmp";
+            using( var writer = new BinaryWriter( File.Create( temp ) ) )
+            {
+                writer.Write( magic );
+                writer.Write( formatVersion );
+                writer.Write( columns.Length );
+                writer.Write( numRows );
+                writer.Write( source.Length );
+                writer.Write( source.LastWriteTimeUtcTicks );
+                writer.Write( (int)source.Delimiter );
+                writer.Write( source.StartLineIndex );
+                writer.Write( source.MissingValueBits );
+                writer.Write( 0L );
+                byte[] bytes = new byte[(int)Math.Min( numRows * sizeof( double ), 1 << 16 )];
+                for( int i = 0; i < columns.Length; i++ )
+                {
+                    int offset = 0;
+                    int remaining = columns[i].Length * sizeof( double );
+                    while( remaining > 0 )
+                    {
+                        int n = Math.Min( remaining, bytes.Length );
+                        Buffer.BlockCopy( columns[i], offset, bytes, 0, n );
+                        writer.Write( bytes, 0, n );
+                        offset += n;
+                        remaining -= n;
+                    }
+                }
+            }
+            if( File.Exists( cacheFileName ) )
+                File.Replace( temp, cacheFileName, null );
+            else
+                File.Move( temp, cacheFileName );
+        }
+    }
+
+    /// <summary>
+    /// The columns of a numeric columns cache file, mapped in memory read-only.
+    /// </summary>
+    /// <remarks>
+    /// The pointers to the columns are valid until this object is disposed, and must not be written to.
+    /// </remarks>
+    public sealed class MappedNumericColumns : IDisposable
+    {
+        internal MappedNumericColumns( string cacheFileName )
+        {
+            if( !BitConverter.IsLittleEndian )
+                throw new NotSupportedException( "Numeric columns cache files are only supported on little endian platforms" );
+            long fileLength = new FileInfo( cacheFileName ).Length;
+            using( var reader = new BinaryReader( File.OpenRead( cacheFileName ) ) )
+            {
+                NumericColumnsCache.ReadHeader( reader, cacheFileName, out columnCount, out rowCount );
+            }
+            NumericColumnsCache.CheckLength( fileLength, columnCount, rowCount, cacheFileName );
+            file = MemoryMappedFile.CreateFromFile( cacheFileName, FileMode.Open, null, 0, MemoryMappedFileAccess.Read );
+            try
+            {
+                view = file.CreateViewAccessor( 0, 0, MemoryMappedFileAccess.Read );
+                dataStart = IntPtr.Add( view.SafeMemoryMappedViewHandle.DangerousGetHandle( ), (int)view.PointerOffset + NumericColumnsCache.HeaderLength );
+            }
+            catch
+            {
+                file.Dispose( );
+                throw;
+            }
+        }
+
+        private readonly MemoryMappedFile file;
+        private readonly MemoryMappedViewAccessor view;
+        private readonly IntPtr dataStart;
+        private readonly int columnCount;
+        private readonly long rowCount;
+        private bool disposed = false;
+
+        /// <summary>
+        /// Gets the number of columns
+        /// </summary>
+        public int ColumnCount
+        {
+            get { return columnCount; }
+        }
+
+        /// <summary>
+        /// Gets the number of values of each column
+        /// </summary>
+        public int RowCount
+        {
+            get { return (int)rowCount; }
+        }
+
+        /// <summary>
+        /// Gets the address of the first value of a column, e.g. to play it into a native simulation without copying it
+        /// </summary>
+        /// <param name="column">Zero-based index of the column</param>
+        public IntPtr GetColumnPointer( int column )
+        {
+            checkColumn( column );
+            return new IntPtr( dataStart.ToInt64( ) + column * rowCount * sizeof( double ) );
+        }
+
+        /// <summary>
+        /// Copies a column to a new array
+        /// </summary>
+        /// <param name="column">Zero-based index of the column</param>
+        public double[] CopyColumn( int column )
+        {
+            checkColumn( column );
+            var result = new double[rowCount];
+            view.ReadArray( NumericColumnsCache.HeaderLength + column * rowCount * sizeof( double ), result, 0, result.Length );
+            return result;
+        }
+
+        private void checkColumn( int column )
+        {
+            if( disposed )
+                throw new ObjectDisposedException( "MappedNumericColumns" );
+            if( column < 0 || column >= columnCount )
+                throw new ArgumentOutOfRangeException( "column", column, "Index of a column out of range" );
+        }
+
+        public void Dispose( )
+        {
+            if( disposed )
+                return;
+            disposed = true;
+            view.Dispose( );
+            file.Dispose( );
+        }
+    }
+}
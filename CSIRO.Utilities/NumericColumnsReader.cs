@@ -0,0 +1,343 @@
+﻿using System;
+using System.Globalization;
+using System.IO;
+
+namespace CSIRO.Utilities
+{
+    /// <summary>
+    /// Loads the numeric columns of delimited text, such as time series of forcing and observation data,
+    /// parsing the numbers as the text is streamed rather than splitting whole lines into strings.
+    /// </summary>
+    /// <remarks>
+    /// As for <see cref="FileInputOutputUtilities.LoadDelimitedFile(string, char, StringSplitOptions)"/>,
+    /// an empty line marks the end of the data. Numbers are parsed with the invariant culture; the fields
+    /// "NA" (case insensitive) and empty fields are missing values.
+    /// </remarks>
+    public static class NumericColumnsReader
+    {
+        private const int BufferSize = 1 << 16;
+
+        /// <summary>
+        /// Loads all the columns of a delimited file
+        /// </summary>
+        /// <param name="fileName">The delimited text file</param>
+        /// <param name="delimiter">The field delimiter</param>
+        /// <param name="startLineIndex">The number of header lines to skip</param>
+        /// <param name="missingValue">The value of the missing values</param>
+        /// <returns>The columns, in the order of the file</returns>
+        public static double[][] LoadColumns( string fileName, char delimiter, int startLineIndex = 0, double missingValue = double.NaN )
+        {
+            return LoadColumns( fileName, null, delimiter, startLineIndex, missingValue );
+        }
+
+        /// <summary>
+        /// Loads a set of columns of a delimited file
+        /// </summary>
+        /// <param name="fileName">The delimited text file</param>
+        /// <param name="columnNumbers">The column numbers (one-based indexing) to extract, or null for all the columns</param>
+        /// <param name="delimiter">The field delimiter</param>
+        /// <param name="startLineIndex">The number of header lines to skip</param>
+        /// <param name="missingValue">The value of the missing values</param>
+        /// <returns>An array of columns in the order of the column numbers</returns>
+        public static double[][] LoadColumns( string fileName, int[] columnNumbers, char delimiter, int startLineIndex = 0, double missingValue = double.NaN )
+        {
+            if( !File.Exists( fileName ) )
+                throw new ArgumentException( "Cannot find delimited file: " + fileName );
+            using( var reader = new StreamReader( fileName ) )
+            {
+                return LoadColumns( reader, columnNumbers, delimiter, startLineIndex, missingValue );
+            }
+        }
+
+        /// <summary>
+        /// Loads a set of columns of delimited text
+        /// </summary>
+        /// <param name="reader">The delimited text</param>
+        /// <param name="columnNumbers">The column numbers (one-based indexing) to extract, or null for all the columns</param>
+        /// <param name="delimiter">The field delimiter</param>
+        /// <param name="startLineIndex">The number of header lines to skip</param>
+        /// <param name="missingValue">The value of the missing values</param>
+        /// <returns>An array of columns in the order of the column numbers</returns>
+        public static double[][] LoadColumns( TextReader reader, int[] columnNumbers, char delimiter, int startLineIndex = 0, double missingValue = double.NaN )
+        {
+            if( columnNumbers != null )
+                for( int i = 0; i < columnNumbers.Length; i++ )
+                    if( columnNumbers[i] < 1 )
+                        throw new ArgumentOutOfRangeException( "columnNumbers", columnNumbers[i], "Column numbers are one-based" );
+            var parser = new Parser( columnNumbers, delimiter, missingValue );
+            char[] buffer = new char[BufferSize];
+            int length = 0;
+            int lineNumber = 0;
+            bool endOfData = false;
+            while( !endOfData )
+            {
+                int read = reader.Read( buffer, length, buffer.Length - length );
+                bool endOfText = ( read == 0 );
+                length += read;
+                int lineStart = 0;
+                while( !endOfData )
+                {
+                    int lineEnd = Array.IndexOf( buffer, '\n', lineStart, length - lineStart );
+                    if( lineEnd < 0 )
+                    {
+                        if( !endOfText || lineStart == length )
+                            break;
+                        // Last line, without a line terminator
+                        lineEnd = length;
+                    }
+                    int end = lineEnd;
+                    if( end > lineStart && buffer[end - 1] == '\r' )
+                        end--;
+                    lineNumber++;
+                    if( lineNumber > startLineIndex )
+                    {
+                        if( end == lineStart )
+                            endOfData = true;
+                        else
+                            parser.ParseLine( buffer, lineStart, end, lineNumber );
+                    }
+                    lineStart = Math.Min( lineEnd + 1, length );
+                }
+                if( endOfText )
+                    break;
+                // Keep the incomplete line for the next read, growing the buffer for lines longer than it.
+                length -= lineStart;
+                Array.Copy( buffer, lineStart, buffer, 0, length );
+                if( length == buffer.Length )
+                    Array.Resize( ref buffer, buffer.Length * 2 );
+            }
+            return parser.GetColumns( );
+        }
+
+        /// <summary>
+        /// Parses a number of delimited text, without allocating in the common cases
+        /// </summary>
+        /// <remarks>
+        /// Numbers with at most 19 significant digits and a small decimal exponent are computed exactly from their digits
+        /// and a power of ten, which is correctly rounded when both are exact doubles (Clinger, 1990).
+        /// Other numbers are parsed by <see cref="double.Parse(string, NumberStyles, IFormatProvider)"/>,
+        /// numbers beyond the range of a double being positive or negative infinity.
+        /// </remarks>
+        internal static double ParseDouble( char[] text, int start, int end, double missingValue )
+        {
+            while( start < end && char.IsWhiteSpace( text[start] ) )
+                start++;
+            while( end > start && char.IsWhiteSpace( text[end - 1] ) )
+                end--;
+            if( start == end )
+                return missingValue;
+            double result;
+            if( tryParseSimple( text, start, end, out result ) )
+                return result;
+            if( end - start == 2 && char.ToUpperInvariant( text[start] ) == 'N' && char.ToUpperInvariant( text[start + 1] ) == 'A' )
+                return missingValue;
+            try
+            {
+                return double.Parse( new string( text, start, end - start ), NumberStyles.Float, CultureInfo.InvariantCulture );
+            }
+            catch( OverflowException )
+            {
+                // Thrown on .NET Framework, whereas .NET Core returns infinities out of the range of a double
+                return ( text[start] == '-' ? double.NegativeInfinity : double.PositiveInfinity );
+            }
+        }
+
+        private static readonly double[] powersOfTen = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        private const ulong maxExactMantissa = 1UL << 53;
+
+        private static bool tryParseSimple( char[] text, int start, int end, out double result )
+        {
+            result = 0;
+            int i = start;
+            bool negative = false;
+            if( text[i] == '-' || text[i] == '+' )
+            {
+                negative = ( text[i] == '-' );
+                i++;
+            }
+            ulong mantissa = 0;
+            int digits = 0;
+            int significantDigits = 0;
+            int exponent = 0;
+            for( ; i < end && isDigit( text[i] ); i++, digits++ )
+                if( !accumulate( ref mantissa, ref significantDigits, text[i] ) )
+                    exponent++;
+            if( i < end && text[i] == '.' )
+            {
+                for( i++; i < end && isDigit( text[i] ); i++, digits++ )
+                    if( accumulate( ref mantissa, ref significantDigits, text[i] ) )
+                        exponent--;
+            }
+            if( digits == 0 )
+                return false;
+            if( i < end && ( text[i] == 'e' || text[i] == 'E' ) )
+            {
+                i++;
+                bool negativeExponent = false;
+                if( i < end && ( text[i] == '-' || text[i] == '+' ) )
+                {
+                    negativeExponent = ( text[i] == '-' );
+                    i++;
+                }
+                if( i == end )
+                    return false;
+                int e = 0;
+                for( ; i < end && isDigit( text[i] ); i++ )
+                {
+                    if( e > 10000 )
+                        return false;
+                    e = e * 10 + ( text[i] - '0' );
+                }
+                exponent += ( negativeExponent ? -e : e );
+            }
+            if( i != end || significantDigits > 19 )
+                return false;
+            if( mantissa == 0 )
+                result = 0.0;
+            else if( mantissa > maxExactMantissa || exponent < -22 || exponent > 22 )
+                return false;
+            else if( exponent < 0 )
+                result = mantissa / powersOfTen[-exponent];
+            else
+                result = mantissa * powersOfTen[exponent];
+            if( negative )
+                result = -result;
+            return true;
+        }
+
+        private static bool isDigit( char c )
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /// <summary>
+        /// Appends a digit to the mantissa, unless there are already more significant digits than a 64 bits integer holds
+        /// </summary>
+        /// <returns>Whether the digit was appended; leading zeros are, without being counted as significant</returns>
+        private static bool accumulate( ref ulong mantissa, ref int significantDigits, char digit )
+        {
+            if( significantDigits > 19 )
+                return false;
+            if( mantissa == 0 && digit == '0' )
+                return true;
+            significantDigits++;
+            if( significantDigits > 19 )
+                return false;
+            mantissa = mantissa * 10 + (ulong)( digit - '0' );
+            return true;
+        }
+
+        /// <summary>
+        /// Accumulates the values of the fields of the lines into growing columns
+        /// </summary>
+        private class Parser
+        {
+            internal Parser( int[] columnNumbers, char delimiter, double missingValue )
+            {
+                this.columnNumbers = columnNumbers;
+                this.delimiter = delimiter;
+                this.missingValue = missingValue;
+                if( columnNumbers != null )
+                    initColumns( columnNumbers.Length );
+            }
+
+            private readonly int[] columnNumbers;
+            private readonly char delimiter;
+            private readonly double missingValue;
+            private double[][] columns;
+            // For each field of a line, the index of its column, or -1 if it is not loaded.
+            private int[] fieldColumns;
+            private int numFields = -1;
+            private int count = 0;
+
+            private void initColumns( int numColumns )
+            {
+                columns = new double[numColumns][];
+                for( int i = 0; i < numColumns; i++ )
+                    columns[i] = new double[256];
+            }
+
+            internal void ParseLine( char[] text, int start, int end, int lineNumber )
+            {
+                if( numFields < 0 )
+                    initFields( text, start, end, lineNumber );
+                if( count == columns[0].Length )
+                    for( int i = 0; i < columns.Length; i++ )
+                        Array.Resize( ref columns[i], count * 2 );
+                int field = 0;
+                int fieldStart = start;
+                while( true )
+                {
+                    int fieldEnd = Array.IndexOf( text, delimiter, fieldStart, end - fieldStart );
+                    if( fieldEnd < 0 )
+                        fieldEnd = end;
+                    if( field >= numFields )
+                        throw fieldCountError( lineNumber );
+                    int column = fieldColumns[field];
+                    if( column >= 0 )
+                    {
+                        try
+                        {
+                            columns[column][count] = ParseDouble( text, fieldStart, fieldEnd, missingValue );
+                        }
+                        catch( FormatException )
+                        {
+                            throw new FormatException( string.Format( "Line {0}, field {1}: '{2}' is not a number", lineNumber, field + 1, new string( text, fieldStart, fieldEnd - fieldStart ) ) );
+                        }
+                    }
+                    field++;
+                    if( fieldEnd == end )
+                        break;
+                    fieldStart = fieldEnd + 1;
+                }
+                if( field != numFields )
+                    throw fieldCountError( lineNumber );
+                count++;
+            }
+
+            // The first line of data sets the number of fields of all lines.
+            private void initFields( char[] text, int start, int end, int lineNumber )
+            {
+                numFields = 1;
+                for( int i = start; i < end; i++ )
+                    if( text[i] == delimiter )
+                        numFields++;
+                fieldColumns = new int[numFields];
+                if( columnNumbers == null )
+                {
+                    initColumns( numFields );
+                    for( int i = 0; i < numFields; i++ )
+                        fieldColumns[i] = i;
+                    return;
+                }
+                for( int i = 0; i < numFields; i++ )
+                    fieldColumns[i] = -1;
+                for( int i = 0; i < columnNumbers.Length; i++ )
+                {
+                    if( columnNumbers[i] > numFields )
+                        throw new FormatException( string.Format( "Line {0} has {1} fields, but column {2} is requested", lineNumber, numFields, columnNumbers[i] ) );
+                    if( fieldColumns[columnNumbers[i] - 1] >= 0 )
+                        throw new ArgumentException( "Column " + columnNumbers[i] + " is requested more than once", "columnNumbers" );
+                    fieldColumns[columnNumbers[i] - 1] = i;
+                }
+            }
+
+            private FormatException fieldCountError( int lineNumber )
+            {
+                return new FormatException( string.Format( "Line {0} does not have the {1} fields of the first line of data", lineNumber, numFields ) );
+            }
+
+            internal double[][] GetColumns( )
+            {
+                if( columns == null )
+                    return new double[0][];
+                for( int i = 0; i < columns.Length; i++ )
+                    Array.Resize( ref columns[i], count );
+                return columns;
+            }
+        }
+    }
+}
@@ -0,0 +1,596 @@
+// Benchmarks of the native AWBM model, to track the cost of a simulation across changes.
+//
+// The command line options, console output and JSON/CSV result files follow those of Google Benchmark,
+// like the benchmarks of the .NET framework (CSIRO.Metaheuristics.Benchmarks), so that results of both
+// can be compared with the same tools (e.g. compare.py of Google Benchmark):
+//
+//   NativeModelBenchmark [--benchmark_filter=regex] [--benchmark_min_time=seconds] [--benchmark_repetitions=n]
+//       [--benchmark_out=file] [--benchmark_out_format=json|csv] [--benchmark_list_tests] [--data=CatData.csv]
+//
+// The forcing data defaults to the sample catchment of the AWBM_URS tutorial.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <new>
+#include <regex>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AwbmSimulation.h"
+#include "AwbmSimulationPool.h"
+#include "AwbmBatchKernel.h"
+
+namespace
+{
+	// Keeps the optimiser from removing the computations whose results are otherwise unused.
+	volatile double sink = 0;
+
+	// Number of calls to operator new, to check the code paths meant not to allocate memory once warm.
+	std::atomic<long long> allocationCount(0);
+}
+
+void * operator new(std::size_t size)
+{
+	allocationCount++;
+	if (void * p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+
+	// State of a running benchmark: the timed loop is 'while (state.KeepRunning()) {...}'.
+	class BenchmarkState
+	{
+	public:
+		explicit BenchmarkState(long long maxIterations) : maxIterations(maxIterations) {}
+
+		bool KeepRunning()
+		{
+			if (iterations == 0)
+				ResumeTiming();
+			if (iterations < maxIterations) {
+				iterations++;
+				return true;
+			}
+			PauseTiming();
+			return false;
+		}
+		void PauseTiming()
+		{
+			if (!running) return;
+			realTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+			cpuTime += double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+			running = false;
+		}
+		void ResumeTiming()
+		{
+			if (running) return;
+			realStart = std::chrono::steady_clock::now();
+			cpuStart = std::clock();
+			running = true;
+		}
+
+		long long Iterations() const { return iterations; }
+		double RealTime() const { return realTime; }
+		double CpuTime() const { return cpuTime; }
+
+		long long itemsProcessed = 0;
+		std::map<std::string, double> counters;
+
+	private:
+		long long maxIterations;
+		long long iterations = 0;
+		bool running = false;
+		double realTime = 0, cpuTime = 0;
+		std::chrono::steady_clock::time_point realStart;
+		std::clock_t cpuStart = 0;
+	};
+
+	struct Benchmark
+	{
+		std::string name;
+		std::function<void(BenchmarkState&)> function;
+	};
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		std::string runType = "iteration";
+		std::string aggregateName;
+		long long iterations = 0;
+		// Per iteration, in microseconds
+		double realTime = 0, cpuTime = 0;
+		double itemsPerSecond = 0;
+		std::map<std::string, double> counters;
+	};
+
+	BenchmarkResult runOnce(const Benchmark& benchmark, double minTime)
+	{
+		// Same growth of the number of iterations as Google Benchmark, until the run lasts long enough
+		long long iterations = 1;
+		const long long maxIterations = 1000000000LL;
+		while (true) {
+			BenchmarkState state(iterations);
+			benchmark.function(state);
+			double seconds = std::max(state.CpuTime(), state.RealTime());
+			if (seconds >= minTime || iterations >= maxIterations) {
+				BenchmarkResult result;
+				result.name = benchmark.name;
+				result.iterations = state.Iterations();
+				result.realTime = state.RealTime() * 1e6 / result.iterations;
+				result.cpuTime = state.CpuTime() * 1e6 / result.iterations;
+				if (state.itemsProcessed > 0 && state.CpuTime() > 0)
+					result.itemsPerSecond = state.itemsProcessed / state.CpuTime();
+				for (auto& c : state.counters)
+					result.counters[c.first] = c.second / result.iterations;
+				return result;
+			}
+			double multiplier = minTime * 1.4 / std::max(seconds, 1e-9);
+			bool isSignificant = (seconds / minTime) > 0.1;
+			multiplier = (isSignificant ? multiplier : std::min(10.0, multiplier));
+			if (multiplier <= 1.0) multiplier = 2.0;
+			iterations = std::min(maxIterations, std::max((long long)(iterations * multiplier), iterations + 1));
+		}
+	}
+
+	BenchmarkResult aggregate(const std::vector<BenchmarkResult>& runs, const std::string& aggregateName)
+	{
+		BenchmarkResult result;
+		result.name = runs[0].name + "_" + aggregateName;
+		result.runType = "aggregate";
+		result.aggregateName = aggregateName;
+		result.iterations = (long long)runs.size();
+		auto stat = [&](std::function<double(const BenchmarkResult&)> get) {
+			std::vector<double> x;
+			for (auto& r : runs) x.push_back(get(r));
+			if (aggregateName == "median") {
+				std::sort(x.begin(), x.end());
+				size_t n = x.size();
+				return (n % 2 == 1 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2);
+			}
+			double mean = 0;
+			for (double v : x) mean += v;
+			mean /= x.size();
+			if (aggregateName == "mean") return mean;
+			if (x.size() < 2) return 0.0;
+			double ss = 0;
+			for (double v : x) ss += (v - mean) * (v - mean);
+			return std::sqrt(ss / (x.size() - 1));
+		};
+		result.realTime = stat([](const BenchmarkResult& r) { return r.realTime; });
+		result.cpuTime = stat([](const BenchmarkResult& r) { return r.cpuTime; });
+		result.itemsPerSecond = stat([](const BenchmarkResult& r) { return r.itemsPerSecond; });
+		for (auto& c : runs[0].counters) {
+			std::string key = c.first;
+			result.counters[key] = stat([key](const BenchmarkResult& r) { return r.counters.at(key); });
+		}
+		return result;
+	}
+
+	std::string jsonQuote(const std::string& s)
+	{
+		std::string result = "\"";
+		for (char c : s) {
+			if (c == '"' || c == '\\') { result += '\\'; result += c; }
+			else if (c == '\n') result += "\\n";
+			else result += c;
+		}
+		return result + "\"";
+	}
+
+	std::string csvQuote(const std::string& s)
+	{
+		std::string result = "\"";
+		for (char c : s) {
+			if (c == '"') result += "\"\"";
+			else result += c;
+		}
+		return result + "\"";
+	}
+
+	void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results, const std::vector<std::pair<std::string, std::string>>& context)
+	{
+		out.precision(17);
+		out << "{\n  \"context\": {\n";
+		for (size_t i = 0; i < context.size(); i++)
+			out << "    " << jsonQuote(context[i].first) << ": " << jsonQuote(context[i].second) << (i + 1 < context.size() ? ",\n" : "\n");
+		out << "  },\n  \"benchmarks\": [\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchmarkResult& r = results[i];
+			out << "    {\n";
+			out << "      \"name\": " << jsonQuote(r.name) << ",\n";
+			out << "      \"run_name\": " << jsonQuote(r.runType == "aggregate" ? r.name.substr(0, r.name.size() - r.aggregateName.size() - 1) : r.name) << ",\n";
+			out << "      \"run_type\": " << jsonQuote(r.runType) << ",\n";
+			if (r.runType == "aggregate")
+				out << "      \"aggregate_name\": " << jsonQuote(r.aggregateName) << ",\n";
+			out << "      \"iterations\": " << r.iterations << ",\n";
+			out << "      \"real_time\": " << r.realTime << ",\n";
+			out << "      \"cpu_time\": " << r.cpuTime << ",\n";
+			out << "      \"time_unit\": \"us\"";
+			if (r.itemsPerSecond > 0)
+				out << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+			for (auto& c : r.counters)
+				out << ",\n      " << jsonQuote(c.first) << ": " << c.second;
+			out << "\n    }" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "  ]\n}\n";
+	}
+
+	void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results)
+	{
+		std::vector<std::string> counterNames;
+		for (auto& r : results)
+			for (auto& c : r.counters)
+				if (std::find(counterNames.begin(), counterNames.end(), c.first) == counterNames.end())
+					counterNames.push_back(c.first);
+		out.precision(17);
+		out << "name,iterations,real_time,cpu_time,time_unit,bytes_per_second,items_per_second,label,error_occurred,error_message";
+		for (auto& n : counterNames)
+			out << "," << csvQuote(n);
+		out << "\n";
+		for (auto& r : results) {
+			out << csvQuote(r.name) << "," << r.iterations << "," << r.realTime << "," << r.cpuTime << ",us,,";
+			if (r.itemsPerSecond > 0)
+				out << r.itemsPerSecond;
+			out << ",,,";
+			for (auto& n : counterNames) {
+				out << ",";
+				auto it = r.counters.find(n);
+				if (it != r.counters.end())
+					out << it->second;
+			}
+			out << "\n";
+		}
+	}
+
+	// Forcing data and observations of a catchment
+	struct CatchmentData
+	{
+		std::vector<double> rainfall, evap, runoff;
+	};
+
+	CatchmentData loadCatchmentData(const std::string& fileName)
+	{
+		std::ifstream in(fileName);
+		if (!in) throw std::runtime_error("Cannot open the data file " + fileName);
+		CatchmentData data;
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.empty()) continue;
+			std::replace(line.begin(), line.end(), ',', ' ');
+			std::istringstream fields(line);
+			double values[3];
+			for (double& v : values) {
+				std::string field;
+				if (!(fields >> field))
+					throw std::runtime_error("Invalid line in " + fileName + ": " + line);
+				// Missing observations are written as NA, and skipped by the statistics as NaN
+				v = (field == "NA" ? std::numeric_limits<double>::quiet_NaN() : std::stod(field));
+			}
+			data.rainfall.push_back(values[0]);
+			data.evap.push_back(values[1]);
+			data.runoff.push_back(values[2]);
+		}
+		return data;
+	}
+
+	// The calibration setup of the AWBM_URS tutorial: parameters near the optimum, the whole series simulated.
+	void setupSimulation(AwbmSimulation& simulation, const CatchmentData& data)
+	{
+		simulation.Play(AwbmVariable::Rainfall, SharedSeries(new std::vector<double>(data.rainfall)));
+		simulation.Play(AwbmVariable::Evapotranspiration, SharedSeries(new std::vector<double>(data.evap)));
+		simulation.SetSpan(0, (int)data.rainfall.size() - 1);
+		simulation.SetVariable(AwbmVariable::C1, 40);
+		simulation.SetVariable(AwbmVariable::C2, 200);
+		simulation.SetVariable(AwbmVariable::C3, 350);
+		simulation.SetVariable(AwbmVariable::BFI, 0.35);
+		simulation.SetVariable(AwbmVariable::KSurf, 0.35);
+		simulation.SetVariable(AwbmVariable::KBase, 0.95);
+	}
+
+	// Parameter sets spread over the feasible region, in the layout expected by ExecuteBatch
+	std::vector<double> createParameterSets(int numSets)
+	{
+		std::vector<double> sets;
+		for (int k = 0; k < numSets; k++) {
+			double f = (numSets > 1 ? double(k) / (numSets - 1) : 0.5);
+			sets.push_back(10 + 40 * f);   // C1
+			sets.push_back(100 + 200 * f); // C2
+			sets.push_back(200 + 300 * f); // C3
+			sets.push_back(0.2 + 0.6 * f); // BFI
+			sets.push_back(0.1 + 0.8 * f); // KSurf
+			sets.push_back(0.9 + 0.09 * f); // KBase
+		}
+		return sets;
+	}
+
+	const std::vector<std::string> parameterIds = { "C1", "C2", "C3", "BFI", "KSurf", "KBase" };
+
+	std::vector<Benchmark> createBenchmarks(const CatchmentData& data)
+	{
+		std::vector<Benchmark> benchmarks;
+		const CatchmentData * d = &data;
+
+		benchmarks.push_back({ "AwbmSimulation/Execute/record", [d](BenchmarkState& state) {
+			AwbmSimulation simulation;
+			setupSimulation(simulation, *d);
+			simulation.Record(AwbmVariable::Runoff);
+			std::vector<double> runoff(simulation.NumSteps());
+			while (state.KeepRunning()) {
+				simulation.Execute();
+				simulation.GetRecorded(AwbmVariable::Runoff, runoff.data(), (int)runoff.size());
+				sink = runoff.back();
+			}
+			state.itemsProcessed = state.Iterations() * simulation.NumSteps();
+		} });
+
+		benchmarks.push_back({ "AwbmSimulation/Execute/statistics", [d](BenchmarkState& state) {
+			AwbmSimulation simulation;
+			setupSimulation(simulation, *d);
+			SharedSeries observed(new std::vector<double>(d->runoff));
+			int handle = simulation.AddStatistics(AwbmVariable::Runoff, observed, 0, simulation.GetEnd(), 1.0);
+			while (state.KeepRunning()) {
+				simulation.Execute();
+				sink = simulation.GetStatistic(handle, AwbmStatistic::NSE);
+			}
+			state.itemsProcessed = state.Iterations() * simulation.NumSteps();
+		} });
+
+		benchmarks.push_back({ "AwbmSimulation/CopyFrom", [d](BenchmarkState& state) {
+			AwbmSimulation simulation;
+			setupSimulation(simulation, *d);
+			simulation.Record(AwbmVariable::Runoff);
+			AwbmSimulation clone;
+			while (state.KeepRunning()) {
+				clone.CopyFrom(simulation);
+				sink = clone.GetVariable(AwbmVariable::C1);
+			}
+			state.itemsProcessed = state.Iterations();
+		} });
+
+		for (bool fromTemplate : { false, true }) {
+			// Recycled simulations keep the storage of their recorded series: a warm cycle must not allocate memory.
+			benchmarks.push_back({ std::string("AwbmSimulationPool/Acquire/Execute/Release") + (fromTemplate ? "/template" : ""), [d, fromTemplate](BenchmarkState& state) {
+				AwbmSimulationPool pool(1);
+				AwbmSimulation templateSimulation;
+				setupSimulation(templateSimulation, *d);
+				templateSimulation.Record(AwbmVariable::Runoff);
+				SharedSeries rainfall(new std::vector<double>(d->rainfall));
+				SharedSeries evap(new std::vector<double>(d->evap));
+				auto cycle = [&]() {
+					AwbmSimulation * simulation;
+					if (fromTemplate)
+						simulation = pool.Acquire(templateSimulation);
+					else {
+						simulation = pool.Acquire();
+						simulation->Record(AwbmVariable::Runoff);
+						simulation->SetSpan(0, (int)d->rainfall.size() - 1);
+					}
+					simulation->Play(AwbmVariable::Rainfall, rainfall);
+					simulation->Play(AwbmVariable::Evapotranspiration, evap);
+					simulation->Execute();
+					sink = simulation->GetVariable(AwbmVariable::Runoff);
+					pool.Release(simulation);
+				};
+				cycle();
+				long long warm = allocationCount;
+				while (state.KeepRunning())
+					cycle();
+				long long allocations = allocationCount - warm;
+				state.counters["allocations"] = double(allocations);
+				if (allocations != 0)
+					throw "A warm cycle of AwbmSimulationPool allocated memory";
+				state.itemsProcessed = state.Iterations() * (long long)d->rainfall.size();
+			} });
+		}
+
+		for (int numSets : { 16, 64 }) {
+			// The same parameter sets, one simulation at a time then in lock step, to measure the gain of the batch kernel
+			benchmarks.push_back({ "AwbmSimulation/Execute/sequential/sets:" + std::to_string(numSets), [d, numSets](BenchmarkState& state) {
+				AwbmSimulation simulation;
+				setupSimulation(simulation, *d);
+				simulation.Record(AwbmVariable::Runoff);
+				std::vector<double> sets = createParameterSets(numSets);
+				int numSteps = simulation.NumSteps();
+				std::vector<double> outputs((size_t)numSets * numSteps);
+				while (state.KeepRunning()) {
+					for (int k = 0; k < numSets; k++) {
+						for (size_t j = 0; j < parameterIds.size(); j++)
+							simulation.SetVariable(parameterIds[j], sets[k * parameterIds.size() + j]);
+						simulation.Execute();
+						simulation.GetRecorded(AwbmVariable::Runoff, outputs.data() + (size_t)k * numSteps, numSteps);
+					}
+					sink = outputs.back();
+				}
+				state.itemsProcessed = state.Iterations() * numSets * numSteps;
+			} });
+			benchmarks.push_back({ "AwbmSimulation/ExecuteBatch/sets:" + std::to_string(numSets), [d, numSets](BenchmarkState& state) {
+				AwbmSimulation simulation;
+				setupSimulation(simulation, *d);
+				std::vector<double> sets = createParameterSets(numSets);
+				int numSteps = simulation.NumSteps();
+				std::vector<double> outputs((size_t)numSets * numSteps);
+				while (state.KeepRunning()) {
+					simulation.ExecuteBatch(parameterIds, sets.data(), numSets, "Runoff", outputs.data());
+					sink = outputs.back();
+				}
+				state.itemsProcessed = state.Iterations() * numSets * numSteps;
+			} });
+		}
+		return benchmarks;
+	}
+
+	std::string formatTime(double microseconds)
+	{
+		std::ostringstream s;
+		s.setf(std::ios::fixed);
+		if (microseconds >= 1e5) { s.precision(0); s << microseconds / 1000 << " ms"; }
+		else { s.precision(microseconds >= 100 ? 0 : 2); s << microseconds << " us"; }
+		return s.str();
+	}
+
+	void printResult(const BenchmarkResult& r)
+	{
+		std::ostringstream line;
+		line << std::left;
+		line.width(60); line << r.name << " ";
+		line << std::right;
+		line.width(17); line << formatTime(r.realTime) << " ";
+		line.width(17); line << formatTime(r.cpuTime) << " ";
+		line.width(12); line << r.iterations;
+		if (r.itemsPerSecond > 0) {
+			std::ostringstream items;
+			items.precision(4);
+			items << " items_per_second=" << r.itemsPerSecond / 1e6 << "M/s";
+			line << items.str();
+		}
+		std::cout << line.str() << std::endl;
+	}
+
+	int usage(const std::string& message)
+	{
+		std::cerr << message << std::endl;
+		std::cerr << "Usage: NativeModelBenchmark [--benchmark_filter=regex] [--benchmark_min_time=seconds] [--benchmark_repetitions=n] "
+			"[--benchmark_out=file] [--benchmark_out_format=json|csv] [--benchmark_list_tests] [--data=CatData.csv]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	std::map<std::string, std::string> options;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg.compare(0, 2, "--") != 0)
+			return usage("Unexpected argument: " + arg);
+		size_t eq = arg.find('=');
+		if (eq == std::string::npos)
+			options[arg.substr(2)] = "true";
+		else
+			options[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+	}
+	auto getOption = [&](const std::string& name, const std::string& defaultValue) {
+		auto it = options.find(name);
+		return (it == options.end() ? defaultValue : it->second);
+	};
+	const std::vector<std::string> known = { "benchmark_filter", "benchmark_min_time", "benchmark_repetitions", "benchmark_out", "benchmark_out_format", "benchmark_list_tests", "data" };
+	for (auto& o : options)
+		if (std::find(known.begin(), known.end(), o.first) == known.end())
+			return usage("Unknown option: --" + o.first);
+	std::string format = getOption("benchmark_out_format", "json");
+	if (format != "json" && format != "csv")
+		return usage("Unsupported output format: " + format);
+
+	double minTime;
+	int repetitions;
+	try {
+		minTime = std::stod(getOption("benchmark_min_time", "0.5"));
+		repetitions = std::stoi(getOption("benchmark_repetitions", "1"));
+	}
+	catch (const std::exception&) {
+		return usage("Invalid numeric option");
+	}
+
+	CatchmentData data;
+	std::string dataFile = getOption("data", "../AWBM_URS/CatData.csv");
+	try {
+		data = loadCatchmentData(dataFile);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	std::regex filter(getOption("benchmark_filter", ".*"));
+	std::vector<Benchmark> benchmarks;
+	for (auto& b : createBenchmarks(data))
+		if (std::regex_search(b.name, filter))
+			benchmarks.push_back(b);
+
+	if (options.count("benchmark_list_tests")) {
+		for (auto& b : benchmarks)
+			std::cout << b.name << std::endl;
+		return 0;
+	}
+
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	std::vector<std::pair<std::string, std::string>> context = {
+		{ "date", date },
+		{ "executable", argv[0] },
+		{ "num_cpus", std::to_string(std::thread::hardware_concurrency()) },
+		{ "awbm_batch_kernel", AwbmBatchKernelName(SelectAwbmBatchKernel()) },
+		{ "data", dataFile },
+		{ "num_time_steps", std::to_string(data.rainfall.size()) },
+#ifdef NDEBUG
+		{ "library_build_type", "release" },
+#else
+		{ "library_build_type", "debug" },
+#endif
+	};
+	for (auto& c : context)
+		std::cout << c.first << ": " << c.second << std::endl;
+	std::ostringstream header;
+	header << std::left;
+	header.width(60); header << "Benchmark" << " " << std::right;
+	header.width(17); header << "Time" << " ";
+	header.width(17); header << "CPU" << " ";
+	header.width(12); header << "Iterations";
+	std::cout << header.str() << std::endl;
+
+	std::vector<BenchmarkResult> results;
+	try {
+		for (auto& b : benchmarks) {
+			std::vector<BenchmarkResult> runs;
+			for (int i = 0; i < std::max(1, repetitions); i++) {
+				runs.push_back(runOnce(b, minTime));
+				printResult(runs.back());
+			}
+			results.insert(results.end(), runs.begin(), runs.end());
+			if (runs.size() > 1) {
+				for (const char * name : { "mean", "median", "stddev" }) {
+					results.push_back(aggregate(runs, name));
+					printResult(results.back());
+				}
+			}
+		}
+	}
+	catch (const char * message) {
+		std::cerr << "Benchmark failed: " << message << std::endl;
+		return 1;
+	}
+
+	std::string outFile = getOption("benchmark_out", "");
+	if (!outFile.empty()) {
+		std::ofstream out(outFile);
+		if (format == "csv")
+			writeCsv(out, results);
+		else
+			writeJson(out, results, context);
+	}
+	return 0;
+}
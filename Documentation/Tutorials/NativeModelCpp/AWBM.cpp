@@ -91,6 +91,85 @@ void AWBM::Reset()
 	}
 }
 
+AwbmVariable AWBM::ResolveVariable(const std::string& variableIdentifier)
+{
+	if (variableIdentifier == "Rainfall") return AwbmVariable::Rainfall;
+	else if (variableIdentifier == "Evapotranspiration") return AwbmVariable::Evapotranspiration;
+	else if (variableIdentifier == "Runoff") return AwbmVariable::Runoff;
+	else if (variableIdentifier == "Baseflow") return AwbmVariable::Baseflow;
+	else if (variableIdentifier == "BFI") return AwbmVariable::BFI;
+	else if (variableIdentifier == "KSurf") return AwbmVariable::KSurf;
+	else if (variableIdentifier == "KBase") return AwbmVariable::KBase;
+	else if (variableIdentifier == "C1") return AwbmVariable::C1;
+	else if (variableIdentifier == "C2") return AwbmVariable::C2;
+	else if (variableIdentifier == "C3") return AwbmVariable::C3;
+	else throw "Unknown model variable";
+}
+
+double * AWBM::GetPtr(AwbmVariable variableId)
+{
+	switch (variableId)
+	{
+	case AwbmVariable::Rainfall: return &Rainfall;
+	case AwbmVariable::Evapotranspiration: return &Evapotranspiration;
+	case AwbmVariable::Runoff: return &Runoff;
+	case AwbmVariable::Baseflow: return &Baseflow;
+	case AwbmVariable::BFI: return &BFI;
+	case AwbmVariable::KSurf: return &KSurf;
+	case AwbmVariable::KBase: return &KBase;
+	case AwbmVariable::C1: return &capacities[0];
+	case AwbmVariable::C2: return &capacities[1];
+	case AwbmVariable::C3: return &capacities[2];
+	default: throw "Unknown model variable identifier";
+	}
+}
+
+AwbmState AWBM::SaveState()
+{
+	AwbmState state;
+	for (int i = 0; i < 3; i++)
+		state.Store[i] = Store[i];
+	state.BaseflowStore = BaseflowStore;
+	state.SurfaceStore = SurfaceStore;
+	state.RoutedSurfaceRunoff = RoutedSurfaceRunoff;
+	state.Runoff = Runoff;
+	state.Baseflow = Baseflow;
+	return state;
+}
+
+void AWBM::RestoreState(const AwbmState& state)
+{
+	for (int i = 0; i < 3; i++)
+		Store[i] = state.Store[i];
+	BaseflowStore = state.BaseflowStore;
+	SurfaceStore = state.SurfaceStore;
+	RoutedSurfaceRunoff = state.RoutedSurfaceRunoff;
+	Runoff = state.Runoff;
+	Baseflow = state.Baseflow;
+}
+
+void AwbmState::CopyTo(double * values) const
+{
+	for (int i = 0; i < 3; i++)
+		values[i] = Store[i];
+	values[3] = BaseflowStore;
+	values[4] = SurfaceStore;
+	values[5] = RoutedSurfaceRunoff;
+	values[6] = Runoff;
+	values[7] = Baseflow;
+}
+
+void AwbmState::CopyFrom(const double * values)
+{
+	for (int i = 0; i < 3; i++)
+		Store[i] = values[i];
+	BaseflowStore = values[3];
+	SurfaceStore = values[4];
+	RoutedSurfaceRunoff = values[5];
+	Runoff = values[6];
+	Baseflow = values[7];
+}
+
 double * AWBM::GetPtr(const std::string& variableIdentifier)
 {
 	if (variableIdentifier == "Rainfall") return &Rainfall;
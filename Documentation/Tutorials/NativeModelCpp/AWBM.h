@@ -3,6 +3,39 @@
 #include <algorithm>
 #include <string>
 
+// Integer identifiers of the model variables. Identifiers can be resolved once from
+// variable names with AWBM::ResolveVariable, to avoid string comparisons in time loops.
+enum class AwbmVariable : int
+{
+	Rainfall = 0,
+	Evapotranspiration,
+	Runoff,
+	Baseflow,
+	BFI,
+	KSurf,
+	KBase,
+	C1,
+	C2,
+	C3,
+	Count
+};
+
+// Snapshot of the states of the AWBM model, to restart a simulation from a point in time.
+struct AwbmState
+{
+	double Store[3];
+	double BaseflowStore;
+	double SurfaceStore;
+	double RoutedSurfaceRunoff;
+	double Runoff;
+	double Baseflow;
+
+	// Number of values in the flat array representation of the state, used by the C API
+	static const int Size = 8;
+	void CopyTo(double * values) const;
+	void CopyFrom(const double * values);
+};
+
 class AWBM
 {
 public:
@@ -16,6 +49,8 @@ public:
 
 	void RunOneTimeStep();
 	void Reset();
+	AwbmState SaveState();
+	void RestoreState(const AwbmState& state);
 
 	double BFI;
 	double KSurf;
@@ -28,11 +63,18 @@ public:
 	void SetC2(double value) { capacities[1] = value; }
 	void SetC3(double value) { capacities[2] = value; }
 
+	double GetPartialArea(int i) { return partialAreas[i]; }
+
 	void SetVariable(const std::string& variableIdentifier, double value);
 	double GetVariable(const std::string& variableIdentifier);
 
 	double * GetPtr(const std::string& variableIdentifier);
 
+	static AwbmVariable ResolveVariable(const std::string& variableIdentifier);
+	void SetVariable(AwbmVariable variableId, double value) { *GetPtr(variableId) = value; }
+	double GetVariable(AwbmVariable variableId) { return *GetPtr(variableId); }
+	double * GetPtr(AwbmVariable variableId);
+
 private:
 	// State values, can be considered as outputs depending on the modelling objective.
 	double EffectiveRainfall;
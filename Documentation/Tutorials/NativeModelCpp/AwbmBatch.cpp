@@ -0,0 +1,84 @@
+#include "AwbmBatch.h"
+
+
+AwbmBatch::AwbmBatch(AWBM& templateModel, int numSets)
+{
+	if (numSets < 1) throw "The number of parameter sets in a batch must be strictly positive";
+	this->numSets = numSets;
+	kernel = SelectAwbmBatchKernel();
+	double c[3] = { templateModel.GetC1(), templateModel.GetC2(), templateModel.GetC3() };
+	AwbmState state = templateModel.SaveState();
+	for (int i = 0; i < 3; i++)
+	{
+		partialAreas[i] = templateModel.GetPartialArea(i);
+		capacities[i].assign(numSets, c[i]);
+		Store[i].assign(numSets, state.Store[i]);
+	}
+	BFI.assign(numSets, templateModel.BFI);
+	KSurf.assign(numSets, templateModel.KSurf);
+	KBase.assign(numSets, templateModel.KBase);
+	BaseflowStore.assign(numSets, state.BaseflowStore);
+	SurfaceStore.assign(numSets, state.SurfaceStore);
+	Runoff.assign(numSets, state.Runoff);
+	Baseflow.assign(numSets, state.Baseflow);
+}
+
+AwbmBatch::~AwbmBatch()
+{
+}
+
+void AwbmBatch::RunOneTimeStep(double rainfall, double evapotranspiration)
+{
+	// The forcing is read once for all the parameter sets.
+	AwbmLanes lanes;
+	lanes.numSets = numSets;
+	lanes.partialAreas = partialAreas;
+	for (int i = 0; i < 3; i++)
+	{
+		lanes.Store[i] = Store[i].data();
+		lanes.capacities[i] = capacities[i].data();
+	}
+	lanes.BFI = BFI.data();
+	lanes.KSurf = KSurf.data();
+	lanes.KBase = KBase.data();
+	lanes.BaseflowStore = BaseflowStore.data();
+	lanes.SurfaceStore = SurfaceStore.data();
+	lanes.Runoff = Runoff.data();
+	lanes.Baseflow = Baseflow.data();
+	kernel(lanes, rainfall - evapotranspiration, 0);
+}
+
+void AwbmBatch::Reset()
+{
+	for (int i = 0; i < 3; i++)
+		Store[i].assign(numSets, 0.0);
+	BaseflowStore.assign(numSets, 0.0);
+	SurfaceStore.assign(numSets, 0.0);
+	Runoff.assign(numSets, 0.0);
+	Baseflow.assign(numSets, 0.0);
+}
+
+void AwbmBatch::SetVariable(int setIndex, AwbmVariable variableId, double value)
+{
+	if (setIndex < 0 || setIndex >= numSets) throw "Parameter set index is out of bounds";
+	switch (variableId)
+	{
+	case AwbmVariable::BFI: BFI[setIndex] = value; break;
+	case AwbmVariable::KSurf: KSurf[setIndex] = value; break;
+	case AwbmVariable::KBase: KBase[setIndex] = value; break;
+	case AwbmVariable::C1: capacities[0][setIndex] = value; break;
+	case AwbmVariable::C2: capacities[1][setIndex] = value; break;
+	case AwbmVariable::C3: capacities[2][setIndex] = value; break;
+	default: throw "Unknown or unsupported model parameter for a batch run";
+	}
+}
+
+double * AwbmBatch::GetPtr(AwbmVariable variableId)
+{
+	switch (variableId)
+	{
+	case AwbmVariable::Runoff: return Runoff.data();
+	case AwbmVariable::Baseflow: return Baseflow.data();
+	default: throw "Unknown or unsupported model output for a batch run";
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "AWBM.h"
+#include "AwbmBatchKernel.h"
+
+// A structure-of-arrays version of the AWBM model, to advance several parameter sets
+// in lock step over the same forcing data. Each state or parameter is held in a contiguous
+// array with one element ('lane') per parameter set. Time steps are computed by
+// the widest SIMD kernel the processor supports, unless another one is set.
+class AwbmBatch
+{
+public:
+	// All lanes start with the parameters and states of the template model.
+	AwbmBatch(AWBM& templateModel, int numSets);
+	~AwbmBatch();
+
+	void RunOneTimeStep(double rainfall, double evapotranspiration);
+	void Reset();
+	int NumSets() { return numSets; }
+	void SetKernel(AwbmBatchKernel kernel) { this->kernel = kernel; }
+	const char * KernelName() { return AwbmBatchKernelName(kernel); }
+
+	void SetVariable(int setIndex, AwbmVariable variableId, double value);
+
+	// Gets the array of lanes for an output variable, e.g. Runoff
+	double * GetPtr(AwbmVariable variableId);
+
+private:
+	int numSets;
+	AwbmBatchKernel kernel;
+	double partialAreas[3];
+	std::vector<double> Store[3], capacities[3];
+	std::vector<double> BFI, KSurf, KBase;
+	std::vector<double> BaseflowStore, SurfaceStore;
+	std::vector<double> Runoff, Baseflow;
+};
@@ -0,0 +1,221 @@
+#include "AwbmBatchKernel.h"
+#include <algorithm>
+
+// Multiplications and additions must not be fused, so that all the kernels give results
+// bitwise identical to the scalar AWBM model. GCC and clang otherwise contract the
+// (operator based) vector intrinsics in functions targeting instruction sets with FMA.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AWBM_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC accepts the AVX intrinsics without /arch; the code paths are only taken if the CPU supports them.
+#define AWBM_TARGET(isa)
+#else
+#include <cpuid.h>
+#define AWBM_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+void AwbmBatchStepScalar(AwbmLanes& lanes, double netInput, int fromLane)
+{
+	for (int k = fromLane; k < lanes.numSets; k++)
+	{
+		double excess = 0.0;
+		for (int i = 0; i < 3; i++)
+		{
+			double s = lanes.Store[i][k] + netInput;
+			double c = lanes.capacities[i][k];
+			// The store spills over its capacity, and cannot be drained below zero.
+			excess += std::max(s - c, 0.0) * lanes.partialAreas[i];
+			lanes.Store[i][k] = std::max(std::min(s, c), 0.0);
+		}
+
+		lanes.BaseflowStore[k] += lanes.BFI[k] * excess;
+		lanes.SurfaceStore[k] += (1 - lanes.BFI[k]) * excess;
+
+		double routedSurfaceRunoff = (1 - lanes.KSurf[k]) * lanes.SurfaceStore[k];
+		lanes.Baseflow[k] = (1 - lanes.KBase[k]) * lanes.BaseflowStore[k];
+
+		lanes.BaseflowStore[k] *= lanes.KBase[k];
+		lanes.SurfaceStore[k] *= lanes.KSurf[k];
+
+		lanes.Runoff[k] = lanes.Baseflow[k] + routedSurfaceRunoff;
+	}
+}
+
+#ifdef AWBM_X86_SIMD
+
+AWBM_TARGET("avx2")
+void AwbmBatchStepAvx2(AwbmLanes& lanes, double netInput, int fromLane)
+{
+	const int width = 4;
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d net = _mm256_set1_pd(netInput);
+	__m256d areas[3];
+	for (int i = 0; i < 3; i++)
+		areas[i] = _mm256_set1_pd(lanes.partialAreas[i]);
+
+	int k = fromLane;
+	for (; k + width <= lanes.numSets; k += width)
+	{
+		__m256d excess = zero;
+		for (int i = 0; i < 3; i++)
+		{
+			__m256d s = _mm256_add_pd(_mm256_loadu_pd(lanes.Store[i] + k), net);
+			__m256d c = _mm256_loadu_pd(lanes.capacities[i] + k);
+			excess = _mm256_add_pd(excess, _mm256_mul_pd(_mm256_max_pd(_mm256_sub_pd(s, c), zero), areas[i]));
+			_mm256_storeu_pd(lanes.Store[i] + k, _mm256_max_pd(_mm256_min_pd(s, c), zero));
+		}
+		__m256d bfi = _mm256_loadu_pd(lanes.BFI + k);
+		__m256d kSurf = _mm256_loadu_pd(lanes.KSurf + k);
+		__m256d kBase = _mm256_loadu_pd(lanes.KBase + k);
+
+		__m256d baseflowStore = _mm256_add_pd(_mm256_loadu_pd(lanes.BaseflowStore + k), _mm256_mul_pd(bfi, excess));
+		__m256d surfaceStore = _mm256_add_pd(_mm256_loadu_pd(lanes.SurfaceStore + k), _mm256_mul_pd(_mm256_sub_pd(one, bfi), excess));
+
+		__m256d routedSurfaceRunoff = _mm256_mul_pd(_mm256_sub_pd(one, kSurf), surfaceStore);
+		__m256d baseflow = _mm256_mul_pd(_mm256_sub_pd(one, kBase), baseflowStore);
+
+		_mm256_storeu_pd(lanes.BaseflowStore + k, _mm256_mul_pd(baseflowStore, kBase));
+		_mm256_storeu_pd(lanes.SurfaceStore + k, _mm256_mul_pd(surfaceStore, kSurf));
+		_mm256_storeu_pd(lanes.Baseflow + k, baseflow);
+		_mm256_storeu_pd(lanes.Runoff + k, _mm256_add_pd(baseflow, routedSurfaceRunoff));
+	}
+	// The upper halves of the registers must be cleared before running SSE code, in the scalar kernel and the caller;
+	// GCC does not insert this before the tail call, and the transition penalties otherwise cost more than the kernel.
+	_mm256_zeroupper();
+	AwbmBatchStepScalar(lanes, netInput, k);
+}
+
+AWBM_TARGET("avx512f")
+void AwbmBatchStepAvx512(AwbmLanes& lanes, double netInput, int fromLane)
+{
+	const int width = 8;
+	const __m512d zero = _mm512_setzero_pd();
+	const __m512d one = _mm512_set1_pd(1.0);
+	const __m512d net = _mm512_set1_pd(netInput);
+	__m512d areas[3];
+	for (int i = 0; i < 3; i++)
+		areas[i] = _mm512_set1_pd(lanes.partialAreas[i]);
+
+	int k = fromLane;
+	for (; k + width <= lanes.numSets; k += width)
+	{
+		__m512d excess = zero;
+		for (int i = 0; i < 3; i++)
+		{
+			__m512d s = _mm512_add_pd(_mm512_loadu_pd(lanes.Store[i] + k), net);
+			__m512d c = _mm512_loadu_pd(lanes.capacities[i] + k);
+			excess = _mm512_add_pd(excess, _mm512_mul_pd(_mm512_max_pd(_mm512_sub_pd(s, c), zero), areas[i]));
+			_mm512_storeu_pd(lanes.Store[i] + k, _mm512_max_pd(_mm512_min_pd(s, c), zero));
+		}
+		__m512d bfi = _mm512_loadu_pd(lanes.BFI + k);
+		__m512d kSurf = _mm512_loadu_pd(lanes.KSurf + k);
+		__m512d kBase = _mm512_loadu_pd(lanes.KBase + k);
+
+		__m512d baseflowStore = _mm512_add_pd(_mm512_loadu_pd(lanes.BaseflowStore + k), _mm512_mul_pd(bfi, excess));
+		__m512d surfaceStore = _mm512_add_pd(_mm512_loadu_pd(lanes.SurfaceStore + k), _mm512_mul_pd(_mm512_sub_pd(one, bfi), excess));
+
+		__m512d routedSurfaceRunoff = _mm512_mul_pd(_mm512_sub_pd(one, kSurf), surfaceStore);
+		__m512d baseflow = _mm512_mul_pd(_mm512_sub_pd(one, kBase), baseflowStore);
+
+		_mm512_storeu_pd(lanes.BaseflowStore + k, _mm512_mul_pd(baseflowStore, kBase));
+		_mm512_storeu_pd(lanes.SurfaceStore + k, _mm512_mul_pd(surfaceStore, kSurf));
+		_mm512_storeu_pd(lanes.Baseflow + k, baseflow);
+		_mm512_storeu_pd(lanes.Runoff + k, _mm512_add_pd(baseflow, routedSurfaceRunoff));
+	}
+	// Lanes left over are still worth a pass of the narrower kernel.
+	_mm256_zeroupper();
+	AwbmBatchStepAvx2(lanes, netInput, k);
+}
+
+namespace
+{
+	void Cpuid(int leaf, int subleaf, unsigned int regs[4])
+	{
+#ifdef _MSC_VER
+		int r[4];
+		__cpuidex(r, leaf, subleaf);
+		for (int i = 0; i < 4; i++) regs[i] = (unsigned int)r[i];
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	unsigned long long EnabledCpuStates()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((unsigned long long)edx << 32) | eax;
+#endif
+	}
+
+	// 0: scalar, 1: AVX2, 2: AVX-512F
+	int DetectSimdLevel()
+	{
+		unsigned int regs[4];
+		Cpuid(0, 0, regs);
+		if (regs[0] < 7) return 0;
+		Cpuid(1, 0, regs);
+		bool osxsave = (regs[2] & (1u << 27)) != 0;
+		bool avx = (regs[2] & (1u << 28)) != 0;
+		if (!osxsave || !avx) return 0;
+		unsigned long long states = EnabledCpuStates();
+		// The operating system must save the YMM (and for AVX-512 the ZMM and opmask) registers on context switches
+		if ((states & 0x6) != 0x6) return 0;
+		Cpuid(7, 0, regs);
+		bool avx2 = (regs[1] & (1u << 5)) != 0;
+		bool avx512f = (regs[1] & (1u << 16)) != 0;
+		if (!avx2) return 0;
+		if (avx512f && (states & 0xE6) == 0xE6) return 2;
+		return 1;
+	}
+}
+
+AwbmBatchKernel SelectAwbmBatchKernel()
+{
+	static const int level = DetectSimdLevel();
+	if (level == 2) return &AwbmBatchStepAvx512;
+	if (level == 1) return &AwbmBatchStepAvx2;
+	return &AwbmBatchStepScalar;
+}
+
+#else
+
+// Non-x86 targets: the wide kernels are aliases of the scalar one.
+void AwbmBatchStepAvx2(AwbmLanes& lanes, double netInput, int fromLane)
+{
+	AwbmBatchStepScalar(lanes, netInput, fromLane);
+}
+
+void AwbmBatchStepAvx512(AwbmLanes& lanes, double netInput, int fromLane)
+{
+	AwbmBatchStepScalar(lanes, netInput, fromLane);
+}
+
+AwbmBatchKernel SelectAwbmBatchKernel()
+{
+	return &AwbmBatchStepScalar;
+}
+
+#endif
+
+const char * AwbmBatchKernelName(AwbmBatchKernel kernel)
+{
+#ifdef AWBM_X86_SIMD
+	if (kernel == &AwbmBatchStepAvx512) return "AVX-512";
+	if (kernel == &AwbmBatchStepAvx2) return "AVX2";
+#endif
+	return "Scalar";
+}
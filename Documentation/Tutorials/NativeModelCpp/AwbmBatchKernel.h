@@ -0,0 +1,29 @@
+#pragma once
+
+// Pointers to the structure-of-arrays state of an AwbmBatch, one element per lane (parameter set).
+struct AwbmLanes
+{
+	int numSets;
+	const double * partialAreas;
+	double * Store[3];
+	const double * capacities[3];
+	const double * BFI;
+	const double * KSurf;
+	const double * KBase;
+	double * BaseflowStore;
+	double * SurfaceStore;
+	double * Runoff;
+	double * Baseflow;
+};
+
+// Advances the lanes [fromLane, numSets) by one time step given the net input (rainfall - evapotranspiration).
+// All kernels use the same branch-free arithmetic and give results identical to AWBM::RunOneTimeStep.
+typedef void(*AwbmBatchKernel)(AwbmLanes& lanes, double netInput, int fromLane);
+
+void AwbmBatchStepScalar(AwbmLanes& lanes, double netInput, int fromLane);
+void AwbmBatchStepAvx2(AwbmLanes& lanes, double netInput, int fromLane);
+void AwbmBatchStepAvx512(AwbmLanes& lanes, double netInput, int fromLane);
+
+// Gets the widest kernel supported by the processor and operating system at runtime.
+AwbmBatchKernel SelectAwbmBatchKernel();
+const char * AwbmBatchKernelName(AwbmBatchKernel kernel);
@@ -1,4 +1,9 @@
+#include <algorithm>
 #include "AwbmSimulation.h"
+#include "AwbmBatch.h"
+
+// Number of time steps of the lanes buffered by ExecuteBatch before they are transposed into its outputs
+static const int batchBlockLength = 256;
 
 
 AwbmSimulation::AwbmSimulation()
@@ -8,34 +13,166 @@ AwbmSimulation::AwbmSimulation()
 
 AwbmSimulation::AwbmSimulation(const AwbmSimulation& src)
 {
-	for (auto& x : src.outputs) {
-		outputs[x.first] = new VariablePtr(model.GetPtr(x.first));;
+	CopyFrom(src);
+}
+
+// Played series are shared with the source rather than copied, so cloning does
+// not depend on the length of the forcing data. Model parameters are copied.
+// The storage of recorded series is reused when possible, so that recycling
+// a simulation with the same configuration does not allocate memory.
+void AwbmSimulation::CopyFrom(const AwbmSimulation& src)
+{
+	if (&src == this) return;
+	model = src.model;
+	resizeOutputs(src.outputs.size());
+	for (size_t j = 0; j < outputs.size(); j++) {
+		outputs[j].variableId = src.outputs[j].variableId;
+		outputs[j].modelVariable = model.GetPtr(src.outputs[j].variableId);
+		outputs[j].OwnDestination();
 	}
-	for (auto& x : src.inputs) {
-		inputs[x.first] = new VariablePtr(model.GetPtr(x.first), x.second->data);;
+	inputs = src.inputs;
+	for (auto& x : inputs) {
+		x.modelVariable = model.GetPtr(x.variableId);
 	}
 	fromIndex = src.fromIndex;
 	toIndex = src.toIndex;
+	warmStart = false;
+	checkpoints = src.checkpoints;
+	for (auto& x : checkpoints)
+		x.saved = false;
+	statistics = src.statistics;
+	statisticsVariables = src.statisticsVariables;
+	for (size_t j = 0; j < statistics.size(); j++)
+		statistics[j].Rebind(model.GetPtr(statisticsVariables[j]));
+	model.Reset();
+}
+
+void AwbmSimulation::Recycle()
+{
+	inputs.clear();
+	for (auto& x : outputs)
+		x.OwnDestination();
+	checkpoints.clear();
+	ClearStatistics();
+}
+
+void AwbmSimulation::Clear()
+{
+	model = AWBM();
 	model.Reset();
+	inputs.clear();
+	resizeOutputs(0);
+	fromIndex = 0;
+	toIndex = -1;
+	warmStart = false;
+	checkpoints.clear();
+	ClearStatistics();
 }
 
 AwbmSimulation::~AwbmSimulation()
 {
 }
 
+// Played series are indexed by time step, and recorded series by the offset from the start of the span.
 void AwbmSimulation::Execute()
 {
+	initInputs();
 	initOutputs();
-	for (int i = fromIndex; i < toIndex; i++)
+	if (!warmStart)
+		model.Reset();
+	warmStart = false;
+	for (auto& x : statistics)
+		x.Reset();
+	size_t nextCheckpoint = 0;
+	while (nextCheckpoint < checkpoints.size() && checkpoints[nextCheckpoint].index < fromIndex)
+		nextCheckpoint++;
+	for (int i = fromIndex; i <= toIndex; i++)
 	{
-		setInputs(i-fromIndex);
+		setInputs(i);
 		model.RunOneTimeStep();
 		getStates(i - fromIndex);
+		for (auto& x : statistics)
+			x.Update(i);
+		if (nextCheckpoint < checkpoints.size() && checkpoints[nextCheckpoint].index == i)
+		{
+			checkpoints[nextCheckpoint].state = model.SaveState();
+			checkpoints[nextCheckpoint].saved = true;
+			nextCheckpoint++;
+		}
+	}
+}
+// Runs several parameter sets over the same forcing data, in a single pass over the time steps.
+// parameterSets is a row major matrix, one row of parameterIds.size() values per parameter set.
+// outputs is a row major matrix, one row of NumSteps() values per parameter set.
+void AwbmSimulation::ExecuteBatch(const std::vector<std::string>& parameterIds, const double * parameterSets, int numSets, const std::string& outputId, double * outputs)
+{
+	initInputs();
+	VariablePtr * rainfall = nullptr;
+	VariablePtr * evap = nullptr;
+	for (auto& x : inputs) {
+		if (x.variableId == AwbmVariable::Rainfall) rainfall = &x;
+		else if (x.variableId == AwbmVariable::Evapotranspiration) evap = &x;
+		else throw "Batch runs only support Rainfall and Evapotranspiration as played inputs";
+	}
+	AwbmBatch batch(model, numSets);
+	if (!warmStart)
+		batch.Reset();
+	warmStart = false;
+	int numParameters = (int)parameterIds.size();
+	std::vector<AwbmVariable> ids;
+	for (int j = 0; j < numParameters; j++)
+		ids.push_back(ResolveVariable(parameterIds[j]));
+	for (int k = 0; k < numSets; k++)
+		for (int j = 0; j < numParameters; j++)
+			batch.SetVariable(k, ids[j], parameterSets[k * numParameters + j]);
+	const double * lanes = batch.GetPtr(ResolveVariable(outputId));
+	int numSteps = NumSteps();
+	// The lanes are buffered time major for a block of time steps, then transposed once into the rows of outputs,
+	// rather than scattered over numSets rows at every time step.
+	std::vector<double> block((size_t)batchBlockLength * numSets);
+	for (int blockStart = fromIndex; blockStart <= toIndex; blockStart += batchBlockLength)
+	{
+		int length = std::min(batchBlockLength, toIndex - blockStart + 1);
+		for (int t = 0; t < length; t++)
+		{
+			int i = blockStart + t;
+			batch.RunOneTimeStep(
+				(rainfall == nullptr ? 0.0 : rainfall->Source()[i]),
+				(evap == nullptr ? 0.0 : evap->Source()[i]));
+			std::copy(lanes, lanes + numSets, block.data() + (size_t)t * numSets);
+		}
+		double * rows = outputs + (blockStart - fromIndex);
+		for (int k = 0; k < numSets; k++)
+		{
+			double * row = rows + (size_t)k * numSteps;
+			const double * column = block.data() + k;
+			for (int t = 0; t < length; t++)
+				row[t] = column[(size_t)t * numSets];
+		}
 	}
 }
+
 std::vector<double> AwbmSimulation::GetRecorded(const std::string& variableIdentifier)
 {
-	return this->outputs[variableIdentifier]->data;
+	return GetRecorded(ResolveVariable(variableIdentifier));
+}
+
+std::vector<double> AwbmSimulation::GetRecorded(AwbmVariable variableId)
+{
+	VariablePtr * binding = findBinding(outputs, variableId);
+	if (binding == nullptr) throw "Model variable is not recorded";
+	const double * recorded = binding->Recorded();
+	return std::vector<double>(recorded, recorded + binding->RecordedLength());
+}
+
+void AwbmSimulation::GetRecorded(AwbmVariable variableId, double * values, int length)
+{
+	VariablePtr * binding = findBinding(outputs, variableId);
+	if (binding == nullptr) throw "Model variable is not recorded";
+	if (binding->RecordedLength() != length) throw "data length specifications are inconsistent";
+	const double * recorded = binding->Recorded();
+	if (recorded != values)
+		std::copy(recorded, recorded + length, values);
 }
 
 void AwbmSimulation::SetSpan(int from, int to)
@@ -46,14 +183,58 @@ void AwbmSimulation::SetSpan(int from, int to)
 
 void   AwbmSimulation::Play(const std::string& variableIdentifier, const std::vector<double>& values)
 {
-	// TODO: in prod system you'd check pre-existing key
-	inputs[variableIdentifier] = new VariablePtr(model.GetPtr(variableIdentifier), values);
+	Play(ResolveVariable(variableIdentifier), values);
+}
+
+void   AwbmSimulation::Play(AwbmVariable variableId, const std::vector<double>& values)
+{
+	Play(variableId, std::make_shared<const std::vector<double>>(values));
+}
+
+void   AwbmSimulation::Play(AwbmVariable variableId, const SharedSeries& values)
+{
+	VariablePtr * binding = findBinding(inputs, variableId);
+	if (binding != nullptr)
+		binding->ShareSource(values);
+	else
+		inputs.push_back(VariablePtr(variableId, model.GetPtr(variableId), values));
+}
+
+void   AwbmSimulation::PlayBorrowed(AwbmVariable variableId, const double * values, int length)
+{
+	VariablePtr * binding = findBinding(inputs, variableId);
+	if (binding == nullptr) {
+		inputs.push_back(VariablePtr(variableId, model.GetPtr(variableId)));
+		binding = &inputs.back();
+	}
+	binding->BorrowSource(values, length);
 }
 
 void   AwbmSimulation::Record(const std::string& variableIdentifier)
 {
-	// TODO: in prod system you'd check pre-existing key
-	outputs[variableIdentifier] = new VariablePtr(model.GetPtr(variableIdentifier));;
+	Record(ResolveVariable(variableIdentifier));
+}
+
+void   AwbmSimulation::Record(AwbmVariable variableId)
+{
+	VariablePtr * binding = findBinding(outputs, variableId);
+	if (binding == nullptr) {
+		resizeOutputs(outputs.size() + 1);
+		outputs.back().variableId = variableId;
+		outputs.back().modelVariable = model.GetPtr(variableId);
+	}
+	else
+		binding->OwnDestination();
+}
+
+void   AwbmSimulation::RecordTo(AwbmVariable variableId, double * destination, int length)
+{
+	VariablePtr * binding = findBinding(outputs, variableId);
+	if (binding == nullptr) {
+		outputs.push_back(VariablePtr(variableId, model.GetPtr(variableId)));
+		binding = &outputs.back();
+	}
+	binding->BorrowDestination(destination, length);
 }
 
 void   AwbmSimulation::SetVariable(const std::string& variableIdentifier, double value)
@@ -61,11 +242,64 @@ void   AwbmSimulation::SetVariable(const std::string& variableIdentifier, double
 	model.SetVariable(variableIdentifier, value);
 }
 
+void   AwbmSimulation::SetVariable(AwbmVariable variableId, double value)
+{
+	model.SetVariable(variableId, value);
+}
+
 double AwbmSimulation::GetVariable(const std::string& variableIdentifier)
 {
 	return model.GetVariable(variableIdentifier);
 }
 
+double AwbmSimulation::GetVariable(AwbmVariable variableId)
+{
+	return model.GetVariable(variableId);
+}
+
+void AwbmSimulation::RestoreState(const AwbmState& state)
+{
+	model.RestoreState(state);
+	warmStart = true;
+}
+
+void AwbmSimulation::SetCheckpoint(int index)
+{
+	auto it = checkpoints.begin();
+	while (it != checkpoints.end() && it->index < index)
+		it++;
+	if (it != checkpoints.end() && it->index == index)
+		return;
+	Checkpoint c;
+	c.index = index;
+	c.saved = false;
+	checkpoints.insert(it, c);
+}
+
+AwbmState AwbmSimulation::GetCheckpoint(int index)
+{
+	for (auto& x : checkpoints) {
+		if (x.index == index) {
+			if (!x.saved) throw "Checkpoint time step was not reached by an execution";
+			return x.state;
+		}
+	}
+	throw "No checkpoint set at this time step";
+}
+
+int AwbmSimulation::AddStatistics(AwbmVariable variableId, const SharedSeries& observed, int from, int to, double logOffset)
+{
+	statistics.push_back(StatisticsAccumulator(model.GetPtr(variableId), observed, from, to, logOffset));
+	statisticsVariables.push_back(variableId);
+	return (int)statistics.size() - 1;
+}
+
+double AwbmSimulation::GetStatistic(int handle, AwbmStatistic statistic)
+{
+	if (handle < 0 || handle >= (int)statistics.size()) throw "Invalid statistics handle";
+	return statistics[handle].GetStatistic(statistic);
+}
+
 int	   AwbmSimulation::GetStart()
 {
 	return fromIndex;
@@ -76,21 +310,53 @@ int	   AwbmSimulation::GetEnd()
 	return toIndex;
 }
 
+void AwbmSimulation::initInputs()
+{
+	for (auto& x : inputs) {
+		x.InitInput(toIndex + 1);
+	}
+}
 void AwbmSimulation::initOutputs()
 {
 	for (auto& x : outputs) {
-		x.second->InitData(this->NumSteps());
+		x.InitData(this->NumSteps());
 	}
 }
 void AwbmSimulation::setInputs(int index)
 {
 	for (auto& x : inputs) {
-		x.second->Play(index);
+		x.Play(index);
 	}
 }
 void AwbmSimulation::getStates(int index)
 {
 	for (auto& x : outputs) {
-		x.second->Record(index);
+		x.Record(index);
+	}
+}
+// Bindings removed hand the storage of their recorded series over to those added, emptied of their values,
+// so that reconfiguring a simulation with as many recorded variables does not allocate memory.
+void AwbmSimulation::resizeOutputs(size_t count)
+{
+	for (size_t j = count; j < outputs.size(); j++) {
+		outputs[j].data.clear();
+		spareSeries.push_back(std::move(outputs[j].data));
+	}
+	size_t previous = outputs.size();
+	outputs.resize(count);
+	// Room for the storage of all the bindings, so that removing them does not allocate memory either
+	if (spareSeries.capacity() < outputs.capacity())
+		spareSeries.reserve(outputs.capacity());
+	for (size_t j = previous; j < count && !spareSeries.empty(); j++) {
+		outputs[j].data = std::move(spareSeries.back());
+		spareSeries.pop_back();
+	}
+}
+
+VariablePtr * AwbmSimulation::findBinding(std::vector<VariablePtr>& bindings, AwbmVariable variableId)
+{
+	for (auto& x : bindings) {
+		if (x.variableId == variableId) return &x;
 	}
+	return nullptr;
 }
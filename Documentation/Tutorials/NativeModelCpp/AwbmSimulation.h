@@ -2,26 +2,72 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <memory>
 #include "AWBM.h"
+#include "StatisticsAccumulator.h"
 
 
+// Read-only time series, shared between simulations (e.g. clones) playing the same forcing data.
+typedef std::shared_ptr<const std::vector<double>> SharedSeries;
+
+// Binding of a model variable to the time series played into it, or recorded from it.
+// Played series are shared immutable buffers, or borrowed from a caller buffer.
+// Recorded series are owned by the binding, or borrowed from a caller buffer.
 class VariablePtr
 {
 public:
-	VariablePtr(double * modelVariable, const std::vector<double>& data) { this->modelVariable = modelVariable; this->data = data; }
-	VariablePtr(double * modelVariable) { this->modelVariable = modelVariable; }
+	VariablePtr(AwbmVariable variableId, double * modelVariable, const SharedSeries& data) { this->variableId = variableId; this->modelVariable = modelVariable; this->sharedSource = data; }
+	VariablePtr(AwbmVariable variableId, double * modelVariable) { this->variableId = variableId; this->modelVariable = modelVariable; }
+	// Initialise before a run the series to play from, checking it covers the simulation.
+	void InitInput(int length) {
+		if (length < 0) throw "Negative length of the simulation span";
+		if (borrowedSource != nullptr) {
+			if (borrowedLength < length) throw "Played data does not cover the simulation span";
+			source = borrowedSource;
+		}
+		else {
+			if (!sharedSource || sharedSource->size() < (size_t)length) throw "Played data does not cover the simulation span";
+			source = sharedSource->data();
+		}
+	}
+	// Initialise before a run the series to record to.
 	void InitData(int length) {
-		if (data.size() != length)
-			data.resize(length);
+		if (length < 0) throw "Negative length of the simulation span";
+		if (borrowedDestination != nullptr) {
+			if (borrowedLength != length) throw "Recording buffer length differs from the simulation span";
+			destination = borrowedDestination;
+		}
+		else {
+			if (data.size() != (size_t)length)
+				data.resize(length);
+			destination = data.data();
+		}
 	}
-	void Record(int index) { data[index] = *modelVariable; }
-	void Play(int index) { *modelVariable = data[index]; }
+	void BorrowSource(const double * values, int length) { sharedSource.reset(); borrowedSource = values; borrowedLength = length; }
+	void BorrowDestination(double * values, int length) { data.clear(); borrowedDestination = values; borrowedLength = length; }
+	void ShareSource(const SharedSeries& values) { sharedSource = values; borrowedSource = nullptr; borrowedLength = 0; }
+	void OwnDestination() { borrowedDestination = nullptr; borrowedLength = 0; }
+	// Gets the recorded series, wherever it is stored.
+	const double * Recorded() const { return (borrowedDestination != nullptr ? borrowedDestination : data.data()); }
+	int RecordedLength() const { return (borrowedDestination != nullptr ? borrowedLength : (int)data.size()); }
+	const double * Source() const { return source; }
+	void Record(int index) { destination[index] = *modelVariable; }
+	void Play(int index) { *modelVariable = source[index]; }
 	~VariablePtr() {}
 	VariablePtr() {}
 	// Note: the following should be private...
+	AwbmVariable variableId = AwbmVariable::Count;
 	double * modelVariable = nullptr;
 	std::vector<double> data;
+private:
+	SharedSeries sharedSource;
+	// Caller buffers, which must outlive their use by the simulation
+	const double * borrowedSource = nullptr;
+	double * borrowedDestination = nullptr;
+	int borrowedLength = 0;
+	// The series used during a run, set by InitInput or InitData
+	const double * source = nullptr;
+	double * destination = nullptr;
 };
 
 class AwbmSimulation
@@ -31,23 +77,87 @@ public:
 	AwbmSimulation(const AwbmSimulation& src);
 	~AwbmSimulation();
 
+	AwbmSimulation& operator=(const AwbmSimulation& src) { CopyFrom(src); return *this; }
+
+	// Reconfigures this simulation as a clone of a template simulation.
+	void CopyFrom(const AwbmSimulation& src);
+	// Reconfigures this simulation as a newly created one, keeping the storage of recorded series for reuse.
+	void Clear();
+	// Releases the played series and caller buffers, keeping the storage of recorded series for reuse.
+	void Recycle();
+
 	void Execute();
+	void ExecuteBatch(const std::vector<std::string>& parameterIds, const double * parameterSets, int numSets, const std::string& outputId, double * outputs);
 	std::vector<double> GetRecorded(const std::string& variableIdentifier);
 	void SetSpan(int from, int to);
 	void Play(const std::string& variableIdentifier, const std::vector<double>& values);
 	void Record(const std::string& variableIdentifier);
 	void SetVariable(const std::string& variableIdentifier, double value);
 	double GetVariable(const std::string& variableIdentifier);
+
+	// Overloads using identifiers resolved once with ResolveVariable; no string is compared.
+	AwbmVariable ResolveVariable(const std::string& variableIdentifier) { return AWBM::ResolveVariable(variableIdentifier); }
+	std::vector<double> GetRecorded(AwbmVariable variableId);
+	void GetRecorded(AwbmVariable variableId, double * values, int length);
+	void Play(AwbmVariable variableId, const std::vector<double>& values);
+	// Plays a series without copying it; the series can be shared by several simulations.
+	void Play(AwbmVariable variableId, const SharedSeries& values);
+	void Record(AwbmVariable variableId);
+	void SetVariable(AwbmVariable variableId, double value);
+	double GetVariable(AwbmVariable variableId);
+
+	// Borrowing variants: the simulation reads inputs from, and writes outputs to, caller owned buffers
+	// without copying them. A buffer must remain valid (and pinned for managed arrays) until its variable
+	// is played or recorded again, or the simulation is disposed. Clones read the same borrowed inputs,
+	// but record to their own storage.
+	void PlayBorrowed(AwbmVariable variableId, const double * values, int length);
+	void RecordTo(AwbmVariable variableId, double * destination, int length);
+
+	// Warm start: each execution starts from the initial model states, unless a state was restored
+	// since the last execution. Checkpoints are snapshots of the model states at the end of given
+	// time steps, taken during the next executions.
+	AwbmState SaveState() { return model.SaveState(); }
+	void RestoreState(const AwbmState& state);
+	void SetCheckpoint(int index);
+	void ClearCheckpoints() { checkpoints.clear(); }
+	AwbmState GetCheckpoint(int index);
+
+	// Statistics of a model variable against observations, accumulated during each execution
+	// over the time steps [from, to]. Returns a handle to get the statistics after an execution.
+	int AddStatistics(AwbmVariable variableId, const SharedSeries& observed, int from, int to, double logOffset);
+	double GetStatistic(int handle, AwbmStatistic statistic);
+	void ClearStatistics() { statistics.clear(); statisticsVariables.clear(); }
+
 	int GetStart();
 	int GetEnd();
 	int NumSteps() { return GetEnd() - GetStart() + 1; }
 
 private:
 	AWBM model;
-	std::map<std::string, VariablePtr*> inputs;
-	std::map<std::string, VariablePtr*> outputs;
-	int fromIndex, toIndex;
+	// Flat arrays of bindings, iterated at each time step.
+	std::vector<VariablePtr> inputs;
+	std::vector<VariablePtr> outputs;
+	// Storage of the series recorded by bindings since removed, given to the bindings added next.
+	std::vector<std::vector<double>> spareSeries;
+	int fromIndex = 0, toIndex = -1;
+	bool warmStart = false;
+
+	struct Checkpoint
+	{
+		int index;
+		bool saved;
+		AwbmState state;
+	};
+	// Sorted by time step index
+	std::vector<Checkpoint> checkpoints;
+
+	std::vector<StatisticsAccumulator> statistics;
+	std::vector<AwbmVariable> statisticsVariables;
+
+	static VariablePtr * findBinding(std::vector<VariablePtr>& bindings, AwbmVariable variableId);
+	void resizeOutputs(size_t count);
 
+	void initInputs();
 	void initOutputs();
 	void setInputs(int index);
 	void getStates(int index);
@@ -0,0 +1,92 @@
+#include "AwbmSimulationPool.h"
+
+
+AwbmSimulationPool::AwbmSimulationPool(size_t capacity)
+{
+	this->capacity = capacity;
+	available.reserve(capacity);
+}
+
+AwbmSimulationPool::~AwbmSimulationPool()
+{
+	Clear();
+}
+
+AwbmSimulation * AwbmSimulationPool::Acquire()
+{
+	AwbmSimulation * simulation = take();
+	if (simulation == nullptr)
+		return new AwbmSimulation();
+	simulation->Clear();
+	return simulation;
+}
+
+AwbmSimulation * AwbmSimulationPool::Acquire(const AwbmSimulation& templateSimulation)
+{
+	AwbmSimulation * simulation = take();
+	if (simulation == nullptr)
+		return new AwbmSimulation(templateSimulation);
+	simulation->CopyFrom(templateSimulation);
+	return simulation;
+}
+
+void AwbmSimulationPool::Release(AwbmSimulation * simulation)
+{
+	if (simulation == nullptr) return;
+	simulation->Recycle();
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if (available.size() < capacity)
+		{
+			available.push_back(simulation);
+			return;
+		}
+	}
+	delete simulation;
+}
+
+void AwbmSimulationPool::SetCapacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	this->capacity = capacity;
+	trim();
+}
+
+size_t AwbmSimulationPool::NumAvailable()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return available.size();
+}
+
+void AwbmSimulationPool::Clear()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	for (auto x : available)
+		delete x;
+	available.clear();
+}
+
+AwbmSimulationPool& AwbmSimulationPool::Default()
+{
+	static AwbmSimulationPool pool(256);
+	return pool;
+}
+
+AwbmSimulation * AwbmSimulationPool::take()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	if (available.empty())
+		return nullptr;
+	AwbmSimulation * simulation = available.back();
+	available.pop_back();
+	return simulation;
+}
+
+void AwbmSimulationPool::trim()
+{
+	while (available.size() > capacity)
+	{
+		delete available.back();
+		available.pop_back();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "AwbmSimulation.h"
+
+// A thread-safe pool recycling simulation instances and the storage of their recorded series,
+// so that creating and cloning simulations does not allocate memory once the pool is warm.
+class AwbmSimulationPool
+{
+public:
+	AwbmSimulationPool(size_t capacity);
+	~AwbmSimulationPool();
+
+	// Gets a simulation configured as newly created
+	AwbmSimulation * Acquire();
+	// Gets a simulation configured as a clone of a template simulation
+	AwbmSimulation * Acquire(const AwbmSimulation& templateSimulation);
+	// Returns a simulation to the pool, or deletes it if the pool is full.
+	void Release(AwbmSimulation * simulation);
+
+	// Sets the maximum number of idle simulations kept; idle simulations in excess are deleted.
+	void SetCapacity(size_t capacity);
+	size_t NumAvailable();
+	void Clear();
+
+	static AwbmSimulationPool& Default();
+
+private:
+	std::mutex mtx;
+	std::vector<AwbmSimulation*> available;
+	size_t capacity;
+
+	AwbmSimulation * take();
+	void trim();
+};
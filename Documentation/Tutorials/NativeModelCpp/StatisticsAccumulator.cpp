@@ -0,0 +1,63 @@
+#include "StatisticsAccumulator.h"
+#include <cmath>
+#include <limits>
+
+
+StatisticsAccumulator::StatisticsAccumulator(const double * modelVariable, const std::shared_ptr<const std::vector<double>>& observed, int from, int to, double logOffset)
+{
+	if (from > to) throw "Statistics period is empty";
+	if (from < 0 || (int)observed->size() <= to) throw "Observed data does not cover the statistics period";
+	this->modelVariable = modelVariable;
+	this->observed = observed;
+	this->from = from;
+	this->to = to;
+	this->logOffset = logOffset;
+	Reset();
+}
+
+void StatisticsAccumulator::Reset()
+{
+	count = 0;
+	sumObs = 0;
+	sumSim = 0;
+	sumSqErr = 0;
+	meanObs = 0;
+	m2Obs = 0;
+	sumSqLogErr = 0;
+	meanLogObs = 0;
+	m2LogObs = 0;
+}
+
+void StatisticsAccumulator::accumulate(double obs, double sim)
+{
+	if (std::isnan(obs) || obs < 0) return;
+	count++;
+	sumObs += obs;
+	sumSim += sim;
+	double err = sim - obs;
+	sumSqErr += err * err;
+	double delta = obs - meanObs;
+	meanObs += delta / count;
+	m2Obs += delta * (obs - meanObs);
+
+	double logObs = std::log(obs + logOffset);
+	double logErr = std::log(sim + logOffset) - logObs;
+	sumSqLogErr += logErr * logErr;
+	double logDelta = logObs - meanLogObs;
+	meanLogObs += logDelta / count;
+	m2LogObs += logDelta * (logObs - meanLogObs);
+}
+
+double StatisticsAccumulator::GetStatistic(AwbmStatistic statistic) const
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	switch (statistic)
+	{
+	case AwbmStatistic::NSE: return (count == 0 ? nan : 1 - sumSqErr / m2Obs);
+	case AwbmStatistic::Bias: return (count == 0 ? nan : (sumSim - sumObs) / sumObs);
+	case AwbmStatistic::RMSE: return (count == 0 ? nan : std::sqrt(sumSqErr / count));
+	case AwbmStatistic::LogNSE: return (count == 0 ? nan : 1 - sumSqLogErr / m2LogObs);
+	case AwbmStatistic::Count: return count;
+	default: throw "Unknown statistic";
+	}
+}
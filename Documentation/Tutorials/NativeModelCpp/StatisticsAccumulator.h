@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// Identifiers of the goodness of fit statistics computed by a StatisticsAccumulator,
+// also the positions of the values returned by the C API.
+enum class AwbmStatistic : int
+{
+	NSE = 0,
+	Bias,
+	RMSE,
+	LogNSE,
+	Count,
+	NumStatistics
+};
+
+// Streaming calculation of statistics comparing a model variable to an observed series, updated at
+// each time step of a simulation so that the simulated series need not be recorded.
+// Time steps where the observation is missing (NaN) or negative are skipped.
+class StatisticsAccumulator
+{
+public:
+	// observed is indexed by time step; statistics cover the time steps [from, to].
+	// logOffset is added to both series before taking logarithms for the log-NSE, to handle zero flows.
+	StatisticsAccumulator(const double * modelVariable, const std::shared_ptr<const std::vector<double>>& observed, int from, int to, double logOffset);
+
+	void Reset();
+	void Update(int index)
+	{
+		if (index < from || index > to) return;
+		accumulate((*observed)[index], *modelVariable);
+	}
+	double GetStatistic(AwbmStatistic statistic) const;
+	void Rebind(const double * modelVariable) { this->modelVariable = modelVariable; }
+	int From() const { return from; }
+	int To() const { return to; }
+
+private:
+	const double * modelVariable;
+	std::shared_ptr<const std::vector<double>> observed;
+	int from, to;
+	double logOffset;
+
+	// Running sums; the variances of the observations use Welford's updates for numerical stability.
+	int count;
+	double sumObs, sumSim, sumSqErr, meanObs, m2Obs;
+	double sumSqLogErr, meanLogObs, m2LogObs;
+
+	void accumulate(double obs, double sim);
+};
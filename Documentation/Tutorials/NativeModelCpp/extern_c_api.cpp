@@ -1,16 +1,35 @@
 #include "extern_c_api.h"
+#include "AwbmSimulationPool.h"
 
 #include <string> 
 
 
+// Simulations are recycled through a pool, so that creating, cloning and disposing of
+// simulations repeatedly, as evaluators of optimisers do, does not allocate memory.
 AwbmSimulation * CreateSimulation()
 {
-	return new AwbmSimulation();
+	return AwbmSimulationPool::Default().Acquire();
 }
 
 AwbmSimulation * Clone(AwbmSimulation * src)
 {
-	return new AwbmSimulation(*src);
+	return AwbmSimulationPool::Default().Acquire(*src);
+}
+
+void ResetToTemplate(AwbmSimulation * modelSimulation, AwbmSimulation * templateSimulation)
+{
+	modelSimulation->CopyFrom(*templateSimulation);
+}
+
+void SetPoolCapacity(int capacity)
+{
+	if (capacity < 0) throw "Pool capacity must be positive";
+	AwbmSimulationPool::Default().SetCapacity((size_t)capacity);
+}
+
+void ClearPool()
+{
+	AwbmSimulationPool::Default().Clear();
 }
 
 bool SupportsThreadSafeCloning(AwbmSimulation * src)
@@ -20,7 +39,7 @@ bool SupportsThreadSafeCloning(AwbmSimulation * src)
 
 void Dispose(AwbmSimulation * modelSimulation)
 {
-	delete modelSimulation;
+	AwbmSimulationPool::Default().Release(modelSimulation);
 }
 
 void Execute(AwbmSimulation * modelSimulation)
@@ -28,14 +47,20 @@ void Execute(AwbmSimulation * modelSimulation)
 	modelSimulation->Execute();
 }
 
+void ExecuteBatch(AwbmSimulation * modelSimulation, char ** parameterIds, int numParameters, double * parameterSets, int numSets, char * outputId, double * outputs, int outputLength)
+{
+	if (modelSimulation->NumSteps() * numSets != outputLength) throw "data length specifications are inconsistent";
+	std::vector<std::string> ids;
+	for (int j = 0; j < numParameters; j++)
+		ids.push_back(std::string(parameterIds[j]));
+	modelSimulation->ExecuteBatch(ids, parameterSets, numSets, std::string(outputId), outputs);
+}
+
 void GetRecorded(AwbmSimulation * modelSimulation, char * variableIdentifier, double * values, int arrayLength)
 {
 	int simulLen = modelSimulation->NumSteps();
 	if (simulLen != arrayLength) throw "data length specifications are inconsistent";
-	auto tmp = modelSimulation->GetRecorded(std::string(variableIdentifier));
-	for (int i = 0; i < arrayLength; i++)
-		values[i] = tmp[i]; // TODO: faster options? memcopy?
-
+	modelSimulation->GetRecorded(modelSimulation->ResolveVariable(std::string(variableIdentifier)), values, arrayLength);
 }
 
 void SetSpan(AwbmSimulation * modelSimulation, int from, int to)
@@ -45,12 +70,8 @@ void SetSpan(AwbmSimulation * modelSimulation, int from, int to)
 
 void Play(AwbmSimulation * modelSimulation, char * variableIdentifier, double * values, int arrayLength)
 {
-	std::vector<double> d;
-	for (size_t i = 0; i < arrayLength; i++)
-	{
-		d.push_back(values[i]);
-	}
-	modelSimulation->Play(std::string(variableIdentifier), d);
+	SharedSeries d = std::make_shared<const std::vector<double>>(values, values + arrayLength);
+	modelSimulation->Play(modelSimulation->ResolveVariable(std::string(variableIdentifier)), d);
 }
 
 void Record(AwbmSimulation * modelSimulation, char * variableIdentifier)
@@ -68,6 +89,113 @@ double GetVariable(AwbmSimulation * modelSimulation, char * variableIdentifier)
 	return modelSimulation->GetVariable(std::string(variableIdentifier));
 }
 
+static AwbmVariable toVariableId(int variableId)
+{
+	if (variableId < 0 || variableId >= (int)AwbmVariable::Count) throw "Invalid model variable handle";
+	return (AwbmVariable)variableId;
+}
+
+int ResolveVariable(AwbmSimulation * modelSimulation, char * variableIdentifier)
+{
+	return (int)modelSimulation->ResolveVariable(std::string(variableIdentifier));
+}
+
+void GetRecordedById(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength)
+{
+	int simulLen = modelSimulation->NumSteps();
+	if (simulLen != arrayLength) throw "data length specifications are inconsistent";
+	modelSimulation->GetRecorded(toVariableId(variableId), values, arrayLength);
+}
+
+void PlayById(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength)
+{
+	SharedSeries d = std::make_shared<const std::vector<double>>(values, values + arrayLength);
+	modelSimulation->Play(toVariableId(variableId), d);
+}
+
+void PlayBorrowed(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength)
+{
+	modelSimulation->PlayBorrowed(toVariableId(variableId), values, arrayLength);
+}
+
+void RecordTo(AwbmSimulation * modelSimulation, int variableId, double * destination, int arrayLength)
+{
+	modelSimulation->RecordTo(toVariableId(variableId), destination, arrayLength);
+}
+
+void RecordById(AwbmSimulation * modelSimulation, int variableId)
+{
+	modelSimulation->Record(toVariableId(variableId));
+}
+
+void SetVariableById(AwbmSimulation * modelSimulation, int variableId, double value)
+{
+	modelSimulation->SetVariable(toVariableId(variableId), value);
+}
+
+double GetVariableById(AwbmSimulation * modelSimulation, int variableId)
+{
+	return modelSimulation->GetVariable(toVariableId(variableId));
+}
+
+int GetStateSize()
+{
+	return AwbmState::Size;
+}
+
+void SaveState(AwbmSimulation * modelSimulation, double * state, int stateSize)
+{
+	if (stateSize != AwbmState::Size) throw "state length specifications are inconsistent";
+	modelSimulation->SaveState().CopyTo(state);
+}
+
+void RestoreState(AwbmSimulation * modelSimulation, double * state, int stateSize)
+{
+	if (stateSize != AwbmState::Size) throw "state length specifications are inconsistent";
+	AwbmState s;
+	s.CopyFrom(state);
+	modelSimulation->RestoreState(s);
+}
+
+void SetCheckpoint(AwbmSimulation * modelSimulation, int index)
+{
+	modelSimulation->SetCheckpoint(index);
+}
+
+void ClearCheckpoints(AwbmSimulation * modelSimulation)
+{
+	modelSimulation->ClearCheckpoints();
+}
+
+void GetCheckpoint(AwbmSimulation * modelSimulation, int index, double * state, int stateSize)
+{
+	if (stateSize != AwbmState::Size) throw "state length specifications are inconsistent";
+	modelSimulation->GetCheckpoint(index).CopyTo(state);
+}
+
+int GetNumStatistics()
+{
+	return (int)AwbmStatistic::NumStatistics;
+}
+
+int AddStatistics(AwbmSimulation * modelSimulation, int variableId, double * observed, int observedLength, int from, int to, double logOffset)
+{
+	SharedSeries obs = std::make_shared<const std::vector<double>>(observed, observed + observedLength);
+	return modelSimulation->AddStatistics(toVariableId(variableId), obs, from, to, logOffset);
+}
+
+void GetStatistics(AwbmSimulation * modelSimulation, int handle, double * values, int numValues)
+{
+	if (numValues != (int)AwbmStatistic::NumStatistics) throw "statistics length specifications are inconsistent";
+	for (int i = 0; i < numValues; i++)
+		values[i] = modelSimulation->GetStatistic(handle, (AwbmStatistic)i);
+}
+
+void ClearStatistics(AwbmSimulation * modelSimulation)
+{
+	modelSimulation->ClearStatistics();
+}
+
 int GetStart(AwbmSimulation * modelSimulation)
 {
 	return modelSimulation->GetStart();
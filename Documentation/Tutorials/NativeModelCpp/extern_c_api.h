@@ -15,18 +15,45 @@ extern "C" {
 #endif
 
 	NATIVE_AWBM_API void Execute(AwbmSimulation * modelSimulation);
+	NATIVE_AWBM_API void ExecuteBatch(AwbmSimulation * modelSimulation, char ** parameterIds, int numParameters, double * parameterSets, int numSets, char * outputId, double * outputs, int outputLength);
 	NATIVE_AWBM_API void GetRecorded(AwbmSimulation * modelSimulation, char * variableIdentifier, double * values, int arrayLength);
 	NATIVE_AWBM_API void SetSpan(AwbmSimulation * modelSimulation, int from, int to);
 	NATIVE_AWBM_API void Play(AwbmSimulation * modelSimulation, char * variableIdentifier, double * values, int arrayLength);
 	NATIVE_AWBM_API void Record(AwbmSimulation * modelSimulation, char * variableIdentifier);
 	NATIVE_AWBM_API void SetVariable(AwbmSimulation * modelSimulation, char * variableIdentifier, double value);
 	NATIVE_AWBM_API double GetVariable(AwbmSimulation * modelSimulation, char * variableIdentifier);
+	// Integer handle based variants; variable handles are obtained once with ResolveVariable.
+	NATIVE_AWBM_API int ResolveVariable(AwbmSimulation * modelSimulation, char * variableIdentifier);
+	NATIVE_AWBM_API void GetRecordedById(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength);
+	NATIVE_AWBM_API void PlayById(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength);
+	// Zero-copy variants: the simulation reads from, or writes to, the caller buffers at each Execute.
+	// Buffers must stay valid (pinned, if managed) until the variable is played or recorded again, or the simulation is disposed.
+	NATIVE_AWBM_API void PlayBorrowed(AwbmSimulation * modelSimulation, int variableId, double * values, int arrayLength);
+	NATIVE_AWBM_API void RecordTo(AwbmSimulation * modelSimulation, int variableId, double * destination, int arrayLength);
+	NATIVE_AWBM_API void RecordById(AwbmSimulation * modelSimulation, int variableId);
+	NATIVE_AWBM_API void SetVariableById(AwbmSimulation * modelSimulation, int variableId, double value);
+	NATIVE_AWBM_API double GetVariableById(AwbmSimulation * modelSimulation, int variableId);
+	// Model states as flat arrays of GetStateSize() values, to warm start executions from a point in time.
+	NATIVE_AWBM_API int GetStateSize();
+	NATIVE_AWBM_API void SaveState(AwbmSimulation * modelSimulation, double * state, int stateSize);
+	NATIVE_AWBM_API void RestoreState(AwbmSimulation * modelSimulation, double * state, int stateSize);
+	NATIVE_AWBM_API void SetCheckpoint(AwbmSimulation * modelSimulation, int index);
+	NATIVE_AWBM_API void ClearCheckpoints(AwbmSimulation * modelSimulation);
+	NATIVE_AWBM_API void GetCheckpoint(AwbmSimulation * modelSimulation, int index, double * state, int stateSize);
+	// Streaming statistics (see AwbmStatistic for the order of the values) of a model variable against observations.
+	NATIVE_AWBM_API int GetNumStatistics();
+	NATIVE_AWBM_API int AddStatistics(AwbmSimulation * modelSimulation, int variableId, double * observed, int observedLength, int from, int to, double logOffset);
+	NATIVE_AWBM_API void GetStatistics(AwbmSimulation * modelSimulation, int handle, double * values, int numValues);
+	NATIVE_AWBM_API void ClearStatistics(AwbmSimulation * modelSimulation);
 	NATIVE_AWBM_API int GetStart(AwbmSimulation * modelSimulation);
 	NATIVE_AWBM_API int GetEnd(AwbmSimulation * modelSimulation);
 	NATIVE_AWBM_API AwbmSimulation * CreateSimulation();
 	NATIVE_AWBM_API AwbmSimulation * Clone(AwbmSimulation * src);
 	NATIVE_AWBM_API bool SupportsThreadSafeCloning(AwbmSimulation * src);
 	NATIVE_AWBM_API void Dispose(AwbmSimulation * modelSimulation);
+	NATIVE_AWBM_API void ResetToTemplate(AwbmSimulation * modelSimulation, AwbmSimulation * templateSimulation);
+	NATIVE_AWBM_API void SetPoolCapacity(int capacity);
+	NATIVE_AWBM_API void ClearPool();
 
 #ifdef __cplusplus
 }
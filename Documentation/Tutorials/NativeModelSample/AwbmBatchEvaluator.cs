@@ -0,0 +1,108 @@
+using System;
+using CSIRO.Metaheuristics;
+using CSIRO.Metaheuristics.Utils;
+using NativeModelWrapper;
+
+namespace NativeModelSample
+{
+    /// <summary>
+    /// A sum of squares runoff objective evaluator of the native AWBM simulation, running all the candidates
+    /// of a batch in a single call to <see cref="AwbmWrapper.ExecuteBatch"/>.
+    /// </summary>
+    /// <remarks>
+    /// The scores are those of the evaluator of ModellingSampleAdapter, whose runs execute one parameter set at a time.
+    /// The parameters not set by the candidates are those currently set in the simulation, which is not modified by the evaluations.
+    /// Clones own a clone of the simulation, released when they are disposed of; the simulation given to the constructor belongs to the caller.
+    /// </remarks>
+    public class AwbmBatchEvaluator : IClonableObjectiveEvaluator<IHyperCube<double>>, IBatchObjectiveEvaluator<IHyperCube<double>>, IDisposable
+    {
+        /// <summary>
+        /// Creates a batch evaluator
+        /// </summary>
+        /// <param name="simulation">The simulation, with its forcing data played and its span set</param>
+        /// <param name="observedData">The observed runoff, indexed by time step. Missing (NaN) and negative values are skipped.</param>
+        /// <param name="from">First time step of the statistics period</param>
+        /// <param name="to">Time step after the last one of the statistics period</param>
+        public AwbmBatchEvaluator(AwbmWrapper simulation, double[] observedData, int from, int to)
+            : this(simulation, observedData, from, to, false)
+        {
+        }
+
+        private AwbmBatchEvaluator(AwbmWrapper simulation, double[] observedData, int from, int to, bool ownsSimulation)
+        {
+            if (simulation == null)
+                throw new ArgumentNullException("simulation");
+            this.simulation = simulation;
+            this.observedData = observedData;
+            this.from = from;
+            this.to = to;
+            this.ownsSimulation = ownsSimulation;
+        }
+
+        private readonly AwbmWrapper simulation;
+        private readonly bool ownsSimulation;
+        private readonly double[] observedData;
+        private readonly int from, to;
+
+        public IObjectiveScores<IHyperCube<double>> EvaluateScore(IHyperCube<double> systemConfiguration)
+        {
+            return EvaluateScores(new[] { systemConfiguration })[0];
+        }
+
+        public IObjectiveScores<IHyperCube<double>>[] EvaluateScores(IHyperCube<double>[] systemConfigurations)
+        {
+            var result = new IObjectiveScores<IHyperCube<double>>[systemConfigurations.Length];
+            if (systemConfigurations.Length == 0)
+                return result;
+            var parameterIds = systemConfigurations[0].GetVariableNames();
+            var parameterSets = new double[systemConfigurations.Length][];
+            for (int k = 0; k < parameterSets.Length; k++)
+            {
+                var values = new double[parameterIds.Length];
+                for (int j = 0; j < parameterIds.Length; j++)
+                    values[j] = systemConfigurations[k].GetValue(parameterIds[j]);
+                parameterSets[k] = values;
+            }
+            var runoff = simulation.ExecuteBatch(parameterIds, parameterSets, "Runoff");
+            int start = simulation.GetStart();
+            for (int k = 0; k < result.Length; k++)
+                result[k] = MetaheuristicsHelper.CreateSingleObjective(systemConfigurations[k], sumSquares(runoff[k], start), "Sum Squares");
+            return result;
+        }
+
+        // The series of a batch run start at the first time step of the simulation span.
+        private double sumSquares(double[] calculated, int start)
+        {
+            double res = 0, d;
+            for (int i = from; i < to; i++)
+            {
+                if (double.IsNaN(observedData[i]) || observedData[i] < 0)
+                    continue;
+                d = calculated[i - start] - observedData[i];
+                res += d * d;
+            }
+            return res;
+        }
+
+        public bool SupportsDeepCloning
+        {
+            get { return simulation.SupportsDeepCloning; }
+        }
+
+        public bool SupportsThreadSafeCloning
+        {
+            get { return simulation.SupportsThreadSafeCloning; }
+        }
+
+        public IClonableObjectiveEvaluator<IHyperCube<double>> Clone()
+        {
+            return new AwbmBatchEvaluator((AwbmWrapper)simulation.Clone(), observedData, from, to, true);
+        }
+
+        public void Dispose()
+        {
+            if (ownsSimulation)
+                simulation.Dispose();
+        }
+    }
+}
@@ -1,5 +1,6 @@
 ﻿using System;
 using CSIRO.Metaheuristics;
+using CSIRO.Metaheuristics.CandidateFactories;
 using CSIRO.Metaheuristics.Optimization;
 using CSIRO.Metaheuristics.RandomNumberGenerators;
 using CSIRO.Metaheuristics.Utils;
@@ -37,6 +38,29 @@ namespace NativeModelSample
                 uniformRandomSampling = new UniformRandomSampling<IHyperCube<double>>(evaluator, new BasicRngFactory(0), paramSpace, 3000);
                 var ursResults = uniformRandomSampling.Evolve();
                 Console.WriteLine(MetaheuristicsHelper.GetHumanReadable(ursResults));
+
+                /*
+                 * The native simulation can also run several parameter sets in one call. With the option
+                 * SpeculativeBatchEvaluation, each step of the evolution of a complex evaluates its reflected,
+                 * contracted and random candidates together, in one batch run of the native model.
+                 */
+                var batchEvaluator = new AwbmBatchEvaluator(simulation, data.Runoff, from, to);
+                var rng = new BasicRngFactory(0);
+                var sce = new ShuffledComplexEvolution<IHyperCube<double>>(batchEvaluator,
+                    new UniformRandomSamplingFactory<IHyperCube<double>>(rng.CreateFactory(), paramSpace),
+                    new ShuffledComplexEvolution<IHyperCube<double>>.MaxShuffleTerminationCondition(),
+                    rng: rng, options: SceOptions.SpeculativeBatchEvaluation);
+                var sceResults = sce.Evolve();
+                Console.WriteLine(MetaheuristicsHelper.GetHumanReadable(sceResults));
+
+                // The batch runs give the same scores as the runs of one parameter set at a time
+                foreach (var s in sceResults)
+                {
+                    double batchScore = (double)s.GetObjective(0).ValueComparable;
+                    double singleScore = (double)evaluator.EvaluateScore((IHyperCube<double>)s.GetSystemConfiguration()).GetObjective(0).ValueComparable;
+                    if (Math.Abs(batchScore - singleScore) > 1e-9 * Math.Abs(singleScore))
+                        throw new Exception(string.Format("Sum of squares of {0} for a batch run, instead of {1}", batchScore, singleScore));
+                }
             }
         }
     }
@@ -0,0 +1,19 @@
+﻿namespace NativeModelWrapper
+{
+    /// <summary>
+    /// Statistics accumulated by the native simulation during executions, in the order of the values returned by <see cref="AwbmWrapper.GetStatistics"/>
+    /// </summary>
+    public enum AwbmStatistic
+    {
+        /// <summary>Nash-Sutcliffe efficiency</summary>
+        NSE = 0,
+        /// <summary>Relative bias of the simulated volume, (sum(sim) - sum(obs)) / sum(obs)</summary>
+        Bias,
+        /// <summary>Root mean square error</summary>
+        RMSE,
+        /// <summary>Nash-Sutcliffe efficiency of the logarithms of the series, with an offset for zero values</summary>
+        LogNSE,
+        /// <summary>Number of time steps with valid observations</summary>
+        Count
+    }
+}
@@ -29,6 +29,7 @@ namespace NativeModelWrapper
                 throw new NotSupportedException("source model says it cannot be cloned in a thread-safe manner");
             IntPtr pointer = api.Clone(src);
             SetHandle(pointer);
+            api.PinBorrowedInputs(src.api);
         }
 
         NativeApi<AwbmWrapper> api;
@@ -37,6 +38,8 @@ namespace NativeModelWrapper
         {
             if (IsInvalid)
                 return true;
+            // Returns the native simulation to the pool of the native library
+            this.api.Dispose(this);
             this.api.Dispose();
             this.SetHandleAsInvalid();
             return true;
@@ -52,6 +55,20 @@ namespace NativeModelWrapper
             api.Execute(this);
         }
 
+        /// <summary>
+        /// Execute the simulation for several parameter sets in a single native call, reading the played forcing data once per time step.
+        /// </summary>
+        /// <param name="parameterIds">Identifiers of the model parameters set by each parameter set, e.g. C1, KBase</param>
+        /// <param name="parameterSets">The parameter sets; each has one value per parameter identifier</param>
+        /// <param name="outputId">Identifier of the model output to record, e.g. Runoff</param>
+        /// <returns>The recorded output, one series for each parameter set</returns>
+        /// <remarks>The parameters not specified by parameterIds are those currently set in this simulation. 
+        /// The state of this simulation is not modified by a batch execution.</remarks>
+        public double[][] ExecuteBatch(string[] parameterIds, double[][] parameterSets, string outputId)
+        {
+            return api.ExecuteBatch(this, parameterIds, parameterSets, outputId);
+        }
+
         public void SetSpan(int start, int end)
         {
             api.SetSpan(this, start, end);
@@ -82,6 +99,143 @@ namespace NativeModelWrapper
             return api.GetVariable(this, modelPropertyId);
         }
 
+        /// <summary>
+        /// Resolve a model variable identifier to an integer handle, to use with the overloads 
+        /// taking a handle. This avoids string marshalling and comparisons in repeated calls, 
+        /// e.g. setting parameters for each evaluation of an objective.
+        /// </summary>
+        /// <param name="modelPropertyId">Identifier of the model variable, e.g. C1, Rainfall</param>
+        /// <returns>The handle of the model variable, valid for any AWBM simulation</returns>
+        public int ResolveVariable(string modelPropertyId)
+        {
+            return api.ResolveVariable(this, modelPropertyId);
+        }
+
+        public void Play(int variableId, double[] values)
+        {
+            api.Play(this, variableId, values);
+        }
+
+        public void Record(int variableId)
+        {
+            api.Record(this, variableId);
+        }
+
+        /// <summary>
+        /// Play an array of values into a model variable without copying it. The array is pinned and 
+        /// read by the native simulation at each execution, until the variable is played again or this simulation is disposed.
+        /// </summary>
+        /// <remarks>Changes to the array content are seen by subsequent executions. Clones of this simulation read the same array.</remarks>
+        public void PlayBorrowed(int variableId, double[] values)
+        {
+            api.PlayBorrowed(this, variableId, values);
+        }
+
+        /// <summary>
+        /// Play values from unmanaged memory into a model variable without copying them, e.g. a column 
+        /// of a memory-mapped data file (see CSIRO.Utilities.MappedNumericColumns). 
+        /// </summary>
+        /// <remarks>The memory must remain valid until the variable is played again or this simulation and 
+        /// its clones are disposed; it is not pinned nor released by this simulation.</remarks>
+        public void PlayBorrowed(int variableId, IntPtr values, int length)
+        {
+            api.PlayBorrowed(this, variableId, values, length);
+        }
+
+        /// <summary>
+        /// Record a model variable directly into a destination array, written by each execution 
+        /// without intermediate copies. The array is pinned until the variable is recorded again or 
+        /// this simulation is disposed.
+        /// </summary>
+        /// <remarks>The length of the array must be the number of time steps of the simulation span. 
+        /// Clones of this simulation record to their own storage.</remarks>
+        public void RecordTo(int variableId, double[] destination)
+        {
+            api.RecordTo(this, variableId, destination);
+        }
+
+        public double[] GetRecorded(int variableId)
+        {
+            return api.GetRecorded(this, variableId);
+        }
+
+        public void SetVariable(int variableId, double value)
+        {
+            api.SetVariable(this, variableId, value);
+        }
+
+        public double GetVariable(int variableId)
+        {
+            return api.GetVariable(this, variableId);
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the current model states, e.g. at the end of a warm-up period.
+        /// </summary>
+        public double[] SaveState()
+        {
+            return api.SaveState(this);
+        }
+
+        /// <summary>
+        /// Restore the model states, from which the next execution will start instead of the initial states.
+        /// </summary>
+        /// <remarks>Played series are indexed by time step, so restoring the state at the end of time step i 
+        /// and setting the span to start at i+1 continues the simulation without playing data again.</remarks>
+        public void RestoreState(double[] state)
+        {
+            api.RestoreState(this, state);
+        }
+
+        /// <summary>
+        /// Request a snapshot of the model states at the end of a time step, taken during the next executions.
+        /// </summary>
+        public void SetCheckpoint(int index)
+        {
+            api.SetCheckpoint(this, index);
+        }
+
+        public void ClearCheckpoints()
+        {
+            api.ClearCheckpoints(this);
+        }
+
+        /// <summary>
+        /// Gets the model states at the end of a time step set with SetCheckpoint, as of the last execution reaching it.
+        /// </summary>
+        public double[] GetCheckpoint(int index)
+        {
+            return api.GetCheckpoint(this, index);
+        }
+
+        /// <summary>
+        /// Attach observations to a model variable, so that goodness of fit statistics are accumulated 
+        /// natively during each execution, without recording and transferring the simulated series.
+        /// </summary>
+        /// <param name="variableId">Handle of the model variable, from ResolveVariable</param>
+        /// <param name="observed">Observations, indexed by time step. Missing (NaN) and negative values are skipped.</param>
+        /// <param name="from">First time step of the statistics period</param>
+        /// <param name="to">Last time step of the statistics period</param>
+        /// <param name="logOffset">Offset added to both series before taking logarithms for the log-NSE</param>
+        /// <returns>A handle to get the statistics with GetStatistics after an execution</returns>
+        public int AddStatistics(int variableId, double[] observed, int from, int to, double logOffset = 1.0)
+        {
+            return api.AddStatistics(this, variableId, observed, from, to, logOffset);
+        }
+
+        /// <summary>
+        /// Gets the statistics calculated by the last execution, indexed by <see cref="AwbmStatistic"/>
+        /// </summary>
+        public double[] GetStatistics(int handle)
+        {
+            return api.GetStatistics(this, handle);
+        }
+
+        public void ClearStatistics()
+        {
+            api.ClearStatistics(this);
+        }
+
         public int GetStart()
         {
             return api.GetStart(this);
@@ -92,6 +246,30 @@ namespace NativeModelWrapper
             return api.GetEnd(this);
         }
 
+        /// <summary>
+        /// Reconfigure this simulation as a clone of a template simulation, reusing the native storage of this simulation.
+        /// </summary>
+        public void ResetTo(AwbmWrapper templateSimulation)
+        {
+            api.ResetToTemplate(this, templateSimulation, templateSimulation.api);
+        }
+
+        /// <summary>
+        /// Sets the maximum number of disposed native simulations kept for reuse by the native library.
+        /// </summary>
+        public static void SetPoolCapacity(int capacity)
+        {
+            NativeApi<AwbmWrapper>.SetPoolCapacity(capacity);
+        }
+
+        /// <summary>
+        /// Frees the disposed native simulations kept for reuse by the native library.
+        /// </summary>
+        public static void ClearPool()
+        {
+            NativeApi<AwbmWrapper>.ClearPool();
+        }
+
         public IModelSimulation<double[], double, int> Clone()
         {
             return new AwbmWrapper(this);
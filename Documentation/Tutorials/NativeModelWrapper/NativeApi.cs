@@ -1,4 +1,6 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
 using CSIRO.Modelling.Core;
 using CSIRO.Modelling.Core.Interop;
 
@@ -14,10 +16,16 @@ namespace NativeModelWrapper
     internal class NativeApi<M> : IDisposable
         where M : IModelSimulation<double[], double, int>, INativeHandle
     {
+        // Managed arrays borrowed by the native simulation, pinned until replaced or disposed.
+        private readonly Dictionary<int, GCHandle> pinnedInputs = new Dictionary<int, GCHandle>();
+        private readonly Dictionary<int, GCHandle> pinnedOutputs = new Dictionary<int, GCHandle>();
+
         protected virtual void Dispose(bool disposing)
         {
-            // In this intance, there is nothing to do to clean up, because no 
-            // native resources are held, as such.
+            // No native resources are held as such, but managed arrays 
+            // borrowed by the native simulation must be unpinned.
+            unpinAll(pinnedInputs);
+            unpinAll(pinnedOutputs);
         }
 
         public void Dispose()
@@ -41,11 +49,52 @@ namespace NativeModelWrapper
             NativeApiPInvoke.Dispose(modelWrapper.DangerousGetHandle());
         }
 
+        internal void ResetToTemplate(M modelWrapper, M templateWrapper, NativeApi<M> templateApi)
+        {
+            NativeApiPInvoke.ResetToTemplate(modelWrapper.DangerousGetHandle(), templateWrapper.DangerousGetHandle());
+            unpinAll(pinnedInputs);
+            unpinAll(pinnedOutputs);
+            PinBorrowedInputs(templateApi);
+        }
+
+        internal static void SetPoolCapacity(int capacity)
+        {
+            NativeApiPInvoke.SetPoolCapacity(capacity);
+        }
+
+        internal static void ClearPool()
+        {
+            NativeApiPInvoke.ClearPool();
+        }
+
         internal void Execute(M modelWrapper)
         {
             NativeApiPInvoke.Execute(modelWrapper.DangerousGetHandle());
         }
 
+        internal double[][] ExecuteBatch(M modelWrapper, string[] parameterIds, double[][] parameterSets, string outputId)
+        {
+            int numParameters = parameterIds.Length;
+            int numSets = parameterSets.Length;
+            double[] packedSets = new double[numSets * numParameters];
+            for (int k = 0; k < numSets; k++)
+            {
+                if (parameterSets[k].Length != numParameters)
+                    throw new ArgumentException("Each parameter set must have one value per parameter identifier");
+                Array.Copy(parameterSets[k], 0, packedSets, k * numParameters, numParameters);
+            }
+            int length = GetSimulationLength(modelWrapper);
+            double[] outputs = new double[numSets * length];
+            NativeApiPInvoke.ExecuteBatch(modelWrapper.DangerousGetHandle(), parameterIds, numParameters, packedSets, numSets, outputId, outputs, outputs.Length);
+            double[][] result = new double[numSets][];
+            for (int k = 0; k < numSets; k++)
+            {
+                result[k] = new double[length];
+                Array.Copy(outputs, k * length, result[k], 0, length);
+            }
+            return result;
+        }
+
         internal void SetSpan(M modelWrapper, int start, int end)
         {
             NativeApiPInvoke.SetSpan(modelWrapper.DangerousGetHandle(), start, end);
@@ -53,11 +102,15 @@ namespace NativeModelWrapper
 
         internal void Play(M modelWrapper, string modelPropertyId, double[] values)
         {
+            if (pinnedInputs.Count > 0)
+                unpin(pinnedInputs, ResolveVariable(modelWrapper, modelPropertyId));
             NativeApiPInvoke.Play(modelWrapper.DangerousGetHandle(), modelPropertyId, values, values.Length);
         }
 
         internal void Record(M modelWrapper, string modelPropertyId)
         {
+            if (pinnedOutputs.Count > 0)
+                unpin(pinnedOutputs, ResolveVariable(modelWrapper, modelPropertyId));
             NativeApiPInvoke.Record(modelWrapper.DangerousGetHandle(), modelPropertyId);
         }
 
@@ -85,6 +138,139 @@ namespace NativeModelWrapper
             return NativeApiPInvoke.GetVariable(modelWrapper.DangerousGetHandle(), modelPropertyId);
         }
 
+        internal int ResolveVariable(M modelWrapper, string modelPropertyId)
+        {
+            return NativeApiPInvoke.ResolveVariable(modelWrapper.DangerousGetHandle(), modelPropertyId);
+        }
+
+        internal void Play(M modelWrapper, int variableId, double[] values)
+        {
+            unpin(pinnedInputs, variableId);
+            NativeApiPInvoke.PlayById(modelWrapper.DangerousGetHandle(), variableId, values, values.Length);
+        }
+
+        internal void Record(M modelWrapper, int variableId)
+        {
+            unpin(pinnedOutputs, variableId);
+            NativeApiPInvoke.RecordById(modelWrapper.DangerousGetHandle(), variableId);
+        }
+
+        internal void PlayBorrowed(M modelWrapper, int variableId, double[] values)
+        {
+            GCHandle pinned = pin(pinnedInputs, variableId, values);
+            NativeApiPInvoke.PlayBorrowed(modelWrapper.DangerousGetHandle(), variableId, pinned.AddrOfPinnedObject(), values.Length);
+        }
+
+        internal void PlayBorrowed(M modelWrapper, int variableId, IntPtr values, int length)
+        {
+            unpin(pinnedInputs, variableId);
+            NativeApiPInvoke.PlayBorrowed(modelWrapper.DangerousGetHandle(), variableId, values, length);
+        }
+
+        internal void RecordTo(M modelWrapper, int variableId, double[] destination)
+        {
+            GCHandle pinned = pin(pinnedOutputs, variableId, destination);
+            NativeApiPInvoke.RecordTo(modelWrapper.DangerousGetHandle(), variableId, pinned.AddrOfPinnedObject(), destination.Length);
+        }
+
+        /// <summary>
+        /// Pin the inputs borrowed by a source simulation, which its native clone reads too.
+        /// </summary>
+        internal void PinBorrowedInputs(NativeApi<M> src)
+        {
+            foreach (var x in src.pinnedInputs)
+                pin(pinnedInputs, x.Key, (double[])x.Value.Target);
+        }
+
+        private static GCHandle pin(Dictionary<int, GCHandle> pinned, int variableId, double[] values)
+        {
+            unpin(pinned, variableId);
+            GCHandle handle = GCHandle.Alloc(values, GCHandleType.Pinned);
+            pinned[variableId] = handle;
+            return handle;
+        }
+
+        private static void unpin(Dictionary<int, GCHandle> pinned, int variableId)
+        {
+            GCHandle handle;
+            if (pinned.TryGetValue(variableId, out handle))
+            {
+                handle.Free();
+                pinned.Remove(variableId);
+            }
+        }
+
+        private static void unpinAll(Dictionary<int, GCHandle> pinned)
+        {
+            foreach (var handle in pinned.Values)
+                handle.Free();
+            pinned.Clear();
+        }
+
+        internal double[] GetRecorded(M modelWrapper, int variableId)
+        {
+            int length = GetSimulationLength(modelWrapper);
+            double[] data = new double[length];
+            NativeApiPInvoke.GetRecordedById(modelWrapper.DangerousGetHandle(), variableId, data, length);
+            return data;
+        }
+
+        internal void SetVariable(M modelWrapper, int variableId, double value)
+        {
+            NativeApiPInvoke.SetVariableById(modelWrapper.DangerousGetHandle(), variableId, value);
+        }
+
+        internal double GetVariable(M modelWrapper, int variableId)
+        {
+            return NativeApiPInvoke.GetVariableById(modelWrapper.DangerousGetHandle(), variableId);
+        }
+
+        internal double[] SaveState(M modelWrapper)
+        {
+            double[] state = new double[NativeApiPInvoke.GetStateSize()];
+            NativeApiPInvoke.SaveState(modelWrapper.DangerousGetHandle(), state, state.Length);
+            return state;
+        }
+
+        internal void RestoreState(M modelWrapper, double[] state)
+        {
+            NativeApiPInvoke.RestoreState(modelWrapper.DangerousGetHandle(), state, state.Length);
+        }
+
+        internal void SetCheckpoint(M modelWrapper, int index)
+        {
+            NativeApiPInvoke.SetCheckpoint(modelWrapper.DangerousGetHandle(), index);
+        }
+
+        internal void ClearCheckpoints(M modelWrapper)
+        {
+            NativeApiPInvoke.ClearCheckpoints(modelWrapper.DangerousGetHandle());
+        }
+
+        internal double[] GetCheckpoint(M modelWrapper, int index)
+        {
+            double[] state = new double[NativeApiPInvoke.GetStateSize()];
+            NativeApiPInvoke.GetCheckpoint(modelWrapper.DangerousGetHandle(), index, state, state.Length);
+            return state;
+        }
+
+        internal int AddStatistics(M modelWrapper, int variableId, double[] observed, int from, int to, double logOffset)
+        {
+            return NativeApiPInvoke.AddStatistics(modelWrapper.DangerousGetHandle(), variableId, observed, observed.Length, from, to, logOffset);
+        }
+
+        internal double[] GetStatistics(M modelWrapper, int handle)
+        {
+            double[] values = new double[NativeApiPInvoke.GetNumStatistics()];
+            NativeApiPInvoke.GetStatistics(modelWrapper.DangerousGetHandle(), handle, values, values.Length);
+            return values;
+        }
+
+        internal void ClearStatistics(M modelWrapper)
+        {
+            NativeApiPInvoke.ClearStatistics(modelWrapper.DangerousGetHandle());
+        }
+
         internal int GetStart(M modelWrapper)
         {
             return NativeApiPInvoke.GetStart(modelWrapper.DangerousGetHandle());
@@ -18,9 +18,31 @@ namespace NativeModelWrapper
         [DllImport("NativeModelCpp.dll", EntryPoint = "Dispose", CallingConvention = CallingConvention.Cdecl)]
         internal static extern void Dispose(IntPtr nativeModel);
 
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ResetToTemplate", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ResetToTemplate(
+            [In] IntPtr nativeModel,
+            [In] IntPtr templateModel);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "SetPoolCapacity", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void SetPoolCapacity([In] int capacity);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ClearPool", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ClearPool();
+
         [DllImport("NativeModelCpp.dll", EntryPoint = "Execute", CallingConvention = CallingConvention.Cdecl)]
         internal static extern void Execute(IntPtr nativeModel);
 
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ExecuteBatch", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ExecuteBatch(
+            [In] IntPtr nativeModel,
+            [In] [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPStr)] string[] parameterIds,
+            [In] int numParameters,
+            [In] [MarshalAs(UnmanagedType.LPArray)] double[] parameterSets,
+            [In] int numSets,
+            [In] string outputId,
+            [Out] [MarshalAs(UnmanagedType.LPArray)] double[] outputs,
+            [In] int outputLength);
+
         [DllImport("NativeModelCpp.dll", EntryPoint = "GetRecorded", CallingConvention = CallingConvention.Cdecl)]
         internal static extern void GetRecorded(
             [In] IntPtr nativeModel,
@@ -57,6 +79,110 @@ namespace NativeModelWrapper
             [In] IntPtr nativeModel,
             [In] string variableIdentifier);
 
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ResolveVariable", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int ResolveVariable(
+            [In] IntPtr nativeModel,
+            [In] string variableIdentifier);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetRecordedById", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetRecordedById(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [Out] [MarshalAs(UnmanagedType.LPArray)] double[] values,
+            [In] int arrayLength);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "PlayById", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void PlayById(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [In] [MarshalAs(UnmanagedType.LPArray)] double[] values,
+            [In] int arrayLength);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "PlayBorrowed", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void PlayBorrowed(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [In] IntPtr values,
+            [In] int arrayLength);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "RecordTo", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RecordTo(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [In] IntPtr destination,
+            [In] int arrayLength);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "RecordById", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RecordById(
+            [In] IntPtr nativeModel,
+            [In] int variableId);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "SetVariableById", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void SetVariableById(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [In] double value);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetVariableById", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern double GetVariableById(
+            [In] IntPtr nativeModel,
+            [In] int variableId);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetStateSize", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetStateSize();
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "SaveState", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void SaveState(
+            [In] IntPtr nativeModel,
+            [Out] [MarshalAs(UnmanagedType.LPArray)] double[] state,
+            [In] int stateSize);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "RestoreState", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RestoreState(
+            [In] IntPtr nativeModel,
+            [In] [MarshalAs(UnmanagedType.LPArray)] double[] state,
+            [In] int stateSize);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "SetCheckpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void SetCheckpoint(
+            [In] IntPtr nativeModel,
+            [In] int index);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ClearCheckpoints", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ClearCheckpoints(
+            [In] IntPtr nativeModel);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetCheckpoint", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetCheckpoint(
+            [In] IntPtr nativeModel,
+            [In] int index,
+            [Out] [MarshalAs(UnmanagedType.LPArray)] double[] state,
+            [In] int stateSize);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetNumStatistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int GetNumStatistics();
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "AddStatistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern int AddStatistics(
+            [In] IntPtr nativeModel,
+            [In] int variableId,
+            [In] [MarshalAs(UnmanagedType.LPArray)] double[] observed,
+            [In] int observedLength,
+            [In] int from,
+            [In] int to,
+            [In] double logOffset);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "GetStatistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void GetStatistics(
+            [In] IntPtr nativeModel,
+            [In] int handle,
+            [Out] [MarshalAs(UnmanagedType.LPArray)] double[] values,
+            [In] int numValues);
+
+        [DllImport("NativeModelCpp.dll", EntryPoint = "ClearStatistics", CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void ClearStatistics(
+            [In] IntPtr nativeModel);
+
         [DllImport("NativeModelCpp.dll", EntryPoint = "GetStart", CallingConvention = CallingConvention.Cdecl)]
         internal static extern int GetStart(
             [In] IntPtr nativeModel);
@@ -1,5 +1,7 @@
 ###### Manipulate objective calculators
 
+saHelper <- 'CSIRO.Metaheuristics.R.Pkgs.SensitivityAnalysisHelper'
+
 #' Calculate the score of a given system configuration 
 #'
 #' Calculate the score of a given system configuration 
@@ -29,3 +31,20 @@ asDataFrame <- function(mhObject) {
   clrCallStatic(sysConfigHelper, 'AsDataFrame', mhObject)
 }
 
+#' Calculate the scores of all the points of a design matrix
+#'
+#' Calculate in a single call to the CLR the scores of all the points of a design matrix, for instance the sample of a Sobol sensitivity analysis. 
+#' The points are evaluated in parallel if the objective calculator supports thread safe cloning.
+#'
+#' @param objectiveEvaluator an objective calculator (implements at least IClonableObjectiveEvaluator)
+#' @param template the system configuration from which the points are created (implements at least IHyperCube<double>). Parameters not in the design keep their values.
+#' @param X a numeric matrix or data frame of parameter values, with one row per point and column names that are parameter names
+#' @param maxDegreeOfParallelism the maximum number of concurrent evaluations, or -1 for no limit
+#' @return a numeric matrix of objective values, with one row per point and one column per objective
+#' @export
+evaluateDesign <- function(objectiveEvaluator, template, X, maxDegreeOfParallelism=-1L) {
+  X <- as.matrix(X)
+  if(is.null(colnames(X))) stop('the design matrix must have the names of the parameters as column names')
+  r <- clrCallStatic(saHelper, 'EvaluateDesign', objectiveEvaluator, template, as.numeric(X), nrow(X), colnames(X), as.integer(maxDegreeOfParallelism))
+  matrix(clrGet(r, 'Values'), nrow=clrGet(r, 'RunCount'), dimnames=list(NULL, clrGet(r, 'ObjectiveNames')))
+}
@@ -137,6 +137,32 @@ getLoggerContent <- function(calibLogger) {
   clrCallStatic(sysConfigHelper, 'GetContent', calibLogger)
 }
 
+#' Creates a logger writing a calibration log to column files
+#'
+#' Creates a logger writing a calibration log to column files during the optimisation, to be read with loadMhColumnarLog.
+#' Use it rather than the default in-memory logger for large logs. The logger should be disposed of once the optimisation is done,
+#' with clrCall(calibLogger, 'Dispose'), to write the last rows logged.
+#'
+#' @param dirName the directory of the column files; existing column files in it are deleted.
+#' @param summaryOnly if TRUE, only the information summarising the progress of the optimisation is logged, not the details of each step
+#' @return a CLR object implementing ILoggerMh, to pass to setLogger
+#' @export
+createColumnarLogger <- function(dirName, summaryOnly=FALSE) {
+  clrCallStatic(sysConfigHelper, 'CreateColumnarLogger', path.expand(dirName), summaryOnly)
+}
+
+#' Writes the content of a calibration log to column files
+#'
+#' Writes the content of a calibration log to column files, to be read with loadMhColumnarLog
+#'
+#' @param calibLogger an object implementing ILoggerMh and holding the log entries, such as an in-memory logger
+#' @param dirName the directory of the column files; existing column files in it are deleted.
+#' @return the number of rows written
+#' @export
+writeColumnarLog <- function(calibLogger, dirName) {
+  clrCallStatic(sysConfigHelper, 'WriteColumnar', calibLogger, path.expand(dirName))
+}
+
 
 
 
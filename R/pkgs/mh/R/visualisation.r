@@ -16,6 +16,70 @@ loadMhLog <- function(fn) {
   x
 }
 
+#' Load a columnar log of an optimisation
+#'
+#' Load a log written as column files by a CSIRO.Metaheuristics.Logging.ColumnarLogger, or exported with LoggerMhHelper.WriteColumnar.
+#' Only the columns and rows requested are read from disk, so that subsets of very large logs can be analysed,
+#' including while the optimisation is still running.
+#'
+#' @param dirName the directory of the column files
+#' @param columns optional names of the columns to load; all the columns by default
+#' @param from the first row to load
+#' @param to optional last row to load; by default the last row written so far
+#' @return a data frame, with the string columns as factors, and an added column 'PointNumber' with the row numbers in the log
+#' @export
+#' @examples
+#' \dontrun{
+#' logSce <- loadMhColumnarLog('F:/path/to/caliblog', columns=c('Message', 'Category', 'NSE.logbias', 'Tq'))
+#' }
+loadMhColumnarLog <- function(dirName, columns=NULL, from=1, to=NULL) {
+  manifest <- strsplit(readLines(file.path(dirName, 'columns.txt'), encoding='UTF-8'), '\t', fixed=TRUE)
+  if(manifest[[1]][1] != 'mhcolumns' || manifest[[1]][2] != '1') {
+    stop(paste('Not a supported columnar log of an optimisation:', dirName))
+  }
+  numRows <- as.numeric(manifest[[2]][2])
+  colInfo <- manifest[-(1:2)]
+  colTypes <- sapply(colInfo, function(x) {x[1]})
+  colFiles <- sapply(colInfo, function(x) {x[2]})
+  colNames <- sapply(colInfo, function(x) {x[3]})
+  if(is.null(columns)) {
+    columns <- colNames
+  }
+  unknown <- setdiff(columns, colNames)
+  if(length(unknown) > 0) {
+    stop(paste('Columns not found in the log:', paste(unknown, collapse=', ')))
+  }
+  if(is.null(to)) {
+    to <- numRows
+  }
+  from <- max(1, from)
+  to <- min(to, numRows)
+  n <- max(0, to - from + 1)
+
+  readColumn <- function(i) {
+    fn <- file.path(dirName, colFiles[i])
+    numeric <- (colTypes[i] == 'numeric')
+    size <- if(numeric) 8 else 4
+    con <- file(fn, 'rb')
+    on.exit(close(con))
+    seek(con, (from - 1) * size)
+    x <- readBin(con, what=if(numeric) 'double' else 'integer', n=n, size=size, endian='little')
+    if(numeric) {
+      return(x)
+    }
+    # One-based codes into the levels, zero where the value is missing
+    x[x == 0L] <- NA_integer_
+    lvls <- readLines(paste0(fn, '.levels'), encoding='UTF-8')
+    factor(lvls[x], levels=lvls)
+  }
+
+  result <- lapply(match(columns, colNames), readColumn)
+  names(result) <- columns
+  result <- if(length(result) > 0) as.data.frame(result, optional=TRUE) else data.frame(row.names=seq_len(n))
+  result[[numColname]] <- if(n > 0) from:to else integer(0)
+  result
+}
+
 #' min/max bound numeric values 
 #'
 #' min/max bound numeric values 
@@ -10,6 +10,23 @@ rosen <- clrCallStatic(mtype, "GetRosenbrockFunction")
 clrReflect(rosen)
 sysConfig <- clrCallStatic(mtype, "GetRosenbrockParameters")
 
+# Sobol indices of the Rosenbrock function (Jansen estimator), the whole design being evaluated in a single call to the CLR.
+# Evaluating one point at a time with getScore makes a round trip between R and the CLR per model run.
+if (require(sensitivity)) {
+  p <- pSetAsDataFrame(sysConfig)
+  n <- 10000
+  sampleParams <- function() {
+    x <- sapply(1:nrow(p), function(i) {runif(n, p$Min[i], p$Max[i])})
+    colnames(x) <- p$Name
+    as.data.frame(x)
+  }
+  sa <- soboljansen(model=NULL, X1=sampleParams(), X2=sampleParams(), nboot=100)
+  y <- evaluateDesign(rosen, sysConfig, sa$X)
+  tell(sa, y[,1])
+  print(sa)
+  plot(sa)
+}
+
 
 
 
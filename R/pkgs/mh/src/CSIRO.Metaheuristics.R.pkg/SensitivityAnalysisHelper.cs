@@ -0,0 +1,71 @@
+﻿using System;
+using System.Reflection;
+using System.Threading.Tasks;
+using CSIRO.Metaheuristics.Objectives;
+using CSIRO.Utilities;
+
+namespace CSIRO.Metaheuristics.R.Pkgs
+{
+    public static class SensitivityAnalysisHelper
+    {
+        /// <summary>
+        /// Evaluates in one call all the points of a design matrix, e.g. a Sobol or Saltelli sample,
+        /// so that R does not call the objective evaluator once per model run.
+        /// </summary>
+        /// <param name="evaluator">An objective evaluator, a IClonableObjectiveEvaluator of the type of the template</param>
+        /// <param name="template">The template of the points</param>
+        /// <param name="design">The values of the parameters, column-major as an R matrix with one row per point</param>
+        /// <param name="runCount">The number of rows of the design matrix</param>
+        /// <param name="variableNames">The names of the parameters of the columns of the design matrix</param>
+        /// <param name="maxDegreeOfParallelism">The maximum number of concurrent evaluations, or -1 for no limit</param>
+        /// <param name="sysConfigType">The type of the system configuration for generics; the type of the template if null</param>
+        public static DesignScoresInterop EvaluateDesign(object evaluator, IHyperCube<double> template, double[] design, int runCount,
+            string[] variableNames, int maxDegreeOfParallelism = -1, Type sysConfigType = null)
+        {
+            if (runCount < 0 || design.Length != runCount * variableNames.Length)
+                throw new ArgumentException(string.Format("A design of {0} values is not a matrix of {1} rows and {2} columns", design.Length, runCount, variableNames.Length));
+            var t = sysConfigType ?? template.GetType();
+            var helper = new GenericTypesHelper(typeof(SensitivityAnalysisHelper), BindingFlags.NonPublic | BindingFlags.Static);
+            var method = helper.MakeGenericMethod("internalEvaluateDesign", t);
+            return (DesignScoresInterop)method.Invoke(null, new object[] { evaluator, template, design, runCount, variableNames, maxDegreeOfParallelism });
+        }
+
+        private static DesignScoresInterop internalEvaluateDesign<T>(IClonableObjectiveEvaluator<T> evaluator, T template, double[] design, int runCount,
+            string[] variableNames, int maxDegreeOfParallelism)
+            where T : IHyperCube<double>
+        {
+            var matrix = new double[runCount, variableNames.Length];
+            for (int j = 0; j < variableNames.Length; j++)
+                for (int i = 0; i < runCount; i++)
+                    matrix[i, j] = design[j * runCount + i];
+
+            var designEvaluator = new DesignEvaluator<T>(evaluator, template, variableNames);
+            designEvaluator.ParallelOptions = new ParallelOptions() { MaxDegreeOfParallelism = maxDegreeOfParallelism };
+            var scores = designEvaluator.Evaluate(matrix);
+
+            int numObjectives = scores.GetLength(1);
+            var r = new DesignScoresInterop(runCount, designEvaluator.ObjectiveNames ?? new string[0]);
+            for (int k = 0; k < numObjectives; k++)
+                for (int i = 0; i < runCount; i++)
+                    r.Values[k * runCount + i] = scores[i, k];
+            return r;
+        }
+
+        /// <summary>
+        /// The scores of the points of a design, as a column-major matrix to transfer to R in one go
+        /// </summary>
+        public class DesignScoresInterop
+        {
+            public int RunCount;
+            public string[] ObjectiveNames;
+            public double[] Values;
+
+            public DesignScoresInterop(int runCount, string[] objectiveNames)
+            {
+                this.RunCount = runCount;
+                this.ObjectiveNames = objectiveNames;
+                this.Values = new double[runCount * objectiveNames.Length];
+            }
+        }
+    }
+}
@@ -67,6 +67,16 @@ namespace CSIRO.Metaheuristics.R.Pkgs
             return logInfo.ToDataFrame();
         }
 
+        public static ColumnarLogger CreateColumnarLogger(string directory, bool summaryOnly = false)
+        {
+            return new ColumnarLogger(directory, summaryOnly ? LoggerMhLevel.Summary : LoggerMhLevel.Detailed);
+        }
+
+        public static double WriteColumnar(IEnumerable<ILogInfo> logInfo, string directory)
+        {
+            return logInfo.WriteColumnar(directory);
+        }
+
         public static DataFrame AsDataFrame(IEnumerable<IObjectiveScores> objScores, bool stringsAsFactors = true)
         {
             var e = REngine.GetInstance();
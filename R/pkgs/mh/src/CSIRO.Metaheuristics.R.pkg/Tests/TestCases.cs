@@ -35,6 +35,11 @@ namespace CSIRO.Metaheuristics.R.Pkgs.Tests
             return new ObjResultsWrapper(Array.ConvertAll(inPoints.ToArray(), (x => (IObjectiveScores)evaluator.EvaluateScore(x))));
         }
 
+        public static IClonableObjectiveEvaluator<TestHyperCube> ParaboloidEvaluator(double bestParam = 0)
+        {
+            return new ParaboloidObjEval<TestHyperCube>(bestParam: bestParam);
+        }
+
         //static TestHyperCube CreateTestHc(params double[] coords)
         //{
         //    var inPoints = new List<TestHyperCube>();
@@ -1,5 +1,5 @@
 ﻿using System;
-using System.Collections.Generic;
+using CSIRO.Utilities;
 
 namespace EnvModellingSample
 {
@@ -16,40 +16,35 @@ namespace EnvModellingSample
         public static double[] GetSampleEvaporation() { return GetSampleClimate().Evapotranspiration ; }
         public static double[] GetSampleRunoff() {      return GetSampleClimate().Runoff ; }
 
+        /// <summary>
+        /// The value of the missing values of the climate data
+        /// </summary>
+        public const double MissingValue = -9999;
+
         public static SampleClimate GetSampleClimate()
         {
-            List<double[]> result = new List<double[]>();
             using (var f = new System.IO.StringReader(Properties.Resources.SampleCatchmentData))
-            {
-                var line = f.ReadLine();
-                while (!string.IsNullOrEmpty(line))
-                {
-                    var items = line.Split(',');
-                    double[] values = Array.ConvertAll(items, parseDouble);
-                    if (values.Length != 3)
-                        throw new ArgumentException();
-                    result.Add(values);
-                    line = f.ReadLine();
-                }
-            }
-            int n = result.Count;
-            var res = new double[][] { new double[n], new double[n], new double[n] };
-            for (int i = 0; i < n; i++)
-            {
-                for (int j = 0; j < 3; j++)
-                {
-                    res[j][i] = result[i][j];
-                }
-            }
-            return new SampleClimate { Rainfall = res[0], Evapotranspiration = res[1], Runoff = res[2] };
+                return toClimate(NumericColumnsReader.LoadColumns(f, null, ',', missingValue: MissingValue));
+        }
+
+        /// <summary>
+        /// Loads climate data from a comma separated file with the columns rainfall, evapotranspiration and runoff, without header.
+        /// </summary>
+        /// <param name="fileName">The comma separated file, e.g. CatData.csv</param>
+        /// <param name="useCache">If true, the data is read from a binary cache of the file, written next to it on its first load</param>
+        public static SampleClimate LoadClimate(string fileName, bool useCache = false)
+        {
+            var columns = (useCache ?
+                NumericColumnsCache.LoadColumns(fileName, ',', missingValue: MissingValue) :
+                NumericColumnsReader.LoadColumns(fileName, ',', missingValue: MissingValue));
+            return toClimate(columns);
         }
 
-        static double parseDouble(string str)
+        private static SampleClimate toClimate(double[][] columns)
         {
-            if (str.ToLower() == "na")
-                return -9999;
-            else
-                return double.Parse(str);
+            if (columns.Length != 3)
+                throw new ArgumentException("Expected 3 columns of climate data, but found " + columns.Length);
+            return new SampleClimate { Rainfall = columns[0], Evapotranspiration = columns[1], Runoff = columns[2] };
         }
 
     }